@@ -15,6 +15,23 @@ FLAG(help, false, "-h", "--help", nullopt, nullopt, "Print help message")
 FLAG(verbose, false, "-v", "--verbose", nullopt, nullopt, "Display extra information from the driver")
 FLAG(debug_lexer, false, "-L", "-fdebug-lexer", nullopt, nullopt, "Dump tokens after lexing phase")
 FLAG(debug_parser, false, "", "-fdebug-parser", 1, 0x1, "Dump tokens after lexing phase")
+FLAG(skip_function_bodies, false, "", "-fskip-function-bodies", 1, 0x2,
+     "Only find where function bodies begin and end while parsing, and parse them later")
+FLAG(profile_parser, false, "", "-fprofile-parser", 1, 0x4,
+     "Count what each parse rule costs, and report where the parser backtracks most at exit")
+FLAG(parallel_parse, false, "", "-fparallel-parse", nullopt, nullopt,
+     "Parse top-level declarations on several threads (see -j), after finding every typedef")
+FLAG(pipeline_lexer, false, "", "-fpipeline-lexer", nullopt, nullopt,
+     "Lex on a thread of its own, with the parser taking the tokens as they are made")
+FLAG(scan_dependencies, false, "-M", "--scan-dependencies", nullopt, nullopt,
+     "Only scan sources for their #include and #embed dependencies, writing them as Make rules")
+FLAG(no_prefetch_sources, false, "", "-fno-prefetch-sources", nullopt, nullopt,
+     "Read each source file only when it is needed, rather than reading ahead in the background")
+FLAG(write_dependencies, false, "-MD", "--write-dependencies", nullopt, nullopt,
+     "Write Make-style dependency rules into a .d file as a side effect of compilation")
+FLAG(dump_record_layouts, false, "", "-fdump-record-layouts", nullopt, nullopt,
+     "Write the size, alignment and member offsets of every file-scope structure and union "
+     "after parsing")
 #endif
 
 #ifdef OPTION
@@ -26,9 +43,31 @@ FLAG(debug_parser, false, "", "-fdebug-parser", 1, 0x1, "Dump tokens after lexin
 OPTION(set_feature_flag, std::string, "-fset-feature-flag", "0,0x0", "Manually set a feature flag")
 OPTION(stop_after_phase, std::string, "-fstop-after-phase", "",
      "Stop compilation after given phase is complete")
+OPTION(dump_ast, std::string, "-fdump-ast", "",
+     "Write the AST to standard output after parsing, as \"text\" or \"json\"")
+OPTION(emit_ast_image, std::string, "-femit-ast-image", "",
+     "Write the AST of the source file to the given file, to be used by -fuse-ast-image")
+OPTION(use_ast_image, std::string, "-fuse-ast-image", "",
+     "Take the declarations of an image written by -femit-ast-image as though they came first, "
+     "instead of parsing their source again")
+OPTION(reparse_edit, std::vector<std::string>, "-freparse-edit", {},
+     "After parsing, replace LENGTH bytes at OFFSET with TEXT (given as \"OFFSET,LENGTH,TEXT\") "
+     "and update the AST to match, parsing again only what the edit touches; each edit given "
+     "is made to the file as the one before left it")
 OPTION(output_file, std::string, "--output-file", "", "The file to write output into.")
 OPTION(
      lex_output_file, std::string, "--lex-output-file", "", "The file to write lexer output into.")
+OPTION(include_directories, std::vector<std::string>, "-I", {},
+     "Add a directory to search for included and embedded files")
+OPTION(dependency_output_file, std::string, "-MF", "",
+     "The file to write dependency rules into.")
+OPTION(dependency_target, std::string, "-MT", "", "The target to use in dependency rules.")
+OPTION(jobs, int, "-j", 0,
+     "Number of threads to use for parallel work (0 means one per hardware thread)")
+OPTION(constexpr_steps, int, "-fconstexpr-steps", 1048576,
+     "Give up on a constant expression after evaluating this many operators and operands")
+OPTION(constexpr_depth, int, "-fconstexpr-depth", 512,
+     "Give up on a constant expression whose operands nest more deeply than this")
 OPTION(example_int_option, int, "-fexample-int-option", 123,
      "Dummy option that takes an int argument")
 #endif
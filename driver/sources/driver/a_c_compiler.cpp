@@ -7,10 +7,19 @@
 
 #include <a_c_compiler/options/global_options.h>
 #include <a_c_compiler/fe/lex/lex.h>
+#include <a_c_compiler/fe/parse/ast_dump.h>
+#include <a_c_compiler/fe/parse/ast_image.h>
 #include <a_c_compiler/fe/parse/parse.h>
+#include <a_c_compiler/fe/parse/parse_profile.h>
+#include <a_c_compiler/fe/parse/type_layout.h>
+#include <a_c_compiler/fe/scan/dependency_scan.h>
+#include <a_c_compiler/fe/sema/sema.h>
+#include <a_c_compiler/fe/source/file_prefetcher.h>
 
 #include <ztd/idk/assert.hpp>
 
+#include <algorithm>
+#include <charconv>
 #include <filesystem>
 #include <iomanip>
 #include <iostream>
@@ -69,16 +78,25 @@ int help(std::string_view exe) noexcept {
 	return help_with(exe, EXIT_FAILURE);
 }
 
-template <typename T>
-T parse_option(std::string arg) noexcept;
+void parse_option_into(std::string& option, std::string arg) noexcept {
+	option = std::move(arg);
+}
+
+void parse_option_into(int& option, std::string arg) noexcept {
+	option = std::atoi(arg.c_str());
+}
 
-template <>
-std::string parse_option<std::string>(std::string arg) noexcept {
-	return arg;
+/* Options that are a list may be given more than once, and every value is kept. */
+void parse_option_into(std::vector<std::string>& option, std::string arg) noexcept {
+	option.push_back(std::move(arg));
 }
-template <>
-int parse_option<int>(std::string arg) noexcept {
-	return std::atoi(arg.c_str());
+
+std::ostream& operator<<(std::ostream& output_stream, const std::vector<std::string>& values) {
+	output_stream << "[ ";
+	for (auto it = values.begin(); it != values.end();) {
+		output_stream << *it << (++it == values.end() ? " " : ", ");
+	}
+	return output_stream << "]";
 }
 
 void handle_feature_flag(std::string_view arg_str, global_options& global_opts) {
@@ -121,7 +139,7 @@ bool parse_args(const std::string& exe, const std::vector<std::string>& args,
 	else if (*it == CLINAME) {                                                              \
 		it++;                                                                              \
 		ZTD_ASSERT_MESSAGE("Expected argument to follow flag -f" #NAME, it != args.end()); \
-		cli_opts.NAME = parse_option<TYPE>(*it);                                           \
+		parse_option_into(cli_opts.NAME, *it);                                             \
 	}
 
 #include <a_c_compiler/driver/command_line_options.inl.h>
@@ -138,6 +156,10 @@ bool parse_args(const std::string& exe, const std::vector<std::string>& args,
 		}
 		it++;
 	}
+	global_opts.set_constexpr_step_limit(
+	     static_cast<std::uint64_t>(std::max(cli_opts.constexpr_steps, 0)));
+	global_opts.set_constexpr_depth_limit(
+	     static_cast<std::uint32_t>(std::max(cli_opts.constexpr_depth, 0)));
 
 	/* Check validity of command line args. */
 
@@ -178,6 +200,111 @@ void print_cli_opts() {
 #undef OPTION
 }
 
+/* Scan every source for its dependencies and write them out as Make rules: to the `-MF` file (or
+ * standard output) when only scanning, or to one `.d` file per source otherwise. */
+bool write_dependency_rules(
+     bool scan_only, file_prefetcher* prefetcher, diagnostic_handles& diag_handles) {
+	dependency_scan_options scan_options {};
+	scan_options.include_directories.assign(
+	     cli_opts.include_directories.begin(), cli_opts.include_directories.end());
+	scan_options.thread_count = cli_opts.jobs < 0 ? 0 : static_cast<std::size_t>(cli_opts.jobs);
+	scan_options.prefetcher   = prefetcher;
+	dependency_scanner scanner(std::move(scan_options), diag_handles);
+
+	std::vector<dependency_scan_result> results = scanner.scan_all(cli_opts.positional_args);
+
+	bool successful = true;
+	std::ofstream shared_output_stream;
+	if (!cli_opts.dependency_output_file.empty()) {
+		shared_output_stream.open(cli_opts.dependency_output_file.c_str());
+		if (!shared_output_stream) {
+			std::cerr << "cannot write to dependency output file \""
+			          << cli_opts.dependency_output_file << "\"\n";
+			return false;
+		}
+	}
+	for (const dependency_scan_result& result : results) {
+		successful &= result.successful;
+		const std::string target = cli_opts.dependency_target.empty()
+		     ? default_dependency_target(result.source_file)
+		     : cli_opts.dependency_target;
+		if (shared_output_stream.is_open()) {
+			write_make_dependencies(shared_output_stream, target, result.dependencies);
+		}
+		else if (scan_only) {
+			write_make_dependencies(std::cout, target, result.dependencies);
+		}
+		else {
+			fs::path rule_file = result.source_file.filename().replace_extension(".d");
+			std::ofstream rule_output_stream(rule_file);
+			if (!rule_output_stream) {
+				std::cerr << "cannot write to dependency output file " << rule_file << "\n";
+				successful = false;
+				continue;
+			}
+			write_make_dependencies(rule_output_stream, target, result.dependencies);
+		}
+	}
+	return successful;
+}
+
+/* Parses a source file as though the source of `image` came before it, reading only the
+ * declarations of the image that it refers to. */
+ast_module parse_with_image(const ast_image& image, const token_vector& tokens,
+     source_manager& sources, const global_options& global_opts,
+     diagnostic_handles& diag_handles) noexcept {
+	ast_module mod {};
+	ast_image_import imported(image, mod, sources, global_opts, diag_handles);
+	parse_into(mod, tokens, sources, global_opts, diag_handles);
+	imported.load_referenced();
+	if (cli_opts.verbose) {
+		std::cout << "\nRead " << imported.loaded_count() << " of "
+		          << image.declaration_count() << " declarations from AST image "
+		          << cli_opts.use_ast_image << "\n";
+	}
+	return mod;
+}
+
+/* Makes the edit `description` (one -freparse-edit) describes to `file`, and brings `mod` up
+ * to date with it the way an editor would: parsing again only what the edit touches. `file`
+ * becomes the edited file. */
+bool reparse_with_edit(ast_module& mod, source_manager& sources, file_id& file,
+     std::string_view description) noexcept {
+	const std::size_t first_comma      = description.find(',');
+	const std::size_t second_comma     = first_comma == std::string_view::npos
+	         ? std::string_view::npos
+	         : description.find(',', first_comma + 1);
+	const auto parse_number = [&](std::size_t begin, std::size_t end, std::uint32_t& value) {
+		const auto [last, error]
+		     = std::from_chars(description.data() + begin, description.data() + end, value);
+		return error == std::errc() && last == description.data() + end;
+	};
+	std::uint32_t offset = 0;
+	std::uint32_t length = 0;
+	if (second_comma == std::string_view::npos || !parse_number(0, first_comma, offset)
+	     || !parse_number(first_comma + 1, second_comma, length)
+	     || std::uint64_t(offset) + length > sources.buffer(file).size()) {
+		std::cerr << "[error] expected an edit within the file as OFFSET,LENGTH,TEXT, not \""
+		          << description << "\"\n";
+		return false;
+	}
+	const text_edit edit { offset, offset + length, description.substr(second_comma + 1) };
+	auto maybe_edited = sources.add_edited(file, edit);
+	if (!maybe_edited) {
+		std::cerr << "[error] could not edit " << sources.name(file) << ": "
+		          << maybe_edited.error().message() << "\n";
+		return false;
+	}
+	file                       = *maybe_edited;
+	const token_range reparsed = reparse_edited(mod, file, edit);
+	if (cli_opts.verbose) {
+		std::cout << "\nParsed " << reparsed.size() << " of " << mod.source->tokens.size()
+		          << " tokens again after the edit, into " << mod.nodes.size()
+		          << " nodes in all\n";
+	}
+	return true;
+}
+
 int main(int argc, char** argv) {
 	std::string exe(argv[0]);
 	std::vector<std::string> args(argv + 1, argv + argc);
@@ -192,15 +319,79 @@ int main(int argc, char** argv) {
 		print_cli_opts();
 	}
 
+	if (cli_opts.profile_parser) {
+		/* Report at exit, from whichever phase that is. */
+		std::atexit([]() { dump_parse_profile_into(std::cerr); });
+	}
+
+	/* Start reading every input now, so later phases rarely wait on the disk. */
+	std::optional<file_prefetcher> prefetcher;
+	if (!cli_opts.no_prefetch_sources) {
+		prefetcher.emplace(cli_opts.jobs < 0 ? 0 : static_cast<std::size_t>(cli_opts.jobs));
+		for (auto const& source_file : cli_opts.positional_args) {
+			prefetcher->prefetch(source_file);
+		}
+		if (cli_opts.verbose) {
+			std::cout << "\nPrefetching source files with "
+			          << (prefetcher->backend() == prefetch_backend::io_uring ? "io_uring"
+			                                                                  : "a thread pool")
+			          << "\n";
+		}
+	}
+	file_prefetcher* maybe_prefetcher = prefetcher ? &*prefetcher : nullptr;
+
+	if (cli_opts.scan_dependencies or cli_opts.stop_after_phase == "scan") {
+		return write_dependency_rules(true, maybe_prefetcher, diag_handles) ? EXIT_SUCCESS
+		                                                                    : EXIT_FAILURE;
+	}
+
+	if (cli_opts.write_dependencies
+	     and !write_dependency_rules(false, maybe_prefetcher, diag_handles)) {
+		return EXIT_FAILURE;
+	}
+
+	if (!cli_opts.reparse_edit.empty() and !cli_opts.use_ast_image.empty()) {
+		std::cerr << "[error] -freparse-edit cannot be used with -fuse-ast-image\n";
+		return EXIT_FAILURE;
+	}
+
+	/* The image is read from as each source file needs it, so it stays mapped until the end. */
+	std::optional<ast_image> image;
+	if (!cli_opts.use_ast_image.empty()) {
+		auto maybe_image = ast_image::open(cli_opts.use_ast_image);
+		if (!maybe_image) {
+			std::cerr << "[error] could not read AST image \"" << cli_opts.use_ast_image
+			          << "\": " << maybe_image.error().message() << "\n";
+			return EXIT_FAILURE;
+		}
+		image.emplace(std::move(*maybe_image));
+	}
+
 	bool failed_lexer_output = false;
 	bool failed_parse_output = false;
+	source_manager sources {};
+	sources.use_prefetcher(maybe_prefetcher);
 
 	for (auto const& source_file : cli_opts.positional_args) {
+		auto maybe_file = sources.load(source_file);
+		if (!maybe_file) {
+			std::cerr << "[error] could not read input file " << source_file << ": "
+			          << maybe_file.error().message() << "\n";
+			return EXIT_FAILURE;
+		}
+
 		if (cli_opts.verbose) {
 			std::cout << "\nLexing source file " << source_file << "\n";
 		}
 
-		auto tokens = lex(source_file, global_opts, diag_handles);
+		/* The parser can only take the tokens as they are lexed when nothing else needs all of
+		 * them first. */
+		const bool pipeline_lexer = cli_opts.pipeline_lexer && !cli_opts.debug_lexer
+		     && !cli_opts.parallel_parse && !image && cli_opts.stop_after_phase != "lex";
+		token_vector tokens;
+		if (!pipeline_lexer) {
+			tokens = lex(sources, *maybe_file, global_opts, diag_handles);
+		}
 
 		if (cli_opts.debug_lexer) {
 			const bool write_lex_to_stdout = cli_opts.lex_output_file.empty();
@@ -212,12 +403,12 @@ int main(int argc, char** argv) {
 			}
 
 			if (write_lex_to_stdout) {
-				dump_tokens(tokens);
+				dump_tokens(tokens, sources);
 			}
 			else {
 				std::ofstream lex_output_stream(cli_opts.lex_output_file.c_str());
 				if (lex_output_stream) {
-					dump_tokens_into(tokens, lex_output_stream);
+					dump_tokens_into(tokens, sources, lex_output_stream);
 				}
 				else {
 					std::cerr << "cannot write to lex output file \""
@@ -231,15 +422,73 @@ int main(int argc, char** argv) {
 			return failed_lexer_output ? EXIT_FAILURE : EXIT_SUCCESS;
 		}
 
-		auto ast_module = parse(tokens, global_opts, diag_handles);
+		auto ast_module = image
+		     ? parse_with_image(*image, tokens, sources, global_opts, diag_handles)
+		     : pipeline_lexer ? parse_pipelined(sources, *maybe_file, global_opts, diag_handles)
+		     : cli_opts.parallel_parse
+		     ? parse_in_parallel(tokens, sources, global_opts, diag_handles,
+		          cli_opts.jobs < 0 ? 0 : static_cast<std::size_t>(cli_opts.jobs))
+		     : parse(tokens, sources, global_opts, diag_handles);
+
+		file_id edited_file = *maybe_file;
+		for (const std::string& edit : cli_opts.reparse_edit) {
+			if (!reparse_with_edit(ast_module, sources, edited_file, edit)) {
+				return EXIT_FAILURE;
+			}
+		}
+
+		if (!cli_opts.emit_ast_image.empty()) {
+			auto written = write_ast_image(ast_module, cli_opts.emit_ast_image);
+			if (!written) {
+				std::cerr << "cannot write AST image \"" << cli_opts.emit_ast_image
+				          << "\": " << written.error().message() << "\n";
+				failed_parse_output = true;
+			}
+		}
 
 		if (cli_opts.verbose) {
 			ast_module.dump();
 		}
 
+		if (!cli_opts.dump_ast.empty()) {
+			if (cli_opts.dump_ast == "text" or cli_opts.dump_ast == "json") {
+				const ast_dump_format format = cli_opts.dump_ast == "json"
+				     ? ast_dump_format::json
+				     : ast_dump_format::text;
+				failed_parse_output
+				     = !dump_ast_into(ast_module, stdout, format) || failed_parse_output;
+			}
+			else {
+				std::cerr << "unknown AST dump format \"" << cli_opts.dump_ast << "\"\n";
+				failed_parse_output = true;
+			}
+		}
+
+		if (cli_opts.dump_record_layouts) {
+			type_layout_table layouts(ast_module.types);
+			failed_parse_output
+			     = !dump_record_layouts_into(ast_module, layouts, stdout) || failed_parse_output;
+		}
+
 		if (cli_opts.stop_after_phase == "parse") {
 			return failed_parse_output || failed_lexer_output ? EXIT_FAILURE : EXIT_SUCCESS;
 		}
+
+		if (cli_opts.skip_function_bodies) {
+			/* Everything after parsing needs the bodies, so parse them all now, in parallel. */
+			parse_function_bodies(
+			     ast_module, cli_opts.jobs < 0 ? 0 : static_cast<std::size_t>(cli_opts.jobs));
+		}
+
+		if (cli_opts.verbose) {
+			std::cout << "\nChecking source file " << source_file << "\n";
+		}
+		analyze_semantics(
+		     ast_module, cli_opts.jobs < 0 ? 0 : static_cast<std::size_t>(cli_opts.jobs));
+
+		if (cli_opts.stop_after_phase == "sema") {
+			return failed_parse_output || failed_lexer_output ? EXIT_FAILURE : EXIT_SUCCESS;
+		}
 	}
 
 	return EXIT_SUCCESS;
@@ -10,11 +10,18 @@
 #include <a_c_compiler/options/global_options.h>
 #include <a_c_compiler/fe/reporting/diagnostic_handles.h>
 #include <a_c_compiler/fe/reporting/logger.h>
+#include <a_c_compiler/fe/source/source_manager.h>
+#include <a_c_compiler/fe/support/spsc_queue.h>
 
+#include <array>
+#include <deque>
 #include <filesystem>
 #include <vector>
 #include <cstdint>
 #include <iosfwd>
+#include <optional>
+#include <span>
+#include <string_view>
 
 namespace a_c_compiler {
 
@@ -22,32 +29,115 @@ namespace a_c_compiler {
 
 	enum token_id : int32_t {
 #define CHAR_TOKEN(TOK, INTVAL) TOK = INTVAL,
+#define PUNCTUATOR_TOKEN(TOK, INTVAL, SPELLING) TOK = INTVAL,
 #define KEYWORD_TOKEN(TOK, INTVAL, KEYWORD) TOK = INTVAL,
 #define TOKEN(TOK, INTVAL) TOK = INTVAL,
 #include <a_c_compiler/fe/lex/tokens.inl.h>
 #undef CHAR_TOKEN
+#undef PUNCTUATOR_TOKEN
 #undef KEYWORD_TOKEN
 #undef TOKEN
 	};
 
+	/* An identifier's spelling, interned: every occurrence of the same spelling, in any file,
+	 * has the same id, so comparing or hashing identifiers never touches their text. */
+	struct identifier_id {
+		constexpr identifier_id() noexcept = default;
 
-	struct file_offset_info {
-		size_t lineno, column;
+		constexpr explicit identifier_id(std::uint32_t index) noexcept : m_index(index) {
+		}
+
+		[[nodiscard]] constexpr std::uint32_t index() const noexcept {
+			return m_index;
+		}
+
+		[[nodiscard]] constexpr bool is_valid() const noexcept {
+			return m_index != invalid_index;
+		}
+
+		friend constexpr bool operator==(identifier_id, identifier_id) noexcept = default;
+
+	private:
+		inline static constexpr const std::uint32_t invalid_index = 0xFFFFFFFFu;
+		std::uint32_t m_index = invalid_index;
 	};
 
 	struct token {
 		token_id id;
-		file_offset_info source_location;
+		source_location location;
+		/* For `tok_id`, the index of its `identifier_id`; for literals, the index of its
+		 * spelling (see `lexed_numeric_literal` and `lexed_string_literal`). */
+		std::uint32_t value = 0;
+
+		[[nodiscard]] constexpr identifier_id identifier() const noexcept {
+			return identifier_id(value);
+		}
 	};
 
 	using token_vector = std::vector<token>;
-	void dump_tokens_into(token_vector const& toks, std::ostream& output_stream) noexcept;
-	void dump_tokens(token_vector const& toks) noexcept;
+	/* Tokens kept in chunks that stay where they are, so adding more never moves the ones
+	 * already there: a parse can read them while the lexer is still adding to them. */
+	using token_sequence = std::deque<token>;
+
+	/* How a token of kind `id` is spelled, or what it is (such as "identifier") if it can be
+	 * spelled many ways, for diagnostics. */
+	std::string_view token_spelling(token_id id) noexcept;
+	void dump_tokens_into(token_vector const& toks, source_manager const& sources,
+	     std::ostream& output_stream) noexcept;
+	void dump_tokens(token_vector const& toks, source_manager const& sources) noexcept;
 
-	std::string_view lexed_id(size_t index) noexcept;
+	/* The tables of spellings are shared by every file, and can be used from any thread, even
+	 * while another lexes more into them. A spelling looked up stays where it is until the
+	 * program ends. */
+	identifier_id intern_identifier(std::string_view spelling) noexcept;
+	std::string_view identifier_spelling(identifier_id id) noexcept;
 	std::string_view lexed_numeric_literal(size_t index) noexcept;
 	std::string_view lexed_string_literal(size_t index) noexcept;
+	/* Stores a literal's spelling as though it had just been lexed, returning the index to look
+	 * it up by again. */
+	std::uint32_t add_lexed_numeric_literal(std::string_view spelling) noexcept;
+	std::uint32_t add_lexed_string_literal(std::string_view spelling) noexcept;
+
+	/* Something the lexer could not finish making a token of, such as a block comment or a
+	 * string literal that is never closed, and where it starts. */
+	struct lex_error {
+		source_location location;
+		std::string_view message;
+	};
 
-	token_vector lex(fs::path const& source_file, const global_options& global_opts,
+	/* Reports each of `errors` to `diag_handles`, in order. */
+	void report_lex_errors(std::span<const lex_error> errors, source_manager const& sources,
 	     diagnostic_handles& diag_handles) noexcept;
+
+	/* Lexes all of `source_file`. What cannot be lexed is reported to `diag_handles`, and lexed
+	 * as far as it goes. */
+	token_vector lex(source_manager const& sources, file_id source_file,
+	     const global_options& global_opts, diagnostic_handles& diag_handles) noexcept;
+	/* Like `lex`, but only lexes the bytes of `source_file` from `begin` up to `end`, which
+	 * have to be where tokens start (or the end of the file). Returns nothing if a token runs
+	 * on past `end`, which means that it is not; then nothing is reported either, since the
+	 * bytes will have to be lexed again as part of something bigger. */
+	std::optional<token_vector> lex_range(source_manager const& sources, file_id source_file,
+	     std::uint32_t begin, std::uint32_t end, const global_options& global_opts,
+	     diagnostic_handles& diag_handles) noexcept;
+
+	/* A run of tokens handed from a lexer on one thread to a parser on another. */
+	struct token_batch {
+		inline static constexpr const std::size_t capacity = 1024;
+
+		std::uint32_t size = 0;
+		/* whether this is the last batch of the file */
+		bool is_last = false;
+		std::array<token, capacity> tokens;
+	};
+
+	using token_queue = spsc_queue<token_batch, 16>;
+
+	/* Like `lex`, but publishes the tokens to `queue` a batch at a time as they are made,
+	 * ending with a batch marked as the last. Meant to run on a thread of its own, with the
+	 * parser consuming the queue on another. What cannot be lexed is returned rather than
+	 * reported, for the caller to report once the parser is done, so that what the two threads
+	 * report does not interleave. */
+	std::vector<lex_error> lex_into(
+	     source_manager const& sources, file_id source_file, token_queue& queue) noexcept;
 } /* namespace a_c_compiler */
@@ -0,0 +1,81 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#ifdef BINARY_OPERATOR
+/*
+ * Infix operators, loosest first
+ *
+ * (Token, left binding power, right binding power, expression operator)
+ *
+ * An operator takes the expression to its left only if its left binding power is at least
+ * the binding power the parser is currently asking for, and parses the expression to its right
+ * asking for its right binding power. So a right binding power one above the left makes an
+ * operator left-associative, and one below makes it right-associative.
+ */
+BINARY_OPERATOR(tok_comma, 1, 2, comma)
+BINARY_OPERATOR(tok_equals_sign, 4, 3, assign)
+BINARY_OPERATOR(tok_asterisk_equals, 4, 3, multiply_assign)
+BINARY_OPERATOR(tok_forward_slash_equals, 4, 3, divide_assign)
+BINARY_OPERATOR(tok_percent_equals, 4, 3, remainder_assign)
+BINARY_OPERATOR(tok_plus_equals, 4, 3, add_assign)
+BINARY_OPERATOR(tok_minus_equals, 4, 3, subtract_assign)
+BINARY_OPERATOR(tok_shift_left_equals, 4, 3, shift_left_assign)
+BINARY_OPERATOR(tok_shift_right_equals, 4, 3, shift_right_assign)
+BINARY_OPERATOR(tok_ampersand_equals, 4, 3, bitwise_and_assign)
+BINARY_OPERATOR(tok_caret_equals, 4, 3, bitwise_xor_assign)
+BINARY_OPERATOR(tok_pipe_equals, 4, 3, bitwise_or_assign)
+// the middle operand, between `?` and `:`, is parsed as a whole expression of its own
+BINARY_OPERATOR(tok_question_mark, 6, 5, conditional)
+BINARY_OPERATOR(tok_pipe_pipe, 7, 8, logical_or)
+BINARY_OPERATOR(tok_ampersand_ampersand, 9, 10, logical_and)
+BINARY_OPERATOR(tok_pipe, 11, 12, bitwise_or)
+BINARY_OPERATOR(tok_caret, 13, 14, bitwise_xor)
+BINARY_OPERATOR(tok_ampersand, 15, 16, bitwise_and)
+BINARY_OPERATOR(tok_equals_equals, 17, 18, equal)
+BINARY_OPERATOR(tok_exclamation_mark_equals, 17, 18, not_equal)
+BINARY_OPERATOR(tok_less_than, 19, 20, less)
+BINARY_OPERATOR(tok_greater_than, 19, 20, greater)
+BINARY_OPERATOR(tok_less_than_equals, 19, 20, less_equal)
+BINARY_OPERATOR(tok_greater_than_equals, 19, 20, greater_equal)
+BINARY_OPERATOR(tok_shift_left, 21, 22, shift_left)
+BINARY_OPERATOR(tok_shift_right, 21, 22, shift_right)
+BINARY_OPERATOR(tok_plus, 23, 24, add)
+BINARY_OPERATOR(tok_minus, 23, 24, subtract)
+BINARY_OPERATOR(tok_asterisk, 25, 26, multiply)
+BINARY_OPERATOR(tok_forward_slash, 25, 26, divide)
+BINARY_OPERATOR(tok_percent, 25, 26, remainder)
+#endif
+
+#ifdef PREFIX_OPERATOR
+/*
+ * Prefix operators, which all bind tighter than any infix operator
+ *
+ * (Token, expression operator)
+ */
+PREFIX_OPERATOR(tok_plus, unary_plus)
+PREFIX_OPERATOR(tok_minus, negate)
+PREFIX_OPERATOR(tok_exclamation_mark, logical_not)
+PREFIX_OPERATOR(tok_tilde, bitwise_not)
+PREFIX_OPERATOR(tok_asterisk, dereference)
+PREFIX_OPERATOR(tok_ampersand, address_of)
+PREFIX_OPERATOR(tok_plus_plus, pre_increment)
+PREFIX_OPERATOR(tok_minus_minus, pre_decrement)
+#endif
+
+#ifdef POSTFIX_OPERATOR
+/*
+ * Postfix operators, which bind tighter still
+ *
+ * (Token, expression operator)
+ */
+POSTFIX_OPERATOR(tok_plus_plus, post_increment)
+POSTFIX_OPERATOR(tok_minus_minus, post_decrement)
+POSTFIX_OPERATOR(tok_l_paren, call)
+POSTFIX_OPERATOR(tok_l_square_bracket, subscript)
+POSTFIX_OPERATOR(tok_period, member)
+POSTFIX_OPERATOR(tok_arrow, member_through_pointer)
+#endif
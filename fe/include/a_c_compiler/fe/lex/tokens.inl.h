@@ -22,6 +22,40 @@ CHAR_TOKEN(tok_plus, '+')
 CHAR_TOKEN(tok_minus, '-')
 CHAR_TOKEN(tok_ampersand, '&')
 CHAR_TOKEN(tok_percent, '%')
+CHAR_TOKEN(tok_exclamation_mark, '!')
+CHAR_TOKEN(tok_tilde, '~')
+CHAR_TOKEN(tok_less_than, '<')
+CHAR_TOKEN(tok_greater_than, '>')
+CHAR_TOKEN(tok_pipe, '|')
+CHAR_TOKEN(tok_caret, '^')
+CHAR_TOKEN(tok_question_mark, '?')
+#endif
+
+#ifdef PUNCTUATOR_TOKEN
+// Punctuators spelled with more than one character. The lexer tries them in this order, so
+// every punctuator has to come before any shorter one it starts with.
+PUNCTUATOR_TOKEN(tok_ellipsis, 256, "...")
+PUNCTUATOR_TOKEN(tok_shift_left_equals, 257, "<<=")
+PUNCTUATOR_TOKEN(tok_shift_right_equals, 258, ">>=")
+PUNCTUATOR_TOKEN(tok_arrow, 259, "->")
+PUNCTUATOR_TOKEN(tok_plus_plus, 260, "++")
+PUNCTUATOR_TOKEN(tok_minus_minus, 261, "--")
+PUNCTUATOR_TOKEN(tok_shift_left, 262, "<<")
+PUNCTUATOR_TOKEN(tok_shift_right, 263, ">>")
+PUNCTUATOR_TOKEN(tok_less_than_equals, 264, "<=")
+PUNCTUATOR_TOKEN(tok_greater_than_equals, 265, ">=")
+PUNCTUATOR_TOKEN(tok_equals_equals, 266, "==")
+PUNCTUATOR_TOKEN(tok_exclamation_mark_equals, 267, "!=")
+PUNCTUATOR_TOKEN(tok_ampersand_ampersand, 268, "&&")
+PUNCTUATOR_TOKEN(tok_pipe_pipe, 269, "||")
+PUNCTUATOR_TOKEN(tok_asterisk_equals, 270, "*=")
+PUNCTUATOR_TOKEN(tok_forward_slash_equals, 271, "/=")
+PUNCTUATOR_TOKEN(tok_percent_equals, 272, "%=")
+PUNCTUATOR_TOKEN(tok_plus_equals, 273, "+=")
+PUNCTUATOR_TOKEN(tok_minus_equals, 274, "-=")
+PUNCTUATOR_TOKEN(tok_ampersand_equals, 275, "&=")
+PUNCTUATOR_TOKEN(tok_caret_equals, 276, "^=")
+PUNCTUATOR_TOKEN(tok_pipe_equals, 277, "|=")
 #endif
 
 #ifdef KEYWORD_TOKEN
@@ -92,12 +126,15 @@ MAKE_KEYWORD_TOKEN(__vectorcall, -2052)
 MAKE_KEYWORD_TOKEN(__thiscall, -2053)
 MAKE_KEYWORD_TOKEN(asm, -2054)
 MAKE_KEYWORD_TOKEN(__asm__, -2055)
+MAKE_KEYWORD_TOKEN(_Padding, -2056)
 #undef MAKE_KEYWORD_TOKEN
 #endif
 
 #ifdef TOKEN
 // defined specifically for comment parsing work
 TOKEN(tok_forward_slash, '/')
+// and this one for numeric literals, which can start with it
+TOKEN(tok_period, '.')
 TOKEN(tok_id, -1)
 TOKEN(tok_num_literal, -2)
 TOKEN(tok_str_literal, -3)
@@ -107,4 +144,6 @@ TOKEN(tok_newline, -6)
 TOKEN(tok_tab, -7)
 // special embed stream token
 TOKEN(tok_pp_embed, -8)
+// never lexed: what the parser sees once it runs out of tokens
+TOKEN(tok_end_of_input, -9)
 #endif
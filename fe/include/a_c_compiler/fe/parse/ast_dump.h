@@ -0,0 +1,29 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/parse/ast_module.h>
+
+#include <cstdio>
+
+namespace a_c_compiler {
+
+	enum class ast_dump_format : unsigned char {
+		/* one line per node, indented by depth */
+		text,
+		/* one object per node, with its children in a "children" array */
+		json,
+	};
+
+	/* Writes the tree of `mod`, every node with its data, to `output`. The tree is walked and
+	 * written in one pass, a buffer-full at a time, so it is never held in memory as text.
+	 * Returns whether all of it was written. */
+	bool dump_ast_into(const ast_module& mod, std::FILE* output,
+	     ast_dump_format format = ast_dump_format::text) noexcept;
+
+} // namespace a_c_compiler
@@ -0,0 +1,128 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/parse/ast_module.h>
+#include <a_c_compiler/fe/reporting/diagnostic_handles.h>
+#include <a_c_compiler/fe/source/source_manager.h>
+#include <a_c_compiler/options/global_options.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace a_c_compiler {
+
+	namespace fs = std::filesystem;
+
+	/* An `ast_module` written out to a file, the way a precompiled header is: its types, its
+	 * nodes, the file-scope names it declares, and the tokens and spellings those refer to.
+	 *
+	 * Nothing in an image is a pointer, and nothing depends on what else was loaded or interned
+	 * when it was written, so it is used straight from the file, mapped into memory. The nodes
+	 * of each top-level declaration are stored together, in the order the tree is walked,
+	 * along with the run of tokens they refer to, so a declaration can be read into a module
+	 * without reading any of the others. Node data is stored as the compiler lays it out in
+	 * memory, so an image is only good for a compiler that lays it out the same way: one
+	 * that does not is rejected when it is opened. */
+	struct ast_image {
+		ast_image(ast_image&& other) noexcept;
+		ast_image& operator=(ast_image&& other) noexcept;
+		~ast_image() noexcept;
+
+		/* Maps the image in `file` into memory, after checking that this compiler can read
+		 * it. */
+		static std::expected<ast_image, std::error_code> open(const fs::path& file) noexcept;
+
+		/* How many top-level declarations the image holds. */
+		[[nodiscard]] std::size_t declaration_count() const noexcept;
+		/* The path of the source file the image was parsed from. */
+		[[nodiscard]] std::string_view source_path() const noexcept;
+		/* The size of that source file at the time. */
+		[[nodiscard]] std::size_t source_size() const noexcept;
+
+	private:
+		friend struct ast_image_import;
+
+		ast_image() noexcept;
+
+		[[nodiscard]] std::span<const std::byte> section(std::size_t index) const noexcept;
+		/* The `index`th record of a section, copied out of the image (which need not be aligned
+		 * for it). */
+		template <typename Record>
+		[[nodiscard]] Record record(std::size_t section, std::size_t index) const noexcept;
+		template <typename Record>
+		[[nodiscard]] std::size_t record_count(std::size_t section) const noexcept;
+		/* The `index`th spelling listed in `section`. */
+		[[nodiscard]] std::string_view string(
+		     std::size_t section, std::uint32_t index) const noexcept;
+
+		const std::byte* m_bytes;
+		std::size_t m_size;
+		/* whether `m_bytes` is mapped, rather than read into memory of its own */
+		bool m_mapped;
+	};
+
+	/* Writes `mod` to `file` as an image, to be opened by `ast_image::open` later. */
+	std::expected<void, std::error_code> write_ast_image(
+	     const ast_module& mod, const fs::path& file) noexcept;
+
+	/* Brings what an image declares into a module, reading as little of it as it can.
+	 *
+	 * Everything the parser has to know about the image's file-scope names (the names, and
+	 * their types) goes into the module right away, so that what is parsed into it afterwards
+	 * sees them. A declaration's nodes are only read from the image the first time they are
+	 * asked for, and are then made children of the module's root, after whatever was there. The
+	 * tokens they refer to are added to the end of the module's. The image has to outlive
+	 * this. */
+	struct ast_image_import {
+		ast_image_import(const ast_image& image, ast_module& mod, source_manager& sources,
+		     const global_options& global_opts, diagnostic_handles& diag_handles) noexcept;
+
+		/* The declaration in the image that `name` names at file scope, reading it first if it
+		 * has not been yet. Invalid if the image declares no such name. */
+		ast_node_id declaration(identifier_id name) noexcept;
+		/* The `index`th top-level declaration of the image, reading it first if it has not
+		 * been yet. */
+		ast_node_id load(std::size_t index) noexcept;
+		/* Reads every declaration that what has been parsed of the module refers to by name,
+		 * and every one that those refer to in turn. (Bodies that were skipped refer to
+		 * nothing until they are parsed.) A name that a local declaration hides is still
+		 * counted, so this can read more than is strictly needed, but never less. */
+		void load_referenced() noexcept;
+
+		/* How many of the image's declarations have been read so far. */
+		[[nodiscard]] std::size_t loaded_count() const noexcept;
+
+	private:
+		identifier_id identifier(std::uint32_t index) noexcept;
+		/* Where the tokens of the image's source file start in the module's source manager, or
+		 * an invalid location if that file cannot be found as it was. */
+		source_location source_start() noexcept;
+
+		const ast_image* m_image;
+		ast_module* m_mod;
+		source_manager* m_sources;
+		type_relocation m_types;
+		/* the module's id for each identifier of the image, interned as they are needed */
+		std::vector<identifier_id> m_identifiers;
+		/* where each declaration of the image is in the module, once it has been read */
+		std::vector<ast_node_id> m_loaded;
+		/* the declaration of the image each file-scope name is declared by */
+		std::unordered_map<std::uint32_t, std::uint32_t> m_declarations_by_name;
+		bool m_looked_for_source;
+		source_location m_source_start;
+	};
+
+} // namespace a_c_compiler
@@ -7,14 +7,21 @@
 #pragma once
 
 #include <a_c_compiler/fe/lex/lex.h>
+#include <a_c_compiler/fe/parse/type.h>
+#include <a_c_compiler/fe/parse/ast_node.h>
+#include <a_c_compiler/fe/parse/expression.h>
+#include <a_c_compiler/fe/parse/symbol_table.h>
+#include <a_c_compiler/fe/parse/constant_evaluator.h>
 
 #include <ztd/idk/assert.hpp>
 
-#include <span>
 #include <cstdint>
 #include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
 #include <vector>
-#include <variant>
 
 namespace a_c_compiler {
 	enum function_specifier {
@@ -22,205 +29,331 @@ namespace a_c_compiler {
 		funcspec__Noreturn = 0x2,
 	};
 
-	enum class type_modifier : unsigned char {
-		tm_none = 0,
-		tm_signed,
-		tm_unsigned,
-		tm__Atomic, // _Atomic(int)
-	};
-
-	enum class type_category : unsigned char {
-		tc_none,
-		tc_void,
-		tc_bool,
-		tc_char,
-		tc_short,
-		tc_int,
-		tc_long,
-		tc_longlong,
-		tc__BitInt,
-		tc_float,
-		tc_double,
-		tc_longdouble,
-		tc_longlongdouble,
-		tc_union,
-		tc_struct,
-		tc_enum,
-		tc_function,
-		tc_array,
-		tc_variable_length_array,
-		tc_vla = tc_variable_length_array,
-		tc_data_pointer,
-		tc_function_pointer,
-		tc_nullptr,
-		tc_auto,      // inferred type
-		tc__Padding,  // extension: struct foo { int meow; _Padding(16) padding; uint16_t bark; };
-		tc_array_span // extension: array span
-	};
-
-	enum class qualifier : unsigned char {
-		none       = 0b0000,
-		q_const    = 0b0001,
-		q__Atomic  = 0b0010, // e.g. _Atomic int
-		q_volatile = 0b0100,
-		q_restrict = 0b1000,
-	};
-
-	enum storage_class_specifier : unsigned short {
-		none             = 0b00000000000,
-		scs_static       = 0b00000000001,
-		scs_extern       = 0b00000000010,
-		scs_constexpr    = 0b00000000100,
-		scs_register     = 0b00000001000,
-		scs_thread_local = 0b00000010000,
-		scs_typedef      = 0b00000100000,
-		scs_auto         = 0b00001000000
-	};
-	using sc_specifier = storage_class_specifier;
-
-	struct type_data;
-	struct type {
-		constexpr type() noexcept                       = default;
-		constexpr type(const type&) noexcept            = default;
-		constexpr type(type&&) noexcept                 = default;
-		constexpr type& operator=(const type&) noexcept = default;
-		constexpr type& operator=(type&&) noexcept      = default;
-
-		constexpr explicit type(std::size_t ref_index) noexcept : m_ref(ref_index) {
-		}
-
-		constexpr std::size_t index() const noexcept {
-			return m_ref;
-		}
+	/* A run of tokens [begin, end), as indices into the tokens a module was parsed from (see
+	 * `token_source`). Nodes refer to their tokens this way instead of copying them. */
+	struct token_range {
+		std::uint32_t begin = 0;
+		std::uint32_t end   = 0;
 
-		type_data& data() const noexcept;
-
-	private:
-		std::uint_least32_t m_ref;
-	};
-
-	struct type_data {
-		type_modifier modifier;
-		type_category category = type_category::tc_none;
-		qualifier qualifiers;
-		std::uint32_t specifiers;
-		std::size_t bit_size; // for _BitInt and _Padding and friends
-		std::vector<type> sub_types;
-
-		static type get_new_type();
-
-		type& pointee_type() {
-			ZTD_ASSERT_MESSAGE("Must be a pointer type.",
-			     category == type_category::tc_data_pointer
-			          || category == type_category::tc_function_pointer);
-			ZTD_ASSERT_MESSAGE(
-			     "There must be at least 1 available sub-type.", sub_types.size() == 1);
-			return sub_types[0];
+		[[nodiscard]] constexpr std::size_t size() const noexcept {
+			return end - begin;
 		}
 
-		type& element_type() {
-			ZTD_ASSERT_MESSAGE("Must be an array type.",
-			     category == type_category::tc_array || category == type_category::tc_vla
-			          || category == type_category::tc_array_span);
-			ZTD_ASSERT_MESSAGE(
-			     "There must be at least 1 available sub-type.", sub_types.size() == 1);
-			return sub_types[0];
+		[[nodiscard]] constexpr bool empty() const noexcept {
+			return begin == end;
 		}
+	};
 
-		std::span<type> member_types() {
-			ZTD_ASSERT_MESSAGE("Must be a structure or union type.",
-			     category == type_category::tc_struct || category == type_category::tc_union);
-			return sub_types;
-		}
+	enum class ast_node_kind : unsigned char {
+#define AST_NODE(NAME) NAME,
+#define AST_NODE_WITH_DATA(NAME, TABLE) NAME,
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE
+#undef AST_NODE_WITH_DATA
+	};
 
-		type& return_type() {
-			ZTD_ASSERT_MESSAGE(
-			     "Must be a function type.", category == type_category::tc_function);
-			ZTD_ASSERT_MESSAGE("Must have at least one type.", sub_types.size() >= 1);
-			// Return Type + Parameter Layout
-			// [ R | P | P | P ]
-			//     ^           ^
-			// [ R ]
-			//     ^
-			return sub_types[0];
+	[[nodiscard]] constexpr std::string_view ast_node_kind_name(ast_node_kind kind) noexcept {
+		switch (kind) {
+#define AST_NODE(NAME)          \
+	case ast_node_kind::NAME: \
+		return #NAME;
+#define AST_NODE_WITH_DATA(NAME, TABLE) AST_NODE(NAME)
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE
+#undef AST_NODE_WITH_DATA
 		}
+		return "";
+	}
 
-		std::span<type> parameter_types() {
-			ZTD_ASSERT_MESSAGE(
-			     "Must be a function type.", category == type_category::tc_function);
-			ZTD_ASSERT_MESSAGE("Must have at least one type.", sub_types.size() >= 1);
-			// Return Type + Parameter Layout
-			// [ R | P | P | P ]
-			//     ^           ^
-			// [ R ]
-			//     ^
-			return std::span<type>(sub_types.data() + 1, sub_types.data() + sub_types.size());
-		}
-	};
+	/*
+	 * The data of each kind of node that has any. How nodes relate to each other is never
+	 * stored here: that is what the children of a node are for.
+	 */
 
-	struct static_assert_declaration { };
-	struct operator_declaration { };
-	struct alias_declaration { };
 	struct attribute {
-		std::vector<token> tokens;
-	};
-
-	struct typed_ast_node {
-		type t;
+		token_range tokens;
 	};
 
+	/* children: attributes */
 	struct member_declaration {
 		type t;
+		/* invalid for an unnamed bit-field */
+		identifier_id name;
+		/* what `alignas` asked for, or 0 */
 		std::size_t alignment;
+		/* 0 for a member that is not a bit-field */
 		std::size_t bit_field_size;
 		std::size_t bit_field_position; // extension
 	};
 
+	/* A structure or union specifier with a body.
+	 * children: attributes, then member declarations and static_assert declarations */
 	struct struct_declaration {
 		type t;
+		/* the tag, invalid if it has none */
+		identifier_id name;
+		/* the strictest `alignas` of any member, or 0 */
 		std::size_t alignment;
-		std::vector<attribute> attributes;
-		std::vector<member_declaration> members;
 	};
 
 	struct parameter_declaration {
 		type t;
+		/* invalid for a parameter with no name */
+		identifier_id name;
 	};
 
+	/* children: attributes, then parameter declarations */
 	struct function_declaration {
 		type t;
 		unsigned char funcspecs = 0;
-		std::vector<attribute> attributes;
-		std::vector<parameter_declaration> members;
+		/* `storage_class_specifier`s */
+		unsigned short storage_classes = 0;
+		identifier_id name {};
+	};
+
+	/* One declarator of a declaration: `int a, *b;` is two of these, sharing a type.
+	 * children: the declaration's attributes, which appertain to every declarator, then the
+	 * expression it is initialized with, if any */
+	struct declaration {
+		type t;
+		identifier_id name;
+		/* `storage_class_specifier`s, which belong to the declaration rather than its type */
+		unsigned short storage_classes = 0;
 	};
 
+	/* children: the statement's expression, for an expression statement or a `return` */
 	struct statement {
-		std::vector<token> tokens;
+		token_range tokens;
 	};
 
-	struct compound_statement {
-		std::vector<statement> statements;
+	/* One operator applied to its operands, or one of the leaves of an expression.
+	 * children: the operands, left to right; a call's are the function, then its arguments */
+	struct expression {
+		expression_operator op;
+		/* the operator's token, or the leaf's (the first, for adjacent string literals) */
+		std::uint32_t token_index;
+		/* the type-name of a cast, compound literal, `sizeof` or `alignof` */
+		type t {};
 	};
 
+	/* children: those of its declaration, then the body once it has been parsed */
 	struct function_definition {
 		function_declaration declaration;
-		compound_statement body;
+		/* every token of the body, braces included */
+		token_range body_tokens;
+		/* The body's compound statement. Invalid until the body is parsed. That is right away,
+		 * unless function bodies are being skipped: then it is whenever `function_body` or
+		 * `parse_function_bodies` gets to it. */
+		ast_node_id body;
 	};
 
-	using declaration = std::variant<function_declaration, struct_declaration,
-	     static_assert_declaration, operator_declaration, alias_declaration, statement>;
+	/* Every node of an AST, stored as a structure of arrays: one array per field, indexed by
+	 * node. A node is its kind, the first and last of its children, its next sibling, and
+	 * (for kinds with data) its position in the side table for its kind. So a node costs a
+	 * fixed 17 bytes, walking the tree only touches the arrays it needs, and the whole thing
+	 * is a handful of flat arrays. */
+	struct ast_node_table {
+		explicit ast_node_table(std::pmr::memory_resource* arena) noexcept;
+
+		ast_node_id add_node(ast_node_kind kind, std::uint32_t payload = 0) noexcept;
+		/* Makes `child` the last child of `parent`. */
+		void append_child(ast_node_id parent, ast_node_id child) noexcept;
+
+		/* Copies every node of `other` (and its side table entries) onto the end of this
+		 * table, relocating the indices to match. Nodes keep their order, so `other`'s node
+		 * `n` becomes node `n + offset` here, where `offset` is what this returns. The types
+		 * the nodes refer to are relocated by `types`, for when they were copied into another
+		 * type table too. Node relationships are copied as they are; linking the copied nodes
+		 * into this table's tree is up to the caller. */
+		std::uint32_t append_table(
+		     const ast_node_table& other, const type_relocation& types = {}) noexcept;
+
+		/* Replaces the children of `parent` that come after `after` and before `until` with the
+		 * children of `from`, keeping their order, and leaves `from` with none. An invalid
+		 * `after` means from the first child on, an invalid `until` means up to the last, and
+		 * an invalid `from` means with nothing. The children replaced are only unlinked: they
+		 * stay in the table. Cannot be rolled back. */
+		void replace_children(ast_node_id parent, ast_node_id after, ast_node_id until,
+		     ast_node_id from) noexcept;
+
+		/* Moves every child of `from` onto the end of the children of `parent`, keeping their
+		 * order, and leaves `from` with none. Cannot be rolled back. */
+		void adopt_children(ast_node_id parent, ast_node_id from) noexcept;
+
+		/* How big the table (and each of its side tables) was at some point. */
+		struct checkpoint {
+			std::uint32_t node_count;
+			std::uint32_t link_count;
+#define AST_NODE_WITH_DATA(NAME, TABLE) std::uint32_t TABLE##_count;
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+		};
+
+		/* Marks the current state of the table so that it can be rolled back to. Checkpoints
+		 * nest: each one has to be either rolled back or committed, innermost first. */
+		checkpoint save() noexcept;
+		/* How big the table is now, without marking a checkpoint: something to roll back to
+		 * from inside a checkpoint marked before it, instead of all the way back to that. */
+		[[nodiscard]] checkpoint position() const noexcept;
+		/* Throws away every node added since `saved`, along with their side table entries, and
+		 * unlinks any of them that were made children of older nodes. */
+		void rollback(const checkpoint& saved) noexcept;
+		/* Throws away every node added since `saved`, along with their side table entries, with
+		 * no checkpoint open: none of them can be linked to from an older node any more. Their
+		 * room in the table is used again by the nodes added next. */
+		void truncate(const checkpoint& saved) noexcept;
+		/* Keeps everything added since `saved`. */
+		void commit(const checkpoint& saved) noexcept;
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return m_kinds.size();
+		}
 
-	using external_declaration = std::variant<function_definition, declaration>;
+		/* Where the table, and everything in it, is allocated. */
+		[[nodiscard]] std::pmr::memory_resource* arena() const noexcept {
+			return m_kinds.get_allocator().resource();
+		}
 
-	struct translation_unit {
-		std::vector<external_declaration> declarations;
+		[[nodiscard]] ast_node_kind kind(ast_node_id node) const noexcept {
+			return m_kinds[node.index()];
+		}
+
+		[[nodiscard]] ast_node_id first_child(ast_node_id node) const noexcept {
+			return ast_node_id(m_first_children[node.index()]);
+		}
+
+		[[nodiscard]] ast_node_id last_child(ast_node_id node) const noexcept {
+			return ast_node_id(m_last_children[node.index()]);
+		}
+
+		[[nodiscard]] ast_node_id next_sibling(ast_node_id node) const noexcept {
+			return ast_node_id(m_next_siblings[node.index()]);
+		}
+
+		[[nodiscard]] std::uint32_t payload(ast_node_id node) const noexcept {
+			return m_payloads[node.index()];
+		}
+
+#define AST_NODE_WITH_DATA(NAME, TABLE)                                          \
+	ast_node_id add_##NAME(NAME data) noexcept {                                  \
+		TABLE.push_back(std::move(data));                                        \
+		return add_node(                                                         \
+		     ast_node_kind::NAME, static_cast<std::uint32_t>(TABLE.size() - 1)); \
+	}                                                                            \
+	[[nodiscard]] NAME& NAME##_data(ast_node_id node) noexcept {                  \
+		ZTD_ASSERT_MESSAGE(                                                      \
+		     "node is not a " #NAME, kind(node) == ast_node_kind::NAME);         \
+		return TABLE[payload(node)];                                             \
+	}                                                                            \
+	[[nodiscard]] const NAME& NAME##_data(ast_node_id node) const noexcept {      \
+		ZTD_ASSERT_MESSAGE(                                                      \
+		     "node is not a " #NAME, kind(node) == ast_node_kind::NAME);         \
+		return TABLE[payload(node)];                                             \
+	}
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+
+		// side tables, one per kind of node with data
+#define AST_NODE_WITH_DATA(NAME, TABLE) std::pmr::vector<NAME> TABLE;
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+
+	private:
+		/* What `append_child` changed, so a rollback can undo it: the parent, and what its last
+		 * child was before. Only kept while a checkpoint is open. */
+		struct link_change {
+			std::uint32_t parent;
+			std::uint32_t previous_last_child;
+		};
+
+		std::pmr::vector<ast_node_kind> m_kinds;
+		std::pmr::vector<std::uint32_t> m_first_children;
+		std::pmr::vector<std::uint32_t> m_last_children;
+		std::pmr::vector<std::uint32_t> m_next_siblings;
+		std::pmr::vector<std::uint32_t> m_payloads;
+		std::vector<link_change> m_link_changes;
+		std::size_t m_open_checkpoints;
+	};
+
+	/* What a module was parsed from, kept around so that the parts of it which were skipped
+	 * (such as function bodies) can be parsed later. */
+	struct token_source {
+		inline static constexpr const std::uint32_t no_matching_bracket = 0xFFFFFFFFu;
+
+		/* only the tokens the grammar cares about: no comments or newlines */
+		token_sequence tokens;
+		/* for every bracket in `tokens`, the index of the bracket that pairs with it, or
+		 * `no_matching_bracket` */
+		std::vector<std::uint32_t> matching_brackets;
+		const source_manager* sources;
+		const global_options* global_opts;
+		diagnostic_handles* diag_handles;
+	};
+
+	/* The tokens one external declaration was parsed from, and how many children of the
+	 * translation unit it became: `int a, b;` becomes two, and `;` none. */
+	struct external_declaration_extent {
+		token_range tokens;
+		std::uint32_t node_count;
+	};
+
+	/* The nodes `reparse_edited` made of the external declarations from `first_declaration`
+	 * up to `end_declaration`: everything added to the node and constant tables after `nodes`
+	 * and `constants`, which were `node_count` nodes and `expression_count` expressions once
+	 * it was done. */
+	struct reparsed_region {
+		ast_node_table::checkpoint nodes;
+		constant_table::checkpoint constants;
+		std::uint32_t node_count;
+		std::uint32_t expression_count;
+		std::uint32_t first_declaration;
+		std::uint32_t end_declaration;
 	};
 
+	/* Owns an AST. Every container in the tree allocates from the module's arena: building a
+	 * node is a pointer bump, and destroying the module releases all of it at once. Nodes keep
+	 * the allocator they were made with, so anything added to the tree has to be made with the
+	 * module's arena, or it would not be released with it. */
 	struct ast_module {
-		translation_unit top_level;
+		inline static constexpr const std::size_t initial_arena_size = 64 * 1024;
 
-		void dump() const {
-			/* */
+		ast_module() noexcept;
+		ast_module(const ast_module&)            = delete;
+		ast_module(ast_module&&) noexcept        = default;
+		ast_module& operator=(const ast_module&) = delete;
+		// assigning would release the arena out from under the tree being replaced
+		ast_module& operator=(ast_module&&) = delete;
+
+		[[nodiscard]] std::pmr::memory_resource* arena() const noexcept {
+			return m_arena.get();
 		}
+
+	private:
+		// declared first, so that the tree is destroyed before the memory it lives in
+		std::unique_ptr<std::pmr::monotonic_buffer_resource> m_arena;
+
+	public:
+		/* Node 0 is the translation unit, and the root of the tree. */
+		ast_node_table nodes;
+		type_table types;
+		/* Everything declared at file scope, for parsing skipped function bodies against. */
+		symbol_table symbols;
+		/* What every constant expression evaluated while parsing came to, and the value of
+		 * every `constexpr` object. */
+		constant_table constants;
+		std::unique_ptr<token_source> source;
+		/* Every external declaration parsed into the module, in order, for `reparse_edited`
+		 * to find what an edit touched by. */
+		std::vector<external_declaration_extent> external_declarations;
+		/* What the last `reparse_edited` parsed again, if nothing has been added to the module
+		 * since, for the next one to take back when it replaces all of it. */
+		std::optional<reparsed_region> last_reparse;
+
+		[[nodiscard]] ast_node_id root() const noexcept {
+			return ast_node_id(0);
+		}
+
+		/* Writes the tree to standard output as indented text (see `dump_ast_into`). */
+		void dump() const noexcept;
 	};
 } /* namespace a_c_compiler */
@@ -6,6 +6,32 @@
 // ============================================================================ //
 
 #pragma once
+
+#include <cstdint>
+
 namespace a_c_compiler {
 	struct ast_node { };
+
+	/* Identifies one node of an `ast_node_table`. */
+	struct ast_node_id {
+		inline static constexpr const std::uint32_t invalid_index = 0xFFFFFFFFu;
+
+		constexpr ast_node_id() noexcept = default;
+
+		constexpr explicit ast_node_id(std::uint32_t index) noexcept : m_index(index) {
+		}
+
+		[[nodiscard]] constexpr std::uint32_t index() const noexcept {
+			return m_index;
+		}
+
+		[[nodiscard]] constexpr bool is_valid() const noexcept {
+			return m_index != invalid_index;
+		}
+
+		friend constexpr bool operator==(ast_node_id, ast_node_id) noexcept = default;
+
+	private:
+		std::uint32_t m_index = invalid_index;
+	};
 } /* namespace a_c_compiler */
@@ -0,0 +1,36 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#ifdef AST_NODE
+/*
+ * Nodes with nothing to them but their children
+ *
+ * (Node kind)
+ */
+AST_NODE(translation_unit)
+AST_NODE(compound_statement)
+AST_NODE(static_assert_declaration)
+AST_NODE(operator_declaration)
+AST_NODE(alias_declaration)
+#endif
+
+#ifdef AST_NODE_WITH_DATA
+/*
+ * Nodes that carry data of their own, kept in a side table of the node table
+ *
+ * (Node kind, which is also the name of its data type, side table name)
+ */
+AST_NODE_WITH_DATA(function_definition, function_definitions)
+AST_NODE_WITH_DATA(function_declaration, function_declarations)
+AST_NODE_WITH_DATA(declaration, declarations)
+AST_NODE_WITH_DATA(parameter_declaration, parameter_declarations)
+AST_NODE_WITH_DATA(struct_declaration, struct_declarations)
+AST_NODE_WITH_DATA(member_declaration, member_declarations)
+AST_NODE_WITH_DATA(attribute, attributes)
+AST_NODE_WITH_DATA(statement, statements)
+AST_NODE_WITH_DATA(expression, expressions)
+#endif
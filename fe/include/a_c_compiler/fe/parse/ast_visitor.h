@@ -0,0 +1,120 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/parse/ast_module.h>
+
+#include <vector>
+
+namespace a_c_compiler {
+
+	/* Walks an AST depth-first, calling `Derived` as it enters and leaves each node.
+	 *
+	 * For each kind of node there is an `enter_<kind>` and a `leave_<kind>` for `Derived` to
+	 * hide; kinds with data are handed their data as well. Whatever `Derived` does not hide
+	 * falls back to `enter_node` and `leave_node`, which it can also hide. Every call is
+	 * resolved at compile time, so a visitor costs one switch on the node kind per node and
+	 * nothing else. `enter_*` says whether to walk the node's children; `leave_*` is called for
+	 * every node entered, whether its children were walked or not.
+	 *
+	 * The walk keeps its own stack rather than recursing, so no tree is too deep for it. */
+	template <typename Derived>
+	struct ast_visitor {
+		void walk(const ast_node_table& nodes, ast_node_id root) {
+			// the nodes whose children are being walked, innermost last
+			std::vector<ast_node_id> open;
+			for (ast_node_id node = root;;) {
+				if (enter(nodes, node)) {
+					const ast_node_id child = nodes.first_child(node);
+					if (child.is_valid()) {
+						open.push_back(node);
+						node = child;
+						continue;
+					}
+				}
+				leave(nodes, node);
+				// on to the next sibling, leaving every parent that has no more children
+				for (;;) {
+					if (open.empty()) {
+						return;
+					}
+					const ast_node_id sibling = nodes.next_sibling(node);
+					if (sibling.is_valid()) {
+						node = sibling;
+						break;
+					}
+					node = open.back();
+					open.pop_back();
+					leave(nodes, node);
+				}
+			}
+		}
+
+		bool enter_node(const ast_node_table&, ast_node_id) {
+			return true;
+		}
+
+		void leave_node(const ast_node_table&, ast_node_id) {
+		}
+
+#define AST_NODE(NAME)                                                 \
+	bool enter_##NAME(const ast_node_table& nodes, ast_node_id node) { \
+		return derived().enter_node(nodes, node);                      \
+	}                                                                  \
+	void leave_##NAME(const ast_node_table& nodes, ast_node_id node) { \
+		derived().leave_node(nodes, node);                             \
+	}
+#define AST_NODE_WITH_DATA(NAME, TABLE)                                            \
+	bool enter_##NAME(const ast_node_table& nodes, ast_node_id node, const NAME&) { \
+		return derived().enter_node(nodes, node);                                  \
+	}                                                                              \
+	void leave_##NAME(const ast_node_table& nodes, ast_node_id node, const NAME&) { \
+		derived().leave_node(nodes, node);                                         \
+	}
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE
+#undef AST_NODE_WITH_DATA
+
+	private:
+		Derived& derived() noexcept {
+			return static_cast<Derived&>(*this);
+		}
+
+		bool enter(const ast_node_table& nodes, ast_node_id node) {
+			switch (nodes.kind(node)) {
+#define AST_NODE(NAME)          \
+	case ast_node_kind::NAME: \
+		return derived().enter_##NAME(nodes, node);
+#define AST_NODE_WITH_DATA(NAME, TABLE) \
+	case ast_node_kind::NAME:         \
+		return derived().enter_##NAME(nodes, node, nodes.NAME##_data(node));
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE
+#undef AST_NODE_WITH_DATA
+			}
+			return true;
+		}
+
+		void leave(const ast_node_table& nodes, ast_node_id node) {
+			switch (nodes.kind(node)) {
+#define AST_NODE(NAME)                       \
+	case ast_node_kind::NAME:              \
+		derived().leave_##NAME(nodes, node); \
+		break;
+#define AST_NODE_WITH_DATA(NAME, TABLE)                               \
+	case ast_node_kind::NAME:                                       \
+		derived().leave_##NAME(nodes, node, nodes.NAME##_data(node)); \
+		break;
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE
+#undef AST_NODE_WITH_DATA
+			}
+		}
+	};
+
+} // namespace a_c_compiler
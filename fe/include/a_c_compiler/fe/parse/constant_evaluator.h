@@ -0,0 +1,185 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/lex/lex.h>
+#include <a_c_compiler/fe/parse/ast_node.h>
+#include <a_c_compiler/fe/parse/type.h>
+#include <a_c_compiler/fe/parse/type_layout.h>
+#include <a_c_compiler/fe/support/big_integer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace a_c_compiler {
+
+	struct ast_node_table;
+	struct symbol_table;
+
+	/* The value of a constant expression, and the type it has: an integer type, with its value
+	 * in `integer`, or a floating type, with its value in `floating`. An integer is kept
+	 * exactly, and is always in the range of its type, however wide that is. `long double` is
+	 * evaluated as a `double`. */
+	struct constant_value {
+		/* tc_bool, tc_char, tc_short, tc_int, tc_long, tc_longlong or tc__BitInt for an
+		 * integer; tc_float, tc_double or tc_longdouble otherwise */
+		type_category category;
+		bool is_unsigned;
+		/* how many bits wide a _BitInt is; 0 for any other type */
+		std::uint32_t bit_width;
+		big_integer integer;
+		double floating;
+
+		[[nodiscard]] constexpr bool is_floating() const noexcept {
+			return category == type_category::tc_float || category == type_category::tc_double
+			     || category == type_category::tc_longdouble;
+		}
+
+		[[nodiscard]] bool is_negative() const noexcept {
+			return is_floating() ? floating < 0 : integer.is_negative();
+		}
+
+		/* Whether the value compares unequal to 0, as a condition does. */
+		[[nodiscard]] bool is_nonzero() const noexcept {
+			return is_floating() ? floating != 0 : !integer.is_zero();
+		}
+	};
+
+	enum class constant_error : unsigned char {
+		/* an operator or operand a constant expression cannot have, such as a call or an
+		 * object that is not `constexpr` */
+		not_constant,
+		division_by_zero,
+		/* a signed or floating-to-integer result that does not fit in its type */
+		overflow,
+		/* a shift by a negative amount or by the width of the type or more, or a left shift
+		 * of a negative value */
+		invalid_shift,
+		/* a `constexpr` initializer whose value changes when converted to the object's type */
+		not_representable,
+		/* an integer constant expression with a floating value */
+		not_integer,
+		step_limit,
+		depth_limit,
+	};
+
+	/* Why an expression is not constant, finishing the sentence "expected a constant
+	 * expression, but ...". */
+	[[nodiscard]] std::string_view constant_error_message(constant_error error) noexcept;
+
+	/* Why an expression is not constant, and the node (of it, or of what it refers to) that
+	 * makes it so. */
+	struct constant_failure {
+		constant_error error;
+		ast_node_id node;
+	};
+
+	using constant_result = std::expected<constant_value, constant_failure>;
+
+	/* Whether a constant can have type `t`: whether it is an integer or floating type. */
+	[[nodiscard]] bool is_arithmetic(const type_data& t_data) noexcept;
+
+	/* How much evaluating one constant expression may take before it is given up on: how
+	 * many operators and operands it may visit, and how deeply they may nest. */
+	struct constant_limits {
+		std::uint64_t steps;
+		std::uint32_t depth;
+	};
+
+	/* What every constant expression evaluated while parsing a module came to, by the node it
+	 * starts at, and the value of every `constexpr` object declared at file scope, by name.
+	 *
+	 * Expressions are kept in the order they were evaluated, so a parser backtracking can drop
+	 * the ones evaluated since some point, along with the nodes they were keyed by. Objects are
+	 * not rolled back: a file-scope `constexpr` object can only be defined once, so whatever
+	 * was recorded for it on a path given up on is what it is recorded as again. */
+	struct constant_table {
+		/* How many expressions had been kept at some point. */
+		struct checkpoint {
+			std::uint32_t expression_count;
+		};
+
+		[[nodiscard]] const constant_result* find(ast_node_id expression) const noexcept;
+		void record(ast_node_id expression, constant_result result) noexcept;
+
+		/* The value of the `constexpr` object `name` declares at file scope, if it is one. */
+		[[nodiscard]] const constant_value* find_object(identifier_id name) const noexcept;
+		void record_object(identifier_id name, constant_value value) noexcept;
+		/* Forgets `name` as a `constexpr` object, for when it is declared as anything else. */
+		void forget_object(identifier_id name) noexcept;
+
+		[[nodiscard]] checkpoint save() const noexcept {
+			return checkpoint { static_cast<std::uint32_t>(m_expressions.size()) };
+		}
+		/* Forgets every expression evaluated since `saved`. */
+		void rollback(const checkpoint& saved) noexcept;
+
+		/* Takes on what `other` evaluated since `since`, for nodes that were copied from its
+		 * node table into this one's at `node_offset` (see `ast_node_table::append_table`),
+		 * and every object it knows of. */
+		void append(const constant_table& other, const checkpoint& since,
+		     std::uint32_t node_offset) noexcept;
+
+	private:
+		std::vector<std::pair<ast_node_id, constant_result>> m_expressions;
+		/* where each expression is in `m_expressions`, by node index */
+		std::unordered_map<std::uint32_t, std::uint32_t> m_expression_indices;
+		std::unordered_map<std::uint32_t, constant_value> m_objects;
+	};
+
+	/* Evaluates constant expressions: integer and floating arithmetic, comparisons, logical
+	 * and conditional operators, casts to arithmetic types, `sizeof` and `alignof`, and the
+	 * names of `constexpr` objects, with C's conversions and overflow rules for the target.
+	 *
+	 * Each expression asked for is evaluated once: its value (or why it has none) is kept in
+	 * the constant table, so asking again is a lookup. A `constexpr` object is evaluated when
+	 * it is declared and kept by name, so using it is a lookup too, however often it is used.
+	 * A name means whatever it means in `symbols` when it is evaluated. */
+	struct constant_evaluator {
+		constant_evaluator(const ast_node_table& nodes, const token_sequence& tokens,
+		     const type_table& types, const symbol_table& symbols, constant_table& constants,
+		     constant_limits limits, target_abi abi = target_abi::x86_64_sysv()) noexcept;
+
+		[[nodiscard]] constant_result evaluate(ast_node_id expression) noexcept;
+
+		/* `value` converted to the arithmetic type `t`; a failure if `t` is not one, or the
+		 * value changes on the way. */
+		[[nodiscard]] constant_result convert_exactly(
+		     const constant_value& value, type t, ast_node_id node) const noexcept;
+
+	private:
+		constant_result evaluate_node(ast_node_id node, std::uint32_t depth) noexcept;
+		constant_result evaluate_binary(ast_node_id node, std::uint32_t depth) noexcept;
+		constant_result evaluate_numeric_literal(ast_node_id node) const noexcept;
+		constant_result evaluate_identifier(ast_node_id node) const noexcept;
+		constant_result evaluate_sizeof_expression(
+		     ast_node_id node, std::uint32_t depth) noexcept;
+		constant_result size_or_alignment(type t, bool is_alignment, ast_node_id node) noexcept;
+		type_layout_table& layouts() noexcept;
+		/* The type of `node` as an operand of `sizeof`, if it can be told without evaluating
+		 * it. */
+		std::optional<type> operand_type(ast_node_id node) const noexcept;
+
+		const ast_node_table& m_nodes;
+		const token_sequence& m_tokens;
+		const type_table& m_types;
+		const symbol_table& m_symbols;
+		constant_table& m_constants;
+		constant_limits m_limits;
+		target_abi m_abi;
+		std::uint64_t m_steps;
+		std::optional<type_layout_table> m_layouts;
+	};
+
+} // namespace a_c_compiler
@@ -0,0 +1,153 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/lex/lex.h>
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace a_c_compiler {
+
+	enum class expression_operator : unsigned char {
+		// leaves
+		identifier,
+		numeric_literal,
+		/* one or more adjacent string literals, which are one string */
+		string_literal,
+		/* `true`, `false` or `nullptr` */
+		constant,
+#define BINARY_OPERATOR(TOK, LEFT_BP, RIGHT_BP, OPERATOR) OPERATOR,
+#define PREFIX_OPERATOR(TOK, OPERATOR) OPERATOR,
+#define POSTFIX_OPERATOR(TOK, OPERATOR) OPERATOR,
+#include <a_c_compiler/fe/lex/operators.inl.h>
+#undef BINARY_OPERATOR
+#undef PREFIX_OPERATOR
+#undef POSTFIX_OPERATOR
+		/* `( type-name ) expression` */
+		cast,
+		/* `( type-name ) { initializer-list }` */
+		compound_literal,
+		/* `sizeof expression` */
+		sizeof_expression,
+		/* `sizeof ( type-name )` */
+		sizeof_type,
+		/* `alignof ( type-name )` */
+		alignof_type,
+	};
+
+	[[nodiscard]] constexpr std::string_view expression_operator_name(
+	     expression_operator op) noexcept {
+		switch (op) {
+#define EXPRESSION_OPERATOR_NAME(OPERATOR) \
+	case expression_operator::OPERATOR:  \
+		return #OPERATOR;
+#define BINARY_OPERATOR(TOK, LEFT_BP, RIGHT_BP, OPERATOR) EXPRESSION_OPERATOR_NAME(OPERATOR)
+#define PREFIX_OPERATOR(TOK, OPERATOR) EXPRESSION_OPERATOR_NAME(OPERATOR)
+#define POSTFIX_OPERATOR(TOK, OPERATOR) EXPRESSION_OPERATOR_NAME(OPERATOR)
+#include <a_c_compiler/fe/lex/operators.inl.h>
+#undef BINARY_OPERATOR
+#undef PREFIX_OPERATOR
+#undef POSTFIX_OPERATOR
+			EXPRESSION_OPERATOR_NAME(identifier)
+			EXPRESSION_OPERATOR_NAME(numeric_literal)
+			EXPRESSION_OPERATOR_NAME(string_literal)
+			EXPRESSION_OPERATOR_NAME(constant)
+			EXPRESSION_OPERATOR_NAME(cast)
+			EXPRESSION_OPERATOR_NAME(compound_literal)
+			EXPRESSION_OPERATOR_NAME(sizeof_expression)
+			EXPRESSION_OPERATOR_NAME(sizeof_type)
+			EXPRESSION_OPERATOR_NAME(alignof_type)
+#undef EXPRESSION_OPERATOR_NAME
+		}
+		return "";
+	}
+
+	/* How an operator token behaves in an expression. `left` is zero for a token which is not
+	 * that kind of operator. */
+	struct binding_power {
+		unsigned char left  = 0;
+		unsigned char right = 0;
+		expression_operator op {};
+	};
+
+	/* Binding powers which are not in the operator table. Asking for a binding power takes
+	 * every operator which binds at least that tightly, so these are where each expression the
+	 * grammar names has to stop. */
+	inline constexpr const unsigned char expression_binding_power             = 0;
+	inline constexpr const unsigned char assignment_expression_binding_power  = 3;
+	inline constexpr const unsigned char conditional_expression_binding_power = 5;
+	inline constexpr const unsigned char prefix_binding_power                 = 27;
+	inline constexpr const unsigned char postfix_binding_power                = 29;
+
+	/* The binding powers of every operator, in tables indexed by token. Operator tokens are
+	 * all punctuators, and all of those have small positive ids, so a lookup is an index into
+	 * a flat array rather than a switch. */
+	namespace detail {
+		inline constexpr const std::size_t operator_token_limit = 512;
+
+		using binding_power_table = std::array<binding_power, operator_token_limit>;
+
+		inline constexpr const binding_power_table binary_binding_powers = []() {
+			binding_power_table table {};
+#define BINARY_OPERATOR(TOK, LEFT_BP, RIGHT_BP, OPERATOR) \
+	table[TOK] = binding_power { LEFT_BP, RIGHT_BP, expression_operator::OPERATOR };
+#include <a_c_compiler/fe/lex/operators.inl.h>
+#undef BINARY_OPERATOR
+			return table;
+		}();
+
+		inline constexpr const binding_power_table prefix_binding_powers = []() {
+			binding_power_table table {};
+#define PREFIX_OPERATOR(TOK, OPERATOR) \
+	table[TOK] = binding_power { 0, prefix_binding_power, expression_operator::OPERATOR };
+#include <a_c_compiler/fe/lex/operators.inl.h>
+#undef PREFIX_OPERATOR
+			return table;
+		}();
+
+		inline constexpr const binding_power_table postfix_binding_powers = []() {
+			binding_power_table table {};
+#define POSTFIX_OPERATOR(TOK, OPERATOR) \
+	table[TOK] = binding_power { postfix_binding_power, 0, expression_operator::OPERATOR };
+#include <a_c_compiler/fe/lex/operators.inl.h>
+#undef POSTFIX_OPERATOR
+			return table;
+		}();
+
+		constexpr binding_power lookup(const binding_power_table& table, token_id id) noexcept {
+			if (id < 0 || static_cast<std::size_t>(id) >= operator_token_limit) {
+				return binding_power {};
+			}
+			return table[static_cast<std::size_t>(id)];
+		}
+	} // namespace detail
+
+	[[nodiscard]] constexpr binding_power binary_operator(token_id id) noexcept {
+		return detail::lookup(detail::binary_binding_powers, id);
+	}
+
+	[[nodiscard]] constexpr binding_power prefix_operator(token_id id) noexcept {
+		return detail::lookup(detail::prefix_binding_powers, id);
+	}
+
+	[[nodiscard]] constexpr binding_power postfix_operator(token_id id) noexcept {
+		return detail::lookup(detail::postfix_binding_powers, id);
+	}
+
+	static_assert(binary_operator(tok_asterisk).left > binary_operator(tok_plus).left,
+	     "multiplication must bind tighter than addition");
+	static_assert(binary_operator(tok_equals_sign).right < binary_operator(tok_equals_sign).left,
+	     "assignment must be right-associative");
+	static_assert(binary_operator(tok_percent).right < prefix_binding_power,
+	     "every prefix operator must bind tighter than any infix one");
+	static_assert(prefix_binding_power < postfix_binding_power,
+	     "every postfix operator must bind tighter than any prefix one");
+
+} // namespace a_c_compiler
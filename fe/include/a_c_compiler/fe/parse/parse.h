@@ -14,7 +14,56 @@
 
 namespace a_c_compiler {
 
-	ast_module parse(token_vector const& toks, const global_options& global_opts,
-	     diagnostic_handles& diag_handles) noexcept;
+	ast_module parse(token_vector const& toks, const source_manager& sources,
+	     const global_options& global_opts, diagnostic_handles& diag_handles) noexcept;
+
+	/* Like `parse`, but parses into `mod`, after whatever it holds already. What it declares at
+	 * file scope (such as the names imported from an AST image) is in scope for the whole
+	 * translation unit. */
+	void parse_into(ast_module& mod, token_vector const& toks, const source_manager& sources,
+	     const global_options& global_opts, diagnostic_handles& diag_handles) noexcept;
+
+	/* Like `parse`, but lexes `source_file` as well, on a thread of its own: the parser takes
+	 * the tokens a batch at a time as they are made, instead of waiting for all of them. */
+	ast_module parse_pipelined(const source_manager& sources, file_id source_file,
+	     const global_options& global_opts, diagnostic_handles& diag_handles) noexcept;
+
+	/* Like `parse`, but parses the external declarations of the translation unit spread over
+	 * up to `thread_count` threads (0 means one per hardware thread). The token stream is split
+	 * into declarations by bracket matching alone, and every typedef declaration (and every
+	 * structure or union with a tag and a body, and every `constexpr` object) is parsed first,
+	 * in order, so that each thread knows every typedef-name, tag and constant up front. A
+	 * declaration that fails to parse does not stop the ones after it from being parsed. */
+	ast_module parse_in_parallel(token_vector const& toks, const source_manager& sources,
+	     const global_options& global_opts, diagnostic_handles& diag_handles,
+	     std::size_t thread_count = 0) noexcept;
+
+	/* The compound statement that is the body of the function definition node `definition`,
+	 * parsing it first if it was skipped. Adds nodes to the module when it parses, so it is not
+	 * safe to call from two threads at once. */
+	ast_node_id function_body(ast_module& mod, ast_node_id definition) noexcept;
+
+	/* Parses every function body in `mod` that was skipped, spread over up to `thread_count`
+	 * threads (0 means one per hardware thread). */
+	void parse_function_bodies(ast_module& mod, std::size_t thread_count = 0) noexcept;
+
+	/* Brings `mod` up to date with `edited_file`, the file it was parsed from with `edit` made
+	 * to it (see `source_manager::add_edited`), without parsing all of it again. Only the
+	 * external declarations the edit touches are lexed and parsed again, and they take the
+	 * place of the ones they replace in the translation unit; every other token and node is
+	 * kept, moved to where it is in the edited file. Everything after them is parsed again as
+	 * well when the edit can change how it parses: when a typedef, the definition of a tagged
+	 * structure or union or a `constexpr` object is edited, or when a bracket or a comment is
+	 * left open.
+	 *
+	 * The nodes replaced are unlinked, not freed, so each reparse grows the node table by the
+	 * nodes of the declarations parsed again. The exception is the nodes the last reparse
+	 * made: when an edit replaces all of them, and nothing has been added to the module since
+	 * (say, a function body parsed), they are the end of the table and are thrown away first,
+	 * so editing the same declarations over and over keeps the table the size it was. Types
+	 * are never freed. `mod` has to have been parsed from the one file, by itself (not with
+	 * an AST image). Returns the tokens that were parsed again. */
+	token_range reparse_edited(
+	     ast_module& mod, file_id edited_file, const text_edit& edit) noexcept;
 
 } /* namespace a_c_compiler */
@@ -0,0 +1,105 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace a_c_compiler {
+
+	/* What one parse rule cost over a parse. */
+	struct parse_rule_profile {
+		std::size_t calls = 0;
+		/* calls whose work was thrown away by backtracking past them */
+		std::size_t undone_calls = 0;
+		/* tokens the rule moved past, counting those of the rules it called */
+		std::size_t tokens_consumed = 0;
+		/* tokens moved past by the calls that were undone, which have to be parsed again */
+		std::size_t tokens_undone = 0;
+		/* tokens looked at ahead of the current one, to decide what to parse */
+		std::size_t tokens_looked_ahead = 0;
+	};
+
+	/* What backtracking at one place in the grammar cost over a parse. */
+	struct backtrack_site_profile {
+		std::size_t backtracks = 0;
+		/* how far back the parser went in all, which it then has to parse again */
+		std::size_t tokens_rescanned = 0;
+	};
+
+	/* Counts of what a parser did, per parse rule (keyed by the name of the function
+	 * implementing it) and per backtracking site. */
+	struct parse_profile {
+		std::unordered_map<std::string_view, parse_rule_profile> rules;
+		std::unordered_map<std::string_view, backtrack_site_profile> backtrack_sites;
+
+		void merge(const parse_profile& other) noexcept;
+	};
+
+	/* Collects a parse_profile as a parser runs: which rules are open, and which calls
+	 * finished since the oldest checkpoint still open, so that a rollback knows what it undid.
+	 * Names have to outlive the profiler. */
+	struct parse_profiler {
+		/* Where a rule call began. */
+		struct open_rule {
+			parse_rule_profile* rule;
+			std::size_t token_index;
+		};
+
+		/* Marks the parser starting the rule `name` at `token_index`. */
+		open_rule enter(std::string_view name, std::size_t token_index) noexcept;
+		/* Marks the call begun by `opened` ending at `token_index`. */
+		void exit(const open_rule& opened, std::size_t token_index) noexcept;
+
+		/* Counts `token_count` tokens looked at ahead by the innermost open rule. */
+		void look_ahead(std::size_t token_count) noexcept;
+
+		/* Marks a checkpoint, returning what to hand back to `rollback` or `commit`. */
+		std::size_t save() noexcept;
+		/* What `save` would return, without marking a checkpoint. */
+		[[nodiscard]] std::size_t position() const noexcept {
+			return m_finished_calls.size();
+		}
+		/* Marks the parser going back from `token_index` to `saved_token_index`, at the
+		 * checkpoint `saved`. An empty `site` stands for the innermost open rule. */
+		void rollback(std::size_t saved, std::string_view site, std::size_t saved_token_index,
+		     std::size_t token_index) noexcept;
+		void commit() noexcept;
+
+		[[nodiscard]] const parse_profile& profile() const noexcept {
+			return m_profile;
+		}
+
+	private:
+		struct finished_call {
+			parse_rule_profile* rule;
+			std::size_t tokens_consumed;
+		};
+
+		void close_checkpoint() noexcept;
+
+		parse_profile m_profile;
+		/* innermost last */
+		std::vector<std::pair<const std::string_view, parse_rule_profile>*> m_open_rules;
+		std::vector<finished_call> m_finished_calls;
+		std::size_t m_open_checkpoints = 0;
+	};
+
+	/* Adds `profile` to what has been collected over the whole run. Safe to call from several
+	 * threads at once. */
+	void record_parse_profile(const parse_profile& profile) noexcept;
+
+	/* Writes the rules that wasted the most work to backtracking, and the sites that
+	 * backtracked the furthest, over everything recorded so far: at most `limit` of each. */
+	void dump_parse_profile_into(std::ostream& output_stream, std::size_t limit = 15) noexcept;
+
+} // namespace a_c_compiler
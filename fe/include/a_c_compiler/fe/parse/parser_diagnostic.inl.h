@@ -14,4 +14,16 @@ DIAGNOSTIC(expected_attribute_identifier,
 DIAGNOSTIC(unbalanced_token_sequence,
      "expected a balanced set of parentheses, square brackets, or curly brackets, but received an "
      "unexpected {}")
+DIAGNOSTIC(expected_expression, "expected an expression")
+DIAGNOSTIC(expected_after_expression, "expected {} after the expression")
+DIAGNOSTIC(not_a_constant_expression, "expected a constant expression, but {}")
+DIAGNOSTIC(static_assertion_failed, "static assertion failed{}")
+DIAGNOSTIC(undeclared_identifier, "use of undeclared identifier '{}'")
+DIAGNOSTIC(function_redefinition, "redefinition of function '{}'")
+DIAGNOSTIC(not_assignable, "expression is not assignable")
+DIAGNOSTIC(not_modifiable, "cannot modify '{}', which is not a modifiable lvalue")
+DIAGNOSTIC(not_callable, "called object '{}' is not a function")
+DIAGNOSTIC(return_value_from_void_function,
+     "function '{}' returns void, but this returns a value")
+DIAGNOSTIC(return_without_value, "function '{}' returns a value, but this returns none")
 #endif
@@ -10,24 +10,47 @@
 #include <a_c_compiler/fe/lex/lex.h>
 #include <a_c_compiler/fe/parse/parser_diagnostic.h>
 #include <a_c_compiler/fe/reporting/diagnostic_handles.h>
+#include <a_c_compiler/fe/source/source_manager.h>
+
+#include <string>
 
 namespace a_c_compiler {
 
+	enum class reporting_mode {
+		/* every diagnostic is printed as soon as it is reported */
+		immediate,
+		/* diagnostics are kept, in the order they are reported, until `report_held` */
+		held,
+		/* every diagnostic is dropped, for a parse that will be redone later */
+		silenced,
+	};
+
 	struct parser_diagnostic_reporter {
-		constexpr parser_diagnostic_reporter(diagnostic_handles& handles) noexcept
-		: m_handles(handles) {
+		parser_diagnostic_reporter(diagnostic_handles& handles, const source_manager& sources,
+		     reporting_mode mode = reporting_mode::immediate) noexcept
+		: m_handles(handles), m_sources(sources), m_mode(mode), m_held() {
 		}
 
 		[[nodiscard]] diagnostic_handles& handles() noexcept {
 			return this->m_handles;
 		}
 
+		[[nodiscard]] const source_manager& sources() const noexcept {
+			return this->m_sources;
+		}
+
 		template <typename... FmtArgs>
-		void report(parser_diagnostic const& diagnostic, std::string_view file_name,
-		     file_offset_info const& source_location, FmtArgs&&... format_args) noexcept;
+		void report(parser_diagnostic const& diagnostic, source_location location,
+		     FmtArgs&&... format_args) noexcept;
+
+		/* Prints every diagnostic held so far, and forgets them. */
+		void report_held() noexcept;
 
 	private:
 		diagnostic_handles& m_handles;
+		const source_manager& m_sources;
+		reporting_mode m_mode;
+		std::string m_held;
 	};
 
 } /* namespace a_c_compiler */
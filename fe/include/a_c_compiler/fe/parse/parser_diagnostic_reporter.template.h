@@ -14,19 +14,37 @@
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
+#include <iterator>
 #include <utility>
 #include <iostream>
 
 namespace a_c_compiler {
 	template <typename... FmtArgs>
 	void parser_diagnostic_reporter::report(parser_diagnostic const& diagnostic,
-	     std::string_view file_name, file_offset_info const& source_Location,
-	     FmtArgs&&... format_args) noexcept {
-		file_name = file_name.size() ? file_name : "<source file>";
-		fmt::print(this->m_handles.error_handle(), "{} ({}, {})\n❌ ", file_name,
-		     source_Location.lineno, source_Location.column);
+	     source_location location, FmtArgs&&... format_args) noexcept {
+		if (this->m_mode == reporting_mode::silenced) {
+			return;
+		}
+		const presumed_location presumed = this->m_sources.presume(location);
+		if (this->m_mode == reporting_mode::held) {
+			fmt::format_to(std::back_inserter(this->m_held), "{} ({}, {})\n❌ ",
+			     presumed.file_name, presumed.lineno, presumed.column);
+			fmt::vformat_to(std::back_inserter(this->m_held), diagnostic.format,
+			     fmt::make_format_args(format_args...));
+			this->m_held += '\n';
+			return;
+		}
+		fmt::print(this->m_handles.error_handle(), "{} ({}, {})\n❌ ", presumed.file_name,
+		     presumed.lineno, presumed.column);
 		fmt::vprint(this->m_handles.error_handle(), diagnostic.format,
 		     fmt::make_format_args(format_args...));
 		fmt::print(this->m_handles.error_handle(), "\n");
 	}
+
+	inline void parser_diagnostic_reporter::report_held() noexcept {
+		if (!this->m_held.empty()) {
+			fmt::print(this->m_handles.error_handle(), "{}", this->m_held);
+			this->m_held.clear();
+		}
+	}
 } // namespace a_c_compiler
@@ -0,0 +1,167 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/lex/lex.h>
+#include <a_c_compiler/fe/parse/ast_node.h>
+#include <a_c_compiler/fe/parse/type.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace a_c_compiler {
+
+	/* C keeps four kinds of names apart (C23 6.2.3): the same identifier can be a label, a
+	 * tag, a member and an ordinary identifier all at once without any of them clashing. */
+	enum class symbol_namespace : unsigned char {
+		ordinary,
+		tag,
+		label,
+		member,
+	};
+
+	inline constexpr const std::size_t symbol_namespace_count = 4;
+
+	enum class symbol_kind : unsigned char {
+		object,
+		function,
+		typedef_name,
+		enumeration_constant,
+		struct_tag,
+		union_tag,
+		enum_tag,
+		label,
+		member,
+	};
+
+	enum class scope_kind : unsigned char {
+		file,
+		/* holds only labels, which are visible anywhere in the function's body */
+		function,
+		block,
+		function_prototype,
+		/* the members of one structure or union, while its body is being parsed */
+		members,
+	};
+
+	struct symbol {
+		identifier_id name;
+		symbol_namespace name_space;
+		symbol_kind kind;
+		type t;
+		ast_node_id declaration;
+		/* how many scopes were open when it was declared */
+		std::uint32_t scope_depth;
+		/* the symbol this one hides, or `symbol_table::no_symbol` */
+		std::uint32_t hidden;
+	};
+
+	/* Every name in scope at the current point of the parse.
+	 *
+	 * Declarations are pushed onto a stack of symbols, which doubles as the undo log: each
+	 * symbol remembers the one it hides, so popping a scope pops its symbols and brings the
+	 * hidden ones back, in time proportional to what the scope declared and nothing else.
+	 * Labels live on a stack of their own, since they belong to the function rather than to
+	 * whichever block they are in. The symbol visible for each (namespace, identifier) pair is
+	 * found through one open-addressing hash table keyed by `identifier_id`, so a lookup is one
+	 * probe in the common case no matter how deep the scopes are or how many names they hold.
+	 * The stacks and the hash table are allocated from the arena given at construction, and
+	 * reuse their memory as scopes come and go. */
+	struct symbol_table {
+		inline static constexpr const std::uint32_t no_symbol = 0xFFFFFFFFu;
+
+		/* How many symbols and scopes the table had at some point. */
+		struct checkpoint {
+			std::uint32_t symbol_count;
+			std::uint32_t label_count;
+			std::uint32_t scope_count;
+		};
+
+		explicit symbol_table(
+		     std::pmr::memory_resource* arena = std::pmr::get_default_resource()) noexcept;
+
+		void push_scope(scope_kind kind) noexcept;
+		/* Forgets every declaration made in the innermost scope. */
+		void pop_scope() noexcept;
+
+		[[nodiscard]] std::size_t scope_depth() const noexcept {
+			return m_scopes.size();
+		}
+
+		/* The innermost open scope: file scope when none is open. */
+		[[nodiscard]] scope_kind current_scope_kind() const noexcept {
+			return m_scopes.empty() ? scope_kind::file : m_scopes.back().kind;
+		}
+
+		/* Declares `name` in the innermost scope (or, for a label, in the innermost function
+		 * scope), hiding whatever it named in that namespace before. The symbol returned stays
+		 * valid until the next declaration. */
+		const symbol& declare(symbol_namespace name_space, identifier_id name, symbol_kind kind,
+		     type t = type(), ast_node_id declaration = ast_node_id()) noexcept;
+
+		/* What `name` means in `name_space` right now, or nullptr if it means nothing. */
+		[[nodiscard]] const symbol* find(
+		     symbol_namespace name_space, identifier_id name) const noexcept;
+		/* Like `find`, but only if the symbol was declared in the innermost scope: a second
+		 * declaration of it there is a redeclaration, not a new name. */
+		[[nodiscard]] const symbol* find_in_current_scope(
+		     symbol_namespace name_space, identifier_id name) const noexcept;
+
+		/* The type `name` stands for, if it is a typedef-name right now; nullptr otherwise. */
+		[[nodiscard]] const type* find_typedef_name(identifier_id name) const noexcept;
+
+		[[nodiscard]] bool is_typedef_name(identifier_id name) const noexcept {
+			return find_typedef_name(name) != nullptr;
+		}
+
+		[[nodiscard]] checkpoint save() const noexcept;
+		/* Every symbol declared since `saved` that is still in scope (labels aside), oldest
+		 * first. */
+		[[nodiscard]] std::span<const symbol> declared_since(
+		     const checkpoint& saved) const noexcept {
+			return std::span<const symbol>(m_symbols).subspan(saved.symbol_count);
+		}
+		/* Undoes every declaration and scope change made since `saved`. */
+		void rollback(const checkpoint& saved) noexcept;
+
+	private:
+		inline static constexpr const std::size_t initial_slot_count = 256;
+
+		struct scope {
+			scope_kind kind;
+			std::uint32_t symbol_start;
+			std::uint32_t label_start;
+		};
+
+		/* A (namespace, identifier) pair that has ever been declared, and the symbol it names
+		 * now (if any). Slots are never emptied, so probing never has to step over deleted
+		 * entries. */
+		struct slot {
+			inline static constexpr const std::uint32_t empty_key = 0xFFFFFFFFu;
+
+			std::uint32_t key     = empty_key;
+			std::uint32_t visible = no_symbol;
+		};
+
+		const symbol* visible_symbol(std::uint32_t key) const noexcept;
+		std::pmr::vector<symbol>& stack_for(symbol_namespace name_space) noexcept;
+		void pop_symbol(std::pmr::vector<symbol>& symbols) noexcept;
+		std::size_t find_slot(std::uint32_t key) const noexcept;
+		void grow() noexcept;
+
+		std::pmr::vector<slot> m_slots;
+		std::size_t m_used_slot_count;
+		std::pmr::vector<symbol> m_symbols;
+		std::pmr::vector<symbol> m_labels;
+		std::pmr::vector<scope> m_scopes;
+	};
+
+} // namespace a_c_compiler
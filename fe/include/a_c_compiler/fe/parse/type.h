@@ -0,0 +1,297 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <ztd/idk/assert.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace a_c_compiler {
+	enum class type_modifier : unsigned char {
+		tm_none = 0,
+		tm_signed,
+		tm_unsigned,
+		tm__Atomic, // _Atomic(int)
+	};
+
+	enum class type_category : unsigned char {
+		tc_none,
+		tc_void,
+		tc_bool,
+		tc_char,
+		tc_short,
+		tc_int,
+		tc_long,
+		tc_longlong,
+		tc__BitInt,
+		tc_float,
+		tc_double,
+		tc_longdouble,
+		tc_longlongdouble,
+		tc_union,
+		tc_struct,
+		tc_enum,
+		tc_function,
+		tc_array,
+		tc_variable_length_array,
+		tc_vla = tc_variable_length_array,
+		tc_data_pointer,
+		tc_function_pointer,
+		tc_nullptr,
+		tc_auto,      // inferred type
+		tc__Padding,  // extension: struct foo { int meow; _Padding(16) padding; uint16_t bark; };
+		tc_array_span // extension: array span
+	};
+
+	enum class qualifier : unsigned char {
+		none       = 0b0000,
+		q_const    = 0b0001,
+		q__Atomic  = 0b0010, // e.g. _Atomic int
+		q_volatile = 0b0100,
+		q_restrict = 0b1000,
+	};
+
+	/* `qualifiers` with `added` as well. */
+	constexpr qualifier add_qualifier(qualifier qualifiers, qualifier added) noexcept {
+		return static_cast<qualifier>(
+		     static_cast<unsigned char>(qualifiers) | static_cast<unsigned char>(added));
+	}
+
+	enum storage_class_specifier : unsigned short {
+		none             = 0b00000000000,
+		scs_static       = 0b00000000001,
+		scs_extern       = 0b00000000010,
+		scs_constexpr    = 0b00000000100,
+		scs_register     = 0b00000001000,
+		scs_thread_local = 0b00000010000,
+		scs_typedef      = 0b00000100000,
+		scs_auto         = 0b00001000000
+	};
+	using sc_specifier = storage_class_specifier;
+
+	/* A type, as an index into the `type_table` that made it. Types are interned, so two types
+	 * from the same table are the same type exactly when they are equal. A default type is the
+	 * first in every table: no type at all. */
+	struct type {
+		constexpr type() noexcept                       = default;
+		constexpr type(const type&) noexcept            = default;
+		constexpr type(type&&) noexcept                 = default;
+		constexpr type& operator=(const type&) noexcept = default;
+		constexpr type& operator=(type&&) noexcept      = default;
+
+		constexpr explicit type(std::size_t ref_index) noexcept : m_ref(ref_index) {
+		}
+
+		constexpr std::size_t index() const noexcept {
+			return m_ref;
+		}
+
+		friend constexpr bool operator==(const type&, const type&) noexcept = default;
+
+	private:
+		std::uint_least32_t m_ref = 0;
+	};
+
+	/* What a type is made of. Its sub-types are listed in the pool of the table it is in, from
+	 * `sub_types_begin` on: the pointee of a pointer, the element of an array, the return type
+	 * and then the parameter types of a function, or the members of a structure or union.
+	 *
+	 * A member that is a bit-field has the type it was declared with, but with its width as
+	 * the extent. An unnamed bit-field is `_Padding` of its width, with the type it was
+	 * declared with as its one sub-type; so is `T : 0`.
+	 *
+	 * A structure or union is the type its declaration made, and its extent is that type's
+	 * index: a qualified or aligned version of it has the same extent, and no sub-types of its
+	 * own, since only the type that was declared lists the members. Until it is completed,
+	 * that type's sub-types start at `type_table::incomplete_record`. */
+	struct type_data {
+		type_modifier modifier = type_modifier::tm_none;
+		type_category category = type_category::tc_none;
+		qualifier qualifiers   = qualifier::none;
+		/* from `alignas`: the type is aligned to at least 2 to the power of this */
+		std::uint8_t alignment_log2 = 0;
+		/* the width in bits of a _BitInt, a bit-field or _Padding, or the length of an array
+		 * (0 if it is not known) */
+		std::uint32_t extent          = 0;
+		std::uint32_t sub_types_begin = 0;
+		std::uint32_t sub_type_count  = 0;
+	};
+
+	/* A type being put together a specifier at a time, before it is interned. */
+	struct type_builder {
+		type_modifier modifier      = type_modifier::tm_none;
+		type_category category      = type_category::tc_none;
+		qualifier qualifiers        = qualifier::none;
+		std::uint8_t alignment_log2 = 0;
+		std::uint32_t extent        = 0;
+		std::vector<type> sub_types;
+
+		[[nodiscard]] bool empty() const noexcept {
+			return category == type_category::tc_none && modifier == type_modifier::tm_none;
+		}
+	};
+
+	/* Where the types of one table went when they were interned into another: those from
+	 * `first` on are listed in `moved`, and the ones before it are the same in both. By
+	 * default, nothing moves. */
+	struct type_relocation {
+		std::size_t first = static_cast<std::size_t>(-1);
+		std::vector<type> moved;
+
+		[[nodiscard]] type operator()(type t) const noexcept {
+			return t.index() >= first ? moved[t.index() - first] : t;
+		}
+	};
+
+	/* Every type made while parsing a module. A `type` is an index into this table.
+	 *
+	 * Each combination of modifier, category, qualifiers, alignment, extent and sub-types is
+	 * stored once, however often it is spelled, and the sub-types of every type share one pool,
+	 * so a type is 16 bytes and no allocation of its own. Types are only ever added to the end,
+	 * so a type's sub-types always come before it. Structures and unions are the exception to
+	 * interning: each declaration of one makes a type of its own, however alike their members
+	 * are, and they are told apart by the index of that type rather than by their members.
+	 * One is declared before its body is parsed and completed with its members in place, so
+	 * everything that named it while it was incomplete names the complete type, and its
+	 * members can come after it. */
+	struct type_table {
+		/* sub_types_begin of a structure or union that has not been completed yet */
+		inline static constexpr const std::uint32_t incomplete_record = 0xFFFFFFFFu;
+
+		/* How many types, sub-types and completed structures and unions the table had at
+		 * some point. */
+		struct checkpoint {
+			std::uint32_t type_count;
+			std::uint32_t sub_type_count;
+			std::uint32_t completed_count;
+		};
+
+		type_table() noexcept;
+
+		/* The type `built` describes, added to the table if it is not in it yet. A structure
+		 * or union has to have been declared first: `built` only qualifies or aligns it. */
+		type intern(const type_builder& built) noexcept;
+
+		/* A new structure or union with no members yet, which is a different type from every
+		 * other. */
+		type declare_record(type_category category) noexcept;
+		/* Gives the structure or union `record`, declared and not completed yet, `members`. */
+		void complete_record(type record, std::span<const type> members) noexcept;
+
+		/* Whether the structure or union `t` has been completed. */
+		[[nodiscard]] bool is_complete_record(type t) const noexcept {
+			return data(type(data(t).extent)).sub_types_begin != incomplete_record;
+		}
+
+		[[nodiscard]] const type_data& data(type t) const noexcept {
+			return m_types[t.index()];
+		}
+
+		[[nodiscard]] std::span<const type> sub_types(type t) const noexcept {
+			const type_data& t_data = data(t);
+			if (t_data.sub_type_count == 0) {
+				return {};
+			}
+			return std::span<const type>(m_sub_types).subspan(
+			     t_data.sub_types_begin, t_data.sub_type_count);
+		}
+
+		/* `t`, as something to build another type from. */
+		[[nodiscard]] type_builder builder(type t) const noexcept;
+
+		[[nodiscard]] type pointee_type(type t) const noexcept {
+			ZTD_ASSERT_MESSAGE("Must be a pointer type.",
+			     data(t).category == type_category::tc_data_pointer
+			          || data(t).category == type_category::tc_function_pointer);
+			ZTD_ASSERT_MESSAGE(
+			     "There must be at least 1 available sub-type.", data(t).sub_type_count == 1);
+			return sub_types(t)[0];
+		}
+
+		[[nodiscard]] type element_type(type t) const noexcept {
+			ZTD_ASSERT_MESSAGE("Must be an array type.",
+			     data(t).category == type_category::tc_array
+			          || data(t).category == type_category::tc_vla
+			          || data(t).category == type_category::tc_array_span);
+			ZTD_ASSERT_MESSAGE(
+			     "There must be at least 1 available sub-type.", data(t).sub_type_count == 1);
+			return sub_types(t)[0];
+		}
+
+		[[nodiscard]] std::span<const type> member_types(type t) const noexcept {
+			ZTD_ASSERT_MESSAGE("Must be a structure or union type.",
+			     data(t).category == type_category::tc_struct
+			          || data(t).category == type_category::tc_union);
+			return sub_types(type(data(t).extent));
+		}
+
+		[[nodiscard]] type return_type(type t) const noexcept {
+			ZTD_ASSERT_MESSAGE(
+			     "Must be a function type.", data(t).category == type_category::tc_function);
+			ZTD_ASSERT_MESSAGE("Must have at least one type.", data(t).sub_type_count >= 1);
+			// Return Type + Parameter Layout
+			// [ R | P | P | P ]
+			//     ^           ^
+			// [ R ]
+			//     ^
+			return sub_types(t)[0];
+		}
+
+		[[nodiscard]] std::span<const type> parameter_types(type t) const noexcept {
+			ZTD_ASSERT_MESSAGE(
+			     "Must be a function type.", data(t).category == type_category::tc_function);
+			ZTD_ASSERT_MESSAGE("Must have at least one type.", data(t).sub_type_count >= 1);
+			return sub_types(t).subspan(1);
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return m_types.size();
+		}
+
+		[[nodiscard]] checkpoint save() const noexcept {
+			return checkpoint { static_cast<std::uint32_t>(m_types.size()),
+				static_cast<std::uint32_t>(m_sub_types.size()),
+				static_cast<std::uint32_t>(m_completed.size()) };
+		}
+		/* Forgets every type added since `saved`, and takes the members of every structure
+		 * and union completed since back out. */
+		void rollback(const checkpoint& saved) noexcept;
+
+		/* Interns the types `other` added since `since` into this table, and completes the
+		 * structures and unions it completed. Everything before `since` is taken to be the
+		 * same in both tables. Returns where `other`'s types ended up here, which is wherever
+		 * an equal type already was, if there was one. */
+		type_relocation append_types(const type_table& other, const checkpoint& since) noexcept;
+
+	private:
+		inline static constexpr const std::size_t initial_slot_count = 64;
+		/* a slot no type has been put in */
+		inline static constexpr const std::uint32_t empty_slot = 0xFFFFFFFFu;
+
+		/* The slot `built` is in, or the empty slot it would go in. */
+		std::size_t find_slot(const type_builder& built) const noexcept;
+		/* Adds `built`, with `sub_types`, as a new type that goes in `slot`. */
+		type add(std::uint32_t& slot, const type_builder& built,
+		     std::span<const type> sub_types) noexcept;
+		void grow() noexcept;
+
+		std::vector<type_data> m_types;
+		std::vector<type> m_sub_types;
+		/* every structure and union completed, in the order they were */
+		std::vector<type> m_completed;
+		/* Each type's index, in an open-addressing hash table keyed by what the type is made
+		 * of. Types only ever leave the table newest first, and each one that does empties
+		 * its slot: nothing that was put in before it can have probed past that slot, so
+		 * probing never has to step over deleted entries. */
+		std::vector<std::uint32_t> m_slots;
+	};
+
+} /* namespace a_c_compiler */
@@ -0,0 +1,143 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/parse/type.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <vector>
+
+namespace a_c_compiler {
+
+	struct ast_module;
+
+	/* How big a scalar type is on a target, and what it is aligned to, in bytes. */
+	struct scalar_layout {
+		std::uint8_t size;
+		std::uint8_t alignment;
+	};
+
+	/* What a target's ABI says about laying out types. Bit-fields are placed the way the
+	 * System V ABIs place them: each one in the next bits that do not cross a boundary of the
+	 * type it was declared with, and unnamed ones do not add to the alignment of what they
+	 * are in. */
+	struct target_abi {
+		scalar_layout bool_layout;
+		scalar_layout char_layout;
+		scalar_layout short_layout;
+		scalar_layout int_layout;
+		scalar_layout long_layout;
+		scalar_layout long_long_layout;
+		scalar_layout float_layout;
+		scalar_layout double_layout;
+		scalar_layout long_double_layout;
+		scalar_layout pointer_layout;
+		/* what a _BitInt wider than 64 bits is aligned to */
+		std::uint8_t wide_bit_int_alignment;
+		/* the widest a _BitInt can be: `BITINT_MAXWIDTH` */
+		std::uint32_t bit_int_max_width;
+
+		/* x86-64, and most other 64-bit System V targets */
+		static constexpr target_abi x86_64_sysv() noexcept {
+			return target_abi { { 1, 1 }, { 1, 1 }, { 2, 2 }, { 4, 4 }, { 8, 8 }, { 8, 8 },
+				{ 4, 4 }, { 8, 8 }, { 16, 16 }, { 8, 8 }, 8, 65535 };
+		}
+
+		/* 32-bit x86 */
+		static constexpr target_abi i386_sysv() noexcept {
+			return target_abi { { 1, 1 }, { 1, 1 }, { 2, 2 }, { 4, 4 }, { 4, 4 }, { 8, 4 },
+				{ 4, 4 }, { 8, 4 }, { 12, 4 }, { 4, 4 }, 4, 65535 };
+		}
+	};
+
+	/* The size and alignment of a type, in bytes. */
+	struct type_layout {
+		std::uint64_t size;
+		std::uint32_t alignment;
+		/* false for a type with no size: `void`, a function, an array of unknown length or a
+		 * variable length array, or a structure or union that is not complete yet or has such
+		 * a member */
+		bool complete;
+	};
+
+	/* Where a member of a structure or union is, in bits from the start of it. */
+	struct member_layout {
+		std::uint64_t bit_offset;
+		/* for a bit-field or `_Padding`, how many bits it takes up; 0 otherwise */
+		std::uint32_t bit_width;
+
+		/* The offset of the byte the member starts in, which is what `offsetof` gives for any
+		 * member that is not a bit-field. */
+		[[nodiscard]] constexpr std::uint64_t offset() const noexcept {
+			return bit_offset / 8;
+		}
+	};
+
+	/* The layouts of the types of one type table, for one target.
+	 *
+	 * A type's layout is worked out the first time it is asked for, and then kept by the type's
+	 * index, so every later question about it (its size, alignment, or where its members are)
+	 * is a lookup. Since types are interned, that is once per distinct type, however many
+	 * times and places it is spelled. The member layouts of every structure and union share
+	 * one pool, in the order of their members.
+	 *
+	 * Layouts are kept by index, so the types they are asked for must not be dropped from the
+	 * table (as a parser backtracking does), or completed, while this is in use. */
+	struct type_layout_table {
+		explicit type_layout_table(
+		     const type_table& types, target_abi abi = target_abi::x86_64_sysv()) noexcept;
+
+		[[nodiscard]] type_layout layout(type t) noexcept;
+
+		[[nodiscard]] std::uint64_t size_of(type t) noexcept {
+			return layout(t).size;
+		}
+
+		[[nodiscard]] std::uint32_t alignment_of(type t) noexcept {
+			return layout(t).alignment;
+		}
+
+		/* Where each member of the structure or union `record` is, in the order of its
+		 * sub-types. Good until the next layout is worked out. */
+		[[nodiscard]] std::span<const member_layout> members(type record) noexcept;
+
+		/* The layout of a _BitInt `width` bits wide. */
+		[[nodiscard]] type_layout bit_int_layout(std::uint32_t width) const noexcept;
+
+		[[nodiscard]] const target_abi& abi() const noexcept {
+			return m_abi;
+		}
+
+	private:
+		/* A layout, and where the layouts of its members start in `m_members`; alignment 0
+		 * means it has not been worked out yet. */
+		struct cached_layout {
+			type_layout layout;
+			std::uint32_t members_begin;
+		};
+
+		cached_layout& cached(type t) noexcept;
+		type_layout compute(type t, std::uint32_t& members_begin) noexcept;
+		type_layout compute_record(type t, std::uint32_t& members_begin) noexcept;
+
+		const type_table* m_types;
+		target_abi m_abi;
+		std::vector<cached_layout> m_layouts;
+		std::vector<member_layout> m_members;
+	};
+
+	/* Writes the layout of every structure and union `mod` defines at file scope to `output`: a
+	 * line for each with its tag, size and alignment, and then a line for each member with
+	 * where it is. Returns whether all of it was written. */
+	bool dump_record_layouts_into(
+	     const ast_module& mod, type_layout_table& layouts, std::FILE* output) noexcept;
+
+} // namespace a_c_compiler
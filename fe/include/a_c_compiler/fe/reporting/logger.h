@@ -57,15 +57,20 @@ namespace a_c_compiler {
 		std::size_t m_indent_width;
 	};
 
+	/* Logs entering a scope named `scope_name` (which has to outlive it), indenting what is
+	 * logged until it is destroyed. */
 	struct scope_logger {
-		scope_logger(std::string scope_name, std::function<void(logger&)>&& entry_callback,
+		scope_logger(std::string_view scope_name, std::function<void(logger&)>&& entry_callback,
 		     logger& target, std::optional<std::string_view> logfile = std::nullopt) noexcept;
+		// a copy would take the indentation back out a second time
+		scope_logger(const scope_logger&)            = delete;
+		scope_logger& operator=(const scope_logger&) = delete;
 
 		~scope_logger() noexcept;
 
 	private:
 		logger& m_logger;
-		std::string scope_name;
+		std::string_view m_scope_name;
 		std::optional<std::string_view> logfile;
 
 		void indent() noexcept;
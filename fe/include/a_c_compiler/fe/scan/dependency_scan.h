@@ -0,0 +1,114 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/options/global_options.h>
+#include <a_c_compiler/fe/reporting/diagnostic_handles.h>
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <iosfwd>
+
+namespace a_c_compiler {
+
+	namespace fs = std::filesystem;
+
+	struct file_prefetcher;
+
+	enum class scanned_directive_kind : unsigned char {
+		include, // #include, #include_next, #import
+		embed,
+		define,
+		conditional_begin, // #if, #ifdef, #ifndef
+		conditional_else,  // #elif, #elifdef, #elifndef, #else
+		conditional_end,   // #endif
+	};
+
+	struct scanned_directive {
+		scanned_directive_kind kind;
+		/* `<...>` rather than `"..."` for includes and embeds */
+		bool angled = false;
+		std::size_t lineno = 0;
+		/* For includes and embeds, the spelled header name without its delimiters (empty for
+		 * computed includes). For definitions, the macro name. */
+		std::string argument;
+	};
+
+	/* A source file reduced to just the preprocessor directives which matter for finding its
+	 * dependencies. Comments, string literals and ordinary lines are dropped entirely. */
+	struct minimized_source {
+		std::vector<scanned_directive> directives;
+		/* Whether the whole file is wrapped in a classic `#ifndef X` / `#define X` / `#endif`
+		 * include guard, so its directives are not really conditional. */
+		bool has_include_guard = false;
+	};
+
+	minimized_source minimize_directives(std::string_view source) noexcept;
+
+	struct dependency_scan_options {
+		std::vector<fs::path> include_directories;
+		/* Number of files to scan at once; 0 means one per hardware thread. */
+		std::size_t thread_count = 0;
+		/* When set, included files are handed to it as soon as they are found, and read
+		 * through it. It must outlive the scanner. */
+		file_prefetcher* prefetcher = nullptr;
+	};
+
+	struct dependency_scan_result {
+		fs::path source_file;
+		/* Every file the source depends on, the source itself first, each listed once in the
+		 * order it was first reached. */
+		std::vector<fs::path> dependencies;
+		bool successful = true;
+	};
+
+	/* Scans translation units for their `#include` and `#embed` dependencies without running
+	 * the lexer or parser. Headers are read and minimized once and shared between every
+	 * translation unit scanned through the same scanner, and `scan_all` spreads files over
+	 * multiple threads. */
+	struct dependency_scanner {
+		dependency_scanner(
+		     dependency_scan_options options, diagnostic_handles& diag_handles) noexcept;
+
+		dependency_scan_result scan(const fs::path& source_file) noexcept;
+		std::vector<dependency_scan_result> scan_all(
+		     const std::vector<fs::path>& source_files) noexcept;
+
+	private:
+		std::shared_ptr<const minimized_source> minimized(const fs::path& file) noexcept;
+		bool is_cached(const fs::path& file) noexcept;
+		std::optional<fs::path> resolve(const scanned_directive& directive,
+		     const fs::path& including_file) const noexcept;
+		void scan_into(const fs::path& file, dependency_scan_result& result,
+		     std::unordered_set<std::string>& visited) noexcept;
+		void report(const fs::path& file, std::size_t lineno, std::string_view message) noexcept;
+
+		dependency_scan_options m_options;
+		diagnostic_handles& m_diag_handles;
+		std::mutex m_cache_mutex;
+		std::unordered_map<std::string, std::shared_ptr<const minimized_source>> m_cache;
+		std::mutex m_report_mutex;
+	};
+
+	/* The make target used for a source file when none is given: its file name, with the
+	 * extension replaced by `.o`. */
+	std::string default_dependency_target(const fs::path& source_file);
+
+	/* Writes a Make-style rule, `target: dependency...`, wrapping long lines and escaping
+	 * spaces and dollar signs. */
+	void write_make_dependencies(std::ostream& output_stream, std::string_view target,
+	     const std::vector<fs::path>& dependencies);
+
+} // namespace a_c_compiler
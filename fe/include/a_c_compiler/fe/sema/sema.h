@@ -0,0 +1,32 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/parse/ast_module.h>
+
+#include <cstddef>
+
+namespace a_c_compiler {
+
+	/* Checks the rules of the language that parsing alone does not: that every name used in a
+	 * function body is declared, that what is assigned to or incremented can be, that what is
+	 * called is a function, that `return` statements agree with their function's return type,
+	 * and that no function is defined twice.
+	 *
+	 * It runs in two phases. The first goes over the file-scope declarations, in order, on the
+	 * calling thread, and gathers what every function body can refer to. The second checks the
+	 * function bodies, which depend on nothing but that and themselves, spread over up to
+	 * `thread_count` threads (0 means one per hardware thread) that steal bodies from each
+	 * other as they run out. Nothing in `mod` is changed, and whatever one body needs while it
+	 * is checked belongs to that body alone. Diagnostics are held back, and reported once every
+	 * body has been checked, in the order of the declarations they are about, so they come out
+	 * the same however many threads there are. Every function body has to have been parsed (see
+	 * `parse_function_bodies`) first. Returns how many diagnostics were reported. */
+	std::size_t analyze_semantics(const ast_module& mod, std::size_t thread_count = 0) noexcept;
+
+} // namespace a_c_compiler
@@ -0,0 +1,78 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <a_c_compiler/fe/source/source_manager.h>
+#include <a_c_compiler/fe/support/thread_pool.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+namespace a_c_compiler {
+
+	namespace fs = std::filesystem;
+
+	using file_read_result = std::expected<std::string, std::error_code>;
+
+	enum class prefetch_backend : unsigned char {
+		io_uring,
+		thread_pool,
+	};
+
+	/* Reads files ahead of when they are needed. Every file handed to `prefetch` is opened and
+	 * read in the background, through io_uring where the build and the running kernel support
+	 * it and through a small pool of reader threads otherwise, so that by the time the
+	 * `source_manager` asks for a file its contents are usually already in memory. */
+	struct file_prefetcher {
+		explicit file_prefetcher(std::size_t thread_count = 0) noexcept;
+		file_prefetcher(const file_prefetcher&)            = delete;
+		file_prefetcher& operator=(const file_prefetcher&) = delete;
+		~file_prefetcher() noexcept;
+
+		/* Starts reading `file` without waiting for it. Asking for the same file more than once
+		 * only reads it once. */
+		void prefetch(const fs::path& file) noexcept;
+		/* Waits for a prefetched file to finish reading and hands over its contents. Files that
+		 * were never prefetched (or were already taken) give back nothing. */
+		std::optional<file_read_result> take(const fs::path& file) noexcept;
+
+		[[nodiscard]] prefetch_backend backend() const noexcept;
+
+	private:
+		struct request;
+		struct io_uring_state;
+
+		void finish(request& target, file_read_result result) noexcept;
+		void submit_to_io_uring(request& target) noexcept;
+		void advance_io_uring_request(request& target, int operation_result) noexcept;
+		void reap_io_uring_completions() noexcept;
+
+		std::mutex m_mutex;
+		std::condition_variable m_request_finished;
+		std::unordered_map<std::string, std::unique_ptr<request>> m_requests;
+		std::size_t m_requests_in_flight;
+		std::unique_ptr<io_uring_state> m_io_uring;
+		std::thread m_io_uring_reaper;
+		std::size_t m_thread_count;
+		/* Declared last, so it is torn down (and its queued reads drained) first. */
+		std::optional<thread_pool> m_pool;
+	};
+
+	/* Reads a whole file into memory, right now, on the calling thread. */
+	file_read_result read_file_contents(const fs::path& file) noexcept;
+
+} // namespace a_c_compiler
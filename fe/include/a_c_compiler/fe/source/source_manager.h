@@ -0,0 +1,162 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace a_c_compiler {
+
+	namespace fs = std::filesystem;
+
+	struct file_prefetcher;
+
+	/* A single position in some source file loaded by a `source_manager`. Every loaded file owns
+	 * a contiguous slice of one 32-bit location space, so this one integer says both which file
+	 * and where in it. 0 is never a valid location, and the top bit is reserved for locations
+	 * inside macro expansions. */
+	struct source_location {
+		inline static constexpr const std::uint32_t macro_location_bit = 0x80000000u;
+
+		constexpr source_location() noexcept = default;
+
+		constexpr explicit source_location(std::uint32_t raw_value) noexcept : m_raw(raw_value) {
+		}
+
+		[[nodiscard]] constexpr std::uint32_t raw() const noexcept {
+			return m_raw;
+		}
+
+		[[nodiscard]] constexpr bool is_valid() const noexcept {
+			return m_raw != 0;
+		}
+
+		[[nodiscard]] constexpr bool is_macro_location() const noexcept {
+			return (m_raw & macro_location_bit) != 0;
+		}
+
+		[[nodiscard]] constexpr source_location advanced_by(std::uint32_t offset) const noexcept {
+			return source_location(m_raw + offset);
+		}
+
+		friend constexpr bool operator==(source_location, source_location) noexcept = default;
+		friend constexpr auto operator<=>(source_location, source_location) noexcept = default;
+
+	private:
+		std::uint32_t m_raw = 0;
+	};
+
+	/* Identifies one file (or in-memory buffer) owned by a `source_manager`. */
+	struct file_id {
+		constexpr file_id() noexcept = default;
+
+		constexpr explicit file_id(std::uint32_t index) noexcept : m_index(index) {
+		}
+
+		[[nodiscard]] constexpr std::uint32_t index() const noexcept {
+			return m_index;
+		}
+
+		[[nodiscard]] constexpr bool is_valid() const noexcept {
+			return m_index != invalid_index;
+		}
+
+		friend constexpr bool operator==(file_id, file_id) noexcept = default;
+
+	private:
+		inline static constexpr const std::uint32_t invalid_index = 0xFFFFFFFFu;
+		std::uint32_t m_index = invalid_index;
+	};
+
+	/* A location decomposed into the line and column a human would look for. Both are
+	 * 1-based. */
+	struct presumed_location {
+		std::string_view file_name;
+		std::uint32_t lineno;
+		std::uint32_t column;
+	};
+
+	/* A change to the text of a file: the bytes [begin, end) replaced with `replacement`. */
+	struct text_edit {
+		std::uint32_t begin;
+		std::uint32_t end;
+		std::string_view replacement;
+	};
+
+	/* Owns the contents of every file read during compilation. Files are deduplicated by their
+	 * identity on disk (device and inode, where the platform has them), so reaching the same
+	 * file through two different paths loads it once. */
+	struct source_manager {
+		source_manager() noexcept;
+		source_manager(const source_manager&)            = delete;
+		source_manager& operator=(const source_manager&) = delete;
+		source_manager(source_manager&&) noexcept        = default;
+		source_manager& operator=(source_manager&&)      = default;
+
+		/* Takes file contents from `prefetcher` when it has them, instead of reading files on
+		 * the spot. The prefetcher must outlive this source manager. */
+		void use_prefetcher(file_prefetcher* prefetcher) noexcept;
+
+		std::expected<file_id, std::error_code> load(const fs::path& file) noexcept;
+		/* Adds an in-memory buffer that does not correspond to any file on disk. */
+		std::expected<file_id, std::error_code> add_buffer(
+		     std::string name, std::string contents) noexcept;
+		/* Adds the text of `file` with `edit` made to it, as a file of its own with the same
+		 * path and name. `file` is left as it is, so its locations still mean what they did, and
+		 * loading its path still gives `file`. Every edit takes up as many locations as the
+		 * whole file does. */
+		std::expected<file_id, std::error_code> add_edited(
+		     file_id file, const text_edit& edit) noexcept;
+
+		[[nodiscard]] std::string_view buffer(file_id file) const noexcept;
+		[[nodiscard]] std::string_view name(file_id file) const noexcept;
+		[[nodiscard]] const fs::path& path(file_id file) const noexcept;
+
+		/* The location of the character `offset` bytes into `file`. The size of the file itself
+		 * is a valid offset, and refers to the end of the file. */
+		[[nodiscard]] source_location location(file_id file, std::uint32_t offset) const noexcept;
+		[[nodiscard]] file_id file_of(source_location location) const noexcept;
+		[[nodiscard]] std::uint32_t offset_of(source_location location) const noexcept;
+		[[nodiscard]] presumed_location presume(source_location location) const noexcept;
+
+		[[nodiscard]] std::size_t file_count() const noexcept {
+			return m_files.size();
+		}
+
+	private:
+		struct file_entry {
+			fs::path path;
+			std::string name;
+			std::string contents;
+			/* first location owned by this file */
+			std::uint32_t start;
+			/* offset of the first character of every line */
+			std::vector<std::uint32_t> line_starts;
+		};
+
+		std::expected<file_id, std::error_code> add_file(
+		     fs::path path, std::string name, std::string contents) noexcept;
+		const file_entry& entry(file_id file) const noexcept;
+
+		std::vector<file_entry> m_files;
+		/* first location of each entry in `m_files`, kept separately so finding the file for a
+		 * location is a binary search over a dense array */
+		std::vector<std::uint32_t> m_file_starts;
+		std::unordered_map<std::string, file_id> m_files_by_identity;
+		std::uint32_t m_next_location;
+		file_prefetcher* m_prefetcher;
+	};
+
+} // namespace a_c_compiler
@@ -0,0 +1,130 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace a_c_compiler {
+
+	/* An integer of any size, kept exactly: a sign, and a magnitude in 64-bit limbs, least
+	 * significant first, with no leading zero limbs (so 0 has none, and is never negative).
+	 *
+	 * A magnitude of up to 128 bits is kept inline, so arithmetic on anything as wide as a
+	 * `long long` (products included) never allocates. Only magnitudes wider than that put
+	 * their limbs on the heap; when an operation brings one back under 128 bits, it moves
+	 * back inline.
+	 *
+	 * Division truncates toward zero, as C's does, and so does `%` with it. Right shifts round
+	 * toward negative infinity, and the bitwise operators act as if on two's complement bits
+	 * extended forever, so both work on negative integers the way they do on a C integer
+	 * of any width that holds them. */
+	struct big_integer {
+		using limb = std::uint64_t;
+
+		inline static constexpr const std::uint32_t limb_bits    = 64;
+		inline static constexpr const std::uint32_t inline_limbs = 2;
+
+		big_integer() noexcept = default;
+		big_integer(std::uint64_t value) noexcept;
+		big_integer(const big_integer& other) noexcept;
+		big_integer(big_integer&& other) noexcept;
+		big_integer& operator=(const big_integer& other) noexcept;
+		big_integer& operator=(big_integer&& other) noexcept;
+		~big_integer() noexcept = default;
+
+		[[nodiscard]] static big_integer from_signed(std::int64_t value) noexcept;
+		/* The integer `value` is, which has to be a finite integer already (see `std::trunc`). */
+		[[nodiscard]] static big_integer from_double(double value) noexcept;
+		/* 2 to the power of `exponent`. */
+		[[nodiscard]] static big_integer power_of_two(std::uint32_t exponent) noexcept;
+
+		[[nodiscard]] bool is_zero() const noexcept {
+			return m_size == 0;
+		}
+
+		[[nodiscard]] bool is_negative() const noexcept {
+			return m_negative;
+		}
+
+		/* How many bits the magnitude takes: 0 for 0, and 1 more than the index of its highest
+		 * set bit otherwise. */
+		[[nodiscard]] std::uint32_t bit_width() const noexcept;
+
+		/* Whether an integer type `width` bits wide holds this value. */
+		[[nodiscard]] bool fits_in(std::uint32_t width, bool is_unsigned) const noexcept;
+		/* This value brought into the range of an integer type `width` bits wide the way
+		 * converting to it does: modulo 2 to the power of `width`. */
+		[[nodiscard]] big_integer wrapped(std::uint32_t width, bool is_unsigned) const noexcept;
+
+		/* The low 64 bits of the value in two's complement. */
+		[[nodiscard]] std::uint64_t low_bits() const noexcept;
+		/* The nearest `double`, rounding to even on a tie. */
+		[[nodiscard]] double to_double() const noexcept;
+
+		/* Multiplies by `factor` and adds `addend` in place, as reading digits does. */
+		void multiply_add(std::uint32_t factor, std::uint32_t addend) noexcept;
+
+		friend big_integer operator-(const big_integer& value) noexcept;
+		friend big_integer operator~(const big_integer& value) noexcept;
+		friend big_integer operator+(const big_integer& left, const big_integer& right) noexcept;
+		friend big_integer operator-(const big_integer& left, const big_integer& right) noexcept;
+		friend big_integer operator*(const big_integer& left, const big_integer& right) noexcept;
+		/* `right` must not be 0. */
+		friend big_integer operator/(const big_integer& left, const big_integer& right) noexcept;
+		/* `right` must not be 0. */
+		friend big_integer operator%(const big_integer& left, const big_integer& right) noexcept;
+		friend big_integer operator&(const big_integer& left, const big_integer& right) noexcept;
+		friend big_integer operator|(const big_integer& left, const big_integer& right) noexcept;
+		friend big_integer operator^(const big_integer& left, const big_integer& right) noexcept;
+		friend big_integer operator<<(const big_integer& value, std::uint32_t by) noexcept;
+		friend big_integer operator>>(const big_integer& value, std::uint32_t by) noexcept;
+
+		friend bool operator==(const big_integer& left, const big_integer& right) noexcept;
+		friend std::strong_ordering operator<=>(
+		     const big_integer& left, const big_integer& right) noexcept;
+
+	private:
+		enum class bitwise_operator : unsigned char { and_, or_, xor_ };
+
+		/* `limb_count` limbs of magnitude, all 0, to be filled in and then normalized. */
+		[[nodiscard]] static big_integer with_limbs(std::uint32_t limb_count) noexcept;
+		[[nodiscard]] static big_integer divide(const big_integer& left,
+		     const big_integer& right, big_integer* remainder) noexcept;
+		[[nodiscard]] static big_integer bitwise(const big_integer& left,
+		     const big_integer& right, bitwise_operator op) noexcept;
+		/* `|left| + |right|` or `|left| - |right|`, with the sign `is_negative` if it is not
+		 * 0; flips the sign when `|right|` is the bigger of a difference. */
+		[[nodiscard]] static big_integer add_magnitudes(const big_integer& left,
+		     const big_integer& right, bool subtract, bool is_negative) noexcept;
+
+		[[nodiscard]] limb* limbs() noexcept {
+			return m_heap ? m_heap.get() : m_inline;
+		}
+
+		[[nodiscard]] const limb* limbs() const noexcept {
+			return m_heap ? m_heap.get() : m_inline;
+		}
+
+		[[nodiscard]] std::span<const limb> magnitude() const noexcept {
+			return std::span<const limb>(limbs(), m_size);
+		}
+
+		/* Drops leading zero limbs, makes 0 not negative, and moves back inline if it can. */
+		void normalize() noexcept;
+
+		limb m_inline[inline_limbs] {};
+		std::unique_ptr<limb[]> m_heap;
+		std::uint32_t m_size = 0;
+		bool m_negative      = false;
+	};
+
+} // namespace a_c_compiler
@@ -0,0 +1,83 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+namespace a_c_compiler {
+
+	/* Writes text to a C stream through a buffer of its own, so that writing a piece of text
+	 * is a copy into memory, and the stream is only written to a buffer-full at a time. Numbers
+	 * are formatted straight into the buffer. Flushes when destroyed. */
+	struct buffered_writer {
+		inline static constexpr const std::size_t buffer_size = 64 * 1024;
+
+		explicit buffered_writer(std::FILE* output) noexcept;
+		buffered_writer(const buffered_writer&)            = delete;
+		buffered_writer& operator=(const buffered_writer&) = delete;
+		~buffered_writer() noexcept;
+
+		void write(std::string_view text) noexcept {
+			if (text.size() > buffer_size - m_size) {
+				flush();
+				if (text.size() > buffer_size) {
+					write_through(text);
+					return;
+				}
+			}
+			std::memcpy(m_buffer.get() + m_size, text.data(), text.size());
+			m_size += text.size();
+		}
+
+		void write(char c) noexcept {
+			if (m_size == buffer_size) {
+				flush();
+			}
+			m_buffer[m_size++] = c;
+		}
+
+		void write_number(std::integral auto value) noexcept {
+			// enough for any integer, sign included
+			static constexpr const std::size_t max_digits = 24;
+			if (buffer_size - m_size < max_digits) {
+				flush();
+			}
+			char* const first = m_buffer.get() + m_size;
+			m_size += std::to_chars(first, first + max_digits, value).ptr - first;
+		}
+
+		void write_repeated(char c, std::size_t count) noexcept {
+			for (; count != 0; --count) {
+				write(c);
+			}
+		}
+
+		/* Hands everything buffered to the stream (but does not flush the stream itself). */
+		void flush() noexcept;
+
+		/* Whether every write so far made it to the stream. */
+		[[nodiscard]] bool good() const noexcept {
+			return !m_failed;
+		}
+
+	private:
+		void write_through(std::string_view text) noexcept;
+
+		std::FILE* m_output;
+		std::unique_ptr<char[]> m_buffer;
+		std::size_t m_size;
+		bool m_failed;
+	};
+
+} // namespace a_c_compiler
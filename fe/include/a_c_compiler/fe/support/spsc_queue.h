@@ -0,0 +1,70 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace a_c_compiler {
+
+	/* A bounded queue between exactly one producing thread and exactly one consuming thread,
+	 * with no locks: each side owns one index into a ring of slots, and only reads the other's.
+	 *
+	 * Values are built and read in place, so nothing is copied through the queue: the producer
+	 * fills in `producer_slot()` and then `publish()`es it, and the consumer reads `front()`
+	 * and then `release()`s it. Either side waits (without spinning) when the ring is full or
+	 * empty. */
+	template <typename T, std::size_t Capacity>
+	struct spsc_queue {
+		static_assert((Capacity & (Capacity - 1)) == 0, "the capacity must be a power of two");
+
+		/* The slot the next value goes in, once the consumer has freed one up. */
+		[[nodiscard]] T& producer_slot() noexcept {
+			const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+			for (std::size_t head = m_head.load(std::memory_order_acquire);
+			     tail - head == Capacity; head = m_head.load(std::memory_order_acquire)) {
+				m_head.wait(head, std::memory_order_acquire);
+			}
+			return m_slots[tail & (Capacity - 1)];
+		}
+
+		/* Hands the value in `producer_slot()` over to the consumer. */
+		void publish() noexcept {
+			m_tail.fetch_add(1, std::memory_order_release);
+			m_tail.notify_one();
+		}
+
+		/* The oldest value not yet released, once the producer has published one. */
+		[[nodiscard]] const T& front() noexcept {
+			const std::size_t head = m_head.load(std::memory_order_relaxed);
+			for (std::size_t tail = m_tail.load(std::memory_order_acquire); tail == head;
+			     tail = m_tail.load(std::memory_order_acquire)) {
+				m_tail.wait(tail, std::memory_order_acquire);
+			}
+			return m_slots[head & (Capacity - 1)];
+		}
+
+		/* Gives the slot of `front()` back to the producer. */
+		void release() noexcept {
+			m_head.fetch_add(1, std::memory_order_release);
+			m_head.notify_one();
+		}
+
+	private:
+		// The two sides each write their own index: keep them off each other's cache lines.
+		// (Not `std::hardware_destructive_interference_size`, which is not stable across
+		// compiler versions, and so is not to be used in a header.)
+		inline static constexpr const std::size_t cache_line_size = 64;
+
+		alignas(cache_line_size) std::atomic<std::size_t> m_head = 0;
+		alignas(cache_line_size) std::atomic<std::size_t> m_tail = 0;
+		std::array<T, Capacity> m_slots {};
+	};
+
+} // namespace a_c_compiler
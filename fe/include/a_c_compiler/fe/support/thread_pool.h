@@ -0,0 +1,184 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#pragma once
+
+#include <ztd/idk/assert.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace a_c_compiler {
+
+	/* The number of threads to use when the user asks for "as many as makes sense" (a requested
+	 * count of 0). Never less than 1. */
+	std::size_t default_thread_count(std::size_t requested_count = 0) noexcept;
+
+	/* A fixed-size pool of worker threads pulling tasks from a single shared queue. Tasks must
+	 * not throw. */
+	struct thread_pool {
+		explicit thread_pool(std::size_t thread_count = 0) noexcept;
+		thread_pool(const thread_pool&)            = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+		~thread_pool() noexcept;
+
+		void submit(std::function<void()> task) noexcept;
+		/* Blocks until every submitted task has finished running. */
+		void wait() noexcept;
+
+		[[nodiscard]] std::size_t thread_count() const noexcept {
+			return m_workers.size();
+		}
+
+	private:
+		void work() noexcept;
+
+		std::mutex m_mutex;
+		std::condition_variable m_task_available;
+		std::condition_variable m_tasks_finished;
+		std::deque<std::function<void()>> m_tasks;
+		std::size_t m_tasks_in_flight;
+		bool m_stopping;
+		std::vector<std::thread> m_workers;
+	};
+
+	/* Calls `body(index)` for every index in [0, count), spread over at most `thread_count`
+	 * threads (including the calling thread). Returns once every call has completed. */
+	template <typename Body>
+	void parallel_for(std::size_t count, std::size_t thread_count, Body&& body) noexcept {
+		thread_count = default_thread_count(thread_count);
+		if (thread_count > count) {
+			thread_count = count;
+		}
+		if (thread_count <= 1) {
+			for (std::size_t index = 0; index < count; ++index) {
+				body(index);
+			}
+			return;
+		}
+		std::atomic<std::size_t> next_index = 0;
+		const auto run                      = [&]() noexcept {
+			for (;;) {
+				std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+				if (index >= count) {
+					return;
+				}
+				body(index);
+			}
+		};
+		std::vector<std::jthread> helpers;
+		helpers.reserve(thread_count - 1);
+		for (std::size_t i = 1; i < thread_count; ++i) {
+			helpers.emplace_back(run);
+		}
+		run();
+	}
+
+	namespace detail {
+		/* The indices one thread of `work_stealing_for` has left to run, [begin, end), packed
+		 * into one word so that the owner and a thief can each claim from it with one
+		 * compare-and-swap. Each is on a cache line of its own, so the owner taking its next
+		 * index does not slow down the other threads taking theirs. */
+		struct alignas(64) stealable_range {
+			std::atomic<std::uint64_t> bounds = 0;
+
+			[[nodiscard]] static constexpr std::uint64_t pack(
+			     std::uint64_t begin, std::uint64_t end) noexcept {
+				return begin << 32 | end;
+			}
+
+			/* Takes the first index left, if there is one. */
+			[[nodiscard]] bool take_front(std::size_t& index) noexcept {
+				std::uint64_t packed = bounds.load(std::memory_order_relaxed);
+				for (;;) {
+					const std::uint64_t begin = packed >> 32;
+					const std::uint64_t end   = packed & 0xFFFFFFFFu;
+					if (begin >= end) {
+						return false;
+					}
+					if (bounds.compare_exchange_weak(packed, pack(begin + 1, end),
+					     std::memory_order_acq_rel, std::memory_order_relaxed)) {
+						index = static_cast<std::size_t>(begin);
+						return true;
+					}
+				}
+			}
+
+			/* Takes the back half of what is left (all of it, if only one index is), and makes
+			 * it what `thief` has left. */
+			[[nodiscard]] bool steal_into(stealable_range& thief) noexcept {
+				std::uint64_t packed = bounds.load(std::memory_order_relaxed);
+				for (;;) {
+					const std::uint64_t begin = packed >> 32;
+					const std::uint64_t end   = packed & 0xFFFFFFFFu;
+					if (begin >= end) {
+						return false;
+					}
+					const std::uint64_t middle = begin + (end - begin) / 2;
+					if (bounds.compare_exchange_weak(packed, pack(begin, middle),
+					     std::memory_order_acq_rel, std::memory_order_relaxed)) {
+						thief.bounds.store(pack(middle, end), std::memory_order_release);
+						return true;
+					}
+				}
+			}
+		};
+	} // namespace detail
+
+	/* Like `parallel_for`, but for work whose indices cost very different amounts. Each thread
+	 * starts with a contiguous share of the indices and runs them in order; a thread that runs
+	 * out steals the back half of what another has left, so one expensive index does not
+	 * leave the others waiting while the rest of its share sits behind it. */
+	template <typename Body>
+	void work_stealing_for(std::size_t count, std::size_t thread_count, Body&& body) noexcept {
+		ZTD_ASSERT_MESSAGE("too many indices to share out", count <= 0xFFFFFFFFu);
+		thread_count = std::min(default_thread_count(thread_count), count);
+		if (thread_count <= 1) {
+			for (std::size_t index = 0; index < count; ++index) {
+				body(index);
+			}
+			return;
+		}
+		std::vector<detail::stealable_range> ranges(thread_count);
+		for (std::size_t thread = 0; thread < thread_count; ++thread) {
+			ranges[thread].bounds.store(detail::stealable_range::pack(
+			     count * thread / thread_count, count * (thread + 1) / thread_count));
+		}
+		const auto run = [&](std::size_t thread) noexcept {
+			for (;;) {
+				std::size_t index = 0;
+				while (ranges[thread].take_front(index)) {
+					body(index);
+				}
+				bool stole = false;
+				for (std::size_t offset = 1; offset < thread_count && !stole; ++offset) {
+					detail::stealable_range& victim = ranges[(thread + offset) % thread_count];
+					stole = victim.steal_into(ranges[thread]);
+				}
+				if (!stole) {
+					// whatever is left is already claimed by a thread that will run it
+					return;
+				}
+			}
+		};
+		std::vector<std::jthread> helpers;
+		helpers.reserve(thread_count - 1);
+		for (std::size_t thread = 1; thread < thread_count; ++thread) {
+			helpers.emplace_back(run, thread);
+		}
+		run(0);
+	}
+
+} // namespace a_c_compiler
@@ -11,43 +11,54 @@
 #include <a_c_compiler/version.h>
 #include <ztd/idk/assert.hpp>
 
+#include <algorithm>
+#include <deque>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <cctype>
 #include <ostream>
+#include <unordered_map>
 
-/* Place lexed literals and identifiers in these vectors for the parser to
+/* Place lexed literals and identifiers in these tables for the parser to
  * access later. Leave numeric literals as strings becaues it is the parser's
- * job to figure out what type the literal should be parsed to. */
-static std::vector<std::string> lexed_numeric_literals;
-static std::vector<std::string> lexed_string_literals;
-static std::vector<std::string> lexed_ids;
+ * job to figure out what type the literal should be parsed to.
+ *
+ * A lexer can run on a thread of its own while the parser reads what it lexed earlier (see
+ * `lex_into`), so every use of the tables holds `spellings_mutex`. They are deques, so a
+ * spelling never moves once it is stored, and a view of it stays good after the lock is let
+ * go; the identifier map looks spellings up by view for the same reason. */
+static std::mutex spellings_mutex;
+static std::deque<std::string> lexed_numeric_literals;
+static std::deque<std::string> lexed_string_literals;
+/* every distinct identifier spelling, indexed by `identifier_id` */
+static std::deque<std::string> interned_identifiers;
+static std::unordered_map<std::string_view, std::uint32_t> interned_identifier_ids;
 
 namespace a_c_compiler {
 
-	/* Maps tokens to offsets into source files */
-	static std::vector<file_offset_info> token_source_info;
-
-	file_offset_info source_info_for_token(size_t tok_idx) {
-		return token_source_info[tok_idx];
-	}
-
-	void dump_tokens_into(token_vector const& toks, std::ostream& output_stream) noexcept {
-		size_t id_idx = 0, numlit_idx = 0, strlit_idx = 0;
+	void dump_tokens_into(token_vector const& toks, source_manager const& sources,
+	     std::ostream& output_stream) noexcept {
 		static constexpr size_t width = 15;
 		output_stream << std::setw(width) << "line:column"
 		              << " | token\n";
-		for (auto [t, foi] : toks) {
+		for (auto [t, location, value] : toks) {
+			presumed_location presumed = sources.presume(location);
 			std::stringstream ss;
-			ss << foi.lineno << ":" << foi.column;
+			ss << presumed.lineno << ":" << presumed.column;
 			output_stream << std::setw(width) << ss.str() << " | ";
 			switch (t) {
-
 #define CHAR_TOKEN(TOK, LIT)     \
 	case TOK:                   \
 		output_stream << #TOK; \
 		break;
 
+#define PUNCTUATOR_TOKEN(TOK, LIT, SPELLING) \
+	case TOK:                               \
+		output_stream << #TOK;             \
+		break;
+
 #define KEYWORD_TOKEN(TOK, LIT, KEYWORD) \
 	case TOK:                           \
 		output_stream << #TOK;         \
@@ -55,8 +66,17 @@ namespace a_c_compiler {
 
 #include <a_c_compiler/fe/lex/tokens.inl.h>
 #undef CHAR_TOKEN
+#undef PUNCTUATOR_TOKEN
 #undef KEYWORD_TOKEN
 
+			case tok_forward_slash:
+				output_stream << "tok_forward_slash";
+				break;
+
+			case tok_period:
+				output_stream << "tok_period";
+				break;
+
 			case tok_block_comment:
 				output_stream << "tok_block_comment";
 				break;
@@ -74,15 +94,15 @@ namespace a_c_compiler {
 				break;
 
 			case tok_id:
-				output_stream << "tok_id: " << lexed_id(id_idx++);
+				output_stream << "tok_id: " << identifier_spelling(identifier_id(value));
 				break;
 
 			case tok_num_literal:
-				output_stream << "tok_num_literal: " << lexed_numeric_literal(numlit_idx++);
+				output_stream << "tok_num_literal: " << lexed_numeric_literal(value);
 				break;
 
 			case tok_str_literal:
-				output_stream << "str_literal: " << lexed_string_literal(strlit_idx++);
+				output_stream << "str_literal: " << lexed_string_literal(value);
 				break;
 
 			case tok_pp_embed:
@@ -96,107 +116,200 @@ namespace a_c_compiler {
 		}
 	}
 
-	void dump_tokens(token_vector const& toks) noexcept {
-		dump_tokens_into(toks, std::cout);
+	void dump_tokens(token_vector const& toks, source_manager const& sources) noexcept {
+		dump_tokens_into(toks, sources, std::cout);
+	}
+
+	std::string_view token_spelling(token_id id) noexcept {
+		switch (id) {
+#define CHAR_TOKEN(TOK, LIT) \
+	case TOK:               \
+		return std::string_view(&(#LIT)[1], 1);
+#define PUNCTUATOR_TOKEN(TOK, LIT, SPELLING) \
+	case TOK:                               \
+		return SPELLING;
+#define KEYWORD_TOKEN(TOK, LIT, KEYWORD) \
+	case TOK:                           \
+		return #KEYWORD;
+#include <a_c_compiler/fe/lex/tokens.inl.h>
+#undef CHAR_TOKEN
+#undef PUNCTUATOR_TOKEN
+#undef KEYWORD_TOKEN
+		case tok_forward_slash:
+			return "/";
+		case tok_period:
+			return ".";
+		case tok_id:
+			return "identifier";
+		case tok_num_literal:
+			return "numeric literal";
+		case tok_str_literal:
+			return "string literal";
+		case tok_line_comment:
+		case tok_block_comment:
+			return "comment";
+		case tok_newline:
+			return "newline";
+		case tok_tab:
+			return "tab";
+		case tok_pp_embed:
+			return "#embed";
+		case tok_end_of_input:
+			return "end of input";
+		}
+		return "token";
 	}
 
 	std::string_view lexed_numeric_literal(size_t index) noexcept {
-		return lexed_numeric_literals[index].data();
+		std::unique_lock lock(spellings_mutex);
+		return lexed_numeric_literals[index];
+	}
+	identifier_id intern_identifier(std::string_view spelling) noexcept {
+		std::unique_lock lock(spellings_mutex);
+		auto id_it = interned_identifier_ids.find(spelling);
+		if (id_it != interned_identifier_ids.end()) {
+			return identifier_id(id_it->second);
+		}
+		const std::uint32_t index = static_cast<std::uint32_t>(interned_identifiers.size());
+		const std::string& stored = interned_identifiers.emplace_back(spelling);
+		interned_identifier_ids.emplace(stored, index);
+		return identifier_id(index);
 	}
-	std::string_view lexed_id(size_t index) noexcept {
-		return lexed_ids[index].data();
+	std::string_view identifier_spelling(identifier_id id) noexcept {
+		std::unique_lock lock(spellings_mutex);
+		return interned_identifiers[id.index()];
 	}
 	std::string_view lexed_string_literal(size_t index) noexcept {
-		return lexed_string_literals[index].data();
+		std::unique_lock lock(spellings_mutex);
+		return lexed_string_literals[index];
+	}
+	std::uint32_t add_lexed_numeric_literal(std::string_view spelling) noexcept {
+		std::unique_lock lock(spellings_mutex);
+		lexed_numeric_literals.emplace_back(spelling);
+		return static_cast<std::uint32_t>(lexed_numeric_literals.size() - 1);
+	}
+	std::uint32_t add_lexed_string_literal(std::string_view spelling) noexcept {
+		std::unique_lock lock(spellings_mutex);
+		lexed_string_literals.emplace_back(spelling);
+		return static_cast<std::uint32_t>(lexed_string_literals.size() - 1);
 	}
 
-	token_vector lex(fs::path const& source_file, const global_options& global_opts,
+	void report_lex_errors(std::span<const lex_error> errors, source_manager const& sources,
 	     diagnostic_handles& diag_handles) noexcept {
-		token_vector toks;
-		toks.reserve(2048);
+		for (const lex_error& error : errors) {
+			const presumed_location presumed = sources.presume(error.location);
+			diag_handles.error_handle() << presumed.file_name << " (" << presumed.lineno << ", "
+			                            << presumed.column << ")\n❌ " << error.message << "\n";
+		}
+	}
 
-		FILE* fp =
-#if ZTD_IS_ON(ZTD_LIBVCXX)
-		     _wfopen(source_file.c_str(), L"r")
-#else
-		     std::fopen(source_file.c_str(), "r")
-#endif
-		     ;
-		ZTD_ASSERT_MESSAGE("Couldn't open file", fp);
-		char c;
-		size_t lineno = 0, column = 0;
-
-		/* Get next character while tracking source location info */
-		auto getc = [&]() {
-			c = fgetc(fp);
-			if (c == '\n') {
-				lineno++;
-				column = 0;
-			}
-			else {
-				column++;
-			}
-			return c;
+	/* Lexes `source_file` from the offset `begin` until a token ends at `end` or later, handing
+	 * each token to `emit` as soon as it is made, and each token it cannot finish to `fail`.
+	 * Returns where the last token ended. */
+	template <typename Emit, typename Fail>
+	std::size_t lex_tokens(source_manager const& sources, file_id source_file, std::size_t begin,
+	     std::size_t end, Emit&& emit, Fail&& fail) {
+		const std::string_view source = sources.buffer(source_file);
+		/* Every offset into this file maps onto a location by adding it to the file's first
+		 * location. */
+		const source_location file_start = sources.location(source_file, 0);
+
+		std::size_t position = begin;
+		const auto at        = [&](std::size_t offset) {
+			return offset < source.size() ? source[offset] : '\0';
+		};
+		const auto location_at = [&](std::size_t offset) {
+			return file_start.advanced_by(static_cast<std::uint32_t>(offset));
 		};
 
-		c = std::fgetc(fp);
-		while (c != EOF) {
+		while (position < end) {
+			const std::size_t token_start = position;
+			const char c                  = source[position];
+			/* Punctuators spelled with more than one character: the longest one that fits */
+			if (std::ispunct(static_cast<unsigned char>(c))) {
+				const std::string_view rest = source.substr(position);
+				if (false) { }
+#define PUNCTUATOR_TOKEN(TOK, INTVAL, SPELLING)          \
+	else if (rest.starts_with(SPELLING)) {              \
+		position += sizeof(SPELLING) - 1;              \
+		emit(token { TOK, location_at(token_start) }); \
+		continue;                                      \
+	}
+#include <a_c_compiler/fe/lex/tokens.inl.h>
+#undef PUNCTUATOR_TOKEN
+			}
 			switch (c) {
 			case ' ':
-				break;
-
 			case '\t':
-				// toks.push_back({ tok_tab, { lineno, column } });
-				break;
+			case '\r':
+			case '\f':
+			case '\v':
+				++position;
+				continue;
 
 				/* Handle comments */
-			case '/': {
-				file_offset_info foi { lineno, column };
-				getc();
+			case '/':
 				/* Line comment */
-				if (c == '/') {
-					while (c != '\n') {
-						getc();
-					}
-					toks.push_back({ tok_line_comment, foi });
-					break;
+				if (at(position + 1) == '/') {
+					// the comment takes its terminating newline with it
+					position = source.find('\n', position);
+					position
+					     = position == std::string_view::npos ? source.size() : position + 1;
+					emit(token { tok_line_comment, location_at(token_start) });
 				}
-
 				/* Block comment */
-				else if (c == '*') {
-					while (true) {
-						if (getc() == '*' && getc() == '/') {
-							toks.push_back({ tok_block_comment, foi });
-							break;
-						}
-						ZTD_ASSERT_MESSAGE("unterminated block comment", c != EOF);
+				else if (at(position + 1) == '*') {
+					position = source.find("*/", position + 2);
+					if (position == std::string_view::npos) {
+						// the comment takes the rest of the file with it
+						fail(lex_error {
+						     location_at(token_start), "unterminated block comment" });
+						position = source.size();
+					}
+					else {
+						position += 2;
 					}
-					break;
+					emit(token { tok_block_comment, location_at(token_start) });
 				}
 				else {
-					toks.push_back({ tok_forward_slash, foi });
+					++position;
+					emit(token { tok_forward_slash, location_at(token_start) });
 				}
-			}
+				continue;
 
 			/* Char-like tokens */
 #define CHAR_TOKEN(TOK, LIT) case LIT:
 #include <a_c_compiler/fe/lex/tokens.inl.h>
-				toks.push_back({ (token_id)c, { lineno, column } });
-				break;
+				++position;
+				emit(token { (token_id)c, location_at(token_start) });
+				continue;
 #undef CHAR_TOKEN
 
 			case '\n':
-				toks.push_back({ tok_newline, { lineno, column } });
-				break;
+				++position;
+				emit(token { tok_newline, location_at(token_start) });
+				continue;
 
 			case '"': {
-				toks.push_back({ tok_str_literal, { lineno, column } });
-				std::string lit = "";
-				while (getc() != '"') {
-					lit += c;
+				++position;
+				while (position < source.size() && source[position] != '"'
+				     && source[position] != '\n') {
+					position += source[position] == '\\' ? 2 : 1;
+				}
+				position = std::min(position, source.size());
+				const std::uint32_t literal = add_lexed_string_literal(
+				     source.substr(token_start + 1, position - token_start - 1));
+				if (at(position) == '"') {
+					++position;
+				}
+				else {
+					// the literal ends with its line, as though it were closed there
+					fail(lex_error {
+					     location_at(token_start), "unterminated string literal" });
 				}
-				lexed_string_literals.push_back(lit);
-			} break;
+				emit(token { tok_str_literal, location_at(token_start), literal });
+				continue;
+			}
 
 				/* Numeric literals */
 			case '0':
@@ -210,53 +323,107 @@ namespace a_c_compiler {
 			case '8':
 			case '9':
 			case '.': {
-				file_offset_info foi { lineno, column };
-				std::string lit = "";
-				lit += c;
-				while (std::isdigit(getc()) || c == '.') {
-					lit += c;
+				if (c == '.' && !std::isdigit(static_cast<unsigned char>(at(position + 1)))) {
+					// member access, not the start of a number like `.5`
+					++position;
+					emit(token { tok_period, location_at(token_start) });
+					continue;
+				}
+				++position;
+				while (std::isdigit(static_cast<unsigned char>(at(position)))
+				     || at(position) == '.') {
+					++position;
 				}
 
 				/* numeric literal type suffixes */
-				if (c == 'f' or c == 'd') {
-					lit += c;
-				}
-				else {
-					ungetc(c, fp);
+				if (at(position) == 'f' or at(position) == 'd') {
+					++position;
 				}
 
-				lexed_numeric_literals.push_back(lit);
-				toks.push_back({ tok_num_literal, foi });
-				break;
+				const std::uint32_t literal = add_lexed_numeric_literal(
+				     source.substr(token_start, position - token_start));
+				emit(token { tok_num_literal, location_at(token_start), literal });
+				continue;
 			}
 			}
 
 			/* Identifier */
-			if (std::isalpha(c) or c == '_') {
-				file_offset_info foi { lineno, column };
-				std::string lit = "";
-				lit += c;
-
-				while (std::isalnum(c = fgetc(fp)) or c == '_') {
-					lit += c;
+			if (std::isalpha(static_cast<unsigned char>(c)) or c == '_') {
+				++position;
+				while (std::isalnum(static_cast<unsigned char>(at(position)))
+				     or at(position) == '_') {
+					++position;
 				}
-				std::ungetc(c, fp);
+				const std::string_view lit = source.substr(token_start, position - token_start);
+				const source_location foi  = location_at(token_start);
 				if (false) { }
 				// if it matches a keyword's spelling, it's a keyword
 #define KEYWORD_TOKEN(TOK, INTVAL, KEYWORD) \
 	else if (lit == #KEYWORD) {            \
-		toks.push_back({ TOK, foi });     \
+		emit(token { TOK, foi });         \
 	}
 #include <a_c_compiler/fe/lex/tokens.inl.h>
 #undef KEYWORD_TOKEN
 				else {
-					lexed_ids.push_back(lit);
-					toks.push_back({ tok_id, foi });
+					emit(token { tok_id, foi, intern_identifier(lit).index() });
 				}
+				continue;
 			}
-			getc();
+
+			/* Anything else is not something we know how to lex yet: skip it. */
+			++position;
+		}
+		return position;
+	}
+
+	token_vector lex(source_manager const& sources, file_id source_file, const global_options&,
+	     diagnostic_handles& diag_handles) noexcept {
+		token_vector toks;
+		toks.reserve(2048);
+		std::vector<lex_error> errors;
+		lex_tokens(
+		     sources, source_file, 0, sources.buffer(source_file).size(),
+		     [&toks](const token& tok) { toks.push_back(tok); },
+		     [&errors](const lex_error& error) { errors.push_back(error); });
+		report_lex_errors(errors, sources, diag_handles);
+		return toks;
+	}
+
+	std::optional<token_vector> lex_range(source_manager const& sources, file_id source_file,
+	     std::uint32_t begin, std::uint32_t end, const global_options&,
+	     diagnostic_handles& diag_handles) noexcept {
+		token_vector toks;
+		std::vector<lex_error> errors;
+		const std::size_t lexed_end = lex_tokens(
+		     sources, source_file, begin, end, [&toks](const token& tok) { toks.push_back(tok); },
+		     [&errors](const lex_error& error) { errors.push_back(error); });
+		if (lexed_end != end) {
+			return std::nullopt;
 		}
+		report_lex_errors(errors, sources, diag_handles);
 		return toks;
 	}
 
+	std::vector<lex_error> lex_into(
+	     source_manager const& sources, file_id source_file, token_queue& queue) noexcept {
+		std::vector<lex_error> errors;
+		token_batch* batch = &queue.producer_slot();
+		batch->size        = 0;
+		lex_tokens(
+		     sources, source_file, 0, sources.buffer(source_file).size(),
+		     [&](const token& tok) {
+			     batch->tokens[batch->size++] = tok;
+			     if (batch->size == token_batch::capacity) {
+				     batch->is_last = false;
+				     queue.publish();
+				     batch       = &queue.producer_slot();
+				     batch->size = 0;
+			     }
+		     },
+		     [&errors](const lex_error& error) { errors.push_back(error); });
+		batch->is_last = true;
+		queue.publish();
+		return errors;
+	}
+
 } // namespace a_c_compiler
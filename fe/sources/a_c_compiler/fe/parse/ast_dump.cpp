@@ -0,0 +1,423 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/parse/ast_dump.h>
+#include <a_c_compiler/fe/parse/ast_visitor.h>
+#include <a_c_compiler/fe/support/buffered_writer.h>
+
+#include <utility>
+
+namespace a_c_compiler {
+
+	namespace {
+		std::string_view type_category_name(type_category category) noexcept {
+			switch (category) {
+			case type_category::tc_none:
+				return "none";
+			case type_category::tc_void:
+				return "void";
+			case type_category::tc_bool:
+				return "bool";
+			case type_category::tc_char:
+				return "char";
+			case type_category::tc_short:
+				return "short";
+			case type_category::tc_int:
+				return "int";
+			case type_category::tc_long:
+				return "long";
+			case type_category::tc_longlong:
+				return "long long";
+			case type_category::tc__BitInt:
+				return "_BitInt";
+			case type_category::tc_float:
+				return "float";
+			case type_category::tc_double:
+				return "double";
+			case type_category::tc_longdouble:
+				return "long double";
+			case type_category::tc_longlongdouble:
+				return "long long double";
+			case type_category::tc_union:
+				return "union";
+			case type_category::tc_struct:
+				return "struct";
+			case type_category::tc_enum:
+				return "enum";
+			case type_category::tc_function:
+				return "function";
+			case type_category::tc_array:
+				return "array";
+			case type_category::tc_variable_length_array:
+				return "variable length array";
+			case type_category::tc_data_pointer:
+				return "pointer";
+			case type_category::tc_function_pointer:
+				return "function pointer";
+			case type_category::tc_nullptr:
+				return "nullptr_t";
+			case type_category::tc_auto:
+				return "auto";
+			case type_category::tc__Padding:
+				return "_Padding";
+			case type_category::tc_array_span:
+				return "array span";
+			}
+			return "";
+		}
+
+		/* One node per line, as its kind and then `key=value` for each of its fields, indented
+		 * two spaces for each of its parents. */
+		struct text_ast_format {
+			buffered_writer& out;
+			std::size_t depth = 0;
+
+			void begin_node(std::string_view kind) noexcept {
+				out.write_repeated(' ', depth * 2);
+				out.write(kind);
+			}
+
+			void field(std::string_view key, std::string_view value) noexcept {
+				out.write(' ');
+				out.write(key);
+				out.write('=');
+				out.write(value);
+			}
+
+			void field(std::string_view key, std::size_t value) noexcept {
+				out.write(' ');
+				out.write(key);
+				out.write('=');
+				out.write_number(value);
+			}
+
+			/* Text as it was spelled in the source, quoted. */
+			void quoted_field(std::string_view key, std::string_view value) noexcept {
+				out.write(' ');
+				out.write(key);
+				out.write("=\"");
+				out.write(value);
+				out.write('"');
+			}
+
+			void end_fields(bool has_children) noexcept {
+				out.write('\n');
+				depth += has_children ? 1 : 0;
+			}
+
+			void end_node(bool has_children) noexcept {
+				depth -= has_children ? 1 : 0;
+			}
+
+			void end_document() noexcept {
+			}
+		};
+
+		/* Each node is an object with its kind and fields as members, and its children (if it
+		 * has any) in a "children" array. */
+		struct json_ast_format {
+			buffered_writer& out;
+			/* whether a node was just closed, so the next one needs a comma before it */
+			bool after_sibling = false;
+
+			void begin_node(std::string_view kind) noexcept {
+				if (after_sibling) {
+					out.write(',');
+				}
+				out.write("{\"kind\":\"");
+				out.write(kind);
+				out.write('"');
+			}
+
+			void field(std::string_view key, std::string_view value) noexcept {
+				quoted_field(key, value);
+			}
+
+			void field(std::string_view key, std::size_t value) noexcept {
+				write_key(key);
+				out.write_number(value);
+			}
+
+			void quoted_field(std::string_view key, std::string_view value) noexcept {
+				write_key(key);
+				out.write('"');
+				for (const char c : value) {
+					switch (c) {
+					case '"':
+						out.write("\\\"");
+						break;
+					case '\\':
+						out.write("\\\\");
+						break;
+					default:
+						if (static_cast<unsigned char>(c) < 0x20) {
+							static constexpr const std::string_view hex_digits
+							     = "0123456789abcdef";
+							out.write("\\u00");
+							out.write(hex_digits[static_cast<unsigned char>(c) >> 4]);
+							out.write(hex_digits[static_cast<unsigned char>(c) & 0xF]);
+						}
+						else {
+							out.write(c);
+						}
+						break;
+					}
+				}
+				out.write('"');
+			}
+
+			void end_fields(bool has_children) noexcept {
+				if (has_children) {
+					out.write(",\"children\":[");
+					after_sibling = false;
+				}
+				else {
+					out.write('}');
+					after_sibling = true;
+				}
+			}
+
+			void end_node(bool has_children) noexcept {
+				if (has_children) {
+					out.write("]}");
+					after_sibling = true;
+				}
+			}
+
+			void end_document() noexcept {
+				out.write('\n');
+			}
+
+		private:
+			void write_key(std::string_view key) noexcept {
+				out.write(",\"");
+				out.write(key);
+				out.write("\":");
+			}
+		};
+
+		template <typename Format>
+		struct ast_dumper : ast_visitor<ast_dumper<Format>> {
+			const ast_module& mod;
+			Format format;
+
+			ast_dumper(const ast_module& mod, Format format) noexcept
+			: mod(mod), format(std::move(format)) {
+			}
+
+			bool enter_node(const ast_node_table& nodes, ast_node_id node) {
+				format.begin_node(ast_node_kind_name(nodes.kind(node)));
+				return end_fields(nodes, node);
+			}
+
+			void leave_node(const ast_node_table& nodes, ast_node_id node) {
+				format.end_node(nodes.first_child(node).is_valid());
+			}
+
+			bool enter_function_definition(const ast_node_table& nodes, ast_node_id node,
+			     const function_definition& data) {
+				format.begin_node("function_definition");
+				write_function_declaration(data.declaration);
+				format.field("body_token_count", data.body_tokens.size());
+				if (!data.body.is_valid()) {
+					format.field("body", "skipped");
+				}
+				return end_fields(nodes, node);
+			}
+
+			bool enter_function_declaration(const ast_node_table& nodes, ast_node_id node,
+			     const function_declaration& data) {
+				format.begin_node("function_declaration");
+				write_function_declaration(data);
+				return end_fields(nodes, node);
+			}
+
+			bool enter_declaration(
+			     const ast_node_table& nodes, ast_node_id node, const declaration& data) {
+				format.begin_node("declaration");
+				write_name(data.name);
+				write_type(data.t);
+				write_storage_classes(data.storage_classes);
+				return end_fields(nodes, node);
+			}
+
+			bool enter_parameter_declaration(const ast_node_table& nodes, ast_node_id node,
+			     const parameter_declaration& data) {
+				format.begin_node("parameter_declaration");
+				write_name(data.name);
+				write_type(data.t);
+				return end_fields(nodes, node);
+			}
+
+			bool enter_struct_declaration(
+			     const ast_node_table& nodes, ast_node_id node, const struct_declaration& data) {
+				format.begin_node("struct_declaration");
+				write_name(data.name);
+				write_type(data.t);
+				format.field("alignment", data.alignment);
+				return end_fields(nodes, node);
+			}
+
+			bool enter_member_declaration(
+			     const ast_node_table& nodes, ast_node_id node, const member_declaration& data) {
+				format.begin_node("member_declaration");
+				write_name(data.name);
+				write_type(data.t);
+				format.field("alignment", data.alignment);
+				if (data.bit_field_size != 0) {
+					format.field("bit_field_size", data.bit_field_size);
+					format.field("bit_field_position", data.bit_field_position);
+				}
+				return end_fields(nodes, node);
+			}
+
+			bool enter_attribute(
+			     const ast_node_table& nodes, ast_node_id node, const attribute& data) {
+				format.begin_node("attribute");
+				format.field("token_count", data.tokens.size());
+				return end_fields(nodes, node);
+			}
+
+			bool enter_statement(
+			     const ast_node_table& nodes, ast_node_id node, const statement& data) {
+				format.begin_node("statement");
+				format.field("token_count", data.tokens.size());
+				return end_fields(nodes, node);
+			}
+
+			bool enter_expression(
+			     const ast_node_table& nodes, ast_node_id node, const expression& data) {
+				format.begin_node("expression");
+				format.field("op", expression_operator_name(data.op));
+				if (mod.source && data.token_index < mod.source->tokens.size()) {
+					const token& tok = mod.source->tokens[data.token_index];
+					switch (data.op) {
+					case expression_operator::identifier:
+						format.field("name", identifier_spelling(tok.identifier()));
+						break;
+					case expression_operator::numeric_literal:
+						format.field("value", lexed_numeric_literal(tok.value));
+						break;
+					case expression_operator::string_literal:
+						format.quoted_field("value", lexed_string_literal(tok.value));
+						break;
+					case expression_operator::constant:
+						format.field("value",
+						     tok.id == tok_keyword_true       ? "true"
+						          : tok.id == tok_keyword_false ? "false"
+						                                        : "nullptr");
+						break;
+					default:
+						break;
+					}
+				}
+				switch (data.op) {
+				case expression_operator::cast:
+				case expression_operator::compound_literal:
+				case expression_operator::sizeof_type:
+				case expression_operator::alignof_type:
+					write_type(data.t);
+					break;
+				default:
+					break;
+				}
+				return end_fields(nodes, node);
+			}
+
+		private:
+			bool end_fields(const ast_node_table& nodes, ast_node_id node) {
+				format.end_fields(nodes.first_child(node).is_valid());
+				return true;
+			}
+
+			void write_name(identifier_id name) {
+				if (name.is_valid()) {
+					format.field("name", identifier_spelling(name));
+				}
+			}
+
+			void write_type(type t) {
+				format.field("type", static_cast<std::size_t>(t.index()));
+				if (t.index() < mod.types.size()) {
+					const type_data& t_data = mod.types.data(t);
+					format.field("type_category", type_category_name(t_data.category));
+					write_qualifiers(t_data.qualifiers);
+				}
+			}
+
+			void write_qualifiers(qualifier qualifiers) {
+				static constexpr const std::pair<qualifier, std::string_view> names[] = {
+					{ qualifier::q_const, "const" },
+					{ qualifier::q_volatile, "volatile" },
+					{ qualifier::q_restrict, "restrict" },
+					{ qualifier::q__Atomic, "_Atomic" },
+				};
+				for (const auto& [qualified, name] : names) {
+					if (static_cast<unsigned>(qualifiers) & static_cast<unsigned>(qualified)) {
+						format.field(name, "true");
+					}
+				}
+			}
+
+			void write_function_declaration(const function_declaration& data) {
+				write_name(data.name);
+				write_type(data.t);
+				if (data.funcspecs & funcspec_inline) {
+					format.field("inline", "true");
+				}
+				if (data.funcspecs & funcspec__Noreturn) {
+					format.field("_Noreturn", "true");
+				}
+				write_storage_classes(data.storage_classes);
+			}
+
+			void write_storage_classes(unsigned short storage_classes) {
+				static constexpr const std::pair<storage_class_specifier, std::string_view>
+				     spellings[] = { { scs_static, "static" }, { scs_extern, "extern" },
+					     { scs_constexpr, "constexpr" }, { scs_register, "register" },
+					     { scs_thread_local, "thread_local" }, { scs_typedef, "typedef" },
+					     { scs_auto, "auto" } };
+				for (const auto& [specifier, spelling] : spellings) {
+					if (storage_classes & specifier) {
+						format.field(spelling, "true");
+					}
+				}
+			}
+		};
+
+		template <typename Format>
+		void dump_with(const ast_module& mod, Format format) noexcept {
+			ast_dumper<Format> dumper(mod, format);
+			dumper.walk(mod.nodes, mod.root());
+			dumper.format.end_document();
+		}
+	} // namespace
+
+	bool dump_ast_into(
+	     const ast_module& mod, std::FILE* output, ast_dump_format format) noexcept {
+		buffered_writer out(output);
+		if (mod.nodes.size() == 0) {
+			return true;
+		}
+		switch (format) {
+		case ast_dump_format::text:
+			dump_with(mod, text_ast_format { out });
+			break;
+		case ast_dump_format::json:
+			dump_with(mod, json_ast_format { out });
+			break;
+		}
+		out.flush();
+		return out.good();
+	}
+
+	void ast_module::dump() const noexcept {
+		dump_ast_into(*this, stdout);
+		std::fflush(stdout);
+	}
+
+} // namespace a_c_compiler
@@ -0,0 +1,958 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/parse/ast_image.h>
+#include <a_c_compiler/fe/parse/ast_visitor.h>
+#include <a_c_compiler/fe/source/file_prefetcher.h>
+#include <a_c_compiler/fe/support/buffered_writer.h>
+
+#include <a_c_compiler/version.h>
+#include <ztd/idk/assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if ZTD_IS_OFF(ZTD_PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace a_c_compiler {
+
+	namespace {
+		inline constexpr const std::array<char, 8> image_magic
+		     = { 'a', 'c', 'c', '-', 'a', 's', 't', '\n' };
+		inline constexpr const std::uint32_t image_format_version = 4;
+		/* written as it is in memory, so an image from a machine of the other byte order does
+		 * not read back the same */
+		inline constexpr const std::uint32_t byte_order_mark = 0x01020304u;
+		inline constexpr const std::uint32_t no_index        = 0xFFFFFFFFu;
+		/* every section starts on a multiple of this, so that it could be read in place */
+		inline constexpr const std::size_t section_alignment = 16;
+
+		/* What an image holds, in the order it holds it after the header. */
+		enum image_section : std::size_t {
+			/* the text of every spelling, one after the other */
+			section_strings,
+			/* one `string_span` per identifier */
+			section_identifiers,
+			/* one `string_span` per literal token */
+			section_numeric_literals,
+			section_string_literals,
+			/* the path of the source file, as text */
+			section_source_path,
+			/* one `image_token` per token of the module */
+			section_tokens,
+			/* one index per token, as in `token_source::matching_brackets` */
+			section_matching_brackets,
+			/* one `image_type` per type, and the sub-types all of them list */
+			section_types,
+			section_sub_types,
+			/* one `image_node` per node, each declaration's together, in walking order */
+			section_nodes,
+			/* the side tables of the nodes, as they are laid out in memory */
+#define AST_NODE_WITH_DATA(NAME, TABLE) section_##TABLE,
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+			/* one `image_declaration` per child of the root */
+			section_top_level_declarations,
+			/* one `image_symbol` per name declared at file scope, in the order they were */
+			section_symbols,
+			section_count
+		};
+
+		struct string_span {
+			std::uint32_t offset;
+			std::uint32_t size;
+		};
+
+		struct image_token {
+			std::int32_t id;
+			/* how far into the source file it is, or `no_index` */
+			std::uint32_t offset;
+			/* for an identifier or a literal, the index of its spelling in the image */
+			std::uint32_t value;
+		};
+
+		struct image_type {
+			std::uint8_t modifier;
+			std::uint8_t category;
+			std::uint8_t qualifiers;
+			std::uint8_t alignment_log2;
+			std::uint32_t extent;
+			std::uint32_t sub_types_begin;
+			std::uint32_t sub_type_count;
+		};
+
+		/* Links are image node indices. A node's payload is its index in the side table for its
+		 * kind, whose entries refer to identifiers by their index in the image. */
+		struct image_node {
+			std::uint32_t kind;
+			std::uint32_t first_child;
+			std::uint32_t next_sibling;
+			std::uint32_t payload;
+		};
+
+		struct image_declaration {
+			std::uint32_t node_begin;
+			std::uint32_t node_end;
+			/* the tokens the declaration's nodes refer to, between them */
+			std::uint32_t token_begin;
+			std::uint32_t token_end;
+		};
+
+		struct image_symbol {
+			std::uint32_t name;
+			std::uint8_t name_space;
+			std::uint8_t kind;
+			std::uint16_t padding;
+			std::uint32_t t;
+			/* the index of the declaration that declares it, or `no_index` */
+			std::uint32_t declaration;
+		};
+
+		struct section_extent {
+			std::uint64_t offset;
+			std::uint64_t size;
+		};
+
+		struct image_header {
+			std::array<char, 8> magic;
+			std::uint32_t format_version;
+			std::uint32_t byte_order_mark;
+			std::uint32_t layout_signature;
+			std::uint32_t padding;
+			std::uint64_t source_size;
+			std::array<section_extent, section_count> sections;
+		};
+
+#define AST_NODE_WITH_DATA(NAME, TABLE) \
+	static_assert(std::is_trivially_copyable_v<NAME>, "node data is stored as it is in memory");
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+
+		/* Tells apart compilers that lay out node data differently, whose images the other
+		 * cannot read. */
+		constexpr std::uint32_t layout_signature() noexcept {
+			std::uint32_t signature = 0;
+			const auto mix          = [&](std::size_t value) noexcept {
+				signature = signature * 31 + static_cast<std::uint32_t>(value);
+			};
+#define AST_NODE_WITH_DATA(NAME, TABLE) \
+	mix(sizeof(NAME));                 \
+	mix(alignof(NAME));
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+			mix(sizeof(type));
+			mix(sizeof(identifier_id));
+			mix(sizeof(ast_node_id));
+			mix(sizeof(token_range));
+			return signature;
+		}
+
+		/* How big one record of each section is. */
+		constexpr std::size_t record_size(std::size_t section) noexcept {
+			switch (section) {
+			case section_strings:
+			case section_source_path:
+				return 1;
+			case section_identifiers:
+			case section_numeric_literals:
+			case section_string_literals:
+				return sizeof(string_span);
+			case section_tokens:
+				return sizeof(image_token);
+			case section_matching_brackets:
+			case section_sub_types:
+				return sizeof(std::uint32_t);
+			case section_types:
+				return sizeof(image_type);
+			case section_nodes:
+				return sizeof(image_node);
+#define AST_NODE_WITH_DATA(NAME, TABLE) \
+	case section_##TABLE:              \
+		return sizeof(NAME);
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+			case section_top_level_declarations:
+				return sizeof(image_declaration);
+			case section_symbols:
+				return sizeof(image_symbol);
+			default:
+				return 1;
+			}
+		}
+
+		constexpr std::uint64_t aligned(std::uint64_t offset) noexcept {
+			return (offset + section_alignment - 1) / section_alignment * section_alignment;
+		}
+
+		image_header read_header(const std::byte* bytes) noexcept {
+			image_header header;
+			std::memcpy(&header, bytes, sizeof(header));
+			return header;
+		}
+
+		/* Whether `bytes` are an image this compiler can read. */
+		std::error_code check_image(const std::byte* bytes, std::size_t size) noexcept {
+			if (size < sizeof(image_header)) {
+				return std::make_error_code(std::errc::invalid_argument);
+			}
+			const image_header header = read_header(bytes);
+			if (header.magic != image_magic) {
+				return std::make_error_code(std::errc::invalid_argument);
+			}
+			if (header.format_version != image_format_version
+			     || header.byte_order_mark != byte_order_mark
+			     || header.layout_signature != layout_signature()) {
+				return std::make_error_code(std::errc::not_supported);
+			}
+			for (std::size_t section = 0; section < section_count; ++section) {
+				const section_extent extent = header.sections[section];
+				if (extent.offset > size || extent.size > size - extent.offset
+				     || extent.offset % section_alignment != 0
+				     || extent.size % record_size(section) != 0) {
+					return std::make_error_code(std::errc::invalid_argument);
+				}
+			}
+			return {};
+		}
+
+		/* Lists the nodes of a tree in the order they are walked. */
+		struct preorder_layout : ast_visitor<preorder_layout> {
+			std::vector<ast_node_id>& order;
+
+			explicit preorder_layout(std::vector<ast_node_id>& order) noexcept : order(order) {
+			}
+
+			bool enter_node(const ast_node_table&, ast_node_id node) {
+				order.push_back(node);
+				return true;
+			}
+		};
+
+		/* The tokens a node's data refers to. */
+		token_range tokens_of(const function_definition& data) noexcept {
+			return data.body_tokens;
+		}
+
+		token_range tokens_of(const attribute& data) noexcept {
+			return data.tokens;
+		}
+
+		token_range tokens_of(const statement& data) noexcept {
+			return data.tokens;
+		}
+
+		token_range tokens_of(const expression& data) noexcept {
+			return token_range { data.token_index, data.token_index + 1 };
+		}
+
+		template <typename Data>
+		token_range tokens_of(const Data&) noexcept {
+			return token_range {};
+		}
+
+		/* Zeroes whatever padding `data` has, so that the same module always makes the same
+		 * image, where the compiler can tell where the padding is. */
+		template <typename Data>
+		void clear_padding([[maybe_unused]] Data& data) noexcept {
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_clear_padding)
+			__builtin_clear_padding(&data);
+#endif
+#endif
+		}
+
+		/* Builds every section of the image of a module in memory, to be written out in one go
+		 * once their sizes are known. */
+		struct image_builder {
+			const ast_module& mod;
+			std::string strings {};
+			std::vector<string_span> identifiers {};
+			std::vector<string_span> numeric_literals {};
+			std::vector<string_span> string_literals {};
+			std::string source_path {};
+			std::uint64_t source_size = 0;
+			std::vector<image_token> tokens {};
+			std::vector<std::uint32_t> matching_brackets {};
+			std::vector<image_type> types {};
+			std::vector<std::uint32_t> sub_types {};
+			std::vector<image_node> nodes {};
+#define AST_NODE_WITH_DATA(NAME, TABLE) std::vector<NAME> TABLE {};
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+			std::vector<image_declaration> top_level_declarations {};
+			std::vector<image_symbol> symbols {};
+			/* the image's index for each identifier of the module written so far */
+			std::unordered_map<std::uint32_t, std::uint32_t> identifier_indices {};
+			/* the image's index for each node of the module, and the declaration it is in */
+			std::vector<std::uint32_t> node_indices {};
+			std::vector<std::uint32_t> node_declarations {};
+
+			void add_tokens() noexcept {
+				if (!mod.source) {
+					return;
+				}
+				const token_source& source    = *mod.source;
+				const source_manager& sources = *source.sources;
+				// a module is parsed from one file: the one its first located token is in
+				file_id file;
+				for (const token& tok : source.tokens) {
+					if (tok.location.is_valid()) {
+						file = sources.file_of(tok.location);
+						break;
+					}
+				}
+				if (file.is_valid()) {
+					// absolute, so the image can be used from anywhere
+					std::error_code ec;
+					const fs::path absolute_path = fs::absolute(sources.path(file), ec);
+					source_path = (ec ? sources.path(file) : absolute_path).string();
+					source_size = sources.buffer(file).size();
+				}
+				tokens.reserve(source.tokens.size());
+				for (const token& tok : source.tokens) {
+					std::uint32_t value = tok.value;
+					switch (tok.id) {
+					case tok_id:
+						value = identifier(tok.identifier()).index();
+						break;
+					case tok_num_literal:
+						value = static_cast<std::uint32_t>(numeric_literals.size());
+						numeric_literals.push_back(
+						     add_string(lexed_numeric_literal(tok.value)));
+						break;
+					case tok_str_literal:
+						value = static_cast<std::uint32_t>(string_literals.size());
+						string_literals.push_back(
+						     add_string(lexed_string_literal(tok.value)));
+						break;
+					default:
+						break;
+					}
+					// tokens from anywhere else (such as another image) lose their location
+					const bool located = tok.location.is_valid() && file.is_valid()
+					     && sources.file_of(tok.location) == file;
+					tokens.push_back(image_token { tok.id,
+					     located ? sources.offset_of(tok.location) : no_index, value });
+				}
+				matching_brackets.assign(
+				     source.matching_brackets.begin(), source.matching_brackets.end());
+			}
+
+			void add_types() noexcept {
+				types.reserve(mod.types.size());
+				for (std::size_t index = 0; index < mod.types.size(); ++index) {
+					const type_data& data = mod.types.data(type(index));
+					// a structure or union that was never completed has no members to start at
+					const std::uint32_t sub_types_begin
+					     = data.sub_types_begin == type_table::incomplete_record
+					     ? no_index
+					     : static_cast<std::uint32_t>(sub_types.size());
+					types.push_back(image_type { static_cast<std::uint8_t>(data.modifier),
+					     static_cast<std::uint8_t>(data.category),
+					     static_cast<std::uint8_t>(data.qualifiers), data.alignment_log2,
+					     data.extent, sub_types_begin, data.sub_type_count });
+					for (const type& sub_type : mod.types.sub_types(type(index))) {
+						sub_types.push_back(static_cast<std::uint32_t>(sub_type.index()));
+					}
+				}
+			}
+
+			void add_nodes() noexcept {
+				const ast_node_table& table = mod.nodes;
+				node_indices.assign(table.size(), no_index);
+				node_declarations.assign(table.size(), no_index);
+				std::vector<ast_node_id> order;
+				order.reserve(table.size());
+				std::vector<image_declaration> extents;
+				for (ast_node_id declared = table.first_child(mod.root()); declared.is_valid();
+				     declared = table.next_sibling(declared)) {
+					const std::uint32_t node_begin = static_cast<std::uint32_t>(order.size());
+					preorder_layout(order).walk(table, declared);
+					for (std::uint32_t index = node_begin; index < order.size(); ++index) {
+						node_indices[order[index].index()]      = index;
+						node_declarations[order[index].index()] = extents.size();
+					}
+					extents.push_back(image_declaration {
+					     node_begin, static_cast<std::uint32_t>(order.size()), 0, 0 });
+				}
+
+				const auto image_node_index = [&](ast_node_id node) noexcept {
+					return node.is_valid() ? node_indices[node.index()] : no_index;
+				};
+				nodes.reserve(order.size());
+				for (image_declaration& extent : extents) {
+					token_range covered { no_index, 0 };
+					for (std::uint32_t index = extent.node_begin; index < extent.node_end;
+					     ++index) {
+						const ast_node_id node   = order[index];
+						const ast_node_kind kind = table.kind(node);
+						std::uint32_t payload    = 0;
+						switch (kind) {
+#define AST_NODE_WITH_DATA(NAME, TABLE)                                 \
+	case ast_node_kind::NAME: {                                        \
+		NAME data = table.NAME##_data(node);                          \
+		prepare(data, image_node_index);                              \
+		const token_range referred = tokens_of(data);                 \
+		if (!referred.empty()) {                                      \
+			covered.begin = std::min(covered.begin, referred.begin); \
+			covered.end   = std::max(covered.end, referred.end);     \
+		}                                                             \
+		payload = static_cast<std::uint32_t>(TABLE.size());           \
+		TABLE.push_back(data);                                        \
+		clear_padding(TABLE.back());                                  \
+	} break;
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+						default:
+							break;
+						}
+						// the declarations are the root's children, and are not linked here
+						nodes.push_back(image_node { static_cast<std::uint32_t>(kind),
+						     image_node_index(table.first_child(node)),
+						     index == extent.node_begin
+						          ? no_index
+						          : image_node_index(table.next_sibling(node)),
+						     payload });
+					}
+					if (covered.begin != no_index) {
+						extent.token_begin = covered.begin;
+						extent.token_end   = covered.end;
+					}
+				}
+				top_level_declarations = std::move(extents);
+			}
+
+			void add_symbols() noexcept {
+				// Functions are declared before their bodies are parsed, and names imported
+				// from another image before their declarations are read, so not every name
+				// knows its declaration: those are found by name instead.
+				std::unordered_map<std::uint32_t, std::uint32_t> declarations_by_name;
+				std::uint32_t declaration_index = 0;
+				for (ast_node_id declared = mod.nodes.first_child(mod.root());
+				     declared.is_valid();
+				     declared = mod.nodes.next_sibling(declared), ++declaration_index) {
+					identifier_id name;
+					if (mod.nodes.kind(declared) == ast_node_kind::function_definition) {
+						name = mod.nodes.function_definition_data(declared).declaration.name;
+					}
+					else if (mod.nodes.kind(declared) == ast_node_kind::declaration) {
+						name = mod.nodes.declaration_data(declared).name;
+					}
+					if (name.is_valid()) {
+						declarations_by_name[name.index()] = declaration_index;
+					}
+				}
+				for (const symbol& declared :
+				     mod.symbols.declared_since(symbol_table::checkpoint {})) {
+					std::uint32_t declaration = no_index;
+					if (declared.declaration.is_valid()
+					     && declared.declaration.index() < node_declarations.size()) {
+						declaration = node_declarations[declared.declaration.index()];
+					}
+					else if (declared.name_space == symbol_namespace::ordinary) {
+						auto declared_it = declarations_by_name.find(declared.name.index());
+						if (declared_it != declarations_by_name.end()) {
+							declaration = declared_it->second;
+						}
+					}
+					symbols.push_back(image_symbol { identifier(declared.name).index(),
+					     static_cast<std::uint8_t>(declared.name_space),
+					     static_cast<std::uint8_t>(declared.kind), 0,
+					     static_cast<std::uint32_t>(declared.t.index()), declaration });
+				}
+			}
+
+			std::expected<void, std::error_code> write(const fs::path& file) noexcept {
+				std::array<std::span<const std::byte>, section_count> contents {};
+				contents[section_strings]          = std::as_bytes(std::span(strings));
+				contents[section_identifiers]      = std::as_bytes(std::span(identifiers));
+				contents[section_numeric_literals] = std::as_bytes(std::span(numeric_literals));
+				contents[section_string_literals]  = std::as_bytes(std::span(string_literals));
+				contents[section_source_path]      = std::as_bytes(std::span(source_path));
+				contents[section_tokens]           = std::as_bytes(std::span(tokens));
+				contents[section_matching_brackets]
+				     = std::as_bytes(std::span(matching_brackets));
+				contents[section_types]     = std::as_bytes(std::span(types));
+				contents[section_sub_types] = std::as_bytes(std::span(sub_types));
+				contents[section_nodes]     = std::as_bytes(std::span(nodes));
+#define AST_NODE_WITH_DATA(NAME, TABLE) contents[section_##TABLE] = std::as_bytes(std::span(TABLE));
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+				contents[section_top_level_declarations]
+				     = std::as_bytes(std::span(top_level_declarations));
+				contents[section_symbols] = std::as_bytes(std::span(symbols));
+
+				image_header header {};
+				header.magic            = image_magic;
+				header.format_version   = image_format_version;
+				header.byte_order_mark  = byte_order_mark;
+				header.layout_signature = layout_signature();
+				header.source_size      = source_size;
+				std::uint64_t offset    = aligned(sizeof(header));
+				for (std::size_t section = 0; section < section_count; ++section) {
+					const std::size_t size   = contents[section].size();
+					header.sections[section] = section_extent { offset, size };
+					offset                   = aligned(offset + size);
+				}
+
+				std::FILE* output = std::fopen(file.string().c_str(), "wb");
+				if (output == nullptr) {
+					return std::unexpected(std::error_code(errno, std::generic_category()));
+				}
+				bool written = false;
+				{
+					buffered_writer out(output);
+					const auto write_bytes = [&](std::span<const std::byte> bytes) noexcept {
+						out.write(std::string_view(
+						     reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+					};
+					write_bytes(std::as_bytes(std::span(&header, 1)));
+					std::uint64_t written_size = sizeof(header);
+					for (std::size_t section = 0; section < section_count; ++section) {
+						const section_extent extent = header.sections[section];
+						out.write_repeated('\0', extent.offset - written_size);
+						write_bytes(contents[section]);
+						written_size = extent.offset + extent.size;
+					}
+					out.flush();
+					written = out.good();
+				}
+				if (std::fclose(output) != 0 || !written) {
+					return std::unexpected(std::make_error_code(std::errc::io_error));
+				}
+				return {};
+			}
+
+		private:
+			string_span add_string(std::string_view text) noexcept {
+				const string_span added { static_cast<std::uint32_t>(strings.size()),
+					static_cast<std::uint32_t>(text.size()) };
+				strings.append(text);
+				return added;
+			}
+
+			/* The image's id for a module's identifier. */
+			identifier_id identifier(identifier_id name) noexcept {
+				if (!name.is_valid()) {
+					return name;
+				}
+				auto [index_it, inserted] = identifier_indices.try_emplace(
+				     name.index(), static_cast<std::uint32_t>(identifiers.size()));
+				if (inserted) {
+					identifiers.push_back(add_string(identifier_spelling(name)));
+				}
+				return identifier_id(index_it->second);
+			}
+
+			/* Makes a node's data refer to identifiers and nodes the way the image does. Types
+			 * and tokens are written in the order the module has them, and are left as they
+			 * are. */
+			template <typename Data, typename NodeIndex>
+			void prepare(Data& data, NodeIndex&& image_node_index) noexcept {
+				if constexpr (std::is_same_v<Data, function_definition>) {
+					data.declaration.name = identifier(data.declaration.name);
+					data.body             = ast_node_id(image_node_index(data.body));
+				}
+				else if constexpr (requires { data.name; }) {
+					data.name = identifier(data.name);
+				}
+			}
+		};
+	} // namespace
+
+	ast_image::ast_image() noexcept : m_bytes(nullptr), m_size(0), m_mapped(false) {
+	}
+
+	ast_image::ast_image(ast_image&& other) noexcept
+	: m_bytes(std::exchange(other.m_bytes, nullptr))
+	, m_size(std::exchange(other.m_size, 0))
+	, m_mapped(std::exchange(other.m_mapped, false)) {
+	}
+
+	ast_image& ast_image::operator=(ast_image&& other) noexcept {
+		// what this held is released along with `other`
+		std::swap(m_bytes, other.m_bytes);
+		std::swap(m_size, other.m_size);
+		std::swap(m_mapped, other.m_mapped);
+		return *this;
+	}
+
+	ast_image::~ast_image() noexcept {
+		if (m_bytes == nullptr) {
+			return;
+		}
+#if ZTD_IS_OFF(ZTD_PLATFORM_WINDOWS)
+		if (m_mapped) {
+			::munmap(const_cast<std::byte*>(m_bytes), m_size);
+			return;
+		}
+#endif
+		delete[] m_bytes;
+	}
+
+	std::expected<ast_image, std::error_code> ast_image::open(const fs::path& file) noexcept {
+		ast_image image;
+#if ZTD_IS_OFF(ZTD_PLATFORM_WINDOWS)
+		const int descriptor = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+		if (descriptor < 0) {
+			return std::unexpected(std::error_code(errno, std::generic_category()));
+		}
+		struct stat file_status;
+		if (::fstat(descriptor, &file_status) != 0) {
+			const std::error_code error(errno, std::generic_category());
+			::close(descriptor);
+			return std::unexpected(error);
+		}
+		if (static_cast<std::size_t>(file_status.st_size) < sizeof(image_header)) {
+			::close(descriptor);
+			return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+		}
+		void* mapped = ::mmap(nullptr, static_cast<std::size_t>(file_status.st_size), PROT_READ,
+		     MAP_PRIVATE, descriptor, 0);
+		const std::error_code map_error(errno, std::generic_category());
+		// the mapping keeps the file open by itself
+		::close(descriptor);
+		if (mapped == MAP_FAILED) {
+			return std::unexpected(map_error);
+		}
+		image.m_bytes  = static_cast<const std::byte*>(mapped);
+		image.m_size   = static_cast<std::size_t>(file_status.st_size);
+		image.m_mapped = true;
+#else
+		// no mapping here: read the whole image in instead
+		file_read_result contents = read_file_contents(file);
+		if (!contents) {
+			return std::unexpected(contents.error());
+		}
+		std::byte* bytes = new std::byte[contents->size()];
+		std::memcpy(bytes, contents->data(), contents->size());
+		image.m_bytes = bytes;
+		image.m_size  = contents->size();
+#endif
+		if (const std::error_code error = check_image(image.m_bytes, image.m_size)) {
+			return std::unexpected(error);
+		}
+		return image;
+	}
+
+	std::size_t ast_image::declaration_count() const noexcept {
+		return record_count<image_declaration>(section_top_level_declarations);
+	}
+
+	std::string_view ast_image::source_path() const noexcept {
+		const std::span<const std::byte> path = section(section_source_path);
+		return std::string_view(reinterpret_cast<const char*>(path.data()), path.size());
+	}
+
+	std::size_t ast_image::source_size() const noexcept {
+		return static_cast<std::size_t>(read_header(m_bytes).source_size);
+	}
+
+	std::span<const std::byte> ast_image::section(std::size_t index) const noexcept {
+		section_extent extent;
+		std::memcpy(&extent,
+		     m_bytes + offsetof(image_header, sections) + index * sizeof(section_extent),
+		     sizeof(extent));
+		return std::span<const std::byte>(m_bytes + extent.offset, extent.size);
+	}
+
+	template <typename Record>
+	Record ast_image::record(std::size_t section, std::size_t index) const noexcept {
+		const std::span<const std::byte> records = this->section(section);
+		ZTD_ASSERT_MESSAGE("record is past the end of its section",
+		     index < records.size() / sizeof(Record));
+		Record read;
+		std::memcpy(&read, records.data() + index * sizeof(Record), sizeof(Record));
+		return read;
+	}
+
+	template <typename Record>
+	std::size_t ast_image::record_count(std::size_t section) const noexcept {
+		return this->section(section).size() / sizeof(Record);
+	}
+
+	std::string_view ast_image::string(std::size_t section, std::uint32_t index) const noexcept {
+		const string_span span               = record<string_span>(section, index);
+		const std::span<const std::byte> text = this->section(section_strings);
+		ZTD_ASSERT_MESSAGE("spelling is past the end of the image's text",
+		     span.offset <= text.size() && span.size <= text.size() - span.offset);
+		return std::string_view(
+		     reinterpret_cast<const char*>(text.data()) + span.offset, span.size);
+	}
+
+	std::expected<void, std::error_code> write_ast_image(
+	     const ast_module& mod, const fs::path& file) noexcept {
+		image_builder builder { mod };
+		builder.add_tokens();
+		builder.add_types();
+		builder.add_nodes();
+		builder.add_symbols();
+		return builder.write(file);
+	}
+
+	ast_image_import::ast_image_import(const ast_image& image, ast_module& mod,
+	     source_manager& sources, const global_options& global_opts,
+	     diagnostic_handles& diag_handles) noexcept
+	: m_image(&image)
+	, m_mod(&mod)
+	, m_sources(&sources)
+	, m_types { 0, {} }
+	, m_identifiers(image.record_count<string_span>(section_identifiers))
+	, m_loaded(image.declaration_count())
+	, m_declarations_by_name()
+	, m_looked_for_source(false)
+	, m_source_start() {
+		if (!mod.source) {
+			mod.source = std::make_unique<token_source>(
+			     token_source { {}, {}, &sources, &global_opts, &diag_handles });
+		}
+
+		// every type, so that the names can be declared with theirs: each one's sub-types come
+		// before it, so they have been interned by the time it is, except for the members of a
+		// structure or union, which are given to it once every type is in
+		const auto imported_sub_types = [&](const image_type& imported) noexcept {
+			std::vector<type> sub_types;
+			sub_types.reserve(imported.sub_type_count);
+			for (std::uint32_t sub_type = 0; sub_type < imported.sub_type_count; ++sub_type) {
+				sub_types.push_back(m_types(type(image.record<std::uint32_t>(
+				     section_sub_types, imported.sub_types_begin + sub_type))));
+			}
+			return sub_types;
+		};
+		const auto is_record = [](std::uint8_t category) noexcept {
+			return category == static_cast<std::uint8_t>(type_category::tc_struct)
+			     || category == static_cast<std::uint8_t>(type_category::tc_union);
+		};
+		const std::size_t type_count = image.record_count<image_type>(section_types);
+		m_types.moved.reserve(type_count);
+		for (std::size_t index = 0; index < type_count; ++index) {
+			const image_type imported = image.record<image_type>(section_types, index);
+			type_builder built { static_cast<type_modifier>(imported.modifier),
+				static_cast<type_category>(imported.category),
+				static_cast<qualifier>(imported.qualifiers), imported.alignment_log2,
+				imported.extent, {} };
+			if (!is_record(imported.category)) {
+				built.sub_types = imported_sub_types(imported);
+				m_types.moved.push_back(mod.types.intern(built));
+			}
+			else if (built.extent == index) {
+				m_types.moved.push_back(mod.types.declare_record(built.category));
+			}
+			else {
+				built.extent = static_cast<std::uint32_t>(m_types(type(built.extent)).index());
+				m_types.moved.push_back(mod.types.intern(built));
+			}
+		}
+		for (std::size_t index = 0; index < type_count; ++index) {
+			const image_type imported = image.record<image_type>(section_types, index);
+			if (is_record(imported.category) && imported.extent == index
+			     && imported.sub_types_begin != no_index) {
+				mod.types.complete_record(m_types(type(index)), imported_sub_types(imported));
+			}
+		}
+
+		// every file-scope name, in the order it was declared, so later ones hide earlier ones
+		// just as they did
+		const std::size_t symbol_count = image.record_count<image_symbol>(section_symbols);
+		for (std::size_t index = 0; index < symbol_count; ++index) {
+			const image_symbol imported = image.record<image_symbol>(section_symbols, index);
+			const identifier_id name    = identifier(imported.name);
+			const auto name_space       = static_cast<symbol_namespace>(imported.name_space);
+			mod.symbols.declare(name_space, name, static_cast<symbol_kind>(imported.kind),
+			     m_types(type(imported.t)));
+			if (name_space == symbol_namespace::ordinary && imported.declaration != no_index) {
+				m_declarations_by_name[name.index()] = imported.declaration;
+			}
+		}
+	}
+
+	ast_node_id ast_image_import::declaration(identifier_id name) noexcept {
+		auto declaration_it = m_declarations_by_name.find(name.index());
+		if (declaration_it == m_declarations_by_name.end()) {
+			return ast_node_id();
+		}
+		return load(declaration_it->second);
+	}
+
+	ast_node_id ast_image_import::load(std::size_t index) noexcept {
+		ZTD_ASSERT_MESSAGE("no such declaration in the image", index < m_loaded.size());
+		if (m_loaded[index].is_valid()) {
+			return m_loaded[index];
+		}
+		const image_declaration declared
+		     = m_image->record<image_declaration>(section_top_level_declarations, index);
+		ast_node_table& nodes = m_mod->nodes;
+		token_source& source  = *m_mod->source;
+
+		// the declaration's tokens go on the end of the module's
+		const std::uint32_t token_base = static_cast<std::uint32_t>(source.tokens.size());
+		const source_location start    = source_start();
+		for (std::uint32_t index = declared.token_begin; index < declared.token_end; ++index) {
+			const image_token imported = m_image->record<image_token>(section_tokens, index);
+			std::uint32_t value        = imported.value;
+			switch (imported.id) {
+			case tok_id:
+				value = identifier(imported.value).index();
+				break;
+			case tok_num_literal:
+				value = add_lexed_numeric_literal(
+				     m_image->string(section_numeric_literals, imported.value));
+				break;
+			case tok_str_literal:
+				value = add_lexed_string_literal(
+				     m_image->string(section_string_literals, imported.value));
+				break;
+			default:
+				break;
+			}
+			source.tokens.push_back(token { static_cast<token_id>(imported.id),
+			     start.is_valid() && imported.offset != no_index
+			          ? start.advanced_by(imported.offset)
+			          : source_location(),
+			     value });
+			const std::uint32_t matching
+			     = m_image->record<std::uint32_t>(section_matching_brackets, index);
+			source.matching_brackets.push_back(
+			     matching >= declared.token_begin && matching < declared.token_end
+			          ? matching - declared.token_begin + token_base
+			          : token_source::no_matching_bracket);
+		}
+
+		const std::uint32_t node_base = static_cast<std::uint32_t>(nodes.size());
+		const auto relocated_node     = [&](std::uint32_t node) noexcept {
+			return node == no_index ? no_index : node - declared.node_begin + node_base;
+		};
+		const auto relocated_token = [&](std::uint32_t token_index) noexcept {
+			return token_index - declared.token_begin + token_base;
+		};
+		const auto relocated_tokens = [&](token_range tokens) noexcept {
+			return tokens.empty()
+			     ? token_range {}
+			     : token_range { relocated_token(tokens.begin), relocated_token(tokens.end) };
+		};
+		const auto imported_name = [&](identifier_id name) noexcept {
+			return name.is_valid() ? identifier(name.index()) : name;
+		};
+		const auto relocate = [&]<typename Data>(Data& data) noexcept {
+			if constexpr (std::is_same_v<Data, function_definition>) {
+				data.declaration.t    = m_types(data.declaration.t);
+				data.declaration.name = imported_name(data.declaration.name);
+				data.body_tokens      = relocated_tokens(data.body_tokens);
+				data.body             = ast_node_id(relocated_node(data.body.index()));
+			}
+			else if constexpr (std::is_same_v<Data, attribute>
+			     || std::is_same_v<Data, statement>) {
+				data.tokens = relocated_tokens(data.tokens);
+			}
+			else if constexpr (std::is_same_v<Data, expression>) {
+				data.token_index = relocated_token(data.token_index);
+				data.t           = m_types(data.t);
+			}
+			else {
+				data.t = m_types(data.t);
+				if constexpr (requires { data.name; }) {
+					data.name = imported_name(data.name);
+				}
+			}
+		};
+
+		// Nodes are added in the order the image has them, so each one's index is the image's
+		// plus a fixed offset, and they can be linked up afterwards.
+		for (std::uint32_t node = declared.node_begin; node < declared.node_end; ++node) {
+			const image_node imported = m_image->record<image_node>(section_nodes, node);
+			switch (static_cast<ast_node_kind>(imported.kind)) {
+#define AST_NODE(NAME)                         \
+	case ast_node_kind::NAME:                 \
+		nodes.add_node(ast_node_kind::NAME); \
+		break;
+#define AST_NODE_WITH_DATA(NAME, TABLE)                         \
+	case ast_node_kind::NAME: {                                \
+		/* qualified, since `declaration` is also a member */ \
+		auto data = m_image->record<a_c_compiler::NAME>(      \
+		     section_##TABLE, imported.payload);              \
+		relocate(data);                                       \
+		nodes.add_##NAME(data);                               \
+	} break;
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE
+#undef AST_NODE_WITH_DATA
+			default:
+				ZTD_ASSERT_MESSAGE("the image holds a node of no known kind", false);
+				break;
+			}
+		}
+		for (std::uint32_t node = declared.node_begin; node < declared.node_end; ++node) {
+			const ast_node_id parent(relocated_node(node));
+			for (std::uint32_t child
+			     = m_image->record<image_node>(section_nodes, node).first_child;
+			     child != no_index;
+			     child = m_image->record<image_node>(section_nodes, child).next_sibling) {
+				nodes.append_child(parent, ast_node_id(relocated_node(child)));
+			}
+		}
+
+		const ast_node_id loaded(node_base);
+		nodes.append_child(m_mod->root(), loaded);
+		m_loaded[index] = loaded;
+		return loaded;
+	}
+
+	void ast_image_import::load_referenced() noexcept {
+		// what a declaration refers to is loaded after it, onto the end of the expressions,
+		// so going through them in order gets to all of it
+		for (std::size_t index = 0; index < m_mod->nodes.expressions.size(); ++index) {
+			const expression used = m_mod->nodes.expressions[index];
+			if (used.op == expression_operator::identifier) {
+				declaration(m_mod->source->tokens[used.token_index].identifier());
+			}
+		}
+	}
+
+	std::size_t ast_image_import::loaded_count() const noexcept {
+		return static_cast<std::size_t>(std::count_if(m_loaded.begin(), m_loaded.end(),
+		     [](ast_node_id loaded) noexcept { return loaded.is_valid(); }));
+	}
+
+	identifier_id ast_image_import::identifier(std::uint32_t index) noexcept {
+		if (index == no_index) {
+			return identifier_id();
+		}
+		if (!m_identifiers[index].is_valid()) {
+			m_identifiers[index]
+			     = intern_identifier(m_image->string(section_identifiers, index));
+		}
+		return m_identifiers[index];
+	}
+
+	source_location ast_image_import::source_start() noexcept {
+		if (!m_looked_for_source) {
+			m_looked_for_source = true;
+			// Only the locations are wanted from the file. If it changed since the image was
+			// written, they would point at the wrong places, so they are left out instead.
+			const std::string_view path = m_image->source_path();
+			auto maybe_file = path.empty() ? std::expected<file_id, std::error_code>(
+			                                      std::unexpected(std::error_code()))
+			                               : m_sources->load(fs::path(path));
+			if (maybe_file && m_sources->buffer(*maybe_file).size() == m_image->source_size()) {
+				m_source_start = m_sources->location(*maybe_file, 0);
+			}
+		}
+		return m_source_start;
+	}
+
+} // namespace a_c_compiler
@@ -1,20 +1,221 @@
 
 #include <a_c_compiler/fe/parse/ast_module.h>
 
+#include <ztd/idk/assert.hpp>
+
+#include <memory>
 #include <vector>
 
 namespace a_c_compiler {
-	namespace {
-		std::vector<type_data> type_data_table;
+	ast_node_table::ast_node_table(std::pmr::memory_resource* arena) noexcept
+	:
+#define AST_NODE_WITH_DATA(NAME, TABLE) TABLE(arena),
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+	m_kinds(arena)
+	, m_first_children(arena)
+	, m_last_children(arena)
+	, m_next_siblings(arena)
+	, m_payloads(arena)
+	, m_link_changes()
+	, m_open_checkpoints(0) {
+	}
+
+	ast_node_id ast_node_table::add_node(ast_node_kind kind, std::uint32_t payload) noexcept {
+		ast_node_id node(static_cast<std::uint32_t>(m_kinds.size()));
+		m_kinds.push_back(kind);
+		m_first_children.push_back(ast_node_id::invalid_index);
+		m_last_children.push_back(ast_node_id::invalid_index);
+		m_next_siblings.push_back(ast_node_id::invalid_index);
+		m_payloads.push_back(payload);
+		return node;
+	}
+
+	void ast_node_table::append_child(ast_node_id parent, ast_node_id child) noexcept {
+		ZTD_ASSERT_MESSAGE("node cannot be its own child", parent != child);
+		std::uint32_t& last_child = m_last_children[parent.index()];
+		if (m_open_checkpoints != 0) {
+			m_link_changes.push_back(link_change { parent.index(), last_child });
+		}
+		if (last_child == ast_node_id::invalid_index) {
+			m_first_children[parent.index()] = child.index();
+		}
+		else {
+			m_next_siblings[last_child] = child.index();
+		}
+		last_child = child.index();
+	}
+
+	ast_node_table::checkpoint ast_node_table::save() noexcept {
+		++m_open_checkpoints;
+		return position();
+	}
+
+	ast_node_table::checkpoint ast_node_table::position() const noexcept {
+		return checkpoint {
+			static_cast<std::uint32_t>(m_kinds.size()),
+			static_cast<std::uint32_t>(m_link_changes.size()),
+#define AST_NODE_WITH_DATA(NAME, TABLE) static_cast<std::uint32_t>(TABLE.size()),
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+		};
+	}
+
+	void ast_node_table::rollback(const checkpoint& saved) noexcept {
+		ZTD_ASSERT_MESSAGE("rolling back without an open checkpoint", m_open_checkpoints != 0);
+		// undo the links newest first, so every parent ends up as it was at the checkpoint
+		while (m_link_changes.size() > saved.link_count) {
+			const link_change change = m_link_changes.back();
+			m_link_changes.pop_back();
+			if (change.previous_last_child == ast_node_id::invalid_index) {
+				m_first_children[change.parent] = ast_node_id::invalid_index;
+			}
+			else {
+				m_next_siblings[change.previous_last_child] = ast_node_id::invalid_index;
+			}
+			m_last_children[change.parent] = change.previous_last_child;
+		}
+		truncate(saved);
+		commit(saved);
 	}
 
-	type type_data::get_new_type() {
-		std::size_t index = type_data_table.size();
-		type_data_table.push_back(type_data {});
-		return type { index };
+	void ast_node_table::truncate(const checkpoint& saved) noexcept {
+		m_kinds.resize(saved.node_count);
+		m_first_children.resize(saved.node_count);
+		m_last_children.resize(saved.node_count);
+		m_next_siblings.resize(saved.node_count);
+		m_payloads.resize(saved.node_count);
+#define AST_NODE_WITH_DATA(NAME, TABLE) \
+	TABLE.erase(TABLE.begin() + saved.TABLE##_count, TABLE.end());
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+	}
+
+	void ast_node_table::commit(const checkpoint&) noexcept {
+		ZTD_ASSERT_MESSAGE("committing without an open checkpoint", m_open_checkpoints != 0);
+		if (--m_open_checkpoints == 0) {
+			// nothing can be rolled back any more, so there is nothing left to undo
+			m_link_changes.clear();
+		}
+	}
+
+	void ast_node_table::adopt_children(ast_node_id parent, ast_node_id from) noexcept {
+		ZTD_ASSERT_MESSAGE("node cannot adopt its own children", parent != from);
+		ZTD_ASSERT_MESSAGE("cannot move children while a checkpoint is open",
+		     m_open_checkpoints == 0);
+		const std::uint32_t first_child = m_first_children[from.index()];
+		if (first_child == ast_node_id::invalid_index) {
+			return;
+		}
+		std::uint32_t& last_child = m_last_children[parent.index()];
+		if (last_child == ast_node_id::invalid_index) {
+			m_first_children[parent.index()] = first_child;
+		}
+		else {
+			m_next_siblings[last_child] = first_child;
+		}
+		last_child                     = m_last_children[from.index()];
+		m_first_children[from.index()] = ast_node_id::invalid_index;
+		m_last_children[from.index()]  = ast_node_id::invalid_index;
+	}
+
+	void ast_node_table::replace_children(
+	     ast_node_id parent, ast_node_id after, ast_node_id until, ast_node_id from) noexcept {
+		ZTD_ASSERT_MESSAGE("node cannot adopt its own children", parent != from);
+		ZTD_ASSERT_MESSAGE("cannot move children while a checkpoint is open",
+		     m_open_checkpoints == 0);
+		std::uint32_t first_child
+		     = from.is_valid() ? m_first_children[from.index()] : ast_node_id::invalid_index;
+		std::uint32_t last_child
+		     = from.is_valid() ? m_last_children[from.index()] : ast_node_id::invalid_index;
+		if (first_child == ast_node_id::invalid_index) {
+			// nothing to put in their place: `after` and `until` become siblings
+			first_child = until.index();
+			last_child  = after.index();
+		}
+		else {
+			m_next_siblings[last_child] = until.index();
+		}
+		if (after.is_valid()) {
+			m_next_siblings[after.index()] = first_child;
+		}
+		else {
+			m_first_children[parent.index()] = first_child;
+		}
+		if (!until.is_valid()) {
+			m_last_children[parent.index()] = last_child;
+		}
+		if (from.is_valid()) {
+			m_first_children[from.index()] = ast_node_id::invalid_index;
+			m_last_children[from.index()]  = ast_node_id::invalid_index;
+		}
+	}
+
+	std::uint32_t ast_node_table::append_table(
+	     const ast_node_table& other, const type_relocation& types) noexcept {
+		const std::uint32_t offset = static_cast<std::uint32_t>(m_kinds.size());
+		const auto relocated       = [offset](std::uint32_t index) noexcept {
+			return index == ast_node_id::invalid_index ? index : index + offset;
+		};
+		// where each of `other`'s side tables will start in ours
+#define AST_NODE_WITH_DATA(NAME, TABLE) \
+	const std::uint32_t TABLE##_offset = static_cast<std::uint32_t>(TABLE.size());
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+
+		for (std::size_t index = 0; index < other.m_kinds.size(); ++index) {
+			const ast_node_kind kind = other.m_kinds[index];
+			std::uint32_t payload    = other.m_payloads[index];
+			switch (kind) {
+#define AST_NODE_WITH_DATA(NAME, TABLE) \
+	case ast_node_kind::NAME:          \
+		payload += TABLE##_offset;     \
+		break;
+#include <a_c_compiler/fe/parse/ast_nodes.inl.h>
+#undef AST_NODE_WITH_DATA
+			default:
+				break;
+			}
+			m_kinds.push_back(kind);
+			m_first_children.push_back(relocated(other.m_first_children[index]));
+			m_last_children.push_back(relocated(other.m_last_children[index]));
+			m_next_siblings.push_back(relocated(other.m_next_siblings[index]));
+			m_payloads.push_back(payload);
+		}
+
+		// Side table entries are copied as they are, except that node ids and types are
+		// relocated.
+		for (const function_definition& definition : other.function_definitions) {
+			function_definition copied = definition;
+			copied.declaration.t       = types(definition.declaration.t);
+			copied.body                = ast_node_id(relocated(definition.body.index()));
+			function_definitions.push_back(copied);
+		}
+		const auto append_retyped = [&types](auto& table, const auto& other_table) noexcept {
+			for (const auto& entry : other_table) {
+				table.push_back(entry);
+				table.back().t = types(entry.t);
+			}
+		};
+		append_retyped(function_declarations, other.function_declarations);
+		append_retyped(declarations, other.declarations);
+		append_retyped(parameter_declarations, other.parameter_declarations);
+		append_retyped(struct_declarations, other.struct_declarations);
+		append_retyped(member_declarations, other.member_declarations);
+		attributes.insert(attributes.end(), other.attributes.begin(), other.attributes.end());
+		statements.insert(statements.end(), other.statements.begin(), other.statements.end());
+		append_retyped(expressions, other.expressions);
+		return offset;
 	}
 
-	type_data& type::data() const noexcept {
-		return type_data_table[m_ref];
+	ast_module::ast_module() noexcept
+	: m_arena(std::make_unique<std::pmr::monotonic_buffer_resource>(initial_arena_size))
+	, nodes(m_arena.get())
+	, types()
+	, symbols(m_arena.get())
+	, constants()
+	, source()
+	, external_declarations() {
+		nodes.add_node(ast_node_kind::translation_unit);
 	}
 } // namespace a_c_compiler
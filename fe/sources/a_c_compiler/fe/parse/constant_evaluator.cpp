@@ -0,0 +1,901 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/parse/constant_evaluator.h>
+#include <a_c_compiler/fe/parse/ast_module.h>
+#include <a_c_compiler/fe/parse/symbol_table.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <initializer_list>
+#include <string>
+
+namespace a_c_compiler {
+
+	namespace {
+		std::unexpected<constant_failure> failure(
+		     constant_error error, ast_node_id node) noexcept {
+			return std::unexpected(constant_failure { error, node });
+		}
+
+		/* An arithmetic type a constant can have (see `constant_value`). */
+		struct arithmetic_kind {
+			type_category category;
+			bool is_unsigned;
+			std::uint32_t bit_width;
+		};
+
+		constant_value integer_value(const arithmetic_kind& kind, big_integer value) noexcept {
+			return constant_value { kind.category, kind.is_unsigned, kind.bit_width,
+				std::move(value), 0 };
+		}
+
+		constant_value integer_value(
+		     type_category category, bool is_unsigned, std::uint64_t value) noexcept {
+			return integer_value(arithmetic_kind { category, is_unsigned, 0 }, value);
+		}
+
+		constant_value floating_value(type_category category, double value) noexcept {
+			return constant_value { category, false, 0, big_integer(), value };
+		}
+
+		arithmetic_kind kind_of(const constant_value& value) noexcept {
+			return arithmetic_kind { value.category, value.is_unsigned, value.bit_width };
+		}
+
+		int floating_rank(type_category category) noexcept {
+			switch (category) {
+			case type_category::tc_float:
+				return 0;
+			case type_category::tc_double:
+				return 1;
+			default:
+				return 2;
+			}
+		}
+
+		std::uint32_t integer_width(const target_abi& abi, const arithmetic_kind& kind) noexcept {
+			switch (kind.category) {
+			case type_category::tc_bool:
+				return 1;
+			case type_category::tc_char:
+				return abi.char_layout.size * 8;
+			case type_category::tc_short:
+				return abi.short_layout.size * 8;
+			case type_category::tc_int:
+				return abi.int_layout.size * 8;
+			case type_category::tc_long:
+				return abi.long_layout.size * 8;
+			case type_category::tc__BitInt:
+				return kind.bit_width;
+			default:
+				return abi.long_long_layout.size * 8;
+			}
+		}
+
+		/* Where an integer type stands among the others, for the usual arithmetic
+		 * conversions: by width first, then with a standard type above a _BitInt as wide,
+		 * and then in the order of the standard types (so `long long` is above `long`, even
+		 * when they are as wide). */
+		std::uint64_t integer_rank(const target_abi& abi, const arithmetic_kind& kind) noexcept {
+			std::uint64_t standard_rank = 0;
+			switch (kind.category) {
+			case type_category::tc__BitInt:
+				standard_rank = 0;
+				break;
+			case type_category::tc_bool:
+				standard_rank = 1;
+				break;
+			case type_category::tc_char:
+				standard_rank = 2;
+				break;
+			case type_category::tc_short:
+				standard_rank = 3;
+				break;
+			case type_category::tc_int:
+				standard_rank = 4;
+				break;
+			case type_category::tc_long:
+				standard_rank = 5;
+				break;
+			default:
+				standard_rank = 6;
+				break;
+			}
+			return (std::uint64_t(integer_width(abi, kind)) << 8) | standard_rank;
+		}
+
+		/* An integer of type `kind` that was worked out exactly: wrapped to the type if it is
+		 * unsigned, and a failure if it does not fit in it otherwise. */
+		constant_result integer_result(const target_abi& abi, const arithmetic_kind& kind,
+		     big_integer exact, ast_node_id node) noexcept {
+			const std::uint32_t width = integer_width(abi, kind);
+			if (kind.is_unsigned) {
+				return integer_value(kind, exact.wrapped(width, true));
+			}
+			if (!exact.fits_in(width, false)) {
+				return failure(constant_error::overflow, node);
+			}
+			return integer_value(kind, std::move(exact));
+		}
+
+		/* The arithmetic type `t` is, as the kind of a constant of it. */
+		std::optional<arithmetic_kind> arithmetic_type(const type_data& t_data) noexcept {
+			const bool is_unsigned = t_data.modifier == type_modifier::tm_unsigned;
+			switch (t_data.category) {
+			case type_category::tc_none:
+				// `signed` or `unsigned` alone
+				if (t_data.modifier == type_modifier::tm_signed
+				     || t_data.modifier == type_modifier::tm_unsigned) {
+					return arithmetic_kind { type_category::tc_int, is_unsigned, 0 };
+				}
+				return std::nullopt;
+			case type_category::tc_bool:
+				return arithmetic_kind { type_category::tc_bool, true, 0 };
+			case type_category::tc_char:
+			case type_category::tc_short:
+			case type_category::tc_int:
+			case type_category::tc_long:
+			case type_category::tc_longlong:
+				return arithmetic_kind { t_data.category, is_unsigned, 0 };
+			case type_category::tc__BitInt:
+				return arithmetic_kind { t_data.category, is_unsigned, t_data.extent };
+			case type_category::tc_enum:
+				return arithmetic_kind { type_category::tc_int, false, 0 };
+			case type_category::tc_float:
+			case type_category::tc_double:
+				return arithmetic_kind { t_data.category, false, 0 };
+			case type_category::tc_longdouble:
+			case type_category::tc_longlongdouble:
+				return arithmetic_kind { type_category::tc_longdouble, false, 0 };
+			default:
+				return std::nullopt;
+			}
+		}
+
+		/* `value` converted to an arithmetic type, as a cast would. Only converting a
+		 * floating value to an integer type it does not fit in can fail. */
+		constant_result convert(const target_abi& abi, const constant_value& value,
+		     const arithmetic_kind& kind, ast_node_id node) noexcept {
+			if (kind.category == type_category::tc_bool) {
+				return integer_value(kind, value.is_nonzero() ? 1 : 0);
+			}
+			if (floating_value(kind.category, 0).is_floating()) {
+				double converted
+				     = value.is_floating() ? value.floating : value.integer.to_double();
+				if (kind.category == type_category::tc_float) {
+					converted = static_cast<float>(converted);
+				}
+				return floating_value(kind.category, converted);
+			}
+			const std::uint32_t width = integer_width(abi, kind);
+			if (!value.is_floating()) {
+				return integer_value(kind, value.integer.wrapped(width, kind.is_unsigned));
+			}
+			// the fraction is thrown away, and what is left has to fit
+			const double truncated = std::trunc(value.floating);
+			const double limit  = std::ldexp(1.0, int(width) - (kind.is_unsigned ? 0 : 1));
+			const double lowest = kind.is_unsigned ? 0.0 : -limit;
+			if (!(truncated >= lowest && truncated < limit)) {
+				return failure(constant_error::overflow, node);
+			}
+			return integer_value(kind, big_integer::from_double(truncated));
+		}
+
+		/* The type an operand is promoted to: `int` for an integer type that ranks below it
+		 * (every one of which fits in `int`, unsigned or not), and its own type otherwise.
+		 * A _BitInt is never promoted. */
+		arithmetic_kind promoted_kind(const constant_value& value) noexcept {
+			switch (value.category) {
+			case type_category::tc_bool:
+			case type_category::tc_char:
+			case type_category::tc_short:
+				return arithmetic_kind { type_category::tc_int, false, 0 };
+			default:
+				return kind_of(value);
+			}
+		}
+
+		constant_value promote(const constant_value& value) noexcept {
+			return integer_value(promoted_kind(value), value.integer);
+		}
+
+		/* The type both operands of a binary operator are converted to: the usual arithmetic
+		 * conversions. */
+		arithmetic_kind common_type(const target_abi& abi, const constant_value& left,
+		     const constant_value& right) noexcept {
+			if (left.is_floating() || right.is_floating()) {
+				if (!right.is_floating()) {
+					return kind_of(left);
+				}
+				if (!left.is_floating()) {
+					return kind_of(right);
+				}
+				return floating_rank(left.category) >= floating_rank(right.category)
+				     ? kind_of(left)
+				     : kind_of(right);
+			}
+			const arithmetic_kind promoted_left  = promoted_kind(left);
+			const arithmetic_kind promoted_right = promoted_kind(right);
+			const bool left_ranks_higher         = integer_rank(abi, promoted_left)
+			     >= integer_rank(abi, promoted_right);
+			if (promoted_left.is_unsigned == promoted_right.is_unsigned) {
+				return left_ranks_higher ? promoted_left : promoted_right;
+			}
+			const arithmetic_kind& unsigned_one
+			     = promoted_left.is_unsigned ? promoted_left : promoted_right;
+			const arithmetic_kind& signed_one
+			     = promoted_left.is_unsigned ? promoted_right : promoted_left;
+			if (integer_rank(abi, unsigned_one) >= integer_rank(abi, signed_one)) {
+				return unsigned_one;
+			}
+			if (integer_width(abi, signed_one) > integer_width(abi, unsigned_one)) {
+				return signed_one;
+			}
+			return arithmetic_kind { signed_one.category, true, signed_one.bit_width };
+		}
+
+		bool same_value(const constant_value& left, const constant_value& right) noexcept {
+			return left.is_floating() ? left.floating == right.floating
+			                          : left.integer == right.integer;
+		}
+
+		/* The value and type of a numeric literal, from its spelling, for the target:
+		 * decimal, hexadecimal, octal or binary integers (with or without digit separators
+		 * and a suffix) as the first type in C23's list for them that holds their value, or as
+		 * the narrowest _BitInt that does for a `wb` suffix, and decimal and hexadecimal
+		 * floating literals. Nothing for a literal too big for any type it can have, or one
+		 * (such as a decimal floating literal) that is not understood yet. */
+		std::optional<constant_value> literal_value(
+		     const target_abi& abi, std::string_view spelling) noexcept {
+			const bool is_prefixed = spelling.size() > 1 && spelling[0] == '0';
+			const bool is_hex      = is_prefixed && (spelling[1] == 'x' || spelling[1] == 'X');
+			const bool is_floating
+			     = spelling.find_first_of(is_hex ? ".pP" : ".eE") != std::string_view::npos;
+			if (is_floating) {
+				std::string digits;
+				type_category category = type_category::tc_double;
+				for (const char c : spelling.substr(is_hex ? 2 : 0)) {
+					if (c != '\'') {
+						digits.push_back(c);
+					}
+				}
+				if (!digits.empty() && (digits.back() == 'f' || digits.back() == 'F')) {
+					category = type_category::tc_float;
+					digits.pop_back();
+				}
+				else if (!digits.empty() && (digits.back() == 'l' || digits.back() == 'L')) {
+					category = type_category::tc_longdouble;
+					digits.pop_back();
+				}
+				double value                 = 0;
+				const char* const digits_end = digits.data() + digits.size();
+				const auto [last, error]     = std::from_chars(digits.data(), digits_end, value,
+				     is_hex ? std::chars_format::hex : std::chars_format::general);
+				if (error != std::errc() || last != digits_end) {
+					return std::nullopt;
+				}
+				if (category == type_category::tc_float) {
+					value = static_cast<float>(value);
+				}
+				return floating_value(category, value);
+			}
+
+			unsigned base     = 10;
+			std::size_t index = 0;
+			if (is_prefixed) {
+				switch (spelling[1]) {
+				case 'x':
+				case 'X':
+					base  = 16;
+					index = 2;
+					break;
+				case 'b':
+				case 'B':
+					base  = 2;
+					index = 2;
+					break;
+				default:
+					base  = 8;
+					index = 1;
+					break;
+				}
+			}
+			// a lone `0` is an octal literal with no digits after its prefix
+			bool has_digits = base == 8;
+			big_integer value;
+			for (; index < spelling.size(); ++index) {
+				const char c = spelling[index];
+				unsigned digit;
+				if (c == '\'') {
+					continue;
+				}
+				else if (c >= '0' && c <= '9') {
+					digit = static_cast<unsigned>(c - '0');
+				}
+				else if (base == 16 && (c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+					digit = static_cast<unsigned>((c | 0x20) - 'a' + 10);
+				}
+				else {
+					break;
+				}
+				if (digit >= base) {
+					return std::nullopt;
+				}
+				value.multiply_add(base, digit);
+				if (value.bit_width() > abi.bit_int_max_width) {
+					return std::nullopt;
+				}
+				has_digits = true;
+			}
+			// whatever is left has to be a suffix: `u`, and `l`, `ll` or `wb` (in either case)
+			bool is_unsigned       = false;
+			bool is_bit_precise    = false;
+			std::size_t long_count = 0;
+			for (; index < spelling.size(); ++index) {
+				switch (spelling[index]) {
+				case 'u':
+				case 'U':
+					if (is_unsigned) {
+						return std::nullopt;
+					}
+					is_unsigned = true;
+					break;
+				case 'l':
+				case 'L':
+					if (long_count != 0
+					     && (long_count == 2 || spelling[index - 1] != spelling[index])) {
+						return std::nullopt;
+					}
+					++long_count;
+					break;
+				case 'w':
+				case 'W':
+					if (is_bit_precise || index + 1 == spelling.size()
+					     || (spelling[index + 1] | 0x20) != 'b'
+					     || (spelling[index] == 'w') != (spelling[index + 1] == 'b')) {
+						return std::nullopt;
+					}
+					is_bit_precise = true;
+					++index;
+					break;
+				default:
+					return std::nullopt;
+				}
+			}
+			if (!has_digits || (is_bit_precise && long_count != 0)) {
+				return std::nullopt;
+			}
+			if (is_bit_precise) {
+				// as narrow as holds the value, and its sign if it has one
+				const std::uint32_t width = std::max<std::uint32_t>(
+				     value.bit_width() + (is_unsigned ? 0 : 1), is_unsigned ? 1 : 2);
+				if (width > abi.bit_int_max_width) {
+					return std::nullopt;
+				}
+				return integer_value(
+				     arithmetic_kind { type_category::tc__BitInt, is_unsigned, width }, value);
+			}
+			// a decimal literal with no `u` is only ever signed; any other can be either
+			const bool may_be_unsigned = is_unsigned || base != 10;
+			const type_category categories[]
+			     = { type_category::tc_int, type_category::tc_long, type_category::tc_longlong };
+			for (std::size_t rank = long_count; rank < std::size(categories); ++rank) {
+				for (const bool candidate_unsigned : { false, true }) {
+					if (candidate_unsigned ? !may_be_unsigned : is_unsigned) {
+						continue;
+					}
+					const arithmetic_kind kind { categories[rank], candidate_unsigned, 0 };
+					if (value.fits_in(integer_width(abi, kind), candidate_unsigned)) {
+						return integer_value(kind, value);
+					}
+				}
+			}
+			return std::nullopt;
+		}
+	} // namespace
+
+	bool is_arithmetic(const type_data& t_data) noexcept {
+		return arithmetic_type(t_data).has_value();
+	}
+
+	std::string_view constant_error_message(constant_error error) noexcept {
+		switch (error) {
+		case constant_error::not_constant:
+			return "it uses something that is not a constant";
+		case constant_error::division_by_zero:
+			return "it divides by zero";
+		case constant_error::overflow:
+			return "its value does not fit in its type";
+		case constant_error::invalid_shift:
+			return "it shifts by a negative amount or by the width of its type or more, or "
+			       "shifts a negative value left";
+		case constant_error::not_representable:
+			return "its value changes when converted to the type of what it initializes";
+		case constant_error::not_integer:
+			return "it is not an integer";
+		case constant_error::step_limit:
+			return "evaluating it takes more steps than the limit allows";
+		case constant_error::depth_limit:
+			return "it nests more deeply than the limit allows";
+		}
+		return "";
+	}
+
+	const constant_result* constant_table::find(ast_node_id expression) const noexcept {
+		const auto found = m_expression_indices.find(expression.index());
+		return found == m_expression_indices.end() ? nullptr
+		                                           : &m_expressions[found->second].second;
+	}
+
+	void constant_table::record(ast_node_id expression, constant_result result) noexcept {
+		const auto [found, inserted] = m_expression_indices.try_emplace(
+		     expression.index(), static_cast<std::uint32_t>(m_expressions.size()));
+		if (inserted) {
+			m_expressions.emplace_back(expression, std::move(result));
+		}
+		else {
+			m_expressions[found->second].second = std::move(result);
+		}
+	}
+
+	const constant_value* constant_table::find_object(identifier_id name) const noexcept {
+		const auto found = m_objects.find(name.index());
+		return found == m_objects.end() ? nullptr : &found->second;
+	}
+
+	void constant_table::record_object(identifier_id name, constant_value value) noexcept {
+		m_objects.insert_or_assign(name.index(), value);
+	}
+
+	void constant_table::forget_object(identifier_id name) noexcept {
+		if (!m_objects.empty()) {
+			m_objects.erase(name.index());
+		}
+	}
+
+	void constant_table::rollback(const checkpoint& saved) noexcept {
+		while (m_expressions.size() > saved.expression_count) {
+			m_expression_indices.erase(m_expressions.back().first.index());
+			m_expressions.pop_back();
+		}
+	}
+
+	void constant_table::append(const constant_table& other, const checkpoint& since,
+	     std::uint32_t node_offset) noexcept {
+		for (std::size_t index = since.expression_count; index < other.m_expressions.size();
+		     ++index) {
+			const auto& [expression, result] = other.m_expressions[index];
+			constant_result moved            = result;
+			if (!moved && moved.error().node.is_valid()) {
+				moved.error().node = ast_node_id(moved.error().node.index() + node_offset);
+			}
+			record(ast_node_id(expression.index() + node_offset), std::move(moved));
+		}
+		for (const auto& [name, value] : other.m_objects) {
+			m_objects.insert_or_assign(name, value);
+		}
+	}
+
+	constant_evaluator::constant_evaluator(const ast_node_table& nodes,
+	     const token_sequence& tokens, const type_table& types, const symbol_table& symbols,
+	     constant_table& constants, constant_limits limits, target_abi abi) noexcept
+	: m_nodes(nodes)
+	, m_tokens(tokens)
+	, m_types(types)
+	, m_symbols(symbols)
+	, m_constants(constants)
+	, m_limits(limits)
+	, m_abi(abi)
+	, m_steps(0)
+	, m_layouts() {
+	}
+
+	constant_result constant_evaluator::evaluate(ast_node_id expression) noexcept {
+		if (const constant_result* known = m_constants.find(expression)) {
+			return *known;
+		}
+		m_steps                      = 0;
+		const constant_result result = evaluate_node(expression, 0);
+		m_constants.record(expression, result);
+		return result;
+	}
+
+	constant_result constant_evaluator::convert_exactly(
+	     const constant_value& value, type t, ast_node_id node) const noexcept {
+		const auto target = arithmetic_type(m_types.data(t));
+		if (!target) {
+			return failure(constant_error::not_constant, node);
+		}
+		const constant_result converted
+		     = convert(m_abi, value, *target, node);
+		if (!converted) {
+			return failure(constant_error::not_representable, node);
+		}
+		const constant_result back
+		     = convert(m_abi, *converted, kind_of(value), node);
+		if (!back || !same_value(*back, value)
+		     || converted->is_negative() != value.is_negative()) {
+			return failure(constant_error::not_representable, node);
+		}
+		return converted;
+	}
+
+	constant_result constant_evaluator::evaluate_node(
+	     ast_node_id node, std::uint32_t depth) noexcept {
+		if (++m_steps > m_limits.steps) {
+			return failure(constant_error::step_limit, node);
+		}
+		if (depth > m_limits.depth) {
+			return failure(constant_error::depth_limit, node);
+		}
+		if (m_nodes.kind(node) != ast_node_kind::expression) {
+			return failure(constant_error::not_constant, node);
+		}
+		const expression& expr  = m_nodes.expression_data(node);
+		const ast_node_id first = m_nodes.first_child(node);
+		switch (expr.op) {
+		case expression_operator::numeric_literal:
+			return evaluate_numeric_literal(node);
+		case expression_operator::identifier:
+			return evaluate_identifier(node);
+		case expression_operator::constant:
+			switch (m_tokens[expr.token_index].id) {
+			case tok_keyword_true:
+				return integer_value(type_category::tc_bool, true, 1);
+			case tok_keyword_false:
+				return integer_value(type_category::tc_bool, true, 0);
+			default:
+				// nullptr is a constant, but not an arithmetic one
+				return failure(constant_error::not_constant, node);
+			}
+		case expression_operator::unary_plus:
+		case expression_operator::negate:
+		case expression_operator::logical_not:
+		case expression_operator::bitwise_not: {
+			const constant_result operand = evaluate_node(first, depth + 1);
+			if (!operand) {
+				return operand;
+			}
+			const constant_value promoted = promote(*operand);
+			switch (expr.op) {
+			case expression_operator::logical_not:
+				return integer_value(
+				     type_category::tc_int, false, operand->is_nonzero() ? 0 : 1);
+			case expression_operator::negate:
+				if (promoted.is_floating()) {
+					return floating_value(promoted.category, -promoted.floating);
+				}
+				return integer_result(m_abi, kind_of(promoted), -promoted.integer, node);
+			case expression_operator::bitwise_not:
+				if (promoted.is_floating()) {
+					return failure(constant_error::not_integer, node);
+				}
+				return integer_result(m_abi, kind_of(promoted), ~promoted.integer, node);
+			default:
+				return promoted;
+			}
+		}
+		case expression_operator::cast: {
+			const constant_result operand = evaluate_node(first, depth + 1);
+			if (!operand) {
+				return operand;
+			}
+			const auto target = arithmetic_type(m_types.data(expr.t));
+			if (!target) {
+				return failure(constant_error::not_constant, node);
+			}
+			return convert(m_abi, *operand, *target, node);
+		}
+		case expression_operator::sizeof_type:
+			return size_or_alignment(expr.t, false, node);
+		case expression_operator::alignof_type:
+			return size_or_alignment(expr.t, true, node);
+		case expression_operator::sizeof_expression:
+			return evaluate_sizeof_expression(node, depth);
+		case expression_operator::conditional: {
+			const constant_result condition = evaluate_node(first, depth + 1);
+			if (!condition) {
+				return condition;
+			}
+			const ast_node_id if_true = m_nodes.next_sibling(first);
+			return evaluate_node(
+			     condition->is_nonzero() ? if_true : m_nodes.next_sibling(if_true), depth + 1);
+		}
+		case expression_operator::logical_and:
+		case expression_operator::logical_or: {
+			const constant_result left = evaluate_node(first, depth + 1);
+			if (!left) {
+				return left;
+			}
+			// the right operand is only evaluated if the left one does not decide it
+			const bool is_and = expr.op == expression_operator::logical_and;
+			if (left->is_nonzero() != is_and) {
+				return integer_value(type_category::tc_int, false, is_and ? 0 : 1);
+			}
+			const constant_result right = evaluate_node(m_nodes.next_sibling(first), depth + 1);
+			if (!right) {
+				return right;
+			}
+			return integer_value(type_category::tc_int, false, right->is_nonzero() ? 1 : 0);
+		}
+		case expression_operator::multiply:
+		case expression_operator::divide:
+		case expression_operator::remainder:
+		case expression_operator::add:
+		case expression_operator::subtract:
+		case expression_operator::shift_left:
+		case expression_operator::shift_right:
+		case expression_operator::less:
+		case expression_operator::greater:
+		case expression_operator::less_equal:
+		case expression_operator::greater_equal:
+		case expression_operator::equal:
+		case expression_operator::not_equal:
+		case expression_operator::bitwise_and:
+		case expression_operator::bitwise_xor:
+		case expression_operator::bitwise_or:
+			return evaluate_binary(node, depth);
+		default:
+			// assignments, increments, calls, and anything to do with objects or addresses
+			return failure(constant_error::not_constant, node);
+		}
+	}
+
+	constant_result constant_evaluator::evaluate_binary(
+	     ast_node_id node, std::uint32_t depth) noexcept {
+		const expression_operator op = m_nodes.expression_data(node).op;
+		const ast_node_id first      = m_nodes.first_child(node);
+		const constant_result left   = evaluate_node(first, depth + 1);
+		if (!left) {
+			return left;
+		}
+		const constant_result right = evaluate_node(m_nodes.next_sibling(first), depth + 1);
+		if (!right) {
+			return right;
+		}
+
+		if (op == expression_operator::shift_left || op == expression_operator::shift_right) {
+			// each operand is promoted on its own, and the result has the left one's type
+			const constant_value shifted = promote(*left);
+			const constant_value amount  = promote(*right);
+			if (shifted.is_floating() || amount.is_floating()) {
+				return failure(constant_error::not_integer, node);
+			}
+			const std::uint32_t width = integer_width(m_abi, kind_of(shifted));
+			if (amount.is_negative() || amount.integer >= big_integer(width)) {
+				return failure(constant_error::invalid_shift, node);
+			}
+			const std::uint32_t by = static_cast<std::uint32_t>(amount.integer.low_bits());
+			if (op == expression_operator::shift_right) {
+				return integer_value(kind_of(shifted), shifted.integer >> by);
+			}
+			if (!shifted.is_unsigned && shifted.is_negative()) {
+				return failure(constant_error::invalid_shift, node);
+			}
+			return integer_result(m_abi, kind_of(shifted), shifted.integer << by, node);
+		}
+
+		const arithmetic_kind kind = common_type(m_abi, *left, *right);
+		const constant_result converted_left  = convert(m_abi, *left, kind, node);
+		const constant_result converted_right = convert(m_abi, *right, kind, node);
+		if (!converted_left) {
+			return converted_left;
+		}
+		if (!converted_right) {
+			return converted_right;
+		}
+		const constant_value& l = *converted_left;
+		const constant_value& r = *converted_right;
+		const auto truth = [](bool value) noexcept {
+			return integer_value(type_category::tc_int, false, value ? 1 : 0);
+		};
+
+		if (l.is_floating()) {
+			const auto rounded = [&](double value) {
+				return floating_value(kind.category,
+				     kind.category == type_category::tc_float ? static_cast<float>(value)
+				                                              : value);
+			};
+			switch (op) {
+			case expression_operator::multiply:
+				return rounded(l.floating * r.floating);
+			case expression_operator::divide:
+				if (r.floating == 0) {
+					return failure(constant_error::division_by_zero, node);
+				}
+				return rounded(l.floating / r.floating);
+			case expression_operator::add:
+				return rounded(l.floating + r.floating);
+			case expression_operator::subtract:
+				return rounded(l.floating - r.floating);
+			case expression_operator::less:
+				return truth(l.floating < r.floating);
+			case expression_operator::greater:
+				return truth(l.floating > r.floating);
+			case expression_operator::less_equal:
+				return truth(l.floating <= r.floating);
+			case expression_operator::greater_equal:
+				return truth(l.floating >= r.floating);
+			case expression_operator::equal:
+				return truth(l.floating == r.floating);
+			case expression_operator::not_equal:
+				return truth(l.floating != r.floating);
+			default:
+				// `%` and the bitwise operators only take integers
+				return failure(constant_error::not_integer, node);
+			}
+		}
+
+		// Both operands are in the range of their (common) type, so comparisons and the
+		// bitwise operators are exact, and so is everything else until it is brought back
+		// into that range.
+		switch (op) {
+		case expression_operator::less:
+			return truth(l.integer < r.integer);
+		case expression_operator::greater:
+			return truth(l.integer > r.integer);
+		case expression_operator::less_equal:
+			return truth(l.integer <= r.integer);
+		case expression_operator::greater_equal:
+			return truth(l.integer >= r.integer);
+		case expression_operator::equal:
+			return truth(l.integer == r.integer);
+		case expression_operator::not_equal:
+			return truth(l.integer != r.integer);
+		case expression_operator::bitwise_and:
+			return integer_value(kind, l.integer & r.integer);
+		case expression_operator::bitwise_xor:
+			return integer_value(kind, l.integer ^ r.integer);
+		case expression_operator::bitwise_or:
+			return integer_value(kind, l.integer | r.integer);
+		case expression_operator::divide:
+		case expression_operator::remainder: {
+			if (r.integer.is_zero()) {
+				return failure(constant_error::division_by_zero, node);
+			}
+			// the remainder of a quotient that does not fit is undefined along with it
+			constant_result quotient = integer_result(m_abi, kind, l.integer / r.integer, node);
+			if (!quotient || op == expression_operator::divide) {
+				return quotient;
+			}
+			return integer_value(kind, l.integer % r.integer);
+		}
+		case expression_operator::multiply:
+			return integer_result(m_abi, kind, l.integer * r.integer, node);
+		case expression_operator::add:
+			return integer_result(m_abi, kind, l.integer + r.integer, node);
+		default:
+			return integer_result(m_abi, kind, l.integer - r.integer, node);
+		}
+	}
+
+	constant_result constant_evaluator::evaluate_numeric_literal(
+	     ast_node_id node) const noexcept {
+		const token& tok = m_tokens[m_nodes.expression_data(node).token_index];
+		const std::optional<constant_value> value
+		     = literal_value(m_abi, lexed_numeric_literal(tok.value));
+		if (!value) {
+			return failure(constant_error::not_constant, node);
+		}
+		return *value;
+	}
+
+	constant_result constant_evaluator::evaluate_identifier(ast_node_id node) const noexcept {
+		const identifier_id name
+		     = m_tokens[m_nodes.expression_data(node).token_index].identifier();
+		// only file-scope objects can be `constexpr` objects here, since nothing in a block
+		// is parsed as a declaration yet
+		const symbol* named = m_symbols.find(symbol_namespace::ordinary, name);
+		if (named != nullptr && named->kind == symbol_kind::object && named->scope_depth == 0) {
+			if (const constant_value* value = m_constants.find_object(name)) {
+				return *value;
+			}
+		}
+		return failure(constant_error::not_constant, node);
+	}
+
+	constant_result constant_evaluator::evaluate_sizeof_expression(
+	     ast_node_id node, std::uint32_t depth) noexcept {
+		const ast_node_id operand = m_nodes.first_child(node);
+		if (const std::optional<type> t = operand_type(operand)) {
+			return size_or_alignment(*t, false, node);
+		}
+		// Anything else with a type that can be told is a constant itself: its value is not
+		// wanted, only its type.
+		const constant_result value = evaluate_node(operand, depth + 1);
+		if (!value) {
+			return value;
+		}
+		std::uint64_t size = 0;
+		switch (value->category) {
+		case type_category::tc_bool:
+			size = m_abi.bool_layout.size;
+			break;
+		case type_category::tc_float:
+			size = m_abi.float_layout.size;
+			break;
+		case type_category::tc_double:
+			size = m_abi.double_layout.size;
+			break;
+		case type_category::tc_longdouble:
+			size = m_abi.long_double_layout.size;
+			break;
+		case type_category::tc__BitInt:
+			size = layouts().bit_int_layout(value->bit_width).size;
+			break;
+		default:
+			size = integer_width(m_abi, kind_of(*value)) / 8;
+			break;
+		}
+		const type_category size_category = m_abi.long_layout.size == m_abi.pointer_layout.size
+		     ? type_category::tc_long
+		     : type_category::tc_int;
+		return integer_value(size_category, true, size);
+	}
+
+	constant_result constant_evaluator::size_or_alignment(
+	     type t, bool is_alignment, ast_node_id node) noexcept {
+		const type_layout laid_out = layouts().layout(t);
+		if (!laid_out.complete) {
+			return failure(constant_error::not_constant, node);
+		}
+		// `size_t` is whichever of `unsigned int` and `unsigned long` is as wide as a pointer
+		const type_category size_category = m_abi.long_layout.size == m_abi.pointer_layout.size
+		     ? type_category::tc_long
+		     : type_category::tc_int;
+		return integer_value(
+		     size_category, true, is_alignment ? laid_out.alignment : laid_out.size);
+	}
+
+	type_layout_table& constant_evaluator::layouts() noexcept {
+		if (!m_layouts) {
+			m_layouts.emplace(m_types, m_abi);
+		}
+		return *m_layouts;
+	}
+
+	std::optional<type> constant_evaluator::operand_type(ast_node_id node) const noexcept {
+		if (m_nodes.kind(node) != ast_node_kind::expression) {
+			return std::nullopt;
+		}
+		const expression& expr = m_nodes.expression_data(node);
+		switch (expr.op) {
+		case expression_operator::identifier: {
+			const symbol* named = m_symbols.find(symbol_namespace::ordinary,
+			     m_tokens[expr.token_index].identifier());
+			if (named == nullptr || named->kind != symbol_kind::object) {
+				return std::nullopt;
+			}
+			return named->t;
+		}
+		case expression_operator::cast:
+		case expression_operator::compound_literal:
+			return expr.t;
+		case expression_operator::subscript:
+		case expression_operator::dereference: {
+			const std::optional<type> operand = operand_type(m_nodes.first_child(node));
+			if (!operand) {
+				return std::nullopt;
+			}
+			switch (m_types.data(*operand).category) {
+			case type_category::tc_array:
+			case type_category::tc_variable_length_array:
+				return m_types.element_type(*operand);
+			case type_category::tc_data_pointer:
+				return m_types.pointee_type(*operand);
+			default:
+				return std::nullopt;
+			}
+		}
+		default:
+			return std::nullopt;
+		}
+	}
+
+} // namespace a_c_compiler
@@ -10,69 +10,370 @@
 #include <a_c_compiler/fe/reporting/logger.h>
 #include <a_c_compiler/fe/parse/parser_diagnostic_reporter.h>
 #include <a_c_compiler/fe/parse/parser_diagnostic.h>
-
+#include <a_c_compiler/fe/parse/constant_evaluator.h>
+#include <a_c_compiler/fe/parse/parse_profile.h>
+#include <a_c_compiler/fe/parse/expression.h>
+#include <a_c_compiler/fe/parse/symbol_table.h>
+#include <a_c_compiler/fe/parse/type_layout.h>
+#include <a_c_compiler/fe/support/thread_pool.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <expected>
+#include <functional>
+#include <limits>
+#include <memory_resource>
 #include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
-#define DEBUGGING() this->global_opts.get_feature_flag(1, 0x1)
+#define DEBUGGING() Instrumentation::tracing
 #define DEBUG(FORMATSTR, ...)                                                                   \
 	if (DEBUGGING()) {                                                                         \
-		this->m_logger.indent();                                                              \
+		this->m_debug_logger.indent();                                                        \
 		std::fprintf(                                                                         \
 		     this->m_debug_logger.c_handle(), "parser:%s:" FORMATSTR, __func__, __VA_ARGS__); \
 	}
+#define SKIPPING_FUNCTION_BODIES() this->m_global_opts.get_feature_flag(1, 0x2)
 #define DEBUGS(DEBUGSTR)                                                                  \
 	if (DEBUGGING()) {                                                                   \
-		this->m_logger.indent();                                                        \
+		this->m_debug_logger.indent();                                                  \
 		std::fprintf(this->m_debug_logger.c_handle(), "parser:%s:" DEBUGSTR, __func__); \
 	}
 #define ENTER_PARSE_FUNCTION()                                                       \
-	scope_logger current_scope_logger(                                              \
-	     __func__,                                                                  \
-	     [&](logger& logger) {                                                      \
-		     auto loc = this->current_token().source_location;                     \
-		     std::fprintf(logger.c_handle(), ":%zu:%zu:", loc.lineno, loc.column); \
-	     },                                                                         \
-	     this->m_debug_logger);
+	[[maybe_unused]] const auto current_scope_logger  = this->trace_rule(__func__); \
+	[[maybe_unused]] const auto current_rule_profiler = this->profile_rule(__func__)
 
 namespace a_c_compiler {
 
+	namespace {
+		/* Builds a `token_source` from a run of raw tokens at a time: drops what the grammar does
+		 * not care about, and pairs up brackets as they close. */
+		struct token_source_builder {
+			token_source& source;
+			/* the brackets seen so far that are not closed yet, innermost last */
+			std::vector<std::uint32_t> open_brackets {};
+
+			void append(std::span<const token> toks) noexcept {
+				for (const token& tok : toks) {
+					switch (tok.id) {
+					/* Comments and newlines mean nothing to the grammar. */
+					case tok_line_comment:
+					case tok_block_comment:
+					case tok_newline:
+					case tok_tab:
+						continue;
+					default:
+						break;
+					}
+					const std::uint32_t index
+					     = static_cast<std::uint32_t>(source.tokens.size());
+					source.tokens.push_back(tok);
+					source.matching_brackets.push_back(token_source::no_matching_bracket);
+					switch (tok.id) {
+					case tok_l_paren:
+					case tok_l_square_bracket:
+					case tok_l_curly_bracket:
+						open_brackets.push_back(index);
+						break;
+					case tok_r_paren:
+						close(index, tok_l_paren);
+						break;
+					case tok_r_square_bracket:
+						close(index, tok_l_square_bracket);
+						break;
+					case tok_r_curly_bracket:
+						close(index, tok_l_curly_bracket);
+						break;
+					default:
+						break;
+					}
+				}
+			}
+
+		private:
+			void close(std::uint32_t index, token_id opening_id) noexcept {
+				// a stray closing bracket stays unmatched, as does whatever it fails to close
+				if (open_brackets.empty()
+				     || source.tokens[open_brackets.back()].id != opening_id) {
+					return;
+				}
+				source.matching_brackets[index]                 = open_brackets.back();
+				source.matching_brackets[open_brackets.back()] = index;
+				open_brackets.pop_back();
+			}
+		};
+
+		/* Hands the parser tokens from a lexer running on another thread, a batch at a time,
+		 * as it asks for them. */
+		struct token_feed {
+			token_source_builder builder;
+			token_queue& queue;
+			/* whether the last batch has been taken */
+			bool finished = false;
+
+			/* Takes the next batch into the token source, if there is one. */
+			bool pull() noexcept {
+				if (finished) {
+					return false;
+				}
+				const token_batch& batch = queue.front();
+				builder.append(std::span<const token>(batch.tokens.data(), batch.size));
+				finished = batch.is_last;
+				queue.release();
+				return true;
+			}
+
+			/* Whether there is a token at `index`, waiting for the lexer to get to it. */
+			bool fetch(std::size_t index) noexcept {
+				while (index >= builder.source.tokens.size()) {
+					if (!pull()) {
+						return false;
+					}
+				}
+				return true;
+			}
+		};
+
+		/* Where the external declaration that starts at `begin` ends, using nothing but the
+		 * brackets: just after the `;` outside of any brackets that ends a declaration, or the
+		 * `}` that closes the body of a function definition. The body is told apart from the
+		 * braces of a structure or an initializer by what comes before its `{`: the `)` of a
+		 * parameter list (or the `]` of an attribute), with no `=` earlier in the declaration.
+		 * A declaration that runs off the end of the tokens ends with them. Tokens (and the
+		 * brackets that close the ones already there) are taken from `feed`, if there is one,
+		 * as they are needed. Returns nothing if some bracket at the top level is unmatched,
+		 * since then there is no telling where anything ends. */
+		std::optional<std::size_t> end_of_external_declaration(const token_sequence& toks,
+		     const std::vector<std::uint32_t>& matching_brackets, std::size_t begin,
+		     token_feed* feed) noexcept {
+			bool initialized = false;
+			for (std::size_t index = begin;
+			     index < toks.size() || (feed != nullptr && feed->fetch(index)); ++index) {
+				switch (toks[index].id) {
+				case tok_semicolon:
+					return index + 1;
+				case tok_equals_sign:
+					initialized = true;
+					break;
+				case tok_l_paren:
+				case tok_l_square_bracket:
+				case tok_l_curly_bracket: {
+					while (matching_brackets[index] == token_source::no_matching_bracket
+					     && feed != nullptr && feed->pull()) {
+						continue;
+					}
+					const std::uint32_t closing_index = matching_brackets[index];
+					if (closing_index == token_source::no_matching_bracket) {
+						return std::nullopt;
+					}
+					const bool is_function_body = toks[index].id == tok_l_curly_bracket
+					     && index > begin && !initialized
+					     && (toks[index - 1].id == tok_r_paren
+					          || toks[index - 1].id == tok_r_square_bracket);
+					index = closing_index;
+					if (is_function_body) {
+						return index + 1;
+					}
+				} break;
+				default:
+					break;
+				}
+			}
+			return toks.size();
+		}
+
+		/* Whether a parser traces the rules it enters and what it decides along the way
+		 * (-fdebug-parser), and whether it profiles what each rule costs (-fprofile-parser).
+		 * The parser is instantiated for each combination, and which one runs is picked once
+		 * per parse, so a parser that does neither has all of it compiled out rather than
+		 * checking flags in every rule. */
+		template <bool Tracing, bool Profiling>
+		struct parse_instrumentation {
+			inline static constexpr const bool tracing   = Tracing;
+			inline static constexpr const bool profiling = Profiling;
+		};
+
+		/* What entering a rule makes when it is not traced or profiled: nothing. */
+		struct uninstrumented_scope { };
+
+		/* Stands in for the profiler of a parser that does not profile. */
+		struct no_parse_profiler { };
+
+		/* Profiles one call of a rule, from where it is made until it is destroyed. */
+		struct profiled_rule_scope {
+			parse_profiler& profiler;
+			const std::size_t& token_index;
+			parse_profiler::open_rule opened;
+
+			profiled_rule_scope(parse_profiler& profiler, std::string_view name,
+			     const std::size_t& token_index) noexcept
+			: profiler(profiler)
+			, token_index(token_index)
+			, opened(profiler.enter(name, token_index)) {
+			}
+			profiled_rule_scope(const profiled_rule_scope&) = delete;
+
+			~profiled_rule_scope() noexcept {
+				profiler.exit(opened, token_index);
+			}
+		};
+
+		/* A diagnostic with one argument, to be reported later. */
+		struct held_diagnostic {
+			const parser_diagnostic* diagnostic;
+			source_location location;
+			std::string argument;
+		};
+
+		/* The rules a function definition starts with that a declaration starts with too. */
+		enum class memoized_rule : unsigned char {
+			declaration_specifiers,
+			declarator,
+		};
+	} // namespace
+
+	template <typename Instrumentation>
 	struct parser {
 		using next_token_t = std::expected<std::reference_wrapper<const token>,
 		     std::reference_wrapper<const parser_diagnostic>>;
+		struct memo_entry;
 
 		std::size_t m_toks_index;
-		std::size_t m_last_identifier_string_index = 0;
-		std::vector<std::size_t> m_token_history_stack;
-		token_vector const& m_toks;
+		token_sequence const& m_toks;
+		std::vector<std::uint32_t> const& m_matching_brackets;
+		type_table& m_types;
+		symbol_table& m_symbols;
+		constant_table& m_constants;
 		parser_diagnostic_reporter& m_reporter;
 		const global_options& m_global_opts;
+		/* what types are like on the target: the widest `_BitInt`, and what constant
+		 * expressions and layouts use */
+		target_abi m_abi;
 		logger m_debug_logger;
-
-		/* Which ident are we operating on? This allows us to get a handle to the
-		 * string representation of an id. */
-		std::size_t id_index = 0;
-
-		constexpr parser(std::size_t toks_index, token_vector const& toks,
-		     parser_diagnostic_reporter& reporter, const global_options& global_opts) noexcept
+		/* the node every external declaration is a child of */
+		ast_node_id m_translation_unit;
+		/* diagnostics about constants and malformed expressions, held back until the external
+		 * declaration they are in is parsed for good, so that an attempt that is rolled back
+		 * takes its own with it */
+		std::vector<held_diagnostic> m_held_diagnostics;
+		/* whether the last expression that failed to parse ran into something the expression
+		 * parser does not know yet, rather than into a mistake */
+		bool m_met_unparsed_expression;
+		/* where more tokens come from while `m_toks` is still being lexed, if it is */
+		token_feed* m_feed;
+		/* When the same tokens are parsed more than once, as the pre-scan and then the
+		 * batches of a parallel parse do, the structure or union each body declared, by the
+		 * index of its `{`: every parse of a body then agrees on its type. */
+		std::unordered_map<std::uint32_t, type>* m_record_bodies;
+		/* what the rules a failed function definition shares with a declaration made, oldest
+		 * first (see `memo_entry`) */
+		std::vector<memo_entry> m_memo;
+		/* for -fdebug-parser */
+		std::size_t m_memo_lookups;
+		std::size_t m_memo_saved_reparses;
+		/* counting does not change what is parsed, so a const query can count too */
+		[[no_unique_address]] mutable std::conditional_t<Instrumentation::profiling,
+		     parse_profiler, no_parse_profiler>
+		     m_profiler;
+
+		constexpr parser(std::size_t toks_index, token_source const& source,
+		     type_table& types, symbol_table& symbols, constant_table& constants,
+		     parser_diagnostic_reporter& reporter, const global_options& global_opts,
+		     token_feed* feed = nullptr) noexcept
 		: m_toks_index(toks_index)
-		, m_toks(toks)
+		, m_toks(source.tokens)
+		, m_matching_brackets(source.matching_brackets)
+		, m_types(types)
+		, m_symbols(symbols)
+		, m_constants(constants)
 		, m_reporter(reporter)
 		, m_global_opts(global_opts)
+		, m_abi(target_abi::x86_64_sysv())
 		, m_debug_logger(
-		       reporter.handles().debug_handle(), reporter.handles().c_debug_handle(), 1) {
+		       reporter.handles().debug_handle(), reporter.handles().c_debug_handle(), 1)
+		, m_translation_unit()
+		, m_held_diagnostics()
+		, m_met_unparsed_expression(false)
+		, m_feed(feed)
+		, m_record_bodies(nullptr)
+		, m_memo()
+		, m_memo_lookups(0)
+		, m_memo_saved_reparses(0)
+		, m_profiler() {
+		}
+
+		parser(const parser&) = delete;
+
+		~parser() noexcept {
+			if constexpr (Instrumentation::profiling) {
+				record_parse_profile(m_profiler.profile());
+			}
+		}
+
+		/* Traces entering the rule `name` until whatever this returns is destroyed. */
+		auto trace_rule(std::string_view name) noexcept {
+			if constexpr (Instrumentation::tracing) {
+				return scope_logger(
+				     name,
+				     [this](logger& target) {
+					     const presumed_location loc
+					          = m_reporter.sources().presume(current_token().location);
+					     std::fprintf(target.c_handle(), ":%u:%u:", loc.lineno, loc.column);
+				     },
+				     m_debug_logger);
+			}
+			else {
+				return uninstrumented_scope {};
+			}
+		}
+
+		/* Profiles a call of the rule `name` until whatever this returns is destroyed. */
+		auto profile_rule(std::string_view name) noexcept {
+			if constexpr (Instrumentation::profiling) {
+				return profiled_rule_scope(m_profiler, name, m_toks_index);
+			}
+			else {
+				return uninstrumented_scope {};
+			}
+		}
+
+		/* Counts `token_count` tokens looked at ahead of the current one. */
+		void count_look_ahead(std::size_t token_count) const noexcept {
+			if constexpr (Instrumentation::profiling) {
+				m_profiler.look_ahead(token_count);
+			}
+		}
+
+		/* Whether there is a token at `index`, which may mean waiting for it to be lexed. */
+		bool has_token(std::size_t index) const noexcept {
+			return index < m_toks.size() || (m_feed != nullptr && m_feed->fetch(index));
 		}
 
 		const token& current_token() noexcept {
+			/* Running off the end reads as an end-of-input token, so loops that stop on some
+			 * closing token do not also have to check for the end of the stream. */
+			static constexpr const token end_of_input_token { tok_end_of_input,
+				source_location() };
+			if (!has_token(m_toks_index)) {
+				return end_of_input_token;
+			}
 			const token& target_token = m_toks[m_toks_index];
 			return target_token;
 		}
 
 		next_token_t peek_token(std::size_t peek_by = 1) noexcept {
-			size_t current_toks_index = m_toks_index;
-			if (m_toks.size() - current_toks_index < peek_by) {
-				return std::unexpected(parser_err::out_of_tokens);
+			count_look_ahead(1);
+			if (!has_token(m_toks_index + peek_by)) {
+				return std::unexpected(std::cref(parser_err::out_of_tokens));
 			}
 			const token& target_token = m_toks[m_toks_index + peek_by];
 			return target_token;
@@ -80,16 +381,28 @@ namespace a_c_compiler {
 
 		next_token_t get_next_token() noexcept {
 			++m_toks_index;
-			if (m_toks_index == m_toks.size()) {
-				return std::unexpected(parser_err::out_of_tokens);
+			if (!has_token(m_toks_index)) {
+				return std::unexpected(std::cref(parser_err::out_of_tokens));
 			}
 			const token& target_token = m_toks[m_toks_index];
 			return target_token;
 		}
 
+		/* Where the token at `index` is, or the last token there is if that runs off the end,
+		 * for reporting what went wrong there. */
+		source_location location_at(std::size_t index) noexcept {
+			if (!has_token(index)) {
+				if (m_toks.empty()) {
+					return source_location();
+				}
+				index = m_toks.size() - 1;
+			}
+			return m_toks[index].location;
+		}
+
 		void advance_token_index(std::size_t advance_by = 1) noexcept {
-			ZTD_ASSERT_MESSAGE("Cannot advance beyond end of stream",
-			     advance_by < (m_toks.size() - m_toks_index));
+			ZTD_ASSERT_MESSAGE(
+			     "Cannot advance beyond end of stream", has_token(m_toks_index + advance_by));
 			m_toks_index += advance_by;
 		}
 
@@ -112,45 +425,75 @@ namespace a_c_compiler {
 			ZTD_ASSERT_MESSAGE("got unexpected token", got_token.id == expected_token);
 		}
 
-		void pop_token_index() {
-			m_toks_index = m_token_history_stack.back();
-			m_token_history_stack.pop_back();
-		}
+		/* Everything a speculative parse can change, as it was before the attempt. */
+		struct checkpoint {
+			std::size_t token_index;
+			type_table::checkpoint types;
+			symbol_table::checkpoint symbols;
+			ast_node_table::checkpoint nodes;
+			constant_table::checkpoint constants;
+			std::size_t held_diagnostic_count;
+			std::size_t memo_entry_count;
+			/* for the profiler, if there is one */
+			std::size_t profiled_calls;
+		};
 
-		void push_token_index() {
-			m_token_history_stack.push_back(m_toks_index);
+		checkpoint save_checkpoint(ast_node_table& nodes) noexcept {
+			std::size_t profiled_calls = 0;
+			if constexpr (Instrumentation::profiling) {
+				profiled_calls = m_profiler.save();
+			}
+			return checkpoint { m_toks_index, m_types.save(), m_symbols.save(), nodes.save(),
+				m_constants.save(), m_held_diagnostics.size(), m_memo.size(), profiled_calls };
 		}
 
-		bool has_more_tokens() noexcept {
-			return m_toks_index < m_toks.size();
+		/* Where the parser is now, as a checkpoint that was never marked: rolling back to it
+		 * has to happen from inside a checkpoint marked before it, and closes that one. */
+		checkpoint current_position(const ast_node_table& nodes) const noexcept {
+			std::size_t profiled_calls = 0;
+			if constexpr (Instrumentation::profiling) {
+				profiled_calls = m_profiler.position();
+			}
+			return checkpoint { m_toks_index, m_types.save(), m_symbols.save(),
+				nodes.position(), m_constants.save(), m_held_diagnostics.size(), m_memo.size(),
+				profiled_calls };
 		}
 
-		token find_first_of(const std::vector<token_id>& toks) noexcept {
-			push_token_index();
-			while (std::find(toks.begin(), toks.end(), current_token().id) == toks.end()) {
-				if (!get_next_token().has_value()) {
-					break;
-				}
+		/* Puts the parser back where it was at `saved`, and drops every node, type,
+		 * declaration, evaluated constant and memo entry made since, so a failed attempt
+		 * leaves nothing behind. `site` names where the parser backtracked for the profiler;
+		 * empty means the innermost rule. */
+		void rollback_checkpoint(ast_node_table& nodes, const checkpoint& saved,
+		     std::string_view site = {}) noexcept {
+			if constexpr (Instrumentation::profiling) {
+				m_profiler.rollback(
+				     saved.profiled_calls, site, saved.token_index, m_toks_index);
 			}
-			token found_tok = current_token();
-			pop_token_index();
-			return found_tok;
+			m_toks_index = saved.token_index;
+			m_types.rollback(saved.types);
+			m_symbols.rollback(saved.symbols);
+			nodes.rollback(saved.nodes);
+			m_constants.rollback(saved.constants);
+			m_held_diagnostics.resize(saved.held_diagnostic_count);
+			m_memo.erase(m_memo.begin() + saved.memo_entry_count, m_memo.end());
 		}
 
-		std::string_view next_id_value() noexcept {
-			id_index++;
-			return current_id_value();
+		void commit_checkpoint(ast_node_table& nodes, const checkpoint& saved) noexcept {
+			if constexpr (Instrumentation::profiling) {
+				m_profiler.commit();
+			}
+			nodes.commit(saved.nodes);
 		}
 
-		std::string_view current_id_value() const noexcept {
-			return lexed_id(id_index);
+		bool has_more_tokens() noexcept {
+			return has_token(m_toks_index);
 		}
 
-#define KEYWORD_TOKEN(TOK, INTVAL, KEYWORD)                                                        \
-	bool parse_##KEYWORD(translation_unit& tu) {                                                  \
-		auto const& tok = current_token();                                                       \
-		m_reporter.report(parser_err::unimplemented_keyword, "", tok.source_location, #KEYWORD); \
-		return false;                                                                            \
+#define KEYWORD_TOKEN(TOK, INTVAL, KEYWORD)                                             \
+	bool parse_##KEYWORD(ast_node_table& nodes) {                                     \
+		auto const& tok = current_token();                                            \
+		m_reporter.report(parser_err::unimplemented_keyword, tok.location, #KEYWORD); \
+		return false;                                                                 \
 	}
 #include <a_c_compiler/fe/lex/tokens.inl.h>
 #undef KEYWORD_TOKEN
@@ -158,232 +501,133 @@ namespace a_c_compiler {
 		using maybe_attribute_t
 		     = std::expected<attribute, std::reference_wrapper<const parser_diagnostic>>;
 
-		enum class balanced_token_seq_behavior {
-			normal         = 0b00,
-			ignore_initial = 0b01,
-			ignore_all     = 0b10
-		};
-
-		enum class balanced_delimeter {
-			parenthesis    = 0,
-			square_bracket = 1,
-			curly_bracket  = 2,
-		};
-
-		struct seen_delimeter {
-			size_t& count;
-			balanced_delimeter delimeter;
-		};
-
-		struct balanced_token_delimeters {
-			size_t parentheses;
-			size_t curly_brackets;
-			size_t square_brackets;
-			std::optional<balanced_delimeter> last_seen;
-
-			[[nodiscard]] constexpr bool unclosed_delimeters() const noexcept {
-				return last_seen.has_value();
-			}
-		};
-
-		template <typename OnToken>
-		balanced_token_delimeters consume_balanced_token_sequence(OnToken&& on_token,
-		     balanced_token_seq_behavior behavior,
-		     balanced_delimeter initial_delimeter = balanced_delimeter::parenthesis) noexcept {
-			balanced_token_delimeters delimeters = {};
-			std::vector<balanced_delimeter> delimeter_stack(
-			     &initial_delimeter, &initial_delimeter + 1);
-
-			for (; delimeters.unclosed_delimeters();) {
-				if (!has_more_tokens()) {
-					break;
-				}
-				// keep going until the sequence is terminated
-				const token& tok                  = current_token();
-				const auto maybe_manage_delimeter = [&tok, &delimeter_stack,
-				                                         &delimeters]() noexcept {
-					switch (tok.id) {
-					case tok_l_paren:
-						delimeter_stack.push_back(balanced_delimeter::parenthesis);
-						++delimeters.parentheses;
-						break;
-					case tok_l_square_bracket:
-						delimeter_stack.push_back(balanced_delimeter::square_bracket);
-						++delimeters.square_brackets;
-						break;
-					case tok_l_curly_bracket:
-						delimeter_stack.push_back(balanced_delimeter::curly_bracket);
-						++delimeters.curly_brackets;
-						break;
-					case tok_r_paren:
-						if (delimeter_stack.back() != balanced_delimeter::parenthesis) {
-							return;
-						}
-						delimeter_stack.pop_back();
-						--delimeters.parentheses;
-						break;
-					case tok_r_square_bracket:
-						if (delimeter_stack.back() != balanced_delimeter::square_bracket) {
-							return;
-						}
-						delimeter_stack.pop_back();
-						--delimeters.square_brackets;
-						break;
-					case tok_r_curly_bracket:
-						if (delimeter_stack.back() != balanced_delimeter::curly_bracket) {
-							return;
-						}
-						delimeter_stack.pop_back();
-						--delimeters.curly_brackets;
-						break;
-					default:
-						break;
-					}
-				};
-				maybe_manage_delimeter();
-				if (behavior == balanced_token_seq_behavior::ignore_initial
-				     && delimeter_stack.size() == 0) {
-					break;
-				}
-				if (!on_token(tok)) {
-					break;
-				}
-			}
-			if (!delimeter_stack.empty()) {
-				delimeters.last_seen = delimeter_stack.back();
-			}
-			return delimeters;
-		}
-
+		/*
+		 * attribute ::= attribute-token attribute-argument-clause?
+		 * attribute-token ::= identifier | identifier :: identifier
+		 * attribute-argument-clause ::= ( balanced-token-sequence? )
+		 *
+		 * The attribute keeps its tokens as a range, from its first identifier to the end of
+		 * its arguments (if any).
+		 */
 		maybe_attribute_t parse_attribute() noexcept {
-			// `attribute-token`
 			// TODO: store attribute token names
-			attribute attr {};
-			const token& first_token = current_token();
-			if (first_token.id != tok_id) {
+			const std::size_t begin_index = m_toks_index;
+			if (current_token().id != tok_id) {
 				// failure
-				return std::unexpected(parser_err::expected_attribute_identifier);
+				return std::unexpected(std::cref(parser_err::expected_attribute_identifier));
 			}
-			attr.tokens.push_back(first_token);
-			advance_token_index(1);
+			get_next_token();
 			constexpr const auto next_token_is_colon = [](const next_token_t& maybe_next_tok) {
 				return maybe_next_tok.has_value() && maybe_next_tok->get().id == tok_colon;
 			};
 			for (; current_token().id == tok_colon && next_token_is_colon(peek_token());) {
-				advance_token_index(2);
-				const token& expecting_id_tok = current_token();
-				if (expecting_id_tok.id != tok_id) {
+				m_toks_index += 2;
+				if (current_token().id != tok_id) {
 					// failure
-					return std::unexpected(parser_err::expected_attribute_identifier);
+					return std::unexpected(
+					     std::cref(parser_err::expected_attribute_identifier));
 				}
-				attr.tokens.push_back(expecting_id_tok);
-				advance_token_index(1);
+				get_next_token();
 			}
 			if (current_token().id == tok_l_paren) {
-				// expect attribute arguments are this point, and consume a balanced
-				// token sequence, started with
-				// `( balanced-token-seq )`
-				// consume all attribute arguments
-				attr.tokens.push_back(current_token());
-				const auto on_token = [&attr](const token& tok) noexcept {
-					attr.tokens.push_back(tok);
-					return true;
-				};
-				advance_token_index(1);
-				balanced_token_delimeters delimeters = consume_balanced_token_sequence(on_token,
-				     balanced_token_seq_behavior::ignore_initial,
-				     balanced_delimeter::parenthesis);
-				if (delimeters.unclosed_delimeters()) {
-					const token& stop_token = current_token();
-					m_reporter.report(parser_err::unbalanced_token_sequence, "",
-					     stop_token.source_location, (char)stop_token.id);
+				// `( balanced-token-seq )`: the bracket table already knows where it ends
+				auto maybe_closing_index = find_matching_bracket();
+				if (!maybe_closing_index) {
+					return std::unexpected(std::cref(parser_err::unbalanced_token_sequence));
 				}
+				m_toks_index = *maybe_closing_index + 1;
 			}
-			return attr;
+			return attribute { token_range { static_cast<std::uint32_t>(begin_index),
+				static_cast<std::uint32_t>(m_toks_index) } };
 		}
 
+		/*
+		 * attribute-list ::=
+		 *    attribute?
+		 *    | attribute-list , attribute?
+		 */
 		size_t parse_attribute_list(std::vector<attribute>& attributes) noexcept {
 			size_t number_of_successfully_parsed_attributes = 0;
-			// loop until double r square bracket
 			for (;;) {
 				const token& tok = current_token();
 				switch (tok.id) {
 				case tok_comma:
 					// this means we COULD get another attribute; just loop around
+					get_next_token();
 					break;
-				case tok_r_square_bracket: {
-					auto maybe_expected_second_r_square_bracket = peek_token();
-					if (!maybe_expected_second_r_square_bracket.has_value()) {
-						return number_of_successfully_parsed_attributes; // there are no more
-						                                                 // tokens? No more
-						                                                 // attributes.
-					}
-					const token& expected_second_r_square_bracket
-					     = *maybe_expected_second_r_square_bracket;
-					if (expected_second_r_square_bracket.id == tok_r_square_bracket) {
-						// we are finished and we can leave.
-						return number_of_successfully_parsed_attributes;
-					}
-				} break;
+				case tok_r_square_bracket:
+				case tok_end_of_input:
+					return number_of_successfully_parsed_attributes;
 				default: {
 					auto maybe_current_attribute = parse_attribute();
-					if (maybe_current_attribute.has_value()) {
-						attributes.push_back(std::move(*maybe_current_attribute));
-						++number_of_successfully_parsed_attributes;
+					if (!maybe_current_attribute.has_value()) {
+						// at the token it went wrong at, which some diagnostics name
+						m_reporter.report(maybe_current_attribute.error(),
+						     location_at(m_toks_index), token_spelling(current_token().id));
+						return number_of_successfully_parsed_attributes;
 					}
+					attributes.push_back(*maybe_current_attribute);
+					++number_of_successfully_parsed_attributes;
 				} break;
 				}
 			}
-			return true;
 		}
 
+		/*
+		 * attribute-specifier-sequence ::=
+		 *    attribute-specifier-sequence? attribute-specifier
+		 *
+		 * attribute-specifier ::= [ [ attribute-list ] ]
+		 */
 		size_t parse_attribute_specifier_sequence(
-		     translation_unit& tu, std::vector<attribute>& attributes) noexcept {
+		     ast_node_table& nodes, std::vector<attribute>& attributes) noexcept {
 			ENTER_PARSE_FUNCTION();
 			std::size_t number_of_successfully_parsed_attribute_specifiers = 0;
+			const auto next_token_is = [this](token_id id) noexcept {
+				auto maybe_next_token = peek_token();
+				return maybe_next_token.has_value() && maybe_next_token->get().id == id;
+			};
 			for (;;) {
-				auto maybe_expected_second_l_square_bracket = peek_token();
-				const token& expected_l_square_bracket      = current_token();
-				if (expected_l_square_bracket.id != tok_l_square_bracket
-				     || !maybe_expected_second_l_square_bracket.has_value()) {
-					return number_of_successfully_parsed_attribute_specifiers;
-				}
-				const token& expected_second_l_square_bracket
-				     = *maybe_expected_second_l_square_bracket;
-				if (expected_second_l_square_bracket.id != tok_l_square_bracket) {
+				if (current_token().id != tok_l_square_bracket
+				     || !next_token_is(tok_l_square_bracket)) {
 					return number_of_successfully_parsed_attribute_specifiers;
 				}
-				advance_token_index(2);
+				m_toks_index += 2;
 				size_t successfully_parsed_attributes = parse_attribute_list(attributes);
 				number_of_successfully_parsed_attribute_specifiers
 				     += successfully_parsed_attributes;
-				eat_token(tok_r_square_bracket);
+				const token& closing_token = current_token();
+				if (closing_token.id != tok_r_square_bracket
+				     || !next_token_is(tok_r_square_bracket)) {
+					m_reporter.report(parser_err::unbalanced_token_sequence,
+					     location_at(m_toks_index), token_spelling(closing_token.id));
+					return number_of_successfully_parsed_attribute_specifiers;
+				}
+				m_toks_index += 2;
 			}
-
-			return number_of_successfully_parsed_attribute_specifiers;
 		}
 
 		bool parse_storage_class_specifier(
-		     translation_unit& tu, function_definition& fd, type ty) noexcept {
+		     ast_node_table& nodes, function_definition& fd) noexcept {
 			ENTER_PARSE_FUNCTION();
 			switch (current_token().id) {
 			case tok_keyword_static:
-				ty.data().specifiers |= storage_class_specifier::scs_static;
+				fd.declaration.storage_classes |= storage_class_specifier::scs_static;
 				break;
 			case tok_keyword_extern:
-				ty.data().specifiers |= storage_class_specifier::scs_extern;
+				fd.declaration.storage_classes |= storage_class_specifier::scs_extern;
 				break;
 			case tok_keyword_constexpr:
-				ty.data().specifiers |= storage_class_specifier::scs_constexpr;
+				fd.declaration.storage_classes |= storage_class_specifier::scs_constexpr;
 				break;
 			case tok_keyword_register:
-				ty.data().specifiers |= storage_class_specifier::scs_register;
+				fd.declaration.storage_classes |= storage_class_specifier::scs_register;
 				break;
 			case tok_keyword_thread_local:
-				ty.data().specifiers |= storage_class_specifier::scs_thread_local;
+				fd.declaration.storage_classes |= storage_class_specifier::scs_thread_local;
 				break;
 			case tok_keyword_typedef:
-				ty.data().specifiers |= storage_class_specifier::scs_typedef;
+				fd.declaration.storage_classes |= storage_class_specifier::scs_typedef;
 				break;
 			case tok_keyword_auto:
 				// While the C standard says this is a Storage Class Specifier, that is
@@ -395,7 +639,7 @@ namespace a_c_compiler {
 				//
 				// Otherwise, `auto` by itself means type deduction unless there's a real type
 				// in the type name at some point.
-				ty.data().specifiers |= storage_class_specifier::scs_auto;
+				fd.declaration.storage_classes |= storage_class_specifier::scs_auto;
 				break;
 			default:
 				return false;
@@ -404,46 +648,56 @@ namespace a_c_compiler {
 			return true;
 		}
 
-		void merge_type_categories(type ty, type_category tc) {
+		void merge_type_categories(type_builder& ty, type_category tc) {
 			/* If the two type categories are given as type specifiers, they may need
 			 * to be merged. E.g. long int and long do not need to be merged, we can
 			 * just take the former. long double however must be merged together into
 			 * the long double type category. */
-#define TYPE_SPECIFIER_MERGE_RULE(BASETYPE, NEWTYPESPEC, NEWTYPE)                             \
-	if (ty.data().category == type_category::BASETYPE && tc == type_category::NEWTYPESPEC) { \
-		ty.data().category = type_category::NEWTYPE;                                        \
-		return;                                                                             \
+#define TYPE_SPECIFIER_MERGE_RULE(BASETYPE, NEWTYPESPEC, NEWTYPE)                        \
+	if (ty.category == type_category::BASETYPE && tc == type_category::NEWTYPESPEC) { \
+		ty.category = type_category::NEWTYPE;                                          \
+		return;                                                                        \
 	}
 			TYPE_SPECIFIER_MERGE_RULE(tc_long, tc_double, tc_longdouble);
 			TYPE_SPECIFIER_MERGE_RULE(tc_long, tc_longdouble, tc_longlongdouble);
 			TYPE_SPECIFIER_MERGE_RULE(tc_long, tc_int, tc_long);
+			TYPE_SPECIFIER_MERGE_RULE(tc_long, tc_long, tc_longlong);
 			TYPE_SPECIFIER_MERGE_RULE(tc_longlong, tc_int, tc_longlong);
+			TYPE_SPECIFIER_MERGE_RULE(tc_short, tc_int, tc_short);
 #undef TYPE_SPECIFIER_MERGE_RULE
 			/* If none of the rules match, just assign the new type to the function's
 			 * type category */
-			ty.data().category = tc;
+			ty.category = tc;
 		}
 
-		void merge_type_categories(type ty, type_modifier tm) {
-			ZTD_ASSERT_MESSAGE("unexpected multiple type modifiers",
-			     ty.data().modifier == type_modifier::tm_none);
-			ty.data().modifier = tm;
+		void merge_type_categories(type_builder& ty, type_modifier tm) {
+			ZTD_ASSERT_MESSAGE(
+			     "unexpected multiple type modifiers", ty.modifier == type_modifier::tm_none);
+			ty.modifier = tm;
+		}
+
+		/* Whether the type specifiers in `ty` make a type, now that there are no more of them:
+		 * a signed `_BitInt` needs a sign bit and a value bit. */
+		bool completes_type_specifiers(const type_builder& ty) const noexcept {
+			return ty.category != type_category::tc__BitInt || ty.extent >= 2
+			     || ty.modifier == type_modifier::tm_unsigned;
 		}
 
-		bool parse_type_specifier(translation_unit& tu, function_definition& fd, type ty) {
+		bool parse_type_specifier(
+		     ast_node_table& nodes, function_definition& fd, type_builder& ty) {
 			ENTER_PARSE_FUNCTION();
 			switch (current_token().id) {
 			case tok_keyword_void:
-				ty.data().category = type_category::tc_void;
+				ty.category = type_category::tc_void;
 				break;
 			case tok_keyword_char:
-				ty.data().category = type_category::tc_char;
+				ty.category = type_category::tc_char;
 				break;
 			case tok_keyword_bool:
-				ty.data().category = type_category::tc_bool;
+				ty.category = type_category::tc_bool;
 				break;
 			case tok_keyword_short:
-				ty.data().category = type_category::tc_short;
+				ty.category = type_category::tc_short;
 				break;
 			case tok_keyword_int:
 				merge_type_categories(ty, type_category::tc_int);
@@ -463,16 +717,32 @@ namespace a_c_compiler {
 			case tok_keyword_unsigned:
 				merge_type_categories(ty, type_modifier::tm_unsigned);
 				break;
+			case tok_id:
+				if (!parse_typedef_name(ty)) {
+					return false;
+				}
+				break;
+			case tok_keyword_struct:
+			case tok_keyword_union:
+				// takes its own tokens, body and all
+				return parse_struct_or_union_specifier(nodes, ty);
+			case tok_keyword__Padding:
+				if (!parse_padding_specifier(nodes, ty)) {
+					return false;
+				}
+				break;
 			case tok_keyword__BitInt:
+				if (!parse_bit_int_specifier(nodes, ty)) {
+					return false;
+				}
+				break;
 			case tok_keyword__Complex:
 				// case tok_keyword__Decimal32: TODO
 				// case tok_keyword__Decimal64: TODO
 				// case tok_keyword__Decimal128: TODO
 				ZTD_ASSERT_MESSAGE("unsupported type specifier", false);
 				// TODO: atomic-type-specifier
-				// TODO: struct-or-union-specifier
 				// TODO: enum-specifier
-				// TODO: typedef-name
 				// TODO: typeof-specifier
 			default:
 				return false;
@@ -481,255 +751,1912 @@ namespace a_c_compiler {
 			return true;
 		}
 
-		bool parse_type_qualifier(translation_unit& tu, function_definition& fd, type ty) {
-			ENTER_PARSE_FUNCTION();
-			return false;
-		}
-
-		bool parse_alignment_specifier(translation_unit& tu, function_definition& fd, type ty) {
-			ENTER_PARSE_FUNCTION();
-			return false;
-		}
-
 		/*
-		 * type_specifier_qualifier ::= type-specifier | type-qualifier | alignment-specifier
+		 * typedef-name ::= identifier
+		 *
+		 * An identifier is a typedef-name only if a typedef declared it and nothing has hidden it
+		 * since, and only if no other type specifier came before it: in `my_int x;`, `x` is the
+		 * declarator even if it happens to name a type too. The type takes on everything the
+		 * typedef-name stands for; `typedef` itself belongs to the declaration, not the type.
 		 */
-		bool parse_type_specifier_qualifier(
-		     translation_unit& tu, function_definition& fd, type ty) {
-			ENTER_PARSE_FUNCTION();
-			if (parse_type_specifier(tu, fd, ty))
-				return true;
-			if (parse_type_qualifier(tu, fd, ty))
-				return true;
-			if (parse_alignment_specifier(tu, fd, ty))
-				return true;
-			return false;
-		}
-
-		bool parse_function_specifier(translation_unit& tu, function_definition& fd) {
-			ENTER_PARSE_FUNCTION();
-			switch (current_token().id) {
-			case tok_keyword_inline:
-				fd.declaration.funcspecs |= function_specifier::funcspec_inline;
-				break;
-			case tok_keyword__Noreturn:
-				fd.declaration.funcspecs |= function_specifier::funcspec__Noreturn;
-				break;
-			default:
+		bool parse_typedef_name(type_builder& ty) noexcept {
+			if (!ty.empty()) {
 				return false;
 			}
-			get_next_token();
+			const type* aliased
+			     = m_symbols.find_typedef_name(current_token().identifier());
+			if (aliased == nullptr) {
+				return false;
+			}
+			take_type(ty, *aliased);
 			return true;
 		}
 
-		/*
-		 * declaration-specifier ::=
-		 *    storage-class-specifier
-		 *    | type-specifier-qualifier
-		 *    | function-specifier
-		 */
-		bool parse_declaration_specifier(translation_unit& tu, function_definition& fd, type ty) {
-			ENTER_PARSE_FUNCTION();
-			if (parse_storage_class_specifier(tu, fd, ty))
-				return true;
-
-			if (parse_type_specifier_qualifier(tu, fd, ty))
-				return true;
+		/* Makes `ty` the type `t`, keeping whatever alignment specifiers and type qualifiers
+		 * before it asked for. */
+		void take_type(type_builder& ty, type t) noexcept {
+			const std::uint8_t alignment_log2 = ty.alignment_log2;
+			const qualifier qualifiers        = ty.qualifiers;
+			ty                                = m_types.builder(t);
+			ty.alignment_log2                 = std::max(ty.alignment_log2, alignment_log2);
+			ty.qualifiers                     = add_qualifier(ty.qualifiers, qualifiers);
+		}
 
-			if (parse_function_specifier(tu, fd))
-				return true;
+		/* Evaluates `expression`, which is kept in the constant table from then on (see
+		 * `constant_evaluator`). */
+		constant_result evaluate_constant(
+		     const ast_node_table& nodes, ast_node_id expression) noexcept {
+			return constant_evaluator_for(nodes).evaluate(expression);
+		}
 
-			return false;
+		constant_evaluator constant_evaluator_for(const ast_node_table& nodes) noexcept {
+			const constant_limits limits { m_global_opts.constexpr_step_limit(),
+				m_global_opts.constexpr_depth_limit() };
+			return constant_evaluator(
+			     nodes, m_toks, m_types, m_symbols, m_constants, limits, m_abi);
 		}
 
-		/*
-		 * declaration-specifiers ::=
-		 *    declaration-specifier attribute-specifier-sequence?
-		 *    | declaration-specifier declaration-specifiers
-		 */
-		bool parse_declaration_specifiers(
-		     translation_unit& tu, function_definition& fd, type ty) {
-			ENTER_PARSE_FUNCTION();
-			while (parse_declaration_specifier(tu, fd, ty)) {
-				// parse_attribute_specifier_sequence(tu, fd, ty);
+		/* The value of the integer constant expression at the current token, taking its
+		 * tokens: a conditional-expression, evaluated as soon as it is parsed. Its nodes belong
+		 * to nothing. If there is no such expression, or its value is not an integer that is
+		 * not negative and fits in 64 bits, this is nothing, and the expression is dropped and
+		 * left where it is. */
+		std::optional<std::uint64_t> parse_integer_constant(ast_node_table& nodes) {
+			const checkpoint saved = save_checkpoint(nodes);
+			const ast_node_id parsed
+			     = parse_expression(nodes, conditional_expression_binding_power);
+			if (parsed.is_valid()) {
+				const constant_result value = evaluate_constant(nodes, parsed);
+				if (value && !value->is_floating() && value->integer.fits_in(64, true)) {
+					commit_checkpoint(nodes, saved);
+					return value->integer.low_bits();
+				}
 			}
-
-			/* empty declspecs is valid */
-			return true;
+			rollback_checkpoint(nodes, saved);
+			return std::nullopt;
 		}
 
 		/*
+		 * padding-specifier ::= _Padding ( constant-expression )
 		 *
+		 * Extension: that many bits that nothing is kept in, for spelling out the holes in a
+		 * structure. Left on the `)`, like any other type specifier's last token.
 		 */
-		bool parse_type_qualifier_list(translation_unit tu, function_definition fd) {
-			ENTER_PARSE_FUNCTION();
-			return false;
+		bool parse_padding_specifier(ast_node_table& nodes, type_builder& ty) {
+			if (!ty.empty()) {
+				return false;
+			}
+			get_next_token();
+			if (current_token().id != tok_l_paren) {
+				return false;
+			}
+			get_next_token();
+			std::optional<std::uint64_t> width = parse_integer_constant(nodes);
+			if (!width || *width > std::numeric_limits<std::uint32_t>::max()
+			     || current_token().id != tok_r_paren) {
+				return false;
+			}
+			ty.category = type_category::tc__Padding;
+			ty.extent   = static_cast<std::uint32_t>(*width);
+			return true;
 		}
 
 		/*
+		 * bit-precise-integer-specifier ::= _BitInt ( constant-expression )
 		 *
+		 * An integer exactly that many bits wide, signed unless `unsigned` goes with it: at
+		 * least 1 and at most the target's `BITINT_MAXWIDTH`. Left on the `)`. A signed one
+		 * has to be at least 2 bits wide, but `unsigned` can still come after it, so that is
+		 * checked once the specifiers end (see `completes_type_specifiers`).
 		 */
-		bool parse_array_declarator(translation_unit tu, function_definition fd) {
-			ENTER_PARSE_FUNCTION();
-			return false;
-		}
-
-		bool parse_parameter_type_list(
-		     translation_unit tu, function_definition fd, std::vector<type>& typelist) {
-			ENTER_PARSE_FUNCTION();
-			return false;
-		}
-
-		/*
-		 * function-declarator ::=
-		 *      direct-declarator ( parameter-type-list? )
-		 */
-		bool parse_function_declarator(translation_unit tu, function_definition fd) {
-			ENTER_PARSE_FUNCTION();
-			std::string funcname;
-			push_token_index();
-			// should be parse_declarator
-			// if (!parse_declarator(tu, fd)) {
-			if (!parse_identifier(tu, fd, funcname)) {
-				pop_token_index();
+		bool parse_bit_int_specifier(ast_node_table& nodes, type_builder& ty) {
+			if (ty.category != type_category::tc_none) {
 				return false;
 			}
+			get_next_token();
 			if (current_token().id != tok_l_paren) {
-				pop_token_index();
 				return false;
 			}
 			get_next_token();
-			std::vector<type> typelist;
-			if (!parse_parameter_type_list(tu, fd, typelist)) {
-				pop_token_index();
+			std::optional<std::uint64_t> width = parse_integer_constant(nodes);
+			if (!width || *width == 0 || *width > m_abi.bit_int_max_width
+			     || current_token().id != tok_r_paren) {
 				return false;
 			}
-			eat_token(tok_r_paren);
+			ty.category = type_category::tc__BitInt;
+			ty.extent   = static_cast<std::uint32_t>(*width);
 			return true;
 		}
 
-
 		/*
-		 * pointer ::=
+		 * struct-or-union-specifier ::=
+		 *    struct-or-union attribute-specifier-sequence? identifier?
+		 *         { member-declaration-list }
+		 *    | struct-or-union attribute-specifier-sequence? identifier
+		 *
+		 * With a body, the structure or union is a new type with its members and declares its
+		 * tag, and becomes a struct_declaration with a member_declaration child per member.
+		 * Tags have file scope when they are not declared in a function or a parameter list, so
+		 * those declared at file scope or in the body of another become children of the
+		 * translation unit, in the order their bodies end. Without a body, it is whatever its
+		 * tag names; if that is nothing, the specifier declares the tag, as a structure or union
+		 * with no members (yet). A body for a tag declared that way in the same scope completes
+		 * that same type, so whatever used it while it was incomplete sees its members.
+		 */
+		bool parse_struct_or_union_specifier(ast_node_table& nodes, type_builder& ty) {
+			ENTER_PARSE_FUNCTION();
+			if (!ty.empty()) {
+				return false;
+			}
+			const bool is_union = current_token().id == tok_keyword_union;
+			const type_category category
+			     = is_union ? type_category::tc_union : type_category::tc_struct;
+			const symbol_kind tag_kind
+			     = is_union ? symbol_kind::union_tag : symbol_kind::struct_tag;
+			get_next_token();
+			std::vector<attribute> attributes;
+			parse_attribute_specifier_sequence(nodes, attributes);
+			identifier_id tag;
+			if (current_token().id == tok_id) {
+				tag = current_token().identifier();
+				get_next_token();
+			}
+			if (current_token().id != tok_l_curly_bracket) {
+				if (!tag.is_valid()) {
+					return false;
+				}
+				const symbol* declared = m_symbols.find(symbol_namespace::tag, tag);
+				if (declared != nullptr && declared->kind == tag_kind) {
+					take_type(ty, declared->t);
+					return true;
+				}
+				take_type(ty, declare_incomplete_tag(tag, category, tag_kind));
+				return true;
+			}
+			const std::uint32_t body_begin = static_cast<std::uint32_t>(m_toks_index);
+			get_next_token();
+			// The tag is in scope from its `{` on, but the type is not complete until the `}`.
+			const type record_type = record_for_body(body_begin, tag, category, tag_kind);
+			if (tag.is_valid()) {
+				m_symbols.declare(symbol_namespace::tag, tag, tag_kind, record_type);
+			}
+
+			const ast_node_id record
+			     = nodes.add_struct_declaration(struct_declaration { type(), tag, 0 });
+			for (attribute& attr : attributes) {
+				nodes.append_child(record, nodes.add_attribute(std::move(attr)));
+			}
+			type_builder record_builder;
+			record_builder.category = category;
+			std::size_t alignment   = 0;
+			m_symbols.push_scope(scope_kind::members);
+			while (current_token().id != tok_r_curly_bracket) {
+				if (!parse_member_declaration(nodes, record, record_builder, alignment)) {
+					m_symbols.pop_scope();
+					return false;
+				}
+			}
+			m_symbols.pop_scope();
+			get_next_token();
+
+			if (!m_types.is_complete_record(record_type)) {
+				m_types.complete_record(record_type, record_builder.sub_types);
+			}
+			struct_declaration& record_data = nodes.struct_declaration_data(record);
+			record_data.t                   = record_type;
+			record_data.alignment           = alignment;
+			if (tag.is_valid()) {
+				m_symbols.declare(symbol_namespace::tag, tag, tag_kind, record_type, record);
+			}
+			const scope_kind declared_in = m_symbols.current_scope_kind();
+			if (m_translation_unit.is_valid()
+			     && (declared_in == scope_kind::file || declared_in == scope_kind::members)) {
+				nodes.append_child(m_translation_unit, record);
+			}
+			take_type(ty, record_type);
+			return true;
+		}
+
+		/* The structure or union the body from `body_begin` completes: the one that
+		 * `m_record_bodies` has for it, if it has one; otherwise the one `tag` was declared as
+		 * without a body in the same scope, if it was; otherwise a new one. */
+		type record_for_body(std::uint32_t body_begin, identifier_id tag,
+		     type_category category, symbol_kind tag_kind) noexcept {
+			type* remembered = nullptr;
+			if (m_record_bodies != nullptr) {
+				auto [body, is_new] = m_record_bodies->try_emplace(body_begin);
+				// one from an attempt that was rolled back is gone, or is another type now
+				if (!is_new && body->second.index() < m_types.size()
+				     && m_types.data(body->second).category == category
+				     && m_types.data(body->second).extent == body->second.index()) {
+					return body->second;
+				}
+				remembered = &body->second;
+			}
+			const symbol* declared = tag.is_valid()
+			     ? m_symbols.find_in_current_scope(symbol_namespace::tag, tag)
+			     : nullptr;
+			const type record = declared != nullptr && declared->kind == tag_kind
+			          && !m_types.is_complete_record(declared->t)
+			     ? declared->t
+			     : m_types.declare_record(category);
+			if (remembered != nullptr) {
+				*remembered = record;
+			}
+			return record;
+		}
+
+		/* Declares `tag` as a structure or union with no members (yet). */
+		type declare_incomplete_tag(
+		     identifier_id tag, type_category category, symbol_kind tag_kind) noexcept {
+			const type declared_type = m_types.declare_record(category);
+			m_symbols.declare(symbol_namespace::tag, tag, tag_kind, declared_type);
+			return declared_type;
+		}
+
+		/*
+		 * member-declaration ::=
+		 *    attribute-specifier-sequence? specifier-qualifier-list member-declarator-list? ;
+		 *    | static_assert-declaration
+		 *
+		 * member-declarator-list ::=
+		 *    member-declarator
+		 *    | member-declarator-list , member-declarator
+		 *
+		 * member-declarator ::= declarator | declarator? : constant-expression
+		 *
+		 * Each member is added to the sub-types of `record_builder`, and as a
+		 * member_declaration child of `record`. A structure or union with no declarator is an
+		 * anonymous member, whose members are members of the one it is in. `alignment` is
+		 * raised to the strictest alignment specifier of any member.
+		 */
+		bool parse_member_declaration(ast_node_table& nodes, ast_node_id record,
+		     type_builder& record_builder, std::size_t& alignment) {
+			ENTER_PARSE_FUNCTION();
+			switch (current_token().id) {
+			case tok_keyword_static_assert:
+			case tok_keyword__Static_assert:
+				return parse_static_assert_declaration(nodes, record);
+			default:
+				break;
+			}
+			std::vector<attribute> attributes;
+			parse_attribute_specifier_sequence(nodes, attributes);
+			function_definition specifiers { function_declaration { type(), 0 }, token_range(),
+				ast_node_id() };
+			type_builder member_builder;
+			while (parse_type_specifier_qualifier(nodes, specifiers, member_builder)) {
+				continue;
+			}
+			if (member_builder.empty() || !completes_type_specifiers(member_builder)) {
+				return false;
+			}
+			const std::uint8_t alignment_log2 = member_builder.alignment_log2;
+			member_builder.alignment_log2     = 0;
+			const type base                   = m_types.intern(member_builder);
+			if (alignment_log2 != 0) {
+				alignment = std::max(alignment, std::size_t(1) << alignment_log2);
+			}
+			const auto add_member = [&](type member_type, identifier_id name,
+			                             std::size_t bit_field_size) {
+				const ast_node_id member = nodes.add_member_declaration(member_declaration {
+				     member_type, name,
+				     alignment_log2 == 0 ? 0 : std::size_t(1) << alignment_log2, bit_field_size,
+				     0 });
+				for (const attribute& attr : attributes) {
+					nodes.append_child(member, nodes.add_attribute(attr));
+				}
+				nodes.append_child(record, member);
+				record_builder.sub_types.push_back(member_type);
+				if (name.is_valid()) {
+					m_symbols.declare(symbol_namespace::member, name, symbol_kind::member,
+					     member_type, member);
+				}
+			};
+			if (current_token().id == tok_semicolon) {
+				add_member(aligned_type(base, alignment_log2), identifier_id(), 0);
+				get_next_token();
+				return true;
+			}
+			for (;;) {
+				declarator_info declarator;
+				if (current_token().id != tok_colon
+				     && !parse_declarator(nodes, specifiers, declarator)) {
+					return false;
+				}
+				type member_type = aligned_type(derived_type(base, declarator), alignment_log2);
+				std::uint64_t bit_field_size = 0;
+				if (current_token().id == tok_colon) {
+					get_next_token();
+					std::optional<std::uint64_t> width = parse_integer_constant(nodes);
+					if (!width || *width > std::numeric_limits<std::uint32_t>::max()) {
+						return false;
+					}
+					bit_field_size = *width;
+					member_type    = bit_field_type(member_type,
+					        static_cast<std::uint32_t>(*width), declarator.name.is_valid());
+				}
+				add_member(member_type, declarator.name, bit_field_size);
+				switch (current_token().id) {
+				case tok_comma:
+					get_next_token();
+					break;
+				case tok_semicolon:
+					get_next_token();
+					return true;
+				default:
+					return false;
+				}
+			}
+		}
+
+		/* The type of a bit-field `width` bits wide, declared with `declared`: that type with
+		 * the width as its extent, or `_Padding` of the width around it if it has no name (see
+		 * `type_data`). */
+		type bit_field_type(type declared, std::uint32_t width, bool is_named) noexcept {
+			type_builder built;
+			if (is_named) {
+				built = m_types.builder(declared);
+			}
+			else {
+				built.category = type_category::tc__Padding;
+				built.sub_types.push_back(declared);
+			}
+			built.extent = width;
+			return m_types.intern(built);
+		}
+
+		/*
+		 * type-qualifier ::= const | restrict | volatile | _Atomic
+		 *
+		 * Adds to the qualifiers of `ty`; saying one twice is the same as saying it once.
+		 * `_Atomic (` starts an atomic-type-specifier instead, which is not parsed yet.
+		 */
+		bool parse_type_qualifier(
+		     ast_node_table& nodes, function_definition& fd, type_builder& ty) {
+			ENTER_PARSE_FUNCTION();
+			const std::optional<qualifier> qualified = parse_type_qualifier_keyword();
+			if (!qualified) {
+				return false;
+			}
+			ty.qualifiers = add_qualifier(ty.qualifiers, *qualified);
+			return true;
+		}
+
+		/* The qualifier the current token is, taking it, if it is one. */
+		std::optional<qualifier> parse_type_qualifier_keyword() noexcept {
+			qualifier qualified = qualifier::none;
+			switch (current_token().id) {
+			case tok_keyword_const:
+				qualified = qualifier::q_const;
+				break;
+			case tok_keyword_restrict:
+				qualified = qualifier::q_restrict;
+				break;
+			case tok_keyword_volatile:
+				qualified = qualifier::q_volatile;
+				break;
+			case tok_keyword__Atomic: {
+				const next_token_t next = peek_token();
+				if (next && next->get().id == tok_l_paren) {
+					return std::nullopt;
+				}
+				qualified = qualifier::q__Atomic;
+			} break;
+			default:
+				return std::nullopt;
+			}
+			get_next_token();
+			return qualified;
+		}
+
+		/*
+		 * alignment-specifier ::=
+		 *    alignas ( type-name )
+		 *    | alignas ( constant-expression )
+		 *
+		 * The strictest alignment asked for is kept in `ty`, to be moved onto whatever the
+		 * declarator makes of it (see `aligned_type`); `alignas(0)` asks for nothing.
+		 */
+		bool parse_alignment_specifier(
+		     ast_node_table& nodes, function_definition& fd, type_builder& ty) {
+			ENTER_PARSE_FUNCTION();
+			if (current_token().id != tok_keyword_alignas
+			     && current_token().id != tok_keyword__Alignas) {
+				return false;
+			}
+			get_next_token();
+			if (current_token().id != tok_l_paren) {
+				return false;
+			}
+			get_next_token();
+			std::uint64_t alignment = 0;
+			if (starts_type_name(m_toks_index)) {
+				type aligned_as;
+				if (!parse_parenthesized_type_name(nodes, aligned_as)) {
+					return false;
+				}
+				alignment = type_layout_table(m_types, m_abi).alignment_of(aligned_as);
+			}
+			else {
+				std::optional<std::uint64_t> value = parse_integer_constant(nodes);
+				if (!value || current_token().id != tok_r_paren) {
+					return false;
+				}
+				get_next_token();
+				alignment = *value;
+			}
+			if (alignment != 0) {
+				if (!std::has_single_bit(alignment)) {
+					return false;
+				}
+				ty.alignment_log2 = std::max(
+				     ty.alignment_log2, static_cast<std::uint8_t>(std::countr_zero(alignment)));
+			}
+			return true;
+		}
+
+		/* `t`, aligned to at least 2 to the power of `alignment_log2`. */
+		type aligned_type(type t, std::uint8_t alignment_log2) noexcept {
+			if (alignment_log2 <= m_types.data(t).alignment_log2) {
+				return t;
+			}
+			type_builder built   = m_types.builder(t);
+			built.alignment_log2 = alignment_log2;
+			return m_types.intern(built);
+		}
+
+		/*
+		 * type_specifier_qualifier ::= type-specifier | type-qualifier | alignment-specifier
+		 */
+		bool parse_type_specifier_qualifier(
+		     ast_node_table& nodes, function_definition& fd, type_builder& ty) {
+			ENTER_PARSE_FUNCTION();
+			if (parse_type_specifier(nodes, fd, ty))
+				return true;
+			if (parse_type_qualifier(nodes, fd, ty))
+				return true;
+			if (parse_alignment_specifier(nodes, fd, ty))
+				return true;
+			return false;
+		}
+
+		bool parse_function_specifier(ast_node_table& nodes, function_definition& fd) {
+			ENTER_PARSE_FUNCTION();
+			switch (current_token().id) {
+			case tok_keyword_inline:
+				fd.declaration.funcspecs |= function_specifier::funcspec_inline;
+				break;
+			case tok_keyword__Noreturn:
+				fd.declaration.funcspecs |= function_specifier::funcspec__Noreturn;
+				break;
+			default:
+				return false;
+			}
+			get_next_token();
+			return true;
+		}
+
+		/*
+		 * declaration-specifier ::=
+		 *    storage-class-specifier
+		 *    | type-specifier-qualifier
+		 *    | function-specifier
+		 */
+		bool parse_declaration_specifier(
+		     ast_node_table& nodes, function_definition& fd, type_builder& ty) {
+			ENTER_PARSE_FUNCTION();
+			if (parse_storage_class_specifier(nodes, fd))
+				return true;
+
+			if (parse_type_specifier_qualifier(nodes, fd, ty))
+				return true;
+
+			if (parse_function_specifier(nodes, fd))
+				return true;
+
+			return false;
+		}
+
+		/*
+		 * declaration-specifiers ::=
+		 *    declaration-specifier attribute-specifier-sequence?
+		 *    | declaration-specifier declaration-specifiers
+		 */
+		bool parse_declaration_specifiers(
+		     ast_node_table& nodes, function_definition& fd, type_builder& ty) {
+			ENTER_PARSE_FUNCTION();
+			while (parse_declaration_specifier(nodes, fd, ty)) {
+				// parse_attribute_specifier_sequence(nodes, fd, ty);
+			}
+
+			/* empty declspecs is valid */
+			return completes_type_specifiers(ty);
+		}
+
+		/*
+		 * type-qualifier-list ::= type-qualifier | type-qualifier-list type-qualifier
+		 *
+		 * All of them together; none at all if there is no list.
+		 */
+		qualifier parse_type_qualifier_list(ast_node_table& nodes, function_definition& fd) {
+			ENTER_PARSE_FUNCTION();
+			qualifier qualifiers = qualifier::none;
+			while (const std::optional<qualifier> qualified = parse_type_qualifier_keyword()) {
+				qualifiers = add_qualifier(qualifiers, *qualified);
+			}
+			return qualifiers;
+		}
+
+		/* One of the types a declarator derives from the type its specifiers make: a pointer,
+		 * an array, or a function. */
+		struct declarator_derivation {
+			/* tc_data_pointer, tc_array, tc_variable_length_array or tc_function */
+			type_category category;
+			/* the length of an array, or 0 if it is not known */
+			std::uint32_t extent = 0;
+			/* of a function */
+			std::vector<type> parameter_types = {};
+			/* of a pointer: what its type-qualifier-list says */
+			qualifier qualifiers = qualifier::none;
+		};
+
+		/* What the parser keeps of a declarator so far. */
+		struct declarator_info {
+			/* invalid for an abstract declarator */
+			identifier_id name;
+			/* whether the first suffix after `name` is a parameter list */
+			bool is_function = false;
+			/* Set by the first parameter list after `name`, which (if there is one) is the
+			 * parameter list of the function `name` declares. */
+			bool has_parameters = false;
+			std::vector<parameter_declaration> parameters;
+			/* In the order they are read outwards from the name: in `int *x[4]`, `x` is an
+			 * array of 4, and then a pointer, to an int. */
+			std::vector<declarator_derivation> derivations;
+		};
+
+		/* What a memoized rule did at `start_index`, when a function definition parsed it: it
+		 * made everything up to `end`, stopped at `end.token_index`, and handed back the rest.
+		 * Something that is not a function definition is parsed again as a declaration from the
+		 * same token, and replays this instead of parsing it all over again; the failed function
+		 * definition is only rolled back as far as `end` of its last entry for that. */
+		struct memo_entry {
+			memoized_rule rule;
+			std::size_t start_index;
+			checkpoint end;
+			/* for declaration_specifiers */
+			type_builder specified = {};
+			unsigned char funcspecs = 0;
+			unsigned short storage_classes = 0;
+			/* for declarator */
+			declarator_info declarator = {};
+		};
+
+		/* Notes that `rule`, begun at `start_index`, has just ended, for it to be replayed. */
+		memo_entry& memoize(const ast_node_table& nodes, memoized_rule rule,
+		     std::size_t start_index) {
+			m_memo.push_back(memo_entry { rule, start_index, current_position(nodes) });
+			// so that rolling back to it keeps it
+			++m_memo.back().end.memo_entry_count;
+			return m_memo.back();
+		}
+
+		/* What `rule` did at the current token, if it is memoized there. */
+		const memo_entry* find_memoized(memoized_rule rule) noexcept {
+			++m_memo_lookups;
+			for (const memo_entry& entry : m_memo | std::views::reverse) {
+				if (entry.rule == rule && entry.start_index == m_toks_index) {
+					++m_memo_saved_reparses;
+					return &entry;
+				}
+			}
+			return nullptr;
+		}
+
+		/* What rolling back to `saved` keeps of the memo entries made since: everything up to
+		 * the end of the last of them, with the token index back at `saved`, where the next
+		 * attempt starts out and replays them. */
+		checkpoint keeping_memoized(const checkpoint& saved) const noexcept {
+			if (m_memo.size() == saved.memo_entry_count) {
+				return saved;
+			}
+			checkpoint kept  = m_memo.back().end;
+			kept.token_index = saved.token_index;
+			return kept;
+		}
+
+		/* Like `parse_declaration_specifiers`, but replaying what a function definition's
+		 * declaration specifiers did here, if it is memoized. */
+		bool parse_memoized_declaration_specifiers(
+		     ast_node_table& nodes, function_definition& fd, type_builder& ty) {
+			if (const memo_entry* entry = find_memoized(memoized_rule::declaration_specifiers)) {
+				ty                             = entry->specified;
+				fd.declaration.funcspecs       = entry->funcspecs;
+				fd.declaration.storage_classes = entry->storage_classes;
+				m_toks_index                   = entry->end.token_index;
+				return true;
+			}
+			return parse_declaration_specifiers(nodes, fd, ty);
+		}
+
+		/* Like `parse_declarator`, but replaying what a function definition's declarator did
+		 * here, if it is memoized. */
+		bool parse_memoized_declarator(
+		     ast_node_table& nodes, function_definition& fd, declarator_info& declarator) {
+			if (const memo_entry* entry = find_memoized(memoized_rule::declarator)) {
+				declarator   = entry->declarator;
+				m_toks_index = entry->end.token_index;
+				return true;
+			}
+			return parse_declarator(nodes, fd, declarator);
+		}
+
+		/* The type `declarator` gives its name when its specifiers make `base`: each of its
+		 * derivations applied in turn, from the one nearest the base type inwards. */
+		type derived_type(type base, const declarator_info& declarator) {
+			type derived = base;
+			for (const declarator_derivation& derivation :
+			     declarator.derivations | std::views::reverse) {
+				type_builder built;
+				built.category   = derivation.category;
+				built.extent     = derivation.extent;
+				built.qualifiers = derivation.qualifiers;
+				if (derivation.category == type_category::tc_data_pointer
+				     && m_types.data(derived).category == type_category::tc_function) {
+					built.category = type_category::tc_function_pointer;
+				}
+				built.sub_types.push_back(derived);
+				built.sub_types.insert(built.sub_types.end(),
+				     derivation.parameter_types.begin(), derivation.parameter_types.end());
+				derived = m_types.intern(built);
+			}
+			return derived;
+		}
+
+		/* Adds the pointers a declarator's `pointer` had, which come after everything its
+		 * direct-declarator derived: the last one written first, since it is the nearest the
+		 * name. */
+		void add_pointers(declarator_info& declarator, std::span<const qualifier> pointers) {
+			for (const qualifier qualifiers : pointers | std::views::reverse) {
+				declarator.derivations.push_back(declarator_derivation {
+				     type_category::tc_data_pointer, 0, {}, qualifiers });
+			}
+		}
+
+		/*
+		 * array-declarator ::=
+		 *    direct-declarator [ type-qualifier-list? assignment-expression? ]
+		 *    | direct-declarator [ static type-qualifier-list? assignment-expression ]
+		 *    | direct-declarator [ type-qualifier-list static assignment-expression ]
+		 *    | direct-declarator [ type-qualifier-list? * ]
+		 *
+		 * Only the `[ ... ]` suffix is parsed here. An integer constant expression on its own is
+		 * the length of the array, and nothing at all leaves it unknown; anything else makes a
+		 * variable length array for now, and is skipped up to the matching `]`.
+		 */
+		bool parse_array_declarator(
+		     ast_node_table& nodes, function_definition& fd, declarator_info& declarator) {
+			ENTER_PARSE_FUNCTION();
+			if (current_token().id != tok_l_square_bracket) {
+				return false;
+			}
+			auto maybe_closing_index = matching_bracket();
+			if (!maybe_closing_index) {
+				return false;
+			}
+			get_next_token();
+			declarator_derivation array { type_category::tc_array };
+			if (m_toks_index != *maybe_closing_index) {
+				std::optional<std::uint64_t> length = parse_integer_constant(nodes);
+				if (length && m_toks_index == *maybe_closing_index
+				     && *length <= std::numeric_limits<std::uint32_t>::max()) {
+					array.extent = static_cast<std::uint32_t>(*length);
+				}
+				else {
+					array.category = type_category::tc_variable_length_array;
+				}
+			}
+			m_toks_index = *maybe_closing_index + 1;
+			declarator.derivations.push_back(std::move(array));
+			return true;
+		}
+
+		/*
+		 * parameter-declaration ::=
+		 *    attribute-specifier-sequence? declaration-specifiers declarator
+		 *    | attribute-specifier-sequence? declaration-specifiers abstract-declarator?
+		 *
+		 * A parameter declared as an array is a pointer to its element, and one declared as a
+		 * function is a pointer to it.
+		 */
+		bool parse_parameter_declaration(ast_node_table& nodes, function_definition& fd,
+		     std::vector<parameter_declaration>& parameters) {
+			ENTER_PARSE_FUNCTION();
+			std::vector<attribute> attributes;
+			parse_attribute_specifier_sequence(nodes, attributes);
+			// a parameter's storage class is its own, not the function's
+			function_definition parameter_specifiers {};
+			type_builder parameter_builder;
+			if (!parse_declaration_specifiers(nodes, parameter_specifiers, parameter_builder)
+			     || parameter_builder.empty()) {
+				return false;
+			}
+			declarator_info parameter_declarator;
+			const std::vector<qualifier> pointers = parse_pointer(nodes, fd);
+			switch (current_token().id) {
+			case tok_id:
+			case tok_l_paren:
+			case tok_l_square_bracket:
+				if (!parse_direct_declarator(
+				         nodes, fd, parameter_declarator, declarator_form::abstract_allowed)) {
+					return false;
+				}
+				break;
+			default:
+				// no declarator at all: an unnamed parameter
+				break;
+			}
+			add_pointers(parameter_declarator, pointers);
+			type parameter_type
+			     = derived_type(m_types.intern(parameter_builder), parameter_declarator);
+			switch (m_types.data(parameter_type).category) {
+			case type_category::tc_array:
+			case type_category::tc_variable_length_array: {
+				type_builder adjusted;
+				adjusted.category = type_category::tc_data_pointer;
+				adjusted.sub_types.push_back(m_types.element_type(parameter_type));
+				parameter_type = m_types.intern(adjusted);
+			} break;
+			case type_category::tc_function: {
+				type_builder adjusted;
+				adjusted.category = type_category::tc_function_pointer;
+				adjusted.sub_types.push_back(parameter_type);
+				parameter_type = m_types.intern(adjusted);
+			} break;
+			default:
+				break;
+			}
+			if (parameter_declarator.name.is_valid()) {
+				// a parameter's name hides a typedef-name from the parameters after it
+				m_symbols.declare(symbol_namespace::ordinary, parameter_declarator.name,
+				     symbol_kind::object, parameter_type);
+			}
+			parameters.push_back(
+			     parameter_declaration { parameter_type, parameter_declarator.name });
+			return true;
+		}
+
+		/*
+		 * parameter-type-list ::=
+		 *    parameter-list
+		 *    | parameter-list , ...
+		 *    | ...
+		 *
+		 * parameter-list ::=
+		 *    parameter-declaration
+		 *    | parameter-list , parameter-declaration
+		 */
+		bool parse_parameter_type_list(ast_node_table& nodes, function_definition& fd,
+		     std::vector<parameter_declaration>& parameters) {
+			ENTER_PARSE_FUNCTION();
+			// TODO: `...`
+			for (;;) {
+				if (!parse_parameter_declaration(nodes, fd, parameters)) {
+					return false;
+				}
+				if (current_token().id != tok_comma) {
+					return true;
+				}
+				get_next_token();
+			}
+		}
+
+		/*
+		 * function-declarator ::=
+		 *      direct-declarator ( parameter-type-list? )
+		 *
+		 * Only the `( ... )` suffix is parsed here: `parse_direct_declarator` has already
+		 * taken the direct-declarator in front of it. The parameters get a scope of their own
+		 * (function prototype scope), which ends with the list. `( void )` has no parameters
+		 * as far as the function's type goes.
+		 */
+		bool parse_function_declarator(
+		     ast_node_table& nodes, function_definition& fd, declarator_info& declarator) {
+			ENTER_PARSE_FUNCTION();
+			if (current_token().id != tok_l_paren) {
+				return false;
+			}
+			get_next_token();
+			std::vector<parameter_declaration> parameters;
+			m_symbols.push_scope(scope_kind::function_prototype);
+			if (current_token().id != tok_r_paren
+			     && !parse_parameter_type_list(nodes, fd, parameters)) {
+				return false;
+			}
+			m_symbols.pop_scope();
+			if (current_token().id != tok_r_paren) {
+				return false;
+			}
+			get_next_token();
+			declarator_derivation function { type_category::tc_function };
+			const bool is_void_list = parameters.size() == 1 && !parameters[0].name.is_valid()
+			     && m_types.data(parameters[0].t).category == type_category::tc_void;
+			if (!is_void_list) {
+				for (const parameter_declaration& parameter : parameters) {
+					function.parameter_types.push_back(parameter.t);
+				}
+			}
+			declarator.derivations.push_back(std::move(function));
+			if (!declarator.has_parameters) {
+				declarator.has_parameters = true;
+				declarator.parameters     = std::move(parameters);
+			}
+			return true;
+		}
+
+
+		/*
+		 * pointer ::=
 		 *    * attribute-specifier-sequence? type-qualifier-list?
 		 *    | * attribute-specifier-sequence? type-qualifier-list? pointer
+		 *
+		 * Returns the qualifiers of each pointer, in the order they were written, which is none
+		 * if there was no pointer.
+		 */
+		std::vector<qualifier> parse_pointer(ast_node_table& nodes, function_definition& fd) {
+			ENTER_PARSE_FUNCTION();
+			std::vector<qualifier> pointers;
+			while (current_token().id == tok_asterisk) {
+				get_next_token();
+				// parse_attribute_specifier_sequence(nodes, fd);
+				pointers.push_back(parse_type_qualifier_list(nodes, fd));
+			}
+			return pointers;
+		}
+
+		bool parse_identifier(
+		     ast_node_table& nodes, function_definition& fd, identifier_id& name) {
+			ENTER_PARSE_FUNCTION();
+			if (current_token().id != tok_id) {
+				return false;
+			}
+			name = current_token().identifier();
+			get_next_token();
+			return true;
+		}
+
+		enum class declarator_form {
+			/* must name something */
+			concrete,
+			/* may leave the name out, as in a parameter declaration */
+			abstract_allowed,
+		};
+
+		/*
+		 * direct-declarator ::=
+		 *    identifier attribute-specifier-sequence?
+		 *    | ( declarator )
+		 *    | array-declarator attribute-specifier-sequence?
+		 *    | function-declarator attribute-specifier-sequence?
+		 *
+		 * Array and function declarators are just another direct-declarator followed by a
+		 * `[ ... ]` or `( ... )` suffix. So: take the identifier or the parenthesized declarator
+		 * first, then take suffixes for as long as there are any. No lookahead is needed to tell
+		 * them apart, and each token is looked at once.
+		 */
+		bool parse_direct_declarator(ast_node_table& nodes, function_definition& fd,
+		     declarator_info& declarator, declarator_form form = declarator_form::concrete) {
+			ENTER_PARSE_FUNCTION();
+			if (parse_identifier(nodes, fd, declarator.name)) {
+				// parse_attribute_specifier_sequence(nodes, fd);
+				declarator.is_function = current_token().id == tok_l_paren;
+			}
+			else if (current_token().id == tok_l_paren && is_grouping_parenthesis(form)) {
+				get_next_token();
+				if (!parse_declarator(nodes, fd, declarator, form)) {
+					return false;
+				}
+				if (current_token().id != tok_r_paren) {
+					return false;
+				}
+				get_next_token();
+			}
+			else if (form == declarator_form::concrete) {
+				return false;
+			}
+
+			for (;;) {
+				switch (current_token().id) {
+				case tok_l_paren:
+					if (!parse_function_declarator(nodes, fd, declarator)) {
+						return false;
+					}
+					break;
+				case tok_l_square_bracket:
+					if (!parse_array_declarator(nodes, fd, declarator)) {
+						return false;
+					}
+					break;
+				default:
+					// parse_attribute_specifier_sequence(nodes, fd);
+					return true;
+				}
+			}
+		}
+
+		/* In an abstract declarator, `(` can either open a nested declarator, as in
+		 * `int (*)(void)`, or be the parameter list of a function with no name, as in
+		 * `int (void)`. A nested declarator has to start with one of a few tokens, and none of
+		 * them can start a parameter list. */
+		bool is_grouping_parenthesis(declarator_form form) noexcept {
+			if (form == declarator_form::concrete) {
+				return true;
+			}
+			auto maybe_next_token = peek_token();
+			if (!maybe_next_token.has_value()) {
+				return false;
+			}
+			switch (maybe_next_token->get().id) {
+			case tok_asterisk:
+			case tok_l_paren:
+			case tok_l_square_bracket:
+			case tok_id:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		/*
+		 * declarator ::= pointer? direct-declarator
+		 */
+		bool parse_declarator(ast_node_table& nodes, function_definition& fd,
+		     declarator_info& declarator, declarator_form form = declarator_form::concrete) {
+			ENTER_PARSE_FUNCTION();
+			const std::vector<qualifier> pointers = parse_pointer(nodes, fd);
+			if (!parse_direct_declarator(nodes, fd, declarator, form)) {
+				return false;
+			}
+			add_pointers(declarator, pointers);
+			return true;
+		}
+
+		/* The index of the bracket closing the one at the current token, if there is one. */
+		std::optional<std::size_t> find_matching_bracket() noexcept {
+			// the closing bracket may not have been lexed yet
+			while (m_matching_brackets[m_toks_index] == token_source::no_matching_bracket
+			     && m_feed != nullptr && m_feed->pull()) {
+				continue;
+			}
+			const std::uint32_t closing_index = m_matching_brackets[m_toks_index];
+			if (closing_index == token_source::no_matching_bracket) {
+				return std::nullopt;
+			}
+			return closing_index;
+		}
+
+		/* Like `find_matching_bracket`, but reporting a diagnostic if there is none. */
+		std::optional<std::size_t> matching_bracket() noexcept {
+			const std::optional<std::size_t> closing_index = find_matching_bracket();
+			if (!closing_index) {
+				const token& open_token = current_token();
+				m_reporter.report(parser_err::unbalanced_token_sequence, open_token.location,
+				     token_spelling(open_token.id));
+			}
+			return closing_index;
+		}
+
+		/* Whether the token at `index` can start a type-name, which is what tells a cast (or a
+		 * compound literal) from a parenthesized expression: `(T)` is a cast only while `T` is a
+		 * typedef-name. */
+		bool starts_type_name(std::size_t index) const noexcept {
+			if (!has_token(index)) {
+				return false;
+			}
+			if (index > m_toks_index) {
+				count_look_ahead(1);
+			}
+			const token& tok = m_toks[index];
+			switch (tok.id) {
+			case tok_keyword_void:
+			case tok_keyword_char:
+			case tok_keyword_short:
+			case tok_keyword_int:
+			case tok_keyword_long:
+			case tok_keyword_float:
+			case tok_keyword_double:
+			case tok_keyword_signed:
+			case tok_keyword_unsigned:
+			case tok_keyword_bool:
+			case tok_keyword__Bool:
+			case tok_keyword__BitInt:
+			case tok_keyword__Complex:
+			case tok_keyword_struct:
+			case tok_keyword_union:
+			case tok_keyword_enum:
+			case tok_keyword_typeof:
+			case tok_keyword_typeof_unqual:
+			case tok_keyword_const:
+			case tok_keyword_volatile:
+			case tok_keyword_restrict:
+			case tok_keyword__Atomic:
+			case tok_keyword_alignas:
+			case tok_keyword__Alignas:
+			case tok_keyword__Padding:
+				return true;
+			case tok_id:
+				return m_symbols.is_typedef_name(tok.identifier());
+			default:
+				return false;
+			}
+		}
+
+		/*
+		 * type-name ::= specifier-qualifier-list abstract-declarator?
+		 *
+		 * Parsed from just inside a `( type-name )` up to and including its `)`.
+		 */
+		bool parse_parenthesized_type_name(ast_node_table& nodes, type& ty) {
+			function_definition fd { function_declaration { type(), 0 }, token_range(),
+				ast_node_id() };
+			type_builder built;
+			if (!parse_type_specifier_qualifier(nodes, fd, built)) {
+				return false;
+			}
+			while (parse_type_specifier_qualifier(nodes, fd, built)) {
+				continue;
+			}
+			if (!completes_type_specifiers(built)) {
+				return false;
+			}
+			declarator_info declarator;
+			const std::vector<qualifier> pointers = parse_pointer(nodes, fd);
+			switch (current_token().id) {
+			case tok_l_paren:
+			case tok_l_square_bracket:
+				if (!parse_direct_declarator(
+				         nodes, fd, declarator, declarator_form::abstract_allowed)) {
+					return false;
+				}
+				break;
+			default:
+				break;
+			}
+			if (declarator.name.is_valid() || current_token().id != tok_r_paren) {
+				return false;
+			}
+			get_next_token();
+			add_pointers(declarator, pointers);
+			ty = derived_type(m_types.intern(built), declarator);
+			return true;
+		}
+
+		ast_node_id add_expression(ast_node_table& nodes, expression_operator op,
+		     std::size_t token_index, type ty = {}) {
+			return nodes.add_expression(
+			     expression { op, static_cast<std::uint32_t>(token_index), ty });
+		}
+
+		/*
+		 * expression ::= assignment-expression | expression , assignment-expression
+		 * assignment-expression ::=
+		 *    conditional-expression
+		 *    | unary-expression assignment-operator assignment-expression
+		 * conditional-expression ::=
+		 *    logical-OR-expression
+		 *    | logical-OR-expression ? expression : conditional-expression
+		 * logical-OR-expression ::= ...
+		 *
+		 * The grammar spells every level of precedence out as a rule of its own. Parsing it that
+		 * way would take a function call per level for every operand, and a call per operator
+		 * for every operator in a chain like `a + b + c + ...`. Instead, every infix operator is
+		 * parsed by the one loop below, driven by the binding powers in `operators.inl.h`
+		 * (precedence climbing, or Pratt parsing). An operator at the same level as the one
+		 * before it is taken by the loop rather than by a recursive call, so how deep this
+		 * recurses depends on how many precedence levels an expression goes up and down, not
+		 * on how long it is.
+		 *
+		 * Takes every operator that binds at least as tightly as `min_binding_power`: see
+		 * `expression_binding_power` and friends for what each grammar rule asks for. Returns
+		 * an invalid node if there is no expression here. The nodes made for it before it went
+		 * wrong are left in the table, for the caller to roll back.
+		 */
+		ast_node_id parse_expression(ast_node_table& nodes, unsigned char min_binding_power) {
+			ast_node_id lhs = parse_unary_expression(nodes);
+			while (lhs.is_valid()) {
+				const binding_power infix = binary_operator(current_token().id);
+				if (infix.left == 0 || infix.left < min_binding_power) {
+					break;
+				}
+				const ast_node_id applied = add_expression(nodes, infix.op, m_toks_index);
+				get_next_token();
+				nodes.append_child(applied, lhs);
+				if (infix.op == expression_operator::conditional) {
+					const ast_node_id middle
+					     = parse_expression(nodes, expression_binding_power);
+					if (!middle.is_valid() || current_token().id != tok_colon) {
+						return ast_node_id();
+					}
+					get_next_token();
+					nodes.append_child(applied, middle);
+				}
+				const ast_node_id rhs = parse_expression(nodes, infix.right);
+				if (!rhs.is_valid()) {
+					return ast_node_id();
+				}
+				nodes.append_child(applied, rhs);
+				lhs = applied;
+			}
+			return lhs;
+		}
+
+		/*
+		 * unary-expression ::=
+		 *    postfix-expression
+		 *    | ++ unary-expression
+		 *    | -- unary-expression
+		 *    | unary-operator cast-expression
+		 *    | sizeof unary-expression
+		 *    | sizeof ( type-name )
+		 *    | alignof ( type-name )
+		 * cast-expression ::= unary-expression | ( type-name ) cast-expression
+		 *
+		 * Prefix operators are taken in a loop too, each becoming the only child of the one
+		 * before it, so a run of them costs no recursion at all.
+		 */
+		ast_node_id parse_unary_expression(ast_node_table& nodes) {
+			ast_node_id outermost;
+			ast_node_id innermost;
+			const auto apply = [&](ast_node_id operand) noexcept {
+				if (!innermost.is_valid()) {
+					outermost = operand;
+				}
+				else if (operand.is_valid()) {
+					nodes.append_child(innermost, operand);
+				}
+				return operand.is_valid() ? outermost : ast_node_id();
+			};
+			const auto apply_prefix = [&](ast_node_id prefix) noexcept {
+				apply(prefix);
+				innermost = prefix;
+			};
+			for (;;) {
+				const std::size_t operator_index = m_toks_index;
+				const token_id id                = current_token().id;
+				const binding_power prefix       = prefix_operator(id);
+				if (prefix.right != 0) {
+					get_next_token();
+					apply_prefix(add_expression(nodes, prefix.op, operator_index));
+					continue;
+				}
+				switch (id) {
+				case tok_keyword_sizeof:
+					get_next_token();
+					if (current_token().id == tok_l_paren
+					     && starts_type_name(m_toks_index + 1)) {
+						get_next_token();
+						type ty;
+						if (!parse_parenthesized_type_name(nodes, ty)) {
+							return ast_node_id();
+						}
+						if (current_token().id != tok_l_curly_bracket) {
+							return apply(add_expression(nodes,
+							     expression_operator::sizeof_type, operator_index, ty));
+						}
+						// `sizeof ( type-name ) { ... }` is the size of a compound literal
+						apply_prefix(add_expression(
+						     nodes, expression_operator::sizeof_expression, operator_index));
+						return apply(parse_compound_literal(nodes, operator_index + 1, ty));
+					}
+					apply_prefix(add_expression(
+					     nodes, expression_operator::sizeof_expression, operator_index));
+					continue;
+				case tok_keyword_alignof:
+				case tok_keyword__Alignof: {
+					get_next_token();
+					if (current_token().id != tok_l_paren) {
+						return ast_node_id();
+					}
+					get_next_token();
+					type ty;
+					if (!parse_parenthesized_type_name(nodes, ty)) {
+						return ast_node_id();
+					}
+					return apply(add_expression(
+					     nodes, expression_operator::alignof_type, operator_index, ty));
+				}
+				case tok_l_paren:
+					if (starts_type_name(m_toks_index + 1)) {
+						get_next_token();
+						type ty;
+						if (!parse_parenthesized_type_name(nodes, ty)) {
+							return ast_node_id();
+						}
+						if (current_token().id == tok_l_curly_bracket) {
+							return apply(parse_postfix_expression(
+							     nodes, parse_compound_literal(nodes, operator_index, ty)));
+						}
+						apply_prefix(add_expression(
+						     nodes, expression_operator::cast, operator_index, ty));
+						continue;
+					}
+					break;
+				default:
+					break;
+				}
+				return apply(parse_postfix_expression(nodes, parse_primary_expression(nodes)));
+			}
+		}
+
+		/*
+		 * compound-literal ::= ( storage-class-specifiers? type-name ) braced-initializer
+		 *
+		 * Initializers are not parsed yet, so the braced initializer is skipped whole.
+		 */
+		ast_node_id parse_compound_literal(
+		     ast_node_table& nodes, std::size_t l_paren_index, type ty) {
+			auto maybe_closing_index = matching_bracket();
+			if (!maybe_closing_index) {
+				return ast_node_id();
+			}
+			m_toks_index = *maybe_closing_index + 1;
+			return add_expression(
+			     nodes, expression_operator::compound_literal, l_paren_index, ty);
+		}
+
+		/*
+		 * primary-expression ::=
+		 *    identifier
+		 *    | constant
+		 *    | string-literal
+		 *    | ( expression )
+		 *    | generic-selection
+		 *
+		 * A parenthesized expression gets no node of its own: the tree already says how its
+		 * operands group.
+		 */
+		ast_node_id parse_primary_expression(ast_node_table& nodes) {
+			const std::size_t token_index = m_toks_index;
+			const token& tok              = current_token();
+			switch (tok.id) {
+			case tok_id:
+				if (m_symbols.is_typedef_name(tok.identifier())) {
+					return ast_node_id();
+				}
+				get_next_token();
+				return add_expression(nodes, expression_operator::identifier, token_index);
+			case tok_num_literal:
+				get_next_token();
+				return add_expression(nodes, expression_operator::numeric_literal, token_index);
+			case tok_str_literal:
+				while (current_token().id == tok_str_literal) {
+					get_next_token();
+				}
+				return add_expression(nodes, expression_operator::string_literal, token_index);
+			case tok_keyword_true:
+			case tok_keyword_false:
+			case tok_keyword_nullptr:
+				get_next_token();
+				return add_expression(nodes, expression_operator::constant, token_index);
+			case tok_l_paren: {
+				get_next_token();
+				const ast_node_id inner = parse_expression(nodes, expression_binding_power);
+				if (!inner.is_valid() || current_token().id != tok_r_paren) {
+					return ast_node_id();
+				}
+				get_next_token();
+				return inner;
+			}
+			case tok_keyword__Generic:
+				// TODO: generic-selection
+				m_met_unparsed_expression = true;
+				return ast_node_id();
+			default:
+				return ast_node_id();
+			}
+		}
+
+		/*
+		 * postfix-expression ::=
+		 *    primary-expression
+		 *    | postfix-expression [ expression ]
+		 *    | postfix-expression ( argument-expression-list? )
+		 *    | postfix-expression . identifier
+		 *    | postfix-expression -> identifier
+		 *    | postfix-expression ++
+		 *    | postfix-expression --
+		 *    | compound-literal
+		 *
+		 * Every postfix operator binds tighter than anything else, so they are simply taken
+		 * left to right for as long as there are any.
+		 */
+		ast_node_id parse_postfix_expression(ast_node_table& nodes, ast_node_id operand) {
+			while (operand.is_valid()) {
+				const binding_power postfix = postfix_operator(current_token().id);
+				if (postfix.left == 0) {
+					break;
+				}
+				const ast_node_id applied = add_expression(nodes, postfix.op, m_toks_index);
+				get_next_token();
+				nodes.append_child(applied, operand);
+				operand = applied;
+				switch (postfix.op) {
+				case expression_operator::call:
+					if (!parse_argument_expression_list(nodes, applied)) {
+						return ast_node_id();
+					}
+					break;
+				case expression_operator::subscript: {
+					const ast_node_id index
+					     = parse_expression(nodes, expression_binding_power);
+					if (!index.is_valid() || current_token().id != tok_r_square_bracket) {
+						return ast_node_id();
+					}
+					get_next_token();
+					nodes.append_child(applied, index);
+				} break;
+				case expression_operator::member:
+				case expression_operator::member_through_pointer:
+					if (current_token().id != tok_id) {
+						return ast_node_id();
+					}
+					nodes.append_child(applied,
+					     add_expression(nodes, expression_operator::identifier, m_toks_index));
+					get_next_token();
+					break;
+				default:
+					break;
+				}
+			}
+			return operand;
+		}
+
+		/*
+		 * argument-expression-list ::=
+		 *    assignment-expression
+		 *    | argument-expression-list , assignment-expression
+		 *
+		 * Parsed from just inside the `(` of a call up to and including its `)`.
+		 */
+		bool parse_argument_expression_list(ast_node_table& nodes, ast_node_id call) {
+			if (current_token().id == tok_r_paren) {
+				get_next_token();
+				return true;
+			}
+			for (;;) {
+				const ast_node_id argument
+				     = parse_expression(nodes, assignment_expression_binding_power);
+				if (!argument.is_valid()) {
+					return false;
+				}
+				nodes.append_child(call, argument);
+				switch (current_token().id) {
+				case tok_comma:
+					get_next_token();
+					break;
+				case tok_r_paren:
+					get_next_token();
+					return true;
+				default:
+					return false;
+				}
+			}
+		}
+
+		/*
+		 * expression-statement ::= expression? ;
+		 * jump-statement ::= return expression? ; | ...
+		 *
+		 * The expression becomes the only child of the statement. If the block item turns out to
+		 * be neither of these (or uses something the expression parser does not know yet), this
+		 * returns false having consumed and made nothing, so that it can be tried as something
+		 * else. So does a malformed expression, which is reported (see
+		 * `hold_malformed_expression`): a block item is taken to be an expression statement
+		 * once its first token is part of an expression, and it is not a label.
+		 */
+		bool parse_expression_statement(ast_node_table& nodes, ast_node_id body) {
+			ENTER_PARSE_FUNCTION();
+			const checkpoint saved = save_checkpoint(nodes);
+			const bool is_return   = current_token().id == tok_keyword_return;
+			if (is_return) {
+				get_next_token();
+			}
+			ast_node_id expr;
+			if (current_token().id != tok_semicolon) {
+				const std::size_t begin   = m_toks_index;
+				m_met_unparsed_expression = false;
+				expr = parse_expression(nodes, expression_binding_power);
+				if (!expr.is_valid() || current_token().id != tok_semicolon) {
+					const std::size_t failed_index = m_toks_index;
+					const bool is_label            = expr.is_valid()
+					     && failed_index == begin + 1 && current_token().id == tok_colon;
+					rollback_checkpoint(nodes, saved);
+					if (!is_label && (is_return || failed_index != begin)) {
+						hold_malformed_expression(expr, failed_index, "';'");
+					}
+					return false;
+				}
+			}
+			get_next_token();
+			commit_checkpoint(nodes, saved);
+			const ast_node_id stmt = nodes.add_statement(statement { token_range {
+			     static_cast<std::uint32_t>(saved.token_index),
+			     static_cast<std::uint32_t>(m_toks_index) } });
+			if (expr.is_valid()) {
+				nodes.append_child(stmt, expr);
+			}
+			nodes.append_child(body, stmt);
+			return true;
+		}
+
+		/*
+		 * block-item ::= declaration | unlabeled-statement | label
+		 *
+		 * Expression statements and `return` statements are parsed. Anything else is not parsed
+		 * yet: such a block item is kept as its tokens, up to and including a `;` or a closing
+		 * `}` that is not outside some enclosing bracket.
+		 */
+		bool parse_block_item(ast_node_table& nodes, ast_node_id body, std::size_t end_index) {
+			ENTER_PARSE_FUNCTION();
+			if (parse_expression_statement(nodes, body)) {
+				return true;
+			}
+			const std::size_t begin_index = m_toks_index;
+			const auto finish_statement   = [&]() noexcept {
+				statement stmt { token_range { static_cast<std::uint32_t>(begin_index),
+					static_cast<std::uint32_t>(m_toks_index) } };
+				nodes.append_child(body, nodes.add_statement(stmt));
+				return true;
+			};
+			if (current_token().id == tok_id) {
+				auto maybe_next_token = peek_token();
+				if (maybe_next_token.has_value() && maybe_next_token->get().id == tok_colon) {
+					// a label, which belongs to the function and outlives the block it is in
+					m_symbols.declare(symbol_namespace::label, current_token().identifier(),
+					     symbol_kind::label);
+				}
+			}
+			while (m_toks_index < end_index) {
+				const token& tok = current_token();
+				switch (tok.id) {
+				case tok_l_paren:
+				case tok_l_square_bracket:
+				case tok_l_curly_bracket: {
+					// skip the whole bracketed group at once; a `;` inside it ends nothing
+					auto maybe_closing_index = matching_bracket();
+					if (!maybe_closing_index) {
+						return false;
+					}
+					m_toks_index = *maybe_closing_index + 1;
+					if (tok.id != tok_l_curly_bracket) {
+						continue;
+					}
+					// a block ends the item, unless the statement carries on past it
+					switch (current_token().id) {
+					case tok_keyword_else:
+					case tok_keyword_while:
+					case tok_semicolon:
+						continue;
+					default:
+						return finish_statement();
+					}
+				}
+				case tok_semicolon:
+					get_next_token();
+					return finish_statement();
+				default:
+					get_next_token();
+					break;
+				}
+			}
+			// ran into the end of the block without a `;`
+			return finish_statement();
+		}
+
+		/*
+		 * compound-statement ::= { block-item-list? }
+		 */
+		bool parse_compound_statement(ast_node_table& nodes, ast_node_id& body) {
+			ENTER_PARSE_FUNCTION();
+			if (current_token().id != tok_l_curly_bracket) {
+				return false;
+			}
+			auto maybe_closing_index = matching_bracket();
+			if (!maybe_closing_index) {
+				return false;
+			}
+			get_next_token();
+			body = nodes.add_node(ast_node_kind::compound_statement);
+			m_symbols.push_scope(scope_kind::block);
+			while (m_toks_index < *maybe_closing_index) {
+				if (!parse_block_item(nodes, body, *maybe_closing_index)) {
+					return false;
+				}
+			}
+			m_symbols.pop_scope();
+			m_toks_index = *maybe_closing_index + 1;
+			return true;
+		}
+
+		/*
+		 * function-body ::= compound-statement
 		 */
-		bool parse_pointer(translation_unit& tu, function_definition& fd) {
+		bool parse_function_body(ast_node_table& nodes, function_definition& fd) {
 			ENTER_PARSE_FUNCTION();
-			if (current_token().id != tok_asterisk)
+			if (current_token().id != tok_l_curly_bracket) {
+				return false;
+			}
+			auto maybe_closing_index = matching_bracket();
+			if (!maybe_closing_index) {
+				return false;
+			}
+			fd.body_tokens = token_range { static_cast<std::uint32_t>(m_toks_index),
+				static_cast<std::uint32_t>(*maybe_closing_index + 1) };
+			if (SKIPPING_FUNCTION_BODIES()) {
+				// nothing inside is looked at until somebody asks for the body
+				m_toks_index = fd.body_tokens.end;
+				return true;
+			}
+			return parse_compound_statement(nodes, fd.body);
+		}
+
+		/*
+		 * function-definition ::=
+		 *    attribute-specifier-sequence? declaration-specifiers declarator function-body
+		 */
+		bool parse_function_definition(ast_node_table& nodes) {
+			ENTER_PARSE_FUNCTION();
+			function_definition fd { function_declaration { type(), 0 }, token_range(),
+				ast_node_id() };
+			std::vector<attribute> attributes;
+
+			parse_attribute_specifier_sequence(nodes, attributes);
+
+			const std::size_t specifiers_index = m_toks_index;
+			type_builder return_type;
+			if (!parse_declaration_specifiers(nodes, fd, return_type))
+				return false;
+			memo_entry& specifiers
+			     = memoize(nodes, memoized_rule::declaration_specifiers, specifiers_index);
+			specifiers.specified       = return_type;
+			specifiers.funcspecs       = fd.declaration.funcspecs;
+			specifiers.storage_classes = fd.declaration.storage_classes;
+
+			const std::size_t declarator_index = m_toks_index;
+			declarator_info declarator;
+			if (!parse_declarator(nodes, fd, declarator))
 				return false;
-			while (current_token().id == tok_asterisk) {
-				// parse_attribute_specifier_sequence(tu, fd);
-				parse_type_qualifier_list(tu, fd);
-				get_next_token();
+			memoize(nodes, memoized_rule::declarator, declarator_index).declarator = declarator;
+
+			fd.declaration.name = declarator.name;
+			fd.declaration.t    = derived_type(m_types.intern(return_type), declarator);
+			// the function is in scope in its own body, and so are its parameters
+			m_symbols.declare(symbol_namespace::ordinary, declarator.name, symbol_kind::function,
+			     fd.declaration.t);
+			m_symbols.push_scope(scope_kind::function);
+			declare_parameters(declarator.parameters);
+			if (!parse_function_body(nodes, fd))
+				return false;
+			m_symbols.pop_scope();
+
+			const ast_node_id definition = nodes.add_function_definition(fd);
+			for (attribute& attr : attributes) {
+				nodes.append_child(definition, nodes.add_attribute(std::move(attr)));
 			}
+			for (const parameter_declaration& parameter : declarator.parameters) {
+				nodes.append_child(definition, nodes.add_parameter_declaration(parameter));
+			}
+			if (fd.body.is_valid()) {
+				nodes.append_child(definition, fd.body);
+			}
+			nodes.append_child(m_translation_unit, definition);
 			return true;
 		}
 
-		bool parse_identifier(translation_unit& tu, function_definition& fd, std::string& idval) {
-			ENTER_PARSE_FUNCTION();
-			switch (current_token().id) {
-			case tok_id:
-				idval = lexed_id(m_last_identifier_string_index++);
-				break;
-			case tok_keyword_int:
-				idval = "int";
-				break;
-			default:
-				return false;
+		void declare_parameters(std::span<const parameter_declaration> parameters) noexcept {
+			for (const parameter_declaration& parameter : parameters) {
+				if (parameter.name.is_valid()) {
+					m_symbols.declare(symbol_namespace::ordinary, parameter.name,
+					     symbol_kind::object, parameter.t);
+				}
 			}
-			get_next_token();
-			return true;
 		}
 
 		/*
-		 * direct-declarator ::=
-		 *    identifier attribute-specifier-sequence?
-		 *    | ( declarator )
-		 *    | array-declarator attribute-specifier-sequence?
-		 *    | function-declarator attribute-specifier-sequence?
+		 * initializer ::= assignment-expression | braced-initializer
+		 *
+		 * An assignment-expression becomes a child of the declaration it initializes. Braced
+		 * initializers are not parsed yet, and neither is an expression using something the
+		 * expression parser does not know yet: those are skipped, and the declaration gets no
+		 * initializer. So is a malformed expression (or a missing one), once it is reported.
 		 */
-		bool parse_direct_declarator(translation_unit& tu, function_definition& fd) {
+		bool parse_initializer(ast_node_table& nodes, ast_node_id declared) {
 			ENTER_PARSE_FUNCTION();
-			std::string idval;
+			if (current_token().id != tok_l_curly_bracket) {
+				const checkpoint saved    = save_checkpoint(nodes);
+				m_met_unparsed_expression = false;
+				const ast_node_id initializer
+				     = parse_expression(nodes, assignment_expression_binding_power);
+				if (initializer.is_valid()
+				     && (current_token().id == tok_comma
+				          || current_token().id == tok_semicolon)) {
+					commit_checkpoint(nodes, saved);
+					nodes.append_child(declared, initializer);
+					return true;
+				}
+				const std::size_t failed_index = m_toks_index;
+				rollback_checkpoint(nodes, saved);
+				hold_malformed_expression(initializer, failed_index, "',' or ';'");
+			}
+			return skip_initializer();
+		}
 
-			// If we find lparen before the next '{' or ';', it's probably a function
-			// declarator
-			const token t = find_first_of({ tok_l_paren, tok_l_curly_bracket, tok_semicolon });
-			if (t.id == tok_l_paren && parse_function_declarator(tu, fd)) {
-				// parse_attribute_specifier_sequence(tu, fd);
-				return true;
+		/* Skips an initializer, up to the `,` or `;` that ends it. */
+		bool skip_initializer() noexcept {
+			for (;;) {
+				switch (current_token().id) {
+				case tok_comma:
+				case tok_semicolon:
+					return true;
+				case tok_end_of_input:
+					return false;
+				case tok_l_paren:
+				case tok_l_square_bracket:
+				case tok_l_curly_bracket: {
+					auto maybe_closing_index = matching_bracket();
+					if (!maybe_closing_index) {
+						return false;
+					}
+					m_toks_index = *maybe_closing_index + 1;
+				} break;
+				default:
+					get_next_token();
+					break;
+				}
 			}
+		}
 
-			if (parse_identifier(tu, fd, idval)) {
-				// parse_attribute_specifier_sequence(tu, fd);
+		/*
+		 * declaration ::=
+		 *    declaration-specifiers init-declarator-list? ;
+		 *    | attribute-specifier-sequence declaration-specifiers init-declarator-list ;
+		 *    | static_assert-declaration
+		 *    | attribute-declaration
+		 *
+		 * init-declarator-list ::= init-declarator | init-declarator-list , init-declarator
+		 * init-declarator ::= declarator | declarator = initializer
+		 * attribute-declaration ::= attribute-specifier-sequence ;
+		 *
+		 * Each declarator becomes a declaration node. Its name is in scope right after the
+		 * declarator, not after the whole declaration, so it is declared there: as a
+		 * typedef-name if the specifiers include `typedef`, and as an ordinary identifier
+		 * otherwise. A `constexpr` object's initializer is evaluated right after it is parsed
+		 * (see `define_constexpr_object`).
+		 */
+		bool parse_declaration(ast_node_table& nodes) {
+			ENTER_PARSE_FUNCTION();
+			if (current_token().id == tok_keyword_static_assert
+			     || current_token().id == tok_keyword__Static_assert) {
+				return parse_static_assert_declaration(nodes, m_translation_unit);
+			}
+			std::vector<attribute> attributes;
+			parse_attribute_specifier_sequence(nodes, attributes);
+			if (!attributes.empty() && current_token().id == tok_semicolon) {
+				// attribute-declaration
+				get_next_token();
+				for (attribute& attr : attributes) {
+					nodes.append_child(m_translation_unit, nodes.add_attribute(attr));
+				}
 				return true;
 			}
 
-			if (current_token().id == tok_l_paren) {
+			function_definition fd { function_declaration { type(), 0 }, token_range(),
+				ast_node_id() };
+			type_builder declared_builder;
+			if (!parse_memoized_declaration_specifiers(nodes, fd, declared_builder)) {
+				return false;
+			}
+			const unsigned short storage_classes = fd.declaration.storage_classes;
+			if (declared_builder.empty() && storage_classes == 0) {
+				return false;
+			}
+			// what alignment specifiers ask for applies to what is declared, not to its base
+			const std::uint8_t alignment_log2 = declared_builder.alignment_log2;
+			declared_builder.alignment_log2   = 0;
+			const type base_type              = m_types.intern(declared_builder);
+			const bool is_typedef
+			     = (storage_classes & storage_class_specifier::scs_typedef) != 0;
+
+			if (current_token().id == tok_semicolon) {
+				// declares nothing but a structure or union's tag, if even that
 				get_next_token();
-				if (!parse_declarator(tu, fd)) {
-					unget_token();
+				return true;
+			}
+			for (bool is_first = true;; is_first = false) {
+				declarator_info declarator;
+				if (is_first ? !parse_memoized_declarator(nodes, fd, declarator)
+				             : !parse_declarator(nodes, fd, declarator)) {
 					return false;
 				}
-				eat_token(tok_r_paren);
-			}
+				const type declared_type
+				     = aligned_type(derived_type(base_type, declarator), alignment_log2);
+				const ast_node_id declared
+				     = nodes.add_declaration(
+				          declaration { declared_type, declarator.name, storage_classes });
+				m_symbols.declare(symbol_namespace::ordinary, declarator.name,
+				     is_typedef                ? symbol_kind::typedef_name
+				          : declarator.is_function ? symbol_kind::function
+				                                   : symbol_kind::object,
+				     declared_type, declared);
+				for (const attribute& attr : attributes) {
+					nodes.append_child(declared, nodes.add_attribute(attr));
+				}
+				nodes.append_child(m_translation_unit, declared);
 
-			if (parse_array_declarator(tu, fd)) {
-				// parse_attribute_specifier_sequence(tu, fd);
-				return true;
+				if (current_token().id == tok_equals_sign) {
+					get_next_token();
+					if (!parse_initializer(nodes, declared)) {
+						return false;
+					}
+				}
+				if ((storage_classes & storage_class_specifier::scs_constexpr) != 0
+				     && m_symbols.scope_depth() == 0) {
+					define_constexpr_object(nodes, declared);
+				}
+				else {
+					m_constants.forget_object(declarator.name);
+				}
+				switch (current_token().id) {
+				case tok_comma:
+					get_next_token();
+					break;
+				case tok_semicolon:
+					get_next_token();
+					return true;
+				default:
+					return false;
+				}
 			}
+		}
 
-			return false;
+		/* Evaluates the initializer of `declared`, a `constexpr` object at file scope, and keeps
+		 * its value (converted to the object's type) for whatever names it from then on. One
+		 * with no initializer that can be evaluated (such as a braced one, which is not parsed
+		 * yet) or with a type that is not arithmetic has no value. Reports an initializer that
+		 * is not a constant expression, or whose value the object cannot hold exactly. */
+		void define_constexpr_object(const ast_node_table& nodes, ast_node_id declared) {
+			const declaration& data       = nodes.declaration_data(declared);
+			const ast_node_id initializer = nodes.last_child(declared);
+			m_constants.forget_object(data.name);
+			if (!initializer.is_valid() || nodes.kind(initializer) != ast_node_kind::expression
+			     || !is_arithmetic(m_types.data(data.t))) {
+				return;
+			}
+			constant_result value = evaluate_constant(nodes, initializer);
+			if (value) {
+				value = constant_evaluator_for(nodes).convert_exactly(
+				     *value, data.t, initializer);
+			}
+			if (!value) {
+				hold_not_constant(nodes, value.error());
+				return;
+			}
+			m_constants.record_object(data.name, *value);
 		}
 
 		/*
-		 * declarator ::= pointer? direct-declarator
+		 * static_assert-declaration ::=
+		 *    static_assert ( constant-expression , string-literal ) ;
+		 *    | static_assert ( constant-expression ) ;
+		 *
+		 * Becomes a static_assert_declaration child of `parent`, with the expression and then
+		 * the message (if there is one) as its children. The expression is evaluated as soon as
+		 * it is parsed, and the assertion is reported if it is 0 or not an integer constant
+		 * expression; either way, it is still a declaration.
 		 */
-		bool parse_declarator(translation_unit& tu, function_definition& fd) {
+		bool parse_static_assert_declaration(ast_node_table& nodes, ast_node_id parent) {
 			ENTER_PARSE_FUNCTION();
-			parse_pointer(tu, fd);
-			if (!parse_direct_declarator(tu, fd))
+			const source_location location = current_token().location;
+			get_next_token();
+			if (current_token().id != tok_l_paren) {
+				return false;
+			}
+			get_next_token();
+			const ast_node_id condition
+			     = parse_expression(nodes, conditional_expression_binding_power);
+			if (!condition.is_valid()) {
+				return false;
+			}
+			ast_node_id message;
+			if (current_token().id == tok_comma) {
+				get_next_token();
+				if (current_token().id != tok_str_literal) {
+					return false;
+				}
+				message = parse_primary_expression(nodes);
+			}
+			if (current_token().id != tok_r_paren) {
 				return false;
+			}
+			get_next_token();
+			if (current_token().id != tok_semicolon) {
+				return false;
+			}
 			get_next_token();
+			const ast_node_id asserted
+			     = nodes.add_node(ast_node_kind::static_assert_declaration);
+			nodes.append_child(asserted, condition);
+			if (message.is_valid()) {
+				nodes.append_child(asserted, message);
+			}
+			nodes.append_child(parent, asserted);
+
+			const constant_result value = evaluate_constant(nodes, condition);
+			if (!value) {
+				hold_not_constant(nodes, value.error());
+			}
+			else if (value->is_floating()) {
+				hold_not_constant(
+				     nodes, constant_failure { constant_error::not_integer, condition });
+			}
+			else if (!value->is_nonzero()) {
+				std::string quoted;
+				if (message.is_valid()) {
+					// adjacent string literals are one message
+					quoted = ": \"";
+					for (std::size_t index = nodes.expression_data(message).token_index;
+					     index < m_toks.size() && m_toks[index].id == tok_str_literal;
+					     ++index) {
+						quoted += lexed_string_literal(m_toks[index].value);
+					}
+					quoted += '"';
+				}
+				hold_diagnostic(
+				     parser_err::static_assertion_failed, location, std::move(quoted));
+			}
 			return true;
 		}
 
-		bool parse_function_body(translation_unit& tu, function_definition& fd) {
-			ENTER_PARSE_FUNCTION();
-			return false;
+		/* Holds back a report of why an expression is not constant, at the token of the node
+		 * that makes it so. */
+		void hold_not_constant(const ast_node_table& nodes, const constant_failure& failed) {
+			hold_diagnostic(parser_err::not_a_constant_expression,
+			     m_toks[nodes.expression_data(failed.node).token_index].location,
+			     std::string(constant_error_message(failed.error)));
 		}
 
-		/*
-		 * function-definition ::=
-		 *    attribute-specifier-sequence? declaration-specifiers declarator function-body
-		 */
-		bool parse_function_definition(translation_unit& tu) {
-			ENTER_PARSE_FUNCTION();
-			function_definition fd;
-			fd.declaration.t = type_data::get_new_type();
-
-			parse_attribute_specifier_sequence(tu, fd.declaration.attributes);
-
-			type return_type = type_data::get_new_type();
-			if (!parse_declaration_specifiers(tu, fd, return_type))
-				return false;
-
-			if (!parse_declarator(tu, fd))
-				return false;
-
-			if (!parse_function_body(tu, fd))
-				return false;
+		/* Holds back a report of an expression that failed to parse at `failed_index`, unless
+		 * it failed on something the expression parser does not know yet. `parsed` is what
+		 * was made of it, which is valid if the expression was whole but not followed by
+		 * `expected`. */
+		void hold_malformed_expression(
+		     ast_node_id parsed, std::size_t failed_index, std::string_view expected) {
+			if (m_met_unparsed_expression) {
+				return;
+			}
+			const source_location location = location_at(failed_index);
+			if (parsed.is_valid()) {
+				hold_diagnostic(
+				     parser_err::expected_after_expression, location, std::string(expected));
+			}
+			else {
+				hold_diagnostic(parser_err::expected_expression, location, std::string());
+			}
+		}
 
-			return true;
+		void hold_diagnostic(const parser_diagnostic& diagnostic, source_location location,
+		     std::string argument) {
+			m_held_diagnostics.push_back(
+			     held_diagnostic { &diagnostic, location, std::move(argument) });
 		}
 
-		/*
-		 *
-		 */
-		bool parse_declaration(translation_unit& tu) {
-			ENTER_PARSE_FUNCTION();
-			return false;
+		/* Reports every diagnostic held back so far. */
+		void report_held_diagnostics() noexcept {
+			for (const held_diagnostic& held : m_held_diagnostics) {
+				m_reporter.report(*held.diagnostic, held.location, held.argument);
+			}
+			m_held_diagnostics.clear();
 		}
 
 		/*
@@ -738,25 +2665,30 @@ namespace a_c_compiler {
 		 *
 		 * external-declaration ::= function-definition | declaration
 		 */
-		bool parse_external_declaration(translation_unit& tu) noexcept {
+		bool parse_external_declaration(ast_node_table& nodes) noexcept {
 			ENTER_PARSE_FUNCTION();
-			if (m_toks.empty()) {
+			if (!has_more_tokens()) {
 				return false;
 			}
 
-			push_token_index();
-			if (parse_function_definition(tu))
+			// A failed function definition keeps what its memoized rules made, for the
+			// declaration to replay: only a failed declaration takes all of it back.
+			const checkpoint saved          = save_checkpoint(nodes);
+			const checkpoint function_saved = save_checkpoint(nodes);
+			if (parse_function_definition(nodes)) {
+				commit_checkpoint(nodes, function_saved);
+				commit_checkpoint(nodes, saved);
+				m_memo.clear();
 				return true;
-			pop_token_index();
-
-			push_token_index();
-			if (parse_declaration(tu))
+			}
+			rollback_checkpoint(
+			     nodes, keeping_memoized(function_saved), "parse_function_definition");
+			if (parse_declaration(nodes)) {
+				commit_checkpoint(nodes, saved);
+				m_memo.clear();
 				return true;
-			pop_token_index();
-
-			/* Keep track of first and last token when searching for a declaration.
-			 * Figure out the details later. */
-			auto const& start_token = current_token();
+			}
+			rollback_checkpoint(nodes, saved, "parse_declaration");
 
 			/* To determine if we're working with a var decl or a function decl, we
 			 * must first try to parse an ident token. */
@@ -765,20 +2697,20 @@ namespace a_c_compiler {
 				switch (tok.id) {
 #define KEYWORD_TOKEN(TOK, INTVAL, KEYWORD) \
 	case TOK:                              \
-		return parse_##KEYWORD(tu);
+		return parse_##KEYWORD(nodes);
 #include <a_c_compiler/fe/lex/tokens.inl.h>
 #undef KEYWORD_TOKEN
 
 				default:
 					// unrecognized token: report and bail!
 					m_reporter.report(
-					     parser_err::unrecognized_token, "", tok.source_location, (int)tok.id);
+					     parser_err::unrecognized_token, tok.location, (int)tok.id);
 					return false;
 				}
 				auto maybe_err = get_next_token();
 				if (!maybe_err.has_value()) {
 					const auto wrapped_err = maybe_err.error();
-					m_reporter.report(wrapped_err, "", tok.source_location);
+					m_reporter.report(wrapped_err, tok.location);
 					break;
 				}
 			}
@@ -786,23 +2718,737 @@ namespace a_c_compiler {
 			return false;
 		}
 
-		translation_unit parse_translation_unit() noexcept {
-			translation_unit tu {};
-			while (parse_external_declaration(tu)) {
-				continue;
+		/* Like `parse_external_declaration`, but notes what it parsed at the end of
+		 * `parsed`. */
+		bool parse_noted_external_declaration(ast_node_table& nodes,
+		     std::vector<external_declaration_extent>& parsed) noexcept {
+			const std::size_t begin            = m_toks_index;
+			const ast_node_id last_declaration = nodes.last_child(m_translation_unit);
+			const bool is_parsed               = parse_external_declaration(nodes);
+			report_held_diagnostics();
+			if (!is_parsed) {
+				return false;
+			}
+			std::uint32_t node_count = 0;
+			for (ast_node_id node = last_declaration.is_valid()
+			          ? nodes.next_sibling(last_declaration)
+			          : nodes.first_child(m_translation_unit);
+			     node.is_valid(); node = nodes.next_sibling(node)) {
+				++node_count;
+			}
+			const token_range tokens { static_cast<std::uint32_t>(begin),
+				static_cast<std::uint32_t>(m_toks_index) };
+			parsed.push_back(external_declaration_extent { tokens, node_count });
+			return true;
+		}
+
+		/* Parses every external declaration from the current token on. One that fails to
+		 * parse has already been reported, and the parse moves on to the one after it (see
+		 * `end_of_external_declaration`), just as `parse_segments` does. */
+		void parse_translation_unit(ast_node_table& nodes, ast_node_id translation_unit,
+		     std::vector<external_declaration_extent>& parsed) noexcept {
+			m_translation_unit = translation_unit;
+			while (has_token(m_toks_index)) {
+				const std::size_t begin = m_toks_index;
+				if (parse_noted_external_declaration(nodes, parsed)) {
+					continue;
+				}
+				const std::optional<std::size_t> end
+				     = end_of_external_declaration(m_toks, m_matching_brackets, begin, m_feed);
+				if (!end) {
+					break;
+				}
+				m_toks_index = *end;
+			}
+			debug_memo_counts();
+		}
+
+		/* Parses each of `segments` (see `split_external_declarations`) in turn, as external
+		 * declarations of `translation_unit`. A segment that fails to parse has already been
+		 * reported, and the parse moves on to the next one. */
+		void parse_segments(ast_node_table& nodes, ast_node_id translation_unit,
+		     std::span<const token_range> segments,
+		     std::vector<external_declaration_extent>& parsed) noexcept {
+			m_translation_unit = translation_unit;
+			for (const token_range& segment : segments) {
+				m_toks_index = segment.begin;
+				while (m_toks_index < segment.end
+				     && parse_noted_external_declaration(nodes, parsed)) {
+					continue;
+				}
 			}
-			return tu;
+			debug_memo_counts();
+		}
+
+		void debug_memo_counts() noexcept {
+			DEBUG("memo table saved %zu re-parses out of %zu lookups\n",
+			     m_memo_saved_reparses, m_memo_lookups);
 		}
 	};
 
 
 
-	ast_module parse(token_vector const& toks, const global_options& global_opts,
-	     diagnostic_handles& diag_handles) noexcept {
-		parser_diagnostic_reporter reporter { diag_handles };
-		parser p(0, toks, reporter, global_opts);
-		ast_module mod { p.parse_translation_unit() };
+	namespace {
+		/* Makes a parser, tracing and profiling or not as -fdebug-parser and -fprofile-parser
+		 * say, and runs `action` with it. */
+		template <typename Action>
+		decltype(auto) with_parser(std::size_t toks_index, token_source const& source,
+		     type_table& types, symbol_table& symbols, constant_table& constants,
+		     parser_diagnostic_reporter& reporter, const global_options& global_opts,
+		     token_feed* feed, Action&& action) {
+			const auto run = [&]<bool Tracing, bool Profiling>() -> decltype(auto) {
+				parser<parse_instrumentation<Tracing, Profiling>> p(toks_index, source, types,
+				     symbols, constants, reporter, global_opts, feed);
+				return action(p);
+			};
+			const bool tracing   = global_opts.get_feature_flag(1, 0x1);
+			const bool profiling = global_opts.get_feature_flag(1, 0x4);
+			if (tracing) {
+				return profiling ? run.template operator()<true, true>()
+				                 : run.template operator()<true, false>();
+			}
+			return profiling ? run.template operator()<false, true>()
+			                 : run.template operator()<false, false>();
+		}
+
+		std::unique_ptr<token_source> make_token_source(token_vector const& toks,
+		     const source_manager& sources, const global_options& global_opts,
+		     diagnostic_handles& diag_handles) noexcept {
+			auto source = std::make_unique<token_source>(
+			     token_source { {}, {}, &sources, &global_opts, &diag_handles });
+			source->matching_brackets.reserve(toks.size());
+			token_source_builder { *source }.append(toks);
+			return source;
+		}
+
+		/* Splits the tokens of a translation unit into one run of tokens per external
+		 * declaration (see `end_of_external_declaration`). Returns nothing if some bracket at
+		 * the top level is unmatched. */
+		std::optional<std::vector<token_range>> split_external_declarations(
+		     token_source const& source) noexcept {
+			std::vector<token_range> segments;
+			std::size_t begin = 0;
+			while (begin < source.tokens.size()) {
+				const std::optional<std::size_t> end = end_of_external_declaration(
+				     source.tokens, source.matching_brackets, begin, nullptr);
+				if (!end) {
+					return std::nullopt;
+				}
+				segments.push_back(token_range { static_cast<std::uint32_t>(begin),
+					static_cast<std::uint32_t>(*end) });
+				begin = *end;
+			}
+			return segments;
+		}
+
+		/* Whether a segment declares a name that decides how what comes after it parses, or
+		 * what type it is: a typedef-name, the tag of a structure or union it defines, or a
+		 * `constexpr` object (whose value can be the length of an array). That is, whether it
+		 * has `typedef` or `constexpr` outside of any brackets, or `struct` or `union` followed
+		 * by a tag and a body. */
+		bool shapes_later_declarations(
+		     token_source const& source, token_range segment) noexcept {
+			for (std::size_t index = segment.begin; index < segment.end; ++index) {
+				switch (source.tokens[index].id) {
+				case tok_keyword_typedef:
+				case tok_keyword_constexpr:
+					return true;
+				case tok_keyword_struct:
+				case tok_keyword_union: {
+					std::size_t next = index + 1;
+					// attributes can come before the tag
+					while (next < segment.end
+					     && source.tokens[next].id == tok_l_square_bracket) {
+						next = std::size_t(source.matching_brackets[next]) + 1;
+					}
+					if (next + 1 < segment.end && source.tokens[next].id == tok_id
+					     && source.tokens[next + 1].id == tok_l_curly_bracket) {
+						return true;
+					}
+				} break;
+				case tok_l_paren:
+				case tok_l_square_bracket:
+				case tok_l_curly_bracket:
+					index = source.matching_brackets[index];
+					break;
+				default:
+					break;
+				}
+			}
+			return false;
+		}
+
+		std::vector<parameter_declaration> parameters_of(
+		     const ast_node_table& nodes, ast_node_id definition) noexcept {
+			std::vector<parameter_declaration> parameters;
+			for (ast_node_id child = nodes.first_child(definition); child.is_valid();
+			     child = nodes.next_sibling(child)) {
+				if (nodes.kind(child) == ast_node_kind::parameter_declaration) {
+					parameters.push_back(nodes.parameter_declaration_data(child));
+				}
+			}
+			return parameters;
+		}
+
+		/* Parses a body that was skipped into `nodes`, returning its compound statement.
+		 * `symbols` is what was declared at file scope by the end of the translation
+		 * unit, which can be more than was declared before the function; it is left as it was
+		 * found. What is wrong with the body goes to `reporter`. */
+		ast_node_id parse_skipped_body(token_source const& source, ast_node_table& nodes,
+		     type_table& types, symbol_table& symbols, constant_table& constants,
+		     parser_diagnostic_reporter& reporter,
+		     std::span<const parameter_declaration> parameters,
+		     token_range body_tokens) noexcept {
+			const symbol_table::checkpoint file_scope = symbols.save();
+			symbols.push_scope(scope_kind::function);
+			ast_node_id body;
+			with_parser(body_tokens.begin, source, types, symbols, constants, reporter,
+			     *source.global_opts, nullptr, [&](auto& p) {
+				     p.declare_parameters(parameters);
+				     // a body that fails to parse has already been reported; keep what was
+				     // made of it
+				     p.parse_compound_statement(nodes, body);
+				     p.report_held_diagnostics();
+			     });
+			if (!body.is_valid()) {
+				body = nodes.add_node(ast_node_kind::compound_statement);
+			}
+			symbols.rollback(file_scope);
+			return body;
+		}
+
+		/* Whether `source` is nothing but whole external declarations, as far as the brackets
+		 * can tell: every bracket is matched, and the last token is the `;` or `}` that ends a
+		 * declaration. */
+		bool holds_whole_declarations(token_source const& source) noexcept {
+			if (source.tokens.empty()) {
+				return true;
+			}
+			for (std::size_t index = 0; index < source.tokens.size(); ++index) {
+				switch (source.tokens[index].id) {
+				case tok_l_paren:
+				case tok_l_square_bracket:
+				case tok_l_curly_bracket:
+				case tok_r_paren:
+				case tok_r_square_bracket:
+				case tok_r_curly_bracket:
+					if (source.matching_brackets[index] == token_source::no_matching_bracket) {
+						return false;
+					}
+					break;
+				default:
+					break;
+				}
+			}
+			const token_id last_id = source.tokens.back().id;
+			return last_id == tok_semicolon || last_id == tok_r_curly_bracket;
+		}
+
+		/* Moves each token index that the nodes from `first_node` on refer to by `delta`, if it
+		 * is at least `from`. */
+		void move_token_indices(ast_node_table& nodes, std::uint32_t first_node,
+		     std::uint32_t from, std::int64_t delta) noexcept {
+			const auto move = [from, delta](std::uint32_t& index) noexcept {
+				if (index >= from) {
+					index = static_cast<std::uint32_t>(index + delta);
+				}
+			};
+			for (std::uint32_t index = first_node; index < nodes.size(); ++index) {
+				const ast_node_id node(index);
+				switch (nodes.kind(node)) {
+				case ast_node_kind::function_definition: {
+					token_range& tokens = nodes.function_definition_data(node).body_tokens;
+					move(tokens.begin);
+					move(tokens.end);
+				} break;
+				case ast_node_kind::attribute: {
+					token_range& tokens = nodes.attribute_data(node).tokens;
+					move(tokens.begin);
+					move(tokens.end);
+				} break;
+				case ast_node_kind::statement: {
+					token_range& tokens = nodes.statement_data(node).tokens;
+					move(tokens.begin);
+					move(tokens.end);
+				} break;
+				case ast_node_kind::expression:
+					move(nodes.expression_data(node).token_index);
+					break;
+				default:
+					break;
+				}
+			}
+		}
+	} // namespace
+
+	ast_module parse(token_vector const& toks, const source_manager& sources,
+	     const global_options& global_opts, diagnostic_handles& diag_handles) noexcept {
+		ast_module mod {};
+		parse_into(mod, toks, sources, global_opts, diag_handles);
+		return mod;
+	}
+
+	void parse_into(ast_module& mod, token_vector const& toks, const source_manager& sources,
+	     const global_options& global_opts, diagnostic_handles& diag_handles) noexcept {
+		std::size_t first_token = 0;
+		if (mod.source) {
+			// the module's tokens so far are whole declarations, with every bracket closed
+			first_token = mod.source->tokens.size();
+			token_source_builder { *mod.source }.append(toks);
+		}
+		else {
+			mod.source = make_token_source(toks, sources, global_opts, diag_handles);
+		}
+		parser_diagnostic_reporter reporter { diag_handles, sources };
+		with_parser(first_token, *mod.source, mod.types, mod.symbols, mod.constants, reporter,
+		     global_opts, nullptr, [&](auto& p) {
+			     p.parse_translation_unit(mod.nodes, mod.root(), mod.external_declarations);
+		     });
+	}
+
+	ast_module parse_pipelined(const source_manager& sources, file_id source_file,
+	     const global_options& global_opts, diagnostic_handles& diag_handles) noexcept {
+		ast_module mod {};
+		mod.source = std::make_unique<token_source>(
+		     token_source { {}, {}, &sources, &global_opts, &diag_handles });
+		// A reference to a token stays good while more come in, since `tokens` never moves
+		// the ones it has. Nothing holds on to a bracket's match, so `matching_brackets` grows
+		// with what the lexer has produced so far, like any vector.
+
+		// The two share the queue, and the tables of spellings, which the parser reads the
+		// literals it evaluates from while the lexer adds more (see `intern_identifier`).
+		auto queue = std::make_unique<token_queue>();
+		std::vector<lex_error> lex_errors;
+		std::thread lexer(
+		     [&]() noexcept { lex_errors = lex_into(sources, source_file, *queue); });
+		token_feed feed { token_source_builder { *mod.source }, *queue };
+		parser_diagnostic_reporter reporter { diag_handles, sources };
+		with_parser(0, *mod.source, mod.types, mod.symbols, mod.constants, reporter, global_opts,
+		     &feed, [&](auto& p) {
+			     p.parse_translation_unit(mod.nodes, mod.root(), mod.external_declarations);
+		     });
+		// take whatever the parse stopped short of, so that the module has every token (for
+		// skipped bodies), and so that the lexer is not left waiting on a full queue
+		while (feed.pull()) {
+			continue;
+		}
+		lexer.join();
+		report_lex_errors(lex_errors, sources, diag_handles);
+		return mod;
+	}
+
+	ast_module parse_in_parallel(token_vector const& toks, const source_manager& sources,
+	     const global_options& global_opts, diagnostic_handles& diag_handles,
+	     std::size_t thread_count) noexcept {
+		thread_count = default_thread_count(thread_count);
+		ast_module mod {};
+		mod.source = make_token_source(toks, sources, global_opts, diag_handles);
+		std::optional<std::vector<token_range>> segments
+		     = split_external_declarations(*mod.source);
+		if (thread_count <= 1 || !segments || segments->size() < 2) {
+			parser_diagnostic_reporter reporter { diag_handles, sources };
+			with_parser(0, *mod.source, mod.types, mod.symbols, mod.constants, reporter,
+			     global_opts, nullptr, [&](auto& p) {
+				     p.parse_translation_unit(mod.nodes, mod.root(), mod.external_declarations);
+			     });
+			return mod;
+		}
+
+		// Whether an identifier is a typedef-name decides how everything after it parses, and
+		// what a tag or a `constexpr` object names decides the type of everything that uses
+		// it, so every typedef-name, every tag defined at file scope and every `constexpr`
+		// object has to be known before anything else is. Those declarations are parsed first,
+		// in order, for their types, values and names alone: their nodes (and the constants
+		// evaluated by node) are thrown away, and they are parsed again (and reported) along
+		// with everything else. So are the names, once every batch has them: they were
+		// declared by the nodes thrown away, and the batches declare them again by their own.
+		// The structures and unions are kept, and a batch that parses one's body again takes
+		// the type the pre-scan gave it.
+		const symbol_table::checkpoint no_declarations = mod.symbols.save();
+		std::unordered_map<std::uint32_t, type> record_bodies;
+		{
+			const constant_table::checkpoint no_expressions = mod.constants.save();
+			std::pmr::monotonic_buffer_resource scratch_arena;
+			ast_node_table scratch_nodes(&scratch_arena);
+			const ast_node_id scratch_root
+			     = scratch_nodes.add_node(ast_node_kind::translation_unit);
+			std::vector<external_declaration_extent> scratch_declarations;
+			parser_diagnostic_reporter silenced_reporter {
+				diag_handles, sources, reporting_mode::silenced
+			};
+			with_parser(0, *mod.source, mod.types, mod.symbols, mod.constants,
+			     silenced_reporter, global_opts, nullptr, [&](auto& p) {
+				     p.m_record_bodies = &record_bodies;
+				     for (const token_range& segment : *segments) {
+					     if (shapes_later_declarations(*mod.source, segment)) {
+						     p.parse_segments(scratch_nodes, scratch_root,
+						          std::span(&segment, 1), scratch_declarations);
+					     }
+				     }
+			     });
+			mod.constants.rollback(no_expressions);
+		}
+
+		// Each batch is a contiguous run of declarations, parsed into a node table (and an
+		// arena) of its own under a root of its own, against its own copy of the types, the
+		// typedef-names and the constants. The batches are spliced into the module in order
+		// afterwards, so the translation unit ends up with its declarations in source order.
+		const std::size_t batch_count          = std::min(thread_count, segments->size());
+		const type_table::checkpoint file_types = mod.types.save();
+		std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> batch_arenas;
+		std::vector<ast_node_table> batch_nodes;
+		std::vector<ast_node_id> batch_roots;
+		std::vector<type_table> batch_types(batch_count, mod.types);
+		std::vector<symbol_table> batch_symbols(batch_count, mod.symbols);
+		std::vector<symbol_table::checkpoint> batch_file_scopes;
+		std::vector<constant_table> batch_constants(batch_count, mod.constants);
+		const constant_table::checkpoint file_constants = mod.constants.save();
+		std::vector<std::unordered_map<std::uint32_t, type>> batch_record_bodies(
+		     batch_count, record_bodies);
+		std::vector<std::vector<external_declaration_extent>> batch_declarations(batch_count);
+		// held back until every batch is done, and then reported batch by batch, so that they
+		// come out in the order of the declarations they are about
+		std::vector<parser_diagnostic_reporter> batch_reporters;
+		batch_arenas.reserve(batch_count);
+		batch_nodes.reserve(batch_count);
+		batch_reporters.reserve(batch_count);
+		for (std::size_t batch = 0; batch < batch_count; ++batch) {
+			batch_reporters.emplace_back(diag_handles, sources, reporting_mode::held);
+			batch_arenas.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+			batch_nodes.emplace_back(batch_arenas.back().get());
+			batch_roots.push_back(batch_nodes.back().add_node(ast_node_kind::translation_unit));
+			batch_file_scopes.push_back(batch_symbols[batch].save());
+		}
+		const auto batch_begin = [&](std::size_t batch) noexcept {
+			return segments->size() * batch / batch_count;
+		};
+		parallel_for(batch_count, batch_count, [&](std::size_t batch) noexcept {
+			const std::span<const token_range> batch_segments = std::span(*segments).subspan(
+			     batch_begin(batch), batch_begin(batch + 1) - batch_begin(batch));
+			with_parser(0, *mod.source, batch_types[batch], batch_symbols[batch],
+			     batch_constants[batch], batch_reporters[batch], global_opts, nullptr,
+			     [&](auto& p) {
+				     p.m_record_bodies = &batch_record_bodies[batch];
+				     p.parse_segments(batch_nodes[batch], batch_roots[batch], batch_segments,
+				          batch_declarations[batch]);
+			     });
+		});
+
+		mod.symbols.rollback(no_declarations);
+		for (std::size_t batch = 0; batch < batch_count; ++batch) {
+			batch_reporters[batch].report_held();
+			const type_relocation types
+			     = mod.types.append_types(batch_types[batch], file_types);
+			const std::uint32_t offset = mod.nodes.append_table(batch_nodes[batch], types);
+			mod.nodes.adopt_children(
+			     mod.root(), ast_node_id(batch_roots[batch].index() + offset));
+			mod.constants.append(batch_constants[batch], file_constants, offset);
+			mod.external_declarations.insert(mod.external_declarations.end(),
+			     batch_declarations[batch].begin(), batch_declarations[batch].end());
+			// what each batch declared at file scope, for parsing skipped bodies against
+			for (const symbol& declared :
+			     batch_symbols[batch].declared_since(batch_file_scopes[batch])) {
+				mod.symbols.declare(declared.name_space, declared.name, declared.kind,
+				     types(declared.t),
+				     declared.declaration.is_valid()
+				          ? ast_node_id(declared.declaration.index() + offset)
+				          : declared.declaration);
+			}
+		}
 		return mod;
 	}
 
+	ast_node_id function_body(ast_module& mod, ast_node_id definition) noexcept {
+		if (!mod.nodes.function_definition_data(definition).body.is_valid()) {
+			const token_range body_tokens
+			     = mod.nodes.function_definition_data(definition).body_tokens;
+			token_source& source = *mod.source;
+			parser_diagnostic_reporter reporter { *source.diag_handles, *source.sources };
+			const ast_node_id body = parse_skipped_body(source, mod.nodes, mod.types,
+			     mod.symbols, mod.constants, reporter, parameters_of(mod.nodes, definition),
+			     body_tokens);
+			mod.nodes.function_definition_data(definition).body = body;
+			mod.nodes.append_child(definition, body);
+		}
+		return mod.nodes.function_definition_data(definition).body;
+	}
+
+	void parse_function_bodies(ast_module& mod, std::size_t thread_count) noexcept {
+		std::vector<ast_node_id> skipped;
+		for (ast_node_id node = mod.nodes.first_child(mod.root()); node.is_valid();
+		     node = mod.nodes.next_sibling(node)) {
+			if (mod.nodes.kind(node) == ast_node_kind::function_definition
+			     && !mod.nodes.function_definition_data(node).body.is_valid()) {
+				skipped.push_back(node);
+			}
+		}
+		if (skipped.empty()) {
+			return;
+		}
+		// Neither an arena nor a node table is thread-safe, so the bodies are dealt out in one
+		// contiguous batch per thread. Each batch is parsed into a node table of its own, in
+		// an arena of its own, and the tables are spliced into the module afterwards.
+		const std::size_t batch_count
+		     = std::min(default_thread_count(thread_count), skipped.size());
+		std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> batch_arenas;
+		std::vector<ast_node_table> batch_nodes;
+		// Every batch starts from the module's types (so typedef-names can be looked up) and
+		// adds the types its bodies make, such as those of casts, on top. Those are interned
+		// into the module's table when the nodes are spliced in.
+		const type_table::checkpoint file_types = mod.types.save();
+		std::vector<type_table> batch_types(batch_count, mod.types);
+		// every batch opens and closes scopes of its own on top of the file scope
+		std::vector<symbol_table> batch_symbols(batch_count, mod.symbols);
+		std::vector<constant_table> batch_constants(batch_count, mod.constants);
+		const constant_table::checkpoint file_constants = mod.constants.save();
+		// held back and reported batch by batch, in the order of the bodies
+		std::vector<parser_diagnostic_reporter> batch_reporters;
+		batch_arenas.reserve(batch_count);
+		batch_nodes.reserve(batch_count);
+		batch_reporters.reserve(batch_count);
+		for (std::size_t batch = 0; batch < batch_count; ++batch) {
+			batch_reporters.emplace_back(
+			     *mod.source->diag_handles, *mod.source->sources, reporting_mode::held);
+			batch_arenas.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+			batch_nodes.emplace_back(batch_arenas.back().get());
+		}
+		const auto batch_begin = [&](std::size_t batch) noexcept {
+			return skipped.size() * batch / batch_count;
+		};
+		std::vector<ast_node_id> bodies(skipped.size());
+		parallel_for(batch_count, batch_count, [&](std::size_t batch) noexcept {
+			for (std::size_t index = batch_begin(batch); index < batch_begin(batch + 1);
+			     ++index) {
+				bodies[index] = parse_skipped_body(*mod.source, batch_nodes[batch],
+				     batch_types[batch], batch_symbols[batch], batch_constants[batch],
+				     batch_reporters[batch], parameters_of(mod.nodes, skipped[index]),
+				     mod.nodes.function_definition_data(skipped[index]).body_tokens);
+			}
+		});
+		for (std::size_t batch = 0; batch < batch_count; ++batch) {
+			batch_reporters[batch].report_held();
+			const type_relocation types
+			     = mod.types.append_types(batch_types[batch], file_types);
+			const std::uint32_t offset = mod.nodes.append_table(batch_nodes[batch], types);
+			mod.constants.append(batch_constants[batch], file_constants, offset);
+			for (std::size_t index = batch_begin(batch); index < batch_begin(batch + 1);
+			     ++index) {
+				const ast_node_id body(bodies[index].index() + offset);
+				mod.nodes.function_definition_data(skipped[index]).body = body;
+				mod.nodes.append_child(skipped[index], body);
+			}
+		}
+	}
+
+	token_range reparse_edited(
+	     ast_module& mod, file_id edited_file, const text_edit& edit) noexcept {
+		ZTD_ASSERT_MESSAGE("the module was not parsed from a source file", mod.source);
+		token_source& source          = *mod.source;
+		const source_manager& sources = *source.sources;
+		const std::vector<external_declaration_extent>& declarations
+		     = mod.external_declarations;
+		const std::uint32_t token_count = static_cast<std::uint32_t>(source.tokens.size());
+		const std::uint32_t edited_size
+		     = static_cast<std::uint32_t>(sources.buffer(edited_file).size());
+		const std::int64_t size_delta = static_cast<std::int64_t>(edit.replacement.size())
+		     - static_cast<std::int64_t>(edit.end - edit.begin);
+		const std::uint32_t file_size = static_cast<std::uint32_t>(edited_size - size_delta);
+
+		// The tokens of each external declaration, and whatever follows them up to the next
+		// one, are a piece of the file; the first piece starts at the start of the file. An
+		// edit touches the pieces it overlaps, or is next to, and those are parsed again.
+		const auto piece_begin = [&](std::size_t index) noexcept -> std::uint32_t {
+			if (index == 0) {
+				return 0;
+			}
+			if (index == declarations.size()) {
+				return file_size;
+			}
+			return sources.offset_of(source.tokens[declarations[index].tokens.begin].location);
+		};
+		const auto ends_before_edit = [&](std::size_t index) noexcept {
+			return piece_begin(index + 1) < edit.begin;
+		};
+		const auto begins_by_edit_end = [&](std::size_t index) noexcept {
+			return piece_begin(index) <= edit.end;
+		};
+		const auto indices = std::views::iota(std::size_t(0), declarations.size());
+		const std::size_t first_piece
+		     = std::ranges::partition_point(indices, ends_before_edit) - indices.begin();
+		std::size_t end_piece
+		     = std::ranges::partition_point(indices, begins_by_edit_end) - indices.begin();
+
+		const std::uint32_t begin_index
+		     = first_piece == 0 ? 0 : declarations[first_piece].tokens.begin;
+		const std::uint32_t begin_offset = piece_begin(first_piece);
+		std::uint32_t end_index          = 0;
+		token_source region { {}, {}, &sources, source.global_opts, source.diag_handles };
+		// Whether a piece is a typedef, defines a tag or defines a `constexpr` object decides
+		// how every piece after it parses, and where an edit leaves a bracket or a comment
+		// open there is no telling where it ends: then everything from the first piece on is
+		// parsed again.
+		for (;;) {
+			end_index = end_piece == declarations.size() ? token_count
+			                                              : declarations[end_piece].tokens.begin;
+			if (end_piece != declarations.size()
+			     && shapes_later_declarations(source, token_range { begin_index, end_index })) {
+				end_piece = declarations.size();
+				continue;
+			}
+			const std::uint32_t end_offset = static_cast<std::uint32_t>(
+			     (end_piece == declarations.size() ? file_size : piece_begin(end_piece))
+			     + size_delta);
+			std::optional<token_vector> lexed = lex_range(sources, edited_file, begin_offset,
+			     end_offset, *source.global_opts, *source.diag_handles);
+			if (lexed) {
+				region.tokens.clear();
+				region.matching_brackets.clear();
+				token_source_builder { region }.append(*lexed);
+				if (end_piece == declarations.size()
+				     || (holds_whole_declarations(region)
+				          && !shapes_later_declarations(region,
+				               token_range { 0,
+				                    static_cast<std::uint32_t>(region.tokens.size()) }))) {
+					break;
+				}
+			}
+			ZTD_ASSERT_MESSAGE("the rest of the file could not be lexed",
+			     end_piece != declarations.size());
+			end_piece = declarations.size();
+		}
+		const std::int64_t token_delta = static_cast<std::int64_t>(region.tokens.size())
+		     - static_cast<std::int64_t>(end_index - begin_index);
+
+		// the children of the translation unit that the pieces became
+		ast_node_id kept_before;
+		ast_node_id node = mod.nodes.first_child(mod.root());
+		for (std::size_t piece = 0; piece < first_piece; ++piece) {
+			for (std::uint32_t count = 0; count < declarations[piece].node_count; ++count) {
+				kept_before = node;
+				node        = mod.nodes.next_sibling(node);
+			}
+		}
+		std::unordered_set<std::uint32_t> replaced_nodes;
+		std::unordered_set<std::uint32_t> replaced_function_names;
+		for (std::size_t piece = first_piece; piece < end_piece; ++piece) {
+			for (std::uint32_t count = 0; count < declarations[piece].node_count; ++count) {
+				replaced_nodes.insert(node.index());
+				if (mod.nodes.kind(node) == ast_node_kind::function_definition) {
+					replaced_function_names.insert(
+					     mod.nodes.function_definition_data(node).declaration.name.index());
+				}
+				node = mod.nodes.next_sibling(node);
+			}
+		}
+		const ast_node_id kept_after = node;
+
+		// An editor edits the same declaration over and over. When the pieces take in all of
+		// what the last reparse parsed, and nothing has been added to the module since, its
+		// nodes are the end of the table and can go, rather than the table growing by the
+		// whole declaration with every keystroke.
+		std::optional<reparsed_region> reclaimed;
+		if (mod.last_reparse) {
+			const reparsed_region& last = *mod.last_reparse;
+			if (first_piece <= last.first_declaration && last.end_declaration <= end_piece
+			     && mod.nodes.size() == last.node_count
+			     && mod.constants.save().expression_count == last.expression_count) {
+				reclaimed = last;
+			}
+		}
+		mod.last_reparse.reset();
+		const std::uint32_t reclaimed_from
+		     = reclaimed ? reclaimed->nodes.node_count : ast_node_id::invalid_index;
+
+		// The file scope, as though the pieces had never been parsed. A function definition
+		// declares its name with no node.
+		std::vector<symbol> kept_symbols;
+		for (const symbol& declared : mod.symbols.declared_since(symbol_table::checkpoint {})) {
+			const bool replaced = declared.declaration.is_valid()
+			     ? declared.declaration.index() >= reclaimed_from
+			          || replaced_nodes.contains(declared.declaration.index())
+			     : declared.kind == symbol_kind::function
+			          && replaced_function_names.contains(declared.name.index());
+			if (!replaced) {
+				kept_symbols.push_back(declared);
+			}
+		}
+		mod.symbols.rollback(symbol_table::checkpoint {});
+		for (const symbol& declared : kept_symbols) {
+			mod.symbols.declare(declared.name_space, declared.name, declared.kind, declared.t,
+			     declared.declaration);
+		}
+
+		if (reclaimed) {
+			mod.nodes.replace_children(mod.root(), kept_before, kept_after, ast_node_id());
+			mod.nodes.truncate(reclaimed->nodes);
+			mod.constants.rollback(reclaimed->constants);
+		}
+		const ast_node_table::checkpoint nodes_before     = mod.nodes.position();
+		const constant_table::checkpoint constants_before = mod.constants.save();
+
+		// The nodes kept refer to tokens where they will be once the pieces' tokens are
+		// replaced, and the new nodes refer to the region's tokens where they will be put.
+		move_token_indices(mod.nodes, 0, end_index, token_delta);
+		const ast_node_id replacements = mod.nodes.add_node(ast_node_kind::translation_unit);
+		std::vector<external_declaration_extent> reparsed;
+		parser_diagnostic_reporter reporter { *source.diag_handles, sources };
+		with_parser(0, region, mod.types, mod.symbols, mod.constants, reporter,
+		     *source.global_opts, nullptr,
+		     [&](auto& p) { p.parse_translation_unit(mod.nodes, replacements, reparsed); });
+		move_token_indices(mod.nodes, replacements.index(), 0, begin_index);
+		mod.nodes.replace_children(mod.root(), kept_before, kept_after, replacements);
+		mod.last_reparse = reparsed_region { nodes_before, constants_before,
+			static_cast<std::uint32_t>(mod.nodes.size()), mod.constants.save().expression_count,
+			static_cast<std::uint32_t>(first_piece),
+			static_cast<std::uint32_t>(first_piece + reparsed.size()) };
+
+		// Every token kept moves into the edited file, and the ones after the edit move by as
+		// much as the edit changed the size of the file.
+		if (token_count != 0) {
+			const std::uint32_t moved_by = sources.location(edited_file, 0).raw()
+			     - sources.location(sources.file_of(source.tokens[0].location), 0).raw();
+			const std::uint32_t moved_after_by
+			     = moved_by + static_cast<std::uint32_t>(size_delta);
+			for (std::uint32_t index = 0; index < begin_index; ++index) {
+				source_location& location = source.tokens[index].location;
+				location                  = location.advanced_by(moved_by);
+			}
+			for (std::uint32_t index = end_index; index < token_count; ++index) {
+				source_location& location = source.tokens[index].location;
+				location                  = location.advanced_by(moved_after_by);
+				std::uint32_t& matching   = source.matching_brackets[index];
+				if (matching != token_source::no_matching_bracket) {
+					matching = static_cast<std::uint32_t>(matching + token_delta);
+				}
+			}
+		}
+		for (std::uint32_t& matching : region.matching_brackets) {
+			matching += begin_index;
+		}
+		source.tokens.erase(
+		     source.tokens.begin() + begin_index, source.tokens.begin() + end_index);
+		source.tokens.insert(source.tokens.begin() + begin_index, region.tokens.begin(),
+		     region.tokens.end());
+		source.matching_brackets.erase(source.matching_brackets.begin() + begin_index,
+		     source.matching_brackets.begin() + end_index);
+		source.matching_brackets.insert(source.matching_brackets.begin() + begin_index,
+		     region.matching_brackets.begin(), region.matching_brackets.end());
+
+		for (external_declaration_extent& parsed : reparsed) {
+			parsed.tokens.begin += begin_index;
+			parsed.tokens.end += begin_index;
+		}
+		for (std::size_t piece = end_piece; piece < declarations.size(); ++piece) {
+			token_range& tokens = mod.external_declarations[piece].tokens;
+			tokens.begin        = static_cast<std::uint32_t>(tokens.begin + token_delta);
+			tokens.end          = static_cast<std::uint32_t>(tokens.end + token_delta);
+		}
+		mod.external_declarations.erase(mod.external_declarations.begin() + first_piece,
+		     mod.external_declarations.begin() + end_piece);
+		mod.external_declarations.insert(mod.external_declarations.begin() + first_piece,
+		     reparsed.begin(), reparsed.end());
+		return token_range { begin_index,
+			static_cast<std::uint32_t>(begin_index + region.tokens.size()) };
+	}
+
 } /* namespace a_c_compiler */
@@ -0,0 +1,165 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/parse/parse_profile.h>
+
+#include <ztd/idk/assert.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+
+namespace a_c_compiler {
+
+	namespace {
+		/* Everything recorded over the run, from every parser on every thread. */
+		std::mutex run_profile_mutex;
+		parse_profile run_profile;
+
+		/* The entries of `table`, costliest first by `cost`, and at most `limit` of them. */
+		template <typename Value, typename Cost>
+		std::vector<std::pair<std::string_view, Value>> costliest(
+		     const std::unordered_map<std::string_view, Value>& table, std::size_t limit,
+		     Cost&& cost) {
+			std::vector<std::pair<std::string_view, Value>> entries(table.begin(), table.end());
+			std::sort(entries.begin(), entries.end(), [&](const auto& left, const auto& right) {
+				// break ties by name, so the report is the same from run to run
+				return cost(left.second) != cost(right.second)
+				     ? cost(left.second) > cost(right.second)
+				     : left.first < right.first;
+			});
+			entries.resize(std::min(entries.size(), limit));
+			return entries;
+		}
+	} // namespace
+
+	void parse_profile::merge(const parse_profile& other) noexcept {
+		for (const auto& [name, counts] : other.rules) {
+			parse_rule_profile& target = rules[name];
+			target.calls += counts.calls;
+			target.undone_calls += counts.undone_calls;
+			target.tokens_consumed += counts.tokens_consumed;
+			target.tokens_undone += counts.tokens_undone;
+			target.tokens_looked_ahead += counts.tokens_looked_ahead;
+		}
+		for (const auto& [name, counts] : other.backtrack_sites) {
+			backtrack_site_profile& target = backtrack_sites[name];
+			target.backtracks += counts.backtracks;
+			target.tokens_rescanned += counts.tokens_rescanned;
+		}
+	}
+
+	parse_profiler::open_rule parse_profiler::enter(
+	     std::string_view name, std::size_t token_index) noexcept {
+		auto& rule = *m_profile.rules.try_emplace(name).first;
+		++rule.second.calls;
+		m_open_rules.push_back(&rule);
+		return open_rule { &rule.second, token_index };
+	}
+
+	void parse_profiler::exit(const open_rule& opened, std::size_t token_index) noexcept {
+		ZTD_ASSERT_MESSAGE("rules must end innermost first",
+		     !m_open_rules.empty() && &m_open_rules.back()->second == opened.rule);
+		m_open_rules.pop_back();
+		// a rule which backtracked past where it began consumed nothing
+		const std::size_t consumed
+		     = token_index > opened.token_index ? token_index - opened.token_index : 0;
+		opened.rule->tokens_consumed += consumed;
+		if (m_open_checkpoints != 0) {
+			m_finished_calls.push_back(finished_call { opened.rule, consumed });
+		}
+	}
+
+	void parse_profiler::look_ahead(std::size_t token_count) noexcept {
+		if (!m_open_rules.empty()) {
+			m_open_rules.back()->second.tokens_looked_ahead += token_count;
+		}
+	}
+
+	std::size_t parse_profiler::save() noexcept {
+		++m_open_checkpoints;
+		return m_finished_calls.size();
+	}
+
+	void parse_profiler::rollback(std::size_t saved, std::string_view site,
+	     std::size_t saved_token_index, std::size_t token_index) noexcept {
+		if (site.empty() && !m_open_rules.empty()) {
+			site = m_open_rules.back()->first;
+		}
+		backtrack_site_profile& backtracked = m_profile.backtrack_sites[site];
+		++backtracked.backtracks;
+		backtracked.tokens_rescanned
+		     += token_index > saved_token_index ? token_index - saved_token_index : 0;
+		for (std::size_t index = saved; index < m_finished_calls.size(); ++index) {
+			const finished_call& undone = m_finished_calls[index];
+			++undone.rule->undone_calls;
+			undone.rule->tokens_undone += undone.tokens_consumed;
+		}
+		m_finished_calls.resize(saved);
+		close_checkpoint();
+	}
+
+	void parse_profiler::commit() noexcept {
+		// what finished since stays logged: a checkpoint further out can still undo it
+		close_checkpoint();
+	}
+
+	void parse_profiler::close_checkpoint() noexcept {
+		ZTD_ASSERT_MESSAGE("no checkpoint is open", m_open_checkpoints != 0);
+		--m_open_checkpoints;
+		if (m_open_checkpoints == 0) {
+			m_finished_calls.clear();
+		}
+	}
+
+	void record_parse_profile(const parse_profile& profile) noexcept {
+		std::lock_guard lock(run_profile_mutex);
+		run_profile.merge(profile);
+	}
+
+	void dump_parse_profile_into(std::ostream& output_stream, std::size_t limit) noexcept {
+		static constexpr size_t name_width   = 40;
+		static constexpr size_t number_width = 12;
+		std::lock_guard lock(run_profile_mutex);
+
+		output_stream << "parser profile: rules, by tokens undone by backtracking\n"
+		              << std::setw(name_width) << "rule"
+		              << " | " << std::setw(number_width) << "calls"
+		              << " | " << std::setw(number_width) << "undone"
+		              << " | " << std::setw(number_width) << "consumed"
+		              << " | " << std::setw(number_width) << "tokens undone"
+		              << " | " << std::setw(number_width) << "looked ahead"
+		              << "\n";
+		for (const auto& [name, counts] :
+		     costliest(run_profile.rules, limit, [](const parse_rule_profile& counts) {
+			     return std::pair(counts.tokens_undone, counts.calls);
+		     })) {
+			output_stream << std::setw(name_width) << name << " | "
+			              << std::setw(number_width) << counts.calls << " | "
+			              << std::setw(number_width) << counts.undone_calls << " | "
+			              << std::setw(number_width) << counts.tokens_consumed << " | "
+			              << std::setw(number_width) << counts.tokens_undone << " | "
+			              << std::setw(number_width) << counts.tokens_looked_ahead << "\n";
+		}
+
+		output_stream << "parser profile: backtrack sites, by tokens rescanned\n"
+		              << std::setw(name_width) << "site"
+		              << " | " << std::setw(number_width) << "backtracks"
+		              << " | " << std::setw(number_width) << "rescanned"
+		              << "\n";
+		for (const auto& [name, counts] : costliest(run_profile.backtrack_sites, limit,
+		          [](const backtrack_site_profile& counts) {
+			          return std::pair(counts.tokens_rescanned, counts.backtracks);
+		          })) {
+			output_stream << std::setw(name_width) << name << " | "
+			              << std::setw(number_width) << counts.backtracks << " | "
+			              << std::setw(number_width) << counts.tokens_rescanned << "\n";
+		}
+	}
+
+} // namespace a_c_compiler
@@ -0,0 +1,168 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/parse/symbol_table.h>
+
+#include <ztd/idk/assert.hpp>
+
+#include <utility>
+
+namespace a_c_compiler {
+
+	namespace {
+		/* One key per (namespace, identifier) pair: the namespace goes in the low bits. */
+		std::uint32_t symbol_key(symbol_namespace name_space, identifier_id name) noexcept {
+			ZTD_ASSERT_MESSAGE("too many identifiers to tell apart in a symbol table",
+			     name.index() < (std::uint32_t(1) << 30));
+			return (name.index() << 2) | static_cast<std::uint32_t>(name_space);
+		}
+
+		/* Identifiers are interned in the order they are first seen, so keys are dense and
+		 * neighbouring keys are common: spread them out over the table. */
+		std::size_t hash_key(std::uint32_t key) noexcept {
+			return static_cast<std::size_t>(key * 0x9E3779B9u);
+		}
+	} // namespace
+
+	symbol_table::symbol_table(std::pmr::memory_resource* arena) noexcept
+	: m_slots(initial_slot_count, arena)
+	, m_used_slot_count(0)
+	, m_symbols(arena)
+	, m_labels(arena)
+	, m_scopes(arena) {
+	}
+
+	void symbol_table::push_scope(scope_kind kind) noexcept {
+		m_scopes.push_back(scope { kind, static_cast<std::uint32_t>(m_symbols.size()),
+		     static_cast<std::uint32_t>(m_labels.size()) });
+	}
+
+	void symbol_table::pop_scope() noexcept {
+		ZTD_ASSERT_MESSAGE("cannot pop a scope that was never pushed", !m_scopes.empty());
+		const scope popped = m_scopes.back();
+		m_scopes.pop_back();
+		while (m_symbols.size() > popped.symbol_start) {
+			pop_symbol(m_symbols);
+		}
+		if (popped.kind == scope_kind::function) {
+			while (m_labels.size() > popped.label_start) {
+				pop_symbol(m_labels);
+			}
+		}
+	}
+
+	const symbol& symbol_table::declare(symbol_namespace name_space, identifier_id name,
+	     symbol_kind kind, type t, ast_node_id declaration) noexcept {
+		ZTD_ASSERT_MESSAGE("cannot declare an invalid identifier", name.is_valid());
+		// keep the table at most half full, so probe sequences stay short
+		if ((m_used_slot_count + 1) * 2 > m_slots.size()) {
+			grow();
+		}
+		const std::uint32_t key = symbol_key(name_space, name);
+		slot& target            = m_slots[find_slot(key)];
+		if (target.key == slot::empty_key) {
+			target.key = key;
+			++m_used_slot_count;
+		}
+		std::pmr::vector<symbol>& symbols = stack_for(name_space);
+		const std::uint32_t index         = static_cast<std::uint32_t>(symbols.size());
+		symbols.push_back(symbol { name, name_space, kind, t, declaration,
+		     static_cast<std::uint32_t>(m_scopes.size()), target.visible });
+		target.visible = index;
+		return symbols.back();
+	}
+
+	const symbol* symbol_table::find(
+	     symbol_namespace name_space, identifier_id name) const noexcept {
+		return visible_symbol(symbol_key(name_space, name));
+	}
+
+	const symbol* symbol_table::find_in_current_scope(
+	     symbol_namespace name_space, identifier_id name) const noexcept {
+		const symbol* visible = find(name_space, name);
+		if (visible == nullptr) {
+			return nullptr;
+		}
+		// there is only ever one function scope open, so any visible label is in it
+		if (name_space == symbol_namespace::label
+		     || visible->scope_depth == m_scopes.size()) {
+			return visible;
+		}
+		return nullptr;
+	}
+
+	const type* symbol_table::find_typedef_name(identifier_id name) const noexcept {
+		const symbol* visible = find(symbol_namespace::ordinary, name);
+		if (visible == nullptr || visible->kind != symbol_kind::typedef_name) {
+			return nullptr;
+		}
+		return &visible->t;
+	}
+
+	symbol_table::checkpoint symbol_table::save() const noexcept {
+		return checkpoint { static_cast<std::uint32_t>(m_symbols.size()),
+			static_cast<std::uint32_t>(m_labels.size()),
+			static_cast<std::uint32_t>(m_scopes.size()) };
+	}
+
+	void symbol_table::rollback(const checkpoint& saved) noexcept {
+		while (m_symbols.size() > saved.symbol_count) {
+			pop_symbol(m_symbols);
+		}
+		while (m_labels.size() > saved.label_count) {
+			pop_symbol(m_labels);
+		}
+		// scopes pushed since are dropped; scopes popped since cannot be brought back, and a
+		// speculative parse never pops more scopes than it pushed
+		ZTD_ASSERT_MESSAGE("a scope open at the checkpoint was popped since",
+		     m_scopes.size() >= saved.scope_count);
+		m_scopes.resize(saved.scope_count);
+	}
+
+	const symbol* symbol_table::visible_symbol(std::uint32_t key) const noexcept {
+		const slot& target = m_slots[find_slot(key)];
+		if (target.visible == no_symbol) {
+			return nullptr;
+		}
+		const std::pmr::vector<symbol>& symbols
+		     = static_cast<symbol_namespace>(key & 0b11) == symbol_namespace::label ? m_labels
+		                                                                            : m_symbols;
+		return &symbols[target.visible];
+	}
+
+	std::pmr::vector<symbol>& symbol_table::stack_for(symbol_namespace name_space) noexcept {
+		return name_space == symbol_namespace::label ? m_labels : m_symbols;
+	}
+
+	void symbol_table::pop_symbol(std::pmr::vector<symbol>& symbols) noexcept {
+		const symbol& popped = symbols.back();
+		slot& target         = m_slots[find_slot(symbol_key(popped.name_space, popped.name))];
+		target.visible       = popped.hidden;
+		symbols.pop_back();
+	}
+
+	std::size_t symbol_table::find_slot(std::uint32_t key) const noexcept {
+		const std::size_t mask = m_slots.size() - 1;
+		for (std::size_t index = hash_key(key) & mask;; index = (index + 1) & mask) {
+			const slot& candidate = m_slots[index];
+			if (candidate.key == key || candidate.key == slot::empty_key) {
+				return index;
+			}
+		}
+	}
+
+	void symbol_table::grow() noexcept {
+		std::pmr::vector<slot> old_slots = std::exchange(m_slots,
+		     std::pmr::vector<slot>(m_slots.size() * 2, m_slots.get_allocator()));
+		for (const slot& old_slot : old_slots) {
+			if (old_slot.key != slot::empty_key) {
+				m_slots[find_slot(old_slot.key)] = old_slot;
+			}
+		}
+	}
+
+} // namespace a_c_compiler
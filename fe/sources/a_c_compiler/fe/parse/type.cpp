@@ -0,0 +1,219 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/parse/type.h>
+
+#include <ztd/idk/assert.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace a_c_compiler {
+
+	namespace {
+		bool is_record(type_category category) noexcept {
+			return category == type_category::tc_struct || category == type_category::tc_union;
+		}
+
+		std::size_t hash_type(type_modifier modifier, type_category category,
+		     qualifier qualifiers, std::uint8_t alignment_log2, std::uint32_t extent,
+		     std::span<const type> sub_types) noexcept {
+			std::uint64_t hash = static_cast<std::uint64_t>(modifier)
+			     | (static_cast<std::uint64_t>(category) << 8)
+			     | (static_cast<std::uint64_t>(qualifiers) << 16)
+			     | (static_cast<std::uint64_t>(alignment_log2) << 24);
+			hash = (hash ^ extent) * 0x9E3779B97F4A7C15u;
+			if (is_record(category)) {
+				// told apart by the extent alone
+				return static_cast<std::size_t>(hash ^ (hash >> 32));
+			}
+			for (const type& sub_type : sub_types) {
+				hash = (hash ^ sub_type.index()) * 0x9E3779B97F4A7C15u;
+			}
+			return static_cast<std::size_t>(hash ^ (hash >> 32));
+		}
+
+		std::size_t hash_type(const type_builder& built) noexcept {
+			return hash_type(built.modifier, built.category, built.qualifiers,
+			     built.alignment_log2, built.extent, built.sub_types);
+		}
+
+		std::size_t hash_type(const type_table& types, type t) noexcept {
+			const type_data& t_data = types.data(t);
+			return hash_type(t_data.modifier, t_data.category, t_data.qualifiers,
+			     t_data.alignment_log2, t_data.extent, types.sub_types(t));
+		}
+	} // namespace
+
+	type_table::type_table() noexcept
+	: m_types(), m_sub_types(), m_completed(), m_slots(initial_slot_count, empty_slot) {
+		// the first type is no type at all, so that a default `type` is one
+		intern(type_builder {});
+	}
+
+	type type_table::intern(const type_builder& built) noexcept {
+		ZTD_ASSERT_MESSAGE("a structure or union has to be declared before it is interned",
+		     !is_record(built.category)
+		          || (built.extent < m_types.size()
+		               && m_types[built.extent].extent == built.extent));
+		// keep the table at most half full, so probe sequences stay short
+		if ((m_types.size() + 1) * 2 > m_slots.size()) {
+			grow();
+		}
+		std::uint32_t& target = m_slots[find_slot(built)];
+		if (target != empty_slot) {
+			return type(target);
+		}
+		return add(target, built,
+		     is_record(built.category) ? std::span<const type>() : built.sub_types);
+	}
+
+	type type_table::declare_record(type_category category) noexcept {
+		ZTD_ASSERT_MESSAGE("only a structure or union can be declared", is_record(category));
+		if ((m_types.size() + 1) * 2 > m_slots.size()) {
+			grow();
+		}
+		type_builder declared;
+		declared.category = category;
+		declared.extent   = static_cast<std::uint32_t>(m_types.size());
+		const type record = add(m_slots[find_slot(declared)], declared, {});
+		// no members yet is not the same as no members
+		m_types.back().sub_types_begin = incomplete_record;
+		return record;
+	}
+
+	void type_table::complete_record(type record, std::span<const type> members) noexcept {
+		type_data& record_data = m_types[record.index()];
+		ZTD_ASSERT_MESSAGE("only a structure or union that was declared can be completed",
+		     is_record(record_data.category) && record_data.extent == record.index());
+		ZTD_ASSERT_MESSAGE("a structure or union can only be completed once",
+		     record_data.sub_types_begin == incomplete_record);
+		record_data.sub_types_begin = static_cast<std::uint32_t>(m_sub_types.size());
+		record_data.sub_type_count  = static_cast<std::uint32_t>(members.size());
+		m_sub_types.insert(m_sub_types.end(), members.begin(), members.end());
+		m_completed.push_back(record);
+	}
+
+	type type_table::add(std::uint32_t& slot, const type_builder& built,
+	     std::span<const type> sub_types) noexcept {
+		ZTD_ASSERT_MESSAGE("too many types for a type table", m_types.size() < empty_slot);
+		slot = static_cast<std::uint32_t>(m_types.size());
+		m_types.push_back(type_data { built.modifier, built.category, built.qualifiers,
+		     built.alignment_log2, built.extent, static_cast<std::uint32_t>(m_sub_types.size()),
+		     static_cast<std::uint32_t>(sub_types.size()) });
+		m_sub_types.insert(m_sub_types.end(), sub_types.begin(), sub_types.end());
+		return type(slot);
+	}
+
+	type_builder type_table::builder(type t) const noexcept {
+		const type_data& t_data = data(t);
+		const std::span<const type> t_sub_types = sub_types(t);
+		return type_builder { t_data.modifier, t_data.category, t_data.qualifiers,
+			t_data.alignment_log2, t_data.extent,
+			std::vector<type>(t_sub_types.begin(), t_sub_types.end()) };
+	}
+
+	void type_table::rollback(const checkpoint& saved) noexcept {
+		ZTD_ASSERT_MESSAGE("cannot roll a type table back to a bigger size",
+		     saved.type_count <= m_types.size() && saved.sub_type_count <= m_sub_types.size()
+		          && saved.completed_count <= m_completed.size());
+		while (m_completed.size() > saved.completed_count) {
+			type_data& record_data      = m_types[m_completed.back().index()];
+			record_data.sub_types_begin = incomplete_record;
+			record_data.sub_type_count  = 0;
+			m_completed.pop_back();
+		}
+		// newest first, so each slot is emptied before any that was filled before it
+		while (m_types.size() > saved.type_count) {
+			const std::size_t forgotten = m_types.size() - 1;
+			const std::size_t mask      = m_slots.size() - 1;
+			std::size_t index           = hash_type(*this, type(forgotten)) & mask;
+			while (m_slots[index] != forgotten) {
+				index = (index + 1) & mask;
+			}
+			m_slots[index] = empty_slot;
+			m_types.pop_back();
+		}
+		m_sub_types.resize(saved.sub_type_count);
+	}
+
+	type_relocation type_table::append_types(
+	     const type_table& other, const checkpoint& since) noexcept {
+		ZTD_ASSERT_MESSAGE("cannot append types past the end of a type table",
+		     since.type_count <= other.m_types.size()
+		          && since.completed_count <= other.m_completed.size());
+		type_relocation relocated { since.type_count, {} };
+		relocated.moved.reserve(other.m_types.size() - since.type_count);
+		for (std::size_t index = since.type_count; index < other.m_types.size(); ++index) {
+			type_builder copied = other.builder(type(index));
+			if (!is_record(copied.category)) {
+				for (type& sub_type : copied.sub_types) {
+					sub_type = relocated(sub_type);
+				}
+				relocated.moved.push_back(intern(copied));
+			}
+			else if (copied.extent == index) {
+				// declared in `other`, so not the same as any here
+				relocated.moved.push_back(declare_record(copied.category));
+			}
+			else {
+				copied.extent
+				     = static_cast<std::uint32_t>(relocated(type(copied.extent)).index());
+				relocated.moved.push_back(intern(copied));
+			}
+		}
+		// the members last, since they can come after what they are members of
+		std::vector<type> members;
+		for (std::size_t index = since.completed_count; index < other.m_completed.size();
+		     ++index) {
+			const type completed = relocated(other.m_completed[index]);
+			if (is_complete_record(completed)) {
+				continue;
+			}
+			members.clear();
+			for (const type& member : other.sub_types(other.m_completed[index])) {
+				members.push_back(relocated(member));
+			}
+			complete_record(completed, members);
+		}
+		return relocated;
+	}
+
+	std::size_t type_table::find_slot(const type_builder& built) const noexcept {
+		const std::size_t mask = m_slots.size() - 1;
+		for (std::size_t index = hash_type(built) & mask;; index = (index + 1) & mask) {
+			const std::uint32_t candidate = m_slots[index];
+			if (candidate == empty_slot) {
+				return index;
+			}
+			const type_data& candidate_data = m_types[candidate];
+			if (candidate_data.modifier == built.modifier
+			     && candidate_data.category == built.category
+			     && candidate_data.qualifiers == built.qualifiers
+			     && candidate_data.alignment_log2 == built.alignment_log2
+			     && candidate_data.extent == built.extent
+			     && (is_record(built.category)
+			          || std::ranges::equal(sub_types(type(candidate)), built.sub_types))) {
+				return index;
+			}
+		}
+	}
+
+	void type_table::grow() noexcept {
+		// every type goes back in the order it was added, just as it was put in the first time
+		m_slots.assign(m_slots.size() * 2, empty_slot);
+		const std::size_t mask = m_slots.size() - 1;
+		for (std::size_t added = 0; added < m_types.size(); ++added) {
+			std::size_t index = hash_type(*this, type(added)) & mask;
+			while (m_slots[index] != empty_slot) {
+				index = (index + 1) & mask;
+			}
+			m_slots[index] = static_cast<std::uint32_t>(added);
+		}
+	}
+
+} // namespace a_c_compiler
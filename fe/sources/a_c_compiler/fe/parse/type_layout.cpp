@@ -0,0 +1,334 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/parse/type_layout.h>
+#include <a_c_compiler/fe/parse/ast_module.h>
+#include <a_c_compiler/fe/support/buffered_writer.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace a_c_compiler {
+
+	namespace {
+		constexpr std::uint64_t round_up(std::uint64_t value, std::uint64_t multiple) noexcept {
+			return (value + multiple - 1) / multiple * multiple;
+		}
+
+		type_layout scalar(scalar_layout layout) noexcept {
+			return type_layout { layout.size, layout.alignment, true };
+		}
+
+		/* Whether `signed` or `unsigned` was all that was said, which means `int`. */
+		bool is_plain_int(const type_data& t_data) noexcept {
+			return t_data.category == type_category::tc_none
+			     && (t_data.modifier == type_modifier::tm_signed
+			          || t_data.modifier == type_modifier::tm_unsigned);
+		}
+
+		/* Whether a member of this type with an extent is a bit-field: only integer types can
+		 * be, and a _BitInt's extent is its own width. */
+		bool is_bit_field(const type_data& member) noexcept {
+			switch (member.category) {
+			case type_category::tc_none:
+				return is_plain_int(member) && member.extent != 0;
+			case type_category::tc_bool:
+			case type_category::tc_char:
+			case type_category::tc_short:
+			case type_category::tc_int:
+			case type_category::tc_long:
+			case type_category::tc_longlong:
+			case type_category::tc_enum:
+				return member.extent != 0;
+			default:
+				return false;
+			}
+		}
+
+		/* Places the members of a structure or union one at a time, in bits. */
+		struct record_builder {
+			bool is_union;
+			std::uint64_t end_bits = 0;
+			std::uint32_t alignment = 1;
+			bool complete           = true;
+
+			/* Puts `size_bits` bits at the next multiple of `alignment` bytes, and returns
+			 * where. */
+			std::uint64_t place(
+			     std::uint64_t size_bits, std::uint32_t member_alignment) noexcept {
+				alignment = std::max(alignment, member_alignment);
+				const std::uint64_t start
+				     = is_union ? 0 : round_up(end_bits, std::uint64_t(member_alignment) * 8);
+				end_bits = std::max(end_bits, start + size_bits);
+				return start;
+			}
+
+			/* Puts `width` bits right after what came before, with no alignment at all. */
+			std::uint64_t skip(std::uint64_t width) noexcept {
+				const std::uint64_t start = is_union ? 0 : end_bits;
+				end_bits                  = std::max(end_bits, start + width);
+				return start;
+			}
+
+			/* Puts `width` bits of a bit-field declared with a type laid out as `unit` in the
+			 * next bits that do not cross a boundary of that type. Unnamed bit-fields do not
+			 * count toward the alignment of the record. */
+			std::uint64_t place_bit_field(
+			     std::uint32_t width, const type_layout& unit, bool named) noexcept {
+				if (named) {
+					alignment = std::max(alignment, unit.alignment);
+				}
+				const std::uint64_t unit_alignment_bits = std::uint64_t(unit.alignment) * 8;
+				if (width == 0) {
+					// `T : 0` puts whatever comes next at the next boundary of `T`
+					if (!is_union) {
+						end_bits = round_up(end_bits, unit_alignment_bits);
+					}
+					return end_bits;
+				}
+				std::uint64_t start = is_union ? 0 : end_bits;
+				if (start % unit_alignment_bits + width > unit.size * 8) {
+					start = round_up(start, unit_alignment_bits);
+				}
+				end_bits = std::max(end_bits, start + width);
+				return start;
+			}
+
+			type_layout finish() const noexcept {
+				return type_layout { round_up(round_up(end_bits, 8) / 8, alignment), alignment,
+					complete };
+			}
+		};
+	} // namespace
+
+	type_layout_table::type_layout_table(const type_table& types, target_abi abi) noexcept
+	: m_types(&types), m_abi(abi), m_layouts(), m_members() {
+	}
+
+	type_layout type_layout_table::layout(type t) noexcept {
+		return cached(t).layout;
+	}
+
+	std::span<const member_layout> type_layout_table::members(type record) noexcept {
+		const std::uint32_t members_begin = cached(record).members_begin;
+		const type_category category      = m_types->data(record).category;
+		if (category != type_category::tc_struct && category != type_category::tc_union) {
+			return {};
+		}
+		return std::span<const member_layout>(m_members).subspan(
+		     members_begin, m_types->member_types(record).size());
+	}
+
+	type_layout_table::cached_layout& type_layout_table::cached(type t) noexcept {
+		if (m_layouts.size() < m_types->size()) {
+			m_layouts.resize(m_types->size(), cached_layout { type_layout { 0, 0, false }, 0 });
+		}
+		if (m_layouts[t.index()].layout.alignment == 0) {
+			std::uint32_t members_begin = 0;
+			const type_layout computed  = compute(t, members_begin);
+			m_layouts[t.index()]        = cached_layout { computed, members_begin };
+		}
+		return m_layouts[t.index()];
+	}
+
+	type_layout type_layout_table::compute(type t, std::uint32_t& members_begin) noexcept {
+		const type_data& t_data = m_types->data(t);
+		type_layout computed { 0, 1, false };
+		switch (t_data.category) {
+		case type_category::tc_none:
+			if (is_plain_int(t_data)) {
+				computed = scalar(m_abi.int_layout);
+			}
+			break;
+		case type_category::tc_void:
+		case type_category::tc_auto:
+		case type_category::tc_function:
+		case type_category::tc_variable_length_array:
+			break;
+		case type_category::tc_bool:
+			computed = scalar(m_abi.bool_layout);
+			break;
+		case type_category::tc_char:
+			computed = scalar(m_abi.char_layout);
+			break;
+		case type_category::tc_short:
+			computed = scalar(m_abi.short_layout);
+			break;
+		case type_category::tc_int:
+		case type_category::tc_enum:
+			computed = scalar(m_abi.int_layout);
+			break;
+		case type_category::tc_long:
+			computed = scalar(m_abi.long_layout);
+			break;
+		case type_category::tc_longlong:
+			computed = scalar(m_abi.long_long_layout);
+			break;
+		case type_category::tc__BitInt:
+			computed = bit_int_layout(t_data.extent);
+			break;
+		case type_category::tc_float:
+			computed = scalar(m_abi.float_layout);
+			break;
+		case type_category::tc_double:
+			computed = scalar(m_abi.double_layout);
+			break;
+		case type_category::tc_longdouble:
+		case type_category::tc_longlongdouble:
+			computed = scalar(m_abi.long_double_layout);
+			break;
+		case type_category::tc_data_pointer:
+		case type_category::tc_function_pointer:
+		case type_category::tc_nullptr:
+			computed = scalar(m_abi.pointer_layout);
+			break;
+		case type_category::tc_array_span:
+			// a pointer to the first element, and how many there are
+			computed = scalar(m_abi.pointer_layout);
+			computed.size *= 2;
+			break;
+		case type_category::tc_array: {
+			const type_layout element = layout(m_types->element_type(t));
+			computed = type_layout { element.size * t_data.extent, element.alignment,
+				element.complete && t_data.extent != 0 };
+		} break;
+		case type_category::tc__Padding:
+			computed = type_layout { round_up(t_data.extent, 8) / 8, 1, true };
+			break;
+		case type_category::tc_struct:
+		case type_category::tc_union:
+			computed = compute_record(t, members_begin);
+			break;
+		}
+		if (t_data.modifier == type_modifier::tm__Atomic
+		     || (static_cast<unsigned>(t_data.qualifiers)
+		          & static_cast<unsigned>(qualifier::q__Atomic))) {
+			// atomics small enough to be lock-free are aligned to their size
+			if (std::has_single_bit(computed.size) && computed.size <= 16) {
+				computed.alignment
+				     = std::max(computed.alignment, static_cast<std::uint32_t>(computed.size));
+			}
+		}
+		computed.alignment
+		     = std::max(computed.alignment, std::uint32_t(1) << t_data.alignment_log2);
+		return computed;
+	}
+
+	type_layout type_layout_table::compute_record(
+	     type t, std::uint32_t& members_begin) noexcept {
+		if (!m_types->is_complete_record(t)) {
+			members_begin = static_cast<std::uint32_t>(m_members.size());
+			return type_layout { 0, 1, false };
+		}
+		const std::span<const type> member_types = m_types->member_types(t);
+		// the members first (and the types unnamed bit-fields were declared with), since
+		// working them out may add layouts of their own to the pool
+		for (const type& member : member_types) {
+			(void)layout(member);
+			if (m_types->data(member).category == type_category::tc__Padding
+			     && m_types->data(member).sub_type_count == 1) {
+				(void)layout(m_types->sub_types(member)[0]);
+			}
+		}
+		record_builder record { m_types->data(t).category == type_category::tc_union };
+		members_begin = static_cast<std::uint32_t>(m_members.size());
+		for (std::size_t index = 0; index < member_types.size(); ++index) {
+			const type member            = member_types[index];
+			const type_data& member_data = m_types->data(member);
+			const type_layout placed     = m_layouts[member.index()].layout;
+			member_layout where { 0, 0 };
+			if (member_data.category == type_category::tc__Padding
+			     && member_data.sub_type_count == 1) {
+				// an unnamed bit-field
+				where.bit_width  = member_data.extent;
+				where.bit_offset = record.place_bit_field(member_data.extent,
+				     m_layouts[m_types->sub_types(member)[0].index()].layout, false);
+			}
+			else if (member_data.category == type_category::tc__Padding) {
+				where.bit_width  = member_data.extent;
+				where.bit_offset = record.skip(member_data.extent);
+			}
+			else if (is_bit_field(member_data)) {
+				where.bit_width  = member_data.extent;
+				where.bit_offset = record.place_bit_field(member_data.extent, placed, true);
+			}
+			else {
+				// only the last member can be an array of unknown length, and it takes up
+				// no room
+				const bool is_flexible = member_data.category == type_category::tc_array
+				     && member_data.extent == 0 && index + 1 == member_types.size();
+				record.complete = record.complete && (placed.complete || is_flexible);
+				where.bit_offset = record.place(placed.size * 8, placed.alignment);
+			}
+			m_members.push_back(where);
+		}
+		return record.finish();
+	}
+
+	type_layout type_layout_table::bit_int_layout(std::uint32_t width) const noexcept {
+		// as small a power of two bytes as will hold it, up to 64 bits; in 64-bit chunks
+		// after that
+		if (width <= 64) {
+			const std::uint32_t size
+			     = std::bit_ceil(std::max<std::uint32_t>(1, (width + 7) / 8));
+			return type_layout { size, size, true };
+		}
+		return type_layout { round_up(width, 64) / 8, m_abi.wide_bit_int_alignment, true };
+	}
+
+	bool dump_record_layouts_into(
+	     const ast_module& mod, type_layout_table& layouts, std::FILE* output) noexcept {
+		buffered_writer out(output);
+		if (mod.nodes.size() == 0) {
+			return true;
+		}
+		const auto write_name = [&](identifier_id name) noexcept {
+			out.write(name.is_valid() ? identifier_spelling(name) : "(unnamed)");
+		};
+		for (ast_node_id node = mod.nodes.first_child(mod.root()); node.is_valid();
+		     node = mod.nodes.next_sibling(node)) {
+			if (mod.nodes.kind(node) != ast_node_kind::struct_declaration) {
+				continue;
+			}
+			const struct_declaration& record = mod.nodes.struct_declaration_data(node);
+			const type_layout laid_out       = layouts.layout(record.t);
+			out.write(mod.types.data(record.t).category == type_category::tc_union ? "union "
+			                                                                        : "struct ");
+			write_name(record.name);
+			out.write(" size=");
+			out.write_number(laid_out.size);
+			out.write(" alignment=");
+			out.write_number(laid_out.alignment);
+			out.write('\n');
+			const std::span<const member_layout> members = layouts.members(record.t);
+			std::size_t index                            = 0;
+			for (ast_node_id child = mod.nodes.first_child(node);
+			     child.is_valid() && index < members.size();
+			     child = mod.nodes.next_sibling(child)) {
+				if (mod.nodes.kind(child) != ast_node_kind::member_declaration) {
+					continue;
+				}
+				const member_declaration& member = mod.nodes.member_declaration_data(child);
+				const member_layout& where       = members[index++];
+				out.write("  ");
+				write_name(member.name);
+				out.write(" offset=");
+				out.write_number(where.offset());
+				if (where.bit_width != 0 || member.bit_field_size != 0) {
+					out.write(" bit_offset=");
+					out.write_number(where.bit_offset);
+					out.write(" bit_width=");
+					out.write_number(where.bit_width);
+				}
+				out.write('\n');
+			}
+		}
+		out.flush();
+		return out.good();
+	}
+
+} // namespace a_c_compiler
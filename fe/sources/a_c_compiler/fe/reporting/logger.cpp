@@ -17,11 +17,11 @@
 namespace a_c_compiler {
 
 	void logger::incr_indent() noexcept {
-		++this->m_indent_width;
+		++this->m_indent_level;
 	}
 
 	void logger::decr_indent() noexcept {
-		--this->m_indent_width;
+		--this->m_indent_level;
 	}
 
 	void logger::indent() noexcept {
@@ -30,13 +30,13 @@ namespace a_c_compiler {
 				fmt::print(this->handle(), "| ");
 	}
 
-	scope_logger::scope_logger(std::string scope_name,
+	scope_logger::scope_logger(std::string_view scope_name,
 	     std::function<void(logger&)>&& entry_callback, logger& target,
 	     std::optional<std::string_view> logfile) noexcept
-	: m_logger(target), logfile(std::move(logfile)), scope_name(std::move(scope_name)) {
+	: m_logger(target), m_scope_name(scope_name), logfile(std::move(logfile)) {
 		// TODO: logfile handling
 		m_logger.indent();
-		fmt::print(m_logger.handle(), "{}", scope_name);
+		fmt::print(m_logger.handle(), "{}", m_scope_name);
 		entry_callback(m_logger);
 		fmt::println(m_logger.handle(), "\n");
 		m_logger.incr_indent();
@@ -0,0 +1,514 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/scan/dependency_scan.h>
+#include <a_c_compiler/fe/support/thread_pool.h>
+#include <a_c_compiler/fe/source/file_prefetcher.h>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include <ostream>
+#include <utility>
+
+namespace a_c_compiler {
+
+	namespace {
+		constexpr bool is_horizontal_space(char c) noexcept {
+			return c == ' ' || c == '\t' || c == '\f' || c == '\v' || c == '\r';
+		}
+
+		constexpr bool is_identifier_start(char c) noexcept {
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+		}
+
+		constexpr bool is_digit(char c) noexcept {
+			return c >= '0' && c <= '9';
+		}
+
+		constexpr bool is_identifier_continue(char c) noexcept {
+			return is_identifier_start(c) || is_digit(c);
+		}
+
+		/* Translation phase 2: drop every backslash-newline, so the scanner below never has to
+		 * think about them. Most files have none, so only copy when there is one. */
+		std::string_view splice_lines(std::string_view source, std::string& storage) noexcept {
+			if (source.find('\\') == std::string_view::npos) {
+				return source;
+			}
+			storage.reserve(source.size());
+			for (std::size_t i = 0; i < source.size(); ++i) {
+				if (source[i] == '\\') {
+					std::size_t next = i + 1;
+					if (next < source.size() && source[next] == '\r') {
+						++next;
+					}
+					if (next < source.size() && source[next] == '\n') {
+						i = next;
+						continue;
+					}
+				}
+				storage.push_back(source[i]);
+			}
+			return storage;
+		}
+
+		struct directive_minimizer {
+			std::string_view source;
+			std::size_t position = 0;
+			std::size_t lineno   = 1;
+			minimized_source result {};
+			/* For include guard detection */
+			bool content_before_first_directive = false;
+			bool content_after_last_directive   = false;
+
+			bool at_end() const noexcept {
+				return position >= source.size();
+			}
+
+			char current() const noexcept {
+				return at_end() ? '\0' : source[position];
+			}
+
+			char peek(std::size_t peek_by = 1) const noexcept {
+				return position + peek_by < source.size() ? source[position + peek_by] : '\0';
+			}
+
+			/* Skips a comment starting at the current position, if there is one. */
+			bool skip_comment() noexcept {
+				if (current() != '/') {
+					return false;
+				}
+				if (peek() == '/') {
+					while (!at_end() && current() != '\n') {
+						++position;
+					}
+					return true;
+				}
+				if (peek() == '*') {
+					position += 2;
+					while (!at_end() && !(current() == '*' && peek() == '/')) {
+						if (current() == '\n') {
+							++lineno;
+						}
+						++position;
+					}
+					position = at_end() ? position : position + 2;
+					return true;
+				}
+				return false;
+			}
+
+			void skip_horizontal_space_and_comments() noexcept {
+				for (; !at_end();) {
+					if (is_horizontal_space(current())) {
+						++position;
+					}
+					else if (!skip_comment()) {
+						return;
+					}
+				}
+			}
+
+			void skip_quoted(char terminator) noexcept {
+				++position;
+				while (!at_end() && current() != terminator && current() != '\n') {
+					if (current() == '\\') {
+						++position;
+					}
+					++position;
+				}
+				if (current() == terminator) {
+					++position;
+				}
+			}
+
+			void skip_pp_number() noexcept {
+				while (!at_end()) {
+					const char c = current();
+					if ((c == 'e' || c == 'E' || c == 'p' || c == 'P')
+					     && (peek() == '+' || peek() == '-')) {
+						position += 2;
+					}
+					else if (c == '\'' && is_identifier_continue(peek())) {
+						// C23 digit separator, not the start of a character constant
+						position += 2;
+					}
+					else if (is_identifier_continue(c) || c == '.') {
+						++position;
+					}
+					else {
+						return;
+					}
+				}
+			}
+
+			/* Skips to the start of the next line, stepping over anything which might contain
+			 * a newline or something that looks like the start of a comment. */
+			void skip_line() noexcept {
+				while (!at_end()) {
+					const char c = current();
+					if (c == '\n') {
+						++position;
+						++lineno;
+						return;
+					}
+					if (skip_comment()) {
+						continue;
+					}
+					if (c == '"' || c == '\'') {
+						skip_quoted(c);
+					}
+					else if (is_digit(c) || (c == '.' && is_digit(peek()))) {
+						skip_pp_number();
+					}
+					else if (is_identifier_start(c)) {
+						while (is_identifier_continue(current())) {
+							++position;
+						}
+					}
+					else {
+						++position;
+					}
+				}
+			}
+
+			std::string_view lex_identifier() noexcept {
+				const std::size_t start = position;
+				while (is_identifier_continue(current())) {
+					++position;
+				}
+				return source.substr(start, position - start);
+			}
+
+			void lex_header_name(scanned_directive& directive) noexcept {
+				skip_horizontal_space_and_comments();
+				const char open = current();
+				if (open != '<' && open != '"') {
+					// computed include: without a preprocessor we cannot follow it
+					return;
+				}
+				const char close        = open == '<' ? '>' : '"';
+				const std::size_t start = position + 1;
+				const std::size_t end
+				     = source.find_first_of(close == '>' ? "\n>" : "\n\"", start);
+				if (end == std::string_view::npos || source[end] != close) {
+					return;
+				}
+				directive.angled   = open == '<';
+				directive.argument = std::string(source.substr(start, end - start));
+				position           = end + 1;
+			}
+
+			void lex_directive() noexcept {
+				// we are sitting on the `#`
+				++position;
+				skip_horizontal_space_and_comments();
+				const std::size_t directive_lineno = lineno;
+				std::string_view name              = lex_identifier();
+				scanned_directive directive { scanned_directive_kind::define, false,
+					directive_lineno, {} };
+				if (name == "include" || name == "include_next" || name == "import") {
+					directive.kind = scanned_directive_kind::include;
+					lex_header_name(directive);
+				}
+				else if (name == "embed") {
+					directive.kind = scanned_directive_kind::embed;
+					lex_header_name(directive);
+				}
+				else if (name == "define") {
+					skip_horizontal_space_and_comments();
+					directive.argument = std::string(lex_identifier());
+				}
+				else if (name == "if" || name == "ifdef" || name == "ifndef") {
+					directive.kind = scanned_directive_kind::conditional_begin;
+					if (name == "ifndef") {
+						skip_horizontal_space_and_comments();
+						directive.argument = std::string(lex_identifier());
+					}
+				}
+				else if (name == "elif" || name == "elifdef" || name == "elifndef"
+				     || name == "else") {
+					directive.kind = scanned_directive_kind::conditional_else;
+				}
+				else if (name == "endif") {
+					directive.kind = scanned_directive_kind::conditional_end;
+				}
+				else {
+					// #pragma, #error, #line, #undef, and so on: irrelevant to dependencies
+					skip_line();
+					return;
+				}
+				content_after_last_directive = false;
+				result.directives.push_back(std::move(directive));
+				skip_line();
+			}
+
+			void minimize() noexcept {
+				while (!at_end()) {
+					skip_horizontal_space_and_comments();
+					if (current() == '#') {
+						lex_directive();
+						continue;
+					}
+					if (current() != '\n' && !at_end()) {
+						if (result.directives.empty()) {
+							content_before_first_directive = true;
+						}
+						content_after_last_directive = true;
+					}
+					skip_line();
+				}
+				result.has_include_guard = detect_include_guard();
+			}
+
+			bool detect_include_guard() const noexcept {
+				const std::vector<scanned_directive>& directives = result.directives;
+				if (content_before_first_directive || content_after_last_directive
+				     || directives.size() < 3) {
+					return false;
+				}
+				const scanned_directive& guard_check      = directives.front();
+				const scanned_directive& guard_definition = directives[1];
+				if (guard_check.kind != scanned_directive_kind::conditional_begin
+				     || guard_check.argument.empty()
+				     || guard_definition.kind != scanned_directive_kind::define
+				     || guard_definition.argument != guard_check.argument) {
+					return false;
+				}
+				// the #ifndef must be closed by the very last directive, and have no #else
+				std::size_t depth = 0;
+				for (std::size_t i = 0; i < directives.size(); ++i) {
+					switch (directives[i].kind) {
+					case scanned_directive_kind::conditional_begin:
+						++depth;
+						break;
+					case scanned_directive_kind::conditional_else:
+						if (depth == 1) {
+							return false;
+						}
+						break;
+					case scanned_directive_kind::conditional_end:
+						if (--depth == 0) {
+							return i + 1 == directives.size();
+						}
+						break;
+					default:
+						break;
+					}
+				}
+				return false;
+			}
+		};
+
+		std::string identity_of(const fs::path& file) noexcept {
+			std::error_code ec;
+			fs::path canonical_path = fs::weakly_canonical(file, ec);
+			return ec ? file.lexically_normal().string() : canonical_path.string();
+		}
+
+		void write_escaped_make_word(std::string& output, std::string_view word) {
+			for (char c : word) {
+				switch (c) {
+				case ' ':
+				case '#':
+					output += '\\';
+					output += c;
+					break;
+				case '$':
+					output += "$$";
+					break;
+				default:
+					output += c;
+					break;
+				}
+			}
+		}
+	} // namespace
+
+	minimized_source minimize_directives(std::string_view source) noexcept {
+		std::string spliced_storage;
+		directive_minimizer minimizer { splice_lines(source, spliced_storage) };
+		minimizer.minimize();
+		return std::move(minimizer.result);
+	}
+
+	dependency_scanner::dependency_scanner(
+	     dependency_scan_options options, diagnostic_handles& diag_handles) noexcept
+	: m_options(std::move(options))
+	, m_diag_handles(diag_handles)
+	, m_cache_mutex()
+	, m_cache()
+	, m_report_mutex() {
+	}
+
+	std::shared_ptr<const minimized_source> dependency_scanner::minimized(
+	     const fs::path& file) noexcept {
+		std::string identity = identity_of(file);
+		{
+			std::unique_lock lock(m_cache_mutex);
+			auto cached_it = m_cache.find(identity);
+			if (cached_it != m_cache.end()) {
+				return cached_it->second;
+			}
+		}
+		std::optional<file_read_result> maybe_prefetched
+		     = m_options.prefetcher ? m_options.prefetcher->take(file) : std::nullopt;
+		file_read_result maybe_contents
+		     = maybe_prefetched ? std::move(*maybe_prefetched) : read_file_contents(file);
+		if (!maybe_contents) {
+			return nullptr;
+		}
+		auto fresh
+		     = std::make_shared<const minimized_source>(minimize_directives(*maybe_contents));
+		std::unique_lock lock(m_cache_mutex);
+		// if another thread got here first, use theirs so everyone shares one copy
+		auto [cached_it, _] = m_cache.try_emplace(std::move(identity), std::move(fresh));
+		return cached_it->second;
+	}
+
+	bool dependency_scanner::is_cached(const fs::path& file) noexcept {
+		std::string identity = identity_of(file);
+		std::unique_lock lock(m_cache_mutex);
+		return m_cache.contains(identity);
+	}
+
+	std::optional<fs::path> dependency_scanner::resolve(
+	     const scanned_directive& directive, const fs::path& including_file) const noexcept {
+		std::error_code ec;
+		if (!directive.angled) {
+			fs::path candidate
+			     = (including_file.parent_path() / directive.argument).lexically_normal();
+			if (fs::is_regular_file(candidate, ec)) {
+				return candidate;
+			}
+		}
+		for (const fs::path& include_directory : m_options.include_directories) {
+			fs::path candidate = (include_directory / directive.argument).lexically_normal();
+			if (fs::is_regular_file(candidate, ec)) {
+				return candidate;
+			}
+		}
+		return std::nullopt;
+	}
+
+	void dependency_scanner::report(
+	     const fs::path& file, std::size_t lineno, std::string_view message) noexcept {
+		std::unique_lock lock(m_report_mutex);
+		fmt::print(m_diag_handles.error_handle(), "{} ({}, {})\n❌ {}\n", file.string(), lineno,
+		     0, message);
+	}
+
+	void dependency_scanner::scan_into(const fs::path& file, dependency_scan_result& result,
+	     std::unordered_set<std::string>& visited) noexcept {
+		std::shared_ptr<const minimized_source> source = minimized(file);
+		if (!source) {
+			report(file, 0, "could not read file");
+			result.successful = false;
+			return;
+		}
+		// Without evaluating conditions we follow every branch. An include that cannot be
+		// found is only an error when it is not inside a conditional, since it may well be
+		// guarded by a test for the platform or for `__has_include`. Angled includes that
+		// cannot be found are assumed to be system headers and are left out, like `-MM`.
+		const std::vector<scanned_directive>& directives = source->directives;
+		std::vector<std::optional<fs::path>> dependencies(directives.size());
+		for (std::size_t i = 0; i < directives.size(); ++i) {
+			const scanned_directive& directive = directives[i];
+			if ((directive.kind != scanned_directive_kind::include
+			         && directive.kind != scanned_directive_kind::embed)
+			     || directive.argument.empty()) {
+				continue;
+			}
+			dependencies[i] = resolve(directive, file);
+			// start reading every header this file includes now, before walking into the first
+			if (m_options.prefetcher && dependencies[i]
+			     && directive.kind == scanned_directive_kind::include
+			     && !is_cached(*dependencies[i])) {
+				m_options.prefetcher->prefetch(*dependencies[i]);
+			}
+		}
+		std::ptrdiff_t conditional_depth = source->has_include_guard ? -1 : 0;
+		for (std::size_t i = 0; i < directives.size(); ++i) {
+			const scanned_directive& directive = directives[i];
+			switch (directive.kind) {
+			case scanned_directive_kind::conditional_begin:
+				++conditional_depth;
+				continue;
+			case scanned_directive_kind::conditional_end:
+				--conditional_depth;
+				continue;
+			case scanned_directive_kind::include:
+			case scanned_directive_kind::embed:
+				break;
+			default:
+				continue;
+			}
+			if (directive.argument.empty()) {
+				continue;
+			}
+			const std::optional<fs::path>& maybe_dependency = dependencies[i];
+			if (!maybe_dependency) {
+				if (!directive.angled && conditional_depth <= 0) {
+					report(file, directive.lineno,
+					     fmt::format("could not find file \"{}\"", directive.argument));
+					result.successful = false;
+				}
+				continue;
+			}
+			if (!visited.insert(identity_of(*maybe_dependency)).second) {
+				continue;
+			}
+			result.dependencies.push_back(*maybe_dependency);
+			if (directive.kind == scanned_directive_kind::include) {
+				scan_into(*maybe_dependency, result, visited);
+			}
+		}
+	}
+
+	dependency_scan_result dependency_scanner::scan(const fs::path& source_file) noexcept {
+		dependency_scan_result result { source_file, { source_file }, true };
+		std::unordered_set<std::string> visited { identity_of(source_file) };
+		scan_into(source_file, result, visited);
+		return result;
+	}
+
+	std::vector<dependency_scan_result> dependency_scanner::scan_all(
+	     const std::vector<fs::path>& source_files) noexcept {
+		std::vector<dependency_scan_result> results(source_files.size());
+		parallel_for(source_files.size(), m_options.thread_count,
+		     [&](std::size_t index) noexcept { results[index] = scan(source_files[index]); });
+		return results;
+	}
+
+	std::string default_dependency_target(const fs::path& source_file) {
+		return source_file.filename().replace_extension(".o").string();
+	}
+
+	void write_make_dependencies(std::ostream& output_stream, std::string_view target,
+	     const std::vector<fs::path>& dependencies) {
+		static constexpr std::size_t line_width = 78;
+		std::string rule;
+		write_escaped_make_word(rule, target);
+		rule += ':';
+		std::size_t line_start = 0;
+		for (const fs::path& dependency : dependencies) {
+			std::string word;
+			write_escaped_make_word(word, dependency.string());
+			if (rule.size() - line_start + 1 + word.size() > line_width) {
+				rule += " \\\n";
+				line_start = rule.size();
+			}
+			rule += ' ';
+			rule += word;
+		}
+		rule += '\n';
+		output_stream << rule;
+	}
+
+} // namespace a_c_compiler
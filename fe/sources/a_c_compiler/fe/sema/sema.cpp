@@ -0,0 +1,432 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/sema/sema.h>
+
+#include <a_c_compiler/fe/parse/parser_diagnostic_reporter.h>
+#include <a_c_compiler/fe/parse/symbol_table.h>
+#include <a_c_compiler/fe/support/thread_pool.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace a_c_compiler {
+
+	namespace {
+		/* A diagnostic found while checking, to be reported once everything has been, at the
+		 * token it is about. */
+		struct held_diagnostic {
+			const parser_diagnostic* diagnostic;
+			std::uint32_t token_index;
+			std::string argument;
+		};
+
+		/* What the file-scope phase gathers. Every function body is checked against it, and
+		 * nothing changes it while they are. */
+		struct file_scope {
+			const ast_module& mod;
+			const token_sequence& tokens;
+			/* By identifier index: whether the identifier appears anywhere outside a function
+			 * body. The parser does not declare everything it parses (enumeration constants,
+			 * for one), so a name that appears there is taken to be declared by something. */
+			std::vector<unsigned char> appears_outside_bodies;
+		};
+
+		enum class name_status : unsigned char {
+			/* declared nowhere the body can see */
+			undeclared,
+			/* declared, but by something there are no nodes or symbols for yet, so what it is
+			 * cannot be told */
+			unknown,
+			known,
+		};
+
+		/* What a name used in a function body refers to, as far as can be told. */
+		struct name_meaning {
+			name_status status;
+			symbol_kind kind = symbol_kind::object;
+			type t {};
+		};
+
+		[[nodiscard]] bool is_assignment(expression_operator op) noexcept {
+			switch (op) {
+			case expression_operator::assign:
+			case expression_operator::multiply_assign:
+			case expression_operator::divide_assign:
+			case expression_operator::remainder_assign:
+			case expression_operator::add_assign:
+			case expression_operator::subtract_assign:
+			case expression_operator::shift_left_assign:
+			case expression_operator::shift_right_assign:
+			case expression_operator::bitwise_and_assign:
+			case expression_operator::bitwise_xor_assign:
+			case expression_operator::bitwise_or_assign:
+			case expression_operator::pre_increment:
+			case expression_operator::pre_decrement:
+			case expression_operator::post_increment:
+			case expression_operator::post_decrement:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		/* Whether an expression with `op` at its top can be an lvalue. The ones that can still
+		 * might not be modifiable, depending on their type. */
+		[[nodiscard]] bool can_be_lvalue(expression_operator op) noexcept {
+			switch (op) {
+			case expression_operator::identifier:
+			case expression_operator::dereference:
+			case expression_operator::subscript:
+			case expression_operator::member:
+			case expression_operator::member_through_pointer:
+			case expression_operator::compound_literal:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		/* Whether an object of a type in `category` certainly cannot be called. Pointers are
+		 * left alone, since the parser does not always tell pointers to functions apart. */
+		[[nodiscard]] bool is_never_callable(type_category category) noexcept {
+			switch (category) {
+			case type_category::tc_bool:
+			case type_category::tc_char:
+			case type_category::tc_short:
+			case type_category::tc_int:
+			case type_category::tc_long:
+			case type_category::tc_longlong:
+			case type_category::tc__BitInt:
+			case type_category::tc_float:
+			case type_category::tc_double:
+			case type_category::tc_longdouble:
+			case type_category::tc_longlongdouble:
+			case type_category::tc_union:
+			case type_category::tc_struct:
+			case type_category::tc_enum:
+			case type_category::tc_array:
+			case type_category::tc_variable_length_array:
+			case type_category::tc_nullptr:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		/* Checks one function body. Everything it keeps is its own, and it only reads the file
+		 * scope and the module, so any number of bodies can be checked on different threads
+		 * at once. */
+		struct function_checker {
+			function_checker(const file_scope& file, ast_node_id definition,
+			     std::vector<held_diagnostic>& diagnostics) noexcept
+			: m_file(file)
+			, m_nodes(file.mod.nodes)
+			, m_definition(file.mod.nodes.function_definition_data(definition))
+			, m_parameters()
+			, m_local_names()
+			, m_pending()
+			, m_diagnostics(diagnostics) {
+				for (ast_node_id child = m_nodes.first_child(definition); child.is_valid();
+				     child = m_nodes.next_sibling(child)) {
+					if (m_nodes.kind(child) == ast_node_kind::parameter_declaration) {
+						m_parameters.push_back(m_nodes.parameter_declaration_data(child));
+					}
+				}
+			}
+
+			void check() noexcept {
+				const ast_node_id body = m_definition.body;
+				if (!body.is_valid()) {
+					return;
+				}
+				// Only expression statements and `return`s are made into nodes yet: everything
+				// else in the body, declarations included, is only tokens. Any name in those
+				// tokens might be declared by them, so none of them is checked against what
+				// it means outside the body.
+				for (ast_node_id item = m_nodes.first_child(body); item.is_valid();
+				     item = m_nodes.next_sibling(item)) {
+					if (m_nodes.kind(item) == ast_node_kind::statement
+					     && !m_nodes.first_child(item).is_valid()) {
+						const token_range tokens = m_nodes.statement_data(item).tokens;
+						for (std::uint32_t index = tokens.begin; index < tokens.end;
+						     ++index) {
+							const token& tok = m_file.tokens[index];
+							if (tok.id == tok_id) {
+								m_local_names.push_back(tok.identifier().index());
+							}
+						}
+					}
+				}
+				std::ranges::sort(m_local_names);
+				const std::size_t first_reported = m_diagnostics.size();
+				check_returns();
+				for (ast_node_id item = m_nodes.first_child(body); item.is_valid();
+				     item = m_nodes.next_sibling(item)) {
+					if (m_nodes.kind(item) == ast_node_kind::statement
+					     && m_nodes.first_child(item).is_valid()) {
+						check_expression(m_nodes.first_child(item));
+					}
+				}
+				// the `return`s were all checked first; put them where they are in the body
+				std::stable_sort(m_diagnostics.begin() + first_reported, m_diagnostics.end(),
+				     [](const held_diagnostic& left, const held_diagnostic& right) noexcept {
+					     return left.token_index < right.token_index;
+				     });
+			}
+
+		private:
+			void report(const parser_diagnostic& diagnostic, std::uint32_t token_index,
+			     identifier_id name = identifier_id()) noexcept {
+				std::string argument;
+				if (name.is_valid()) {
+					argument = identifier_spelling(name);
+				}
+				m_diagnostics.push_back(
+				     held_diagnostic { &diagnostic, token_index, std::move(argument) });
+			}
+
+			/* Every `return` in the body, whether or not the statement it is in has been
+			 * parsed: the tokens after it say whether it returns a value. */
+			void check_returns() noexcept {
+				const type_table& types  = m_file.mod.types;
+				const type function_type = m_definition.declaration.t;
+				if (types.data(function_type).category != type_category::tc_function
+				     || types.data(function_type).sub_type_count == 0) {
+					return;
+				}
+				const type_category returned
+				     = types.data(types.return_type(function_type)).category;
+				if (returned == type_category::tc_none) {
+					return;
+				}
+				const token_range tokens = m_definition.body_tokens;
+				for (std::uint32_t index = tokens.begin; index + 1 < tokens.end; ++index) {
+					if (m_file.tokens[index].id != tok_keyword_return) {
+						continue;
+					}
+					const bool has_value = m_file.tokens[index + 1].id != tok_semicolon;
+					if (returned == type_category::tc_void && has_value) {
+						report(parser_err::return_value_from_void_function, index,
+						     m_definition.declaration.name);
+					}
+					else if (returned != type_category::tc_void && !has_value) {
+						report(parser_err::return_without_value, index,
+						     m_definition.declaration.name);
+					}
+				}
+			}
+
+			/* Walks the expression rooted at `root` depth first, left to right, so that what
+			 * it reports comes in the order it is written. */
+			void check_expression(ast_node_id root) noexcept {
+				m_pending.assign(1, root);
+				while (!m_pending.empty()) {
+					const ast_node_id node = m_pending.back();
+					m_pending.pop_back();
+					if (m_nodes.kind(node) != ast_node_kind::expression) {
+						continue;
+					}
+					const expression& expr    = m_nodes.expression_data(node);
+					const ast_node_id operand = m_nodes.first_child(node);
+					switch (expr.op) {
+					case expression_operator::identifier:
+						check_declared(expr.token_index);
+						break;
+					case expression_operator::member:
+					case expression_operator::member_through_pointer:
+						// the member's name is looked up in the structure, not here
+						m_pending.push_back(operand);
+						continue;
+					case expression_operator::call:
+						check_callable(operand);
+						break;
+					default:
+						if (is_assignment(expr.op)) {
+							check_modifiable(expr.token_index, operand);
+						}
+						break;
+					}
+					const std::size_t first_pushed = m_pending.size();
+					for (ast_node_id child = operand; child.is_valid();
+					     child = m_nodes.next_sibling(child)) {
+						m_pending.push_back(child);
+					}
+					std::reverse(m_pending.begin() + first_pushed, m_pending.end());
+				}
+			}
+
+			[[nodiscard]] name_meaning meaning_of(identifier_id name) const noexcept {
+				if (std::ranges::binary_search(m_local_names, name.index())) {
+					return name_meaning { name_status::unknown };
+				}
+				for (const parameter_declaration& parameter : m_parameters) {
+					if (parameter.name == name) {
+						return name_meaning { name_status::known, symbol_kind::object,
+							parameter.t };
+					}
+				}
+				if (const symbol* declared
+				     = m_file.mod.symbols.find(symbol_namespace::ordinary, name)) {
+					return name_meaning { name_status::known, declared->kind, declared->t };
+				}
+				if ((name.index() < m_file.appears_outside_bodies.size()
+				          && m_file.appears_outside_bodies[name.index()])
+				     || identifier_spelling(name) == "__func__") {
+					return name_meaning { name_status::unknown };
+				}
+				return name_meaning { name_status::undeclared };
+			}
+
+			void check_declared(std::uint32_t token_index) noexcept {
+				const identifier_id name = m_file.tokens[token_index].identifier();
+				if (meaning_of(name).status == name_status::undeclared) {
+					report(parser_err::undeclared_identifier, token_index, name);
+				}
+			}
+
+			/* The name `operand` is, if it is nothing but an identifier. */
+			[[nodiscard]] const expression* identifier_operand(
+			     ast_node_id operand) const noexcept {
+				if (!operand.is_valid() || m_nodes.kind(operand) != ast_node_kind::expression) {
+					return nullptr;
+				}
+				const expression& expr = m_nodes.expression_data(operand);
+				return expr.op == expression_operator::identifier ? &expr : nullptr;
+			}
+
+			void check_callable(ast_node_id callee) noexcept {
+				const expression* named = identifier_operand(callee);
+				if (named == nullptr) {
+					return;
+				}
+				const identifier_id name    = m_file.tokens[named->token_index].identifier();
+				const name_meaning meaning = meaning_of(name);
+				if (meaning.status == name_status::known && meaning.kind == symbol_kind::object
+				     && is_never_callable(m_file.mod.types.data(meaning.t).category)) {
+					report(parser_err::not_callable, named->token_index, name);
+				}
+			}
+
+			void check_modifiable(std::uint32_t operator_index, ast_node_id target) noexcept {
+				if (!target.is_valid() || m_nodes.kind(target) != ast_node_kind::expression) {
+					return;
+				}
+				if (!can_be_lvalue(m_nodes.expression_data(target).op)) {
+					report(parser_err::not_assignable, operator_index);
+					return;
+				}
+				const expression* named = identifier_operand(target);
+				if (named == nullptr) {
+					return;
+				}
+				const identifier_id name    = m_file.tokens[named->token_index].identifier();
+				const name_meaning meaning = meaning_of(name);
+				if (meaning.status != name_status::known) {
+					return;
+				}
+				const type_category category = m_file.mod.types.data(meaning.t).category;
+				if (meaning.kind != symbol_kind::object || category == type_category::tc_array
+				     || category == type_category::tc_variable_length_array) {
+					report(parser_err::not_modifiable, named->token_index, name);
+				}
+			}
+
+			const file_scope& m_file;
+			const ast_node_table& m_nodes;
+			const function_definition& m_definition;
+			std::vector<parameter_declaration> m_parameters;
+			/* the index of every identifier in the body's unparsed block items, sorted */
+			std::vector<std::uint32_t> m_local_names;
+			/* the expression nodes left to visit */
+			std::vector<ast_node_id> m_pending;
+			std::vector<held_diagnostic>& m_diagnostics;
+		};
+
+		/* The token that names the function `definition`, which is the last one spelled like it
+		 * before its body. */
+		std::uint32_t name_token_of(
+		     const token_sequence& tokens, const function_definition& definition) noexcept {
+			for (std::uint32_t index = definition.body_tokens.begin; index > 0; --index) {
+				const token& tok = tokens[index - 1];
+				if (tok.id == tok_id && tok.identifier() == definition.declaration.name) {
+					return index - 1;
+				}
+			}
+			return definition.body_tokens.begin;
+		}
+	} // namespace
+
+	std::size_t analyze_semantics(const ast_module& mod, std::size_t thread_count) noexcept {
+		ZTD_ASSERT_MESSAGE("the module was not parsed from a source file", mod.source);
+		const token_source& source = *mod.source;
+		file_scope file { mod, source.tokens, {} };
+
+		// The file-scope phase: every external declaration, in order, on this thread.
+		std::vector<ast_node_id> definitions;
+		// what is reported about each external declaration, by its place in the translation
+		// unit; each function body only ever adds to its own definition's
+		std::vector<std::vector<held_diagnostic>> diagnostics;
+		std::vector<std::size_t> definition_slots;
+		std::vector<unsigned char> in_body(source.tokens.size(), 0);
+		std::unordered_set<std::uint32_t> defined_names;
+		for (ast_node_id node = mod.nodes.first_child(mod.root()); node.is_valid();
+		     node = mod.nodes.next_sibling(node)) {
+			diagnostics.emplace_back();
+			if (mod.nodes.kind(node) != ast_node_kind::function_definition) {
+				continue;
+			}
+			const function_definition& definition = mod.nodes.function_definition_data(node);
+			std::fill(in_body.begin() + definition.body_tokens.begin,
+			     in_body.begin() + definition.body_tokens.end, 1);
+			const identifier_id name = definition.declaration.name;
+			if (name.is_valid() && !defined_names.insert(name.index()).second) {
+				diagnostics.back().push_back(
+				     held_diagnostic { &parser_err::function_redefinition,
+				          name_token_of(source.tokens, definition),
+				          std::string(identifier_spelling(name)) });
+			}
+			definitions.push_back(node);
+			definition_slots.push_back(diagnostics.size() - 1);
+		}
+		for (std::size_t index = 0; index < source.tokens.size(); ++index) {
+			const token& tok = source.tokens[index];
+			if (tok.id != tok_id || in_body[index]) {
+				continue;
+			}
+			const std::uint32_t name = tok.identifier().index();
+			if (name >= file.appears_outside_bodies.size()) {
+				file.appears_outside_bodies.resize(name + 1, 0);
+			}
+			file.appears_outside_bodies[name] = 1;
+		}
+
+		// The function phase: the bodies are independent of each other, and some are far
+		// bigger than others, so they are shared out over threads that steal from each other.
+		work_stealing_for(definitions.size(), thread_count, [&](std::size_t index) noexcept {
+			function_checker checker(
+			     file, definitions[index], diagnostics[definition_slots[index]]);
+			checker.check();
+		});
+
+		parser_diagnostic_reporter reporter { *source.diag_handles, *source.sources };
+		std::size_t reported = 0;
+		for (const std::vector<held_diagnostic>& held_for_declaration : diagnostics) {
+			for (const held_diagnostic& held : held_for_declaration) {
+				reporter.report(*held.diagnostic, source.tokens[held.token_index].location,
+				     held.argument);
+				++reported;
+			}
+		}
+		return reported;
+	}
+
+} // namespace a_c_compiler
@@ -0,0 +1,285 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/source/file_prefetcher.h>
+
+#include <a_c_compiler/version.h>
+#include <ztd/idk/assert.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <utility>
+
+#if defined(A_C_COMPILER_HAS_IO_URING) && A_C_COMPILER_HAS_IO_URING != 0
+#include <liburing.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define A_C_COMPILER_IO_URING_AVAILABLE 1
+#else
+#define A_C_COMPILER_IO_URING_AVAILABLE 0
+#endif
+
+namespace a_c_compiler {
+
+	file_read_result read_file_contents(const fs::path& file) noexcept {
+		FILE* fp =
+#if ZTD_IS_ON(ZTD_LIBVCXX)
+		     _wfopen(file.c_str(), L"rb")
+#else
+		     std::fopen(file.c_str(), "rb")
+#endif
+		     ;
+		if (fp == nullptr) {
+			return std::unexpected(std::error_code(errno, std::generic_category()));
+		}
+		std::string contents;
+		char chunk[16384];
+		for (;;) {
+			std::size_t read_size = std::fread(chunk, 1, sizeof(chunk), fp);
+			contents.append(chunk, read_size);
+			if (read_size < sizeof(chunk)) {
+				break;
+			}
+		}
+		const bool failed = std::ferror(fp) != 0;
+		std::fclose(fp);
+		if (failed) {
+			return std::unexpected(std::make_error_code(std::errc::io_error));
+		}
+		return contents;
+	}
+
+	struct file_prefetcher::request {
+		enum class stage : unsigned char { opening, sizing, reading };
+
+		fs::path path;
+		std::optional<file_read_result> result;
+		// io_uring bookkeeping: which operation is in flight, and what it has produced
+		stage current_stage = stage::opening;
+		int fd              = -1;
+		std::string contents;
+		std::size_t bytes_read = 0;
+#if A_C_COMPILER_IO_URING_AVAILABLE
+		struct statx file_status;
+#endif
+	};
+
+	struct file_prefetcher::io_uring_state {
+#if A_C_COMPILER_IO_URING_AVAILABLE
+		inline static constexpr const unsigned queue_depth = 256;
+
+		::io_uring ring;
+		/* Submissions come from whoever calls `prefetch` and from the reaper thread moving
+		 * a file on to its next operation; completions are only ever read by the reaper. */
+		std::mutex submission_mutex;
+		std::atomic<bool> stopping = false;
+#endif
+	};
+
+	file_prefetcher::file_prefetcher(std::size_t thread_count) noexcept
+	: m_mutex()
+	, m_request_finished()
+	, m_requests()
+	, m_requests_in_flight(0)
+	, m_io_uring()
+	, m_io_uring_reaper()
+	, m_thread_count(thread_count)
+	, m_pool() {
+#if A_C_COMPILER_IO_URING_AVAILABLE
+		auto state = std::make_unique<io_uring_state>();
+		// the kernel may be too old, or io_uring may be turned off: then use threads instead
+		if (::io_uring_queue_init(io_uring_state::queue_depth, &state->ring, 0) == 0) {
+			m_io_uring = std::move(state);
+			m_io_uring_reaper
+			     = std::thread([this]() noexcept { this->reap_io_uring_completions(); });
+			return;
+		}
+#endif
+		// Reading files is waiting, not computing: a few more threads than cores is fine.
+		m_pool.emplace(default_thread_count(m_thread_count) * 2);
+	}
+
+	file_prefetcher::~file_prefetcher() noexcept {
+#if A_C_COMPILER_IO_URING_AVAILABLE
+		if (m_io_uring) {
+			{
+				std::unique_lock lock(m_io_uring->submission_mutex);
+				m_io_uring->stopping = true;
+				// wake the reaper up with a completion that belongs to no file
+				::io_uring_sqe* sqe = ::io_uring_get_sqe(&m_io_uring->ring);
+				while (sqe == nullptr) {
+					::io_uring_submit(&m_io_uring->ring);
+					sqe = ::io_uring_get_sqe(&m_io_uring->ring);
+				}
+				::io_uring_prep_nop(sqe);
+				::io_uring_sqe_set_data(sqe, nullptr);
+				::io_uring_submit(&m_io_uring->ring);
+			}
+			m_io_uring_reaper.join();
+			::io_uring_queue_exit(&m_io_uring->ring);
+		}
+#endif
+		m_pool.reset();
+	}
+
+	prefetch_backend file_prefetcher::backend() const noexcept {
+		return m_io_uring ? prefetch_backend::io_uring : prefetch_backend::thread_pool;
+	}
+
+	void file_prefetcher::prefetch(const fs::path& file) noexcept {
+		request* target = nullptr;
+		{
+			std::unique_lock lock(m_mutex);
+			auto [request_it, inserted]
+			     = m_requests.try_emplace(file.lexically_normal().string(), nullptr);
+			if (!inserted) {
+				return;
+			}
+			request_it->second       = std::make_unique<request>();
+			request_it->second->path = file;
+			target                   = request_it->second.get();
+			++m_requests_in_flight;
+		}
+		if (m_io_uring) {
+			submit_to_io_uring(*target);
+		}
+		else {
+			m_pool->submit([this, target]() noexcept {
+				this->finish(*target, read_file_contents(target->path));
+			});
+		}
+	}
+
+	std::optional<file_read_result> file_prefetcher::take(const fs::path& file) noexcept {
+		std::unique_lock lock(m_mutex);
+		auto request_it = m_requests.find(file.lexically_normal().string());
+		if (request_it == m_requests.end()) {
+			return std::nullopt;
+		}
+		request& target = *request_it->second;
+		m_request_finished.wait(lock, [&target]() { return target.result.has_value(); });
+		std::optional<file_read_result> result = std::move(target.result);
+		m_requests.erase(request_it);
+		return result;
+	}
+
+	void file_prefetcher::finish(request& target, file_read_result result) noexcept {
+		{
+			std::unique_lock lock(m_mutex);
+			target.result = std::move(result);
+			--m_requests_in_flight;
+		}
+		m_request_finished.notify_all();
+	}
+
+#if A_C_COMPILER_IO_URING_AVAILABLE
+	void file_prefetcher::submit_to_io_uring(request& target) noexcept {
+		std::unique_lock lock(m_io_uring->submission_mutex);
+		::io_uring_sqe* sqe = ::io_uring_get_sqe(&m_io_uring->ring);
+		while (sqe == nullptr) {
+			// the submission queue is full: push what is there to the kernel and try again
+			::io_uring_submit(&m_io_uring->ring);
+			sqe = ::io_uring_get_sqe(&m_io_uring->ring);
+		}
+		switch (target.current_stage) {
+		case request::stage::opening:
+			::io_uring_prep_openat(
+			     sqe, AT_FDCWD, target.path.c_str(), O_RDONLY | O_CLOEXEC, 0);
+			break;
+		case request::stage::sizing:
+			::io_uring_prep_statx(
+			     sqe, target.fd, "", AT_EMPTY_PATH, STATX_SIZE, &target.file_status);
+			break;
+		case request::stage::reading:
+			::io_uring_prep_read(sqe, target.fd, target.contents.data() + target.bytes_read,
+			     static_cast<unsigned>(target.contents.size() - target.bytes_read),
+			     target.bytes_read);
+			break;
+		}
+		::io_uring_sqe_set_data(sqe, &target);
+		::io_uring_submit(&m_io_uring->ring);
+	}
+
+	void file_prefetcher::advance_io_uring_request(
+	     request& target, int operation_result) noexcept {
+		const auto fail = [&](int error_value) noexcept {
+			if (target.fd >= 0) {
+				::close(target.fd);
+			}
+			finish(target,
+			     std::unexpected(std::error_code(error_value, std::generic_category())));
+		};
+		if (operation_result < 0) {
+			fail(-operation_result);
+			return;
+		}
+		switch (target.current_stage) {
+		case request::stage::opening:
+			target.fd            = operation_result;
+			target.current_stage = request::stage::sizing;
+			break;
+		case request::stage::sizing:
+			target.contents.resize(static_cast<std::size_t>(target.file_status.stx_size));
+			target.current_stage = request::stage::reading;
+			break;
+		case request::stage::reading:
+			target.bytes_read += static_cast<std::size_t>(operation_result);
+			if (operation_result == 0) {
+				// the file shrank since we asked for its size
+				target.contents.resize(target.bytes_read);
+			}
+			break;
+		}
+		if (target.current_stage == request::stage::reading
+		     && target.bytes_read == target.contents.size()) {
+			::close(target.fd);
+			finish(target, std::move(target.contents));
+			return;
+		}
+		submit_to_io_uring(target);
+	}
+
+	void file_prefetcher::reap_io_uring_completions() noexcept {
+		for (;;) {
+			::io_uring_cqe* cqe   = nullptr;
+			const int wait_result = ::io_uring_wait_cqe(&m_io_uring->ring, &cqe);
+			if (wait_result == -EINTR) {
+				continue;
+			}
+			ZTD_ASSERT_MESSAGE("waiting on io_uring completions failed", wait_result == 0);
+			request* target            = static_cast<request*>(::io_uring_cqe_get_data(cqe));
+			const int operation_result = cqe->res;
+			::io_uring_cqe_seen(&m_io_uring->ring, cqe);
+			if (target != nullptr) {
+				advance_io_uring_request(*target, operation_result);
+			}
+			// once destruction has started, stop as soon as nothing is left in flight
+			if (m_io_uring->stopping.load()) {
+				std::unique_lock lock(m_mutex);
+				if (m_requests_in_flight == 0) {
+					return;
+				}
+			}
+		}
+	}
+#else
+	void file_prefetcher::submit_to_io_uring(request&) noexcept {
+		ZTD_ASSERT_MESSAGE("io_uring is not available in this build", false);
+	}
+
+	void file_prefetcher::advance_io_uring_request(request&, int) noexcept {
+		ZTD_ASSERT_MESSAGE("io_uring is not available in this build", false);
+	}
+
+	void file_prefetcher::reap_io_uring_completions() noexcept {
+		ZTD_ASSERT_MESSAGE("io_uring is not available in this build", false);
+	}
+#endif
+
+} // namespace a_c_compiler
@@ -0,0 +1,183 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/source/source_manager.h>
+#include <a_c_compiler/fe/source/file_prefetcher.h>
+
+#include <a_c_compiler/version.h>
+#include <ztd/idk/assert.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#if ZTD_IS_OFF(ZTD_PLATFORM_WINDOWS)
+#include <sys/stat.h>
+#endif
+
+namespace a_c_compiler {
+
+	namespace {
+		/* Something which is the same for every path naming the same file. */
+		std::expected<std::string, std::error_code> file_identity(const fs::path& file) noexcept {
+#if ZTD_IS_ON(ZTD_PLATFORM_WINDOWS)
+			std::error_code ec;
+			fs::path canonical_path = fs::canonical(file, ec);
+			if (ec) {
+				return std::unexpected(ec);
+			}
+			return canonical_path.string();
+#else
+			struct stat file_status;
+			if (::stat(file.c_str(), &file_status) != 0) {
+				return std::unexpected(std::error_code(errno, std::generic_category()));
+			}
+			return std::to_string(file_status.st_dev) + ":" + std::to_string(file_status.st_ino);
+#endif
+		}
+	} // namespace
+
+	source_manager::source_manager() noexcept
+	: m_files()
+	, m_file_starts()
+	, m_files_by_identity()
+	, m_next_location(1)
+	, m_prefetcher(nullptr) {
+	}
+
+	void source_manager::use_prefetcher(file_prefetcher* prefetcher) noexcept {
+		m_prefetcher = prefetcher;
+	}
+
+	std::expected<file_id, std::error_code> source_manager::load(const fs::path& file) noexcept {
+		auto maybe_identity = file_identity(file);
+		if (!maybe_identity) {
+			return std::unexpected(maybe_identity.error());
+		}
+		auto existing_it = m_files_by_identity.find(*maybe_identity);
+		if (existing_it != m_files_by_identity.end()) {
+			return existing_it->second;
+		}
+		std::optional<file_read_result> maybe_prefetched
+		     = m_prefetcher ? m_prefetcher->take(file) : std::nullopt;
+		file_read_result maybe_contents
+		     = maybe_prefetched ? std::move(*maybe_prefetched) : read_file_contents(file);
+		if (!maybe_contents) {
+			return std::unexpected(maybe_contents.error());
+		}
+		auto maybe_file = add_file(file, file.string(), std::move(*maybe_contents));
+		if (maybe_file) {
+			m_files_by_identity.emplace(std::move(*maybe_identity), *maybe_file);
+		}
+		return maybe_file;
+	}
+
+	std::expected<file_id, std::error_code> source_manager::add_buffer(
+	     std::string name, std::string contents) noexcept {
+		return add_file(fs::path(), std::move(name), std::move(contents));
+	}
+
+	std::expected<file_id, std::error_code> source_manager::add_edited(
+	     file_id file, const text_edit& edit) noexcept {
+		const file_entry& edited = entry(file);
+		ZTD_ASSERT_MESSAGE("edit is not within the file",
+		     edit.begin <= edit.end && edit.end <= edited.contents.size());
+		std::string contents;
+		contents.reserve(
+		     edited.contents.size() - (edit.end - edit.begin) + edit.replacement.size());
+		contents.append(edited.contents, 0, edit.begin);
+		contents.append(edit.replacement);
+		contents.append(edited.contents, edit.end);
+		// copied before adding, which can move `edited`
+		fs::path path    = edited.path;
+		std::string name = edited.name;
+		return add_file(std::move(path), std::move(name), std::move(contents));
+	}
+
+	std::expected<file_id, std::error_code> source_manager::add_file(
+	     fs::path path, std::string name, std::string contents) noexcept {
+		// one extra location, so the end of the file has a location too
+		const std::uint64_t end_location
+		     = static_cast<std::uint64_t>(m_next_location) + contents.size() + 1;
+		if (end_location > source_location::macro_location_bit) {
+			return std::unexpected(std::make_error_code(std::errc::value_too_large));
+		}
+		std::vector<std::uint32_t> line_starts { 0 };
+		for (const char* newline = static_cast<const char*>(
+		          std::memchr(contents.data(), '\n', contents.size()));
+		     newline != nullptr;) {
+			const std::size_t next_line
+			     = static_cast<std::size_t>(newline - contents.data()) + 1;
+			line_starts.push_back(static_cast<std::uint32_t>(next_line));
+			newline = static_cast<const char*>(
+			     std::memchr(contents.data() + next_line, '\n', contents.size() - next_line));
+		}
+		file_id id(static_cast<std::uint32_t>(m_files.size()));
+		m_file_starts.push_back(m_next_location);
+		m_files.push_back(file_entry { std::move(path), std::move(name), std::move(contents),
+		     m_next_location, std::move(line_starts) });
+		m_next_location = static_cast<std::uint32_t>(end_location);
+		return id;
+	}
+
+	const source_manager::file_entry& source_manager::entry(file_id file) const noexcept {
+		ZTD_ASSERT_MESSAGE("file id does not belong to this source manager",
+		     file.is_valid() && file.index() < m_files.size());
+		return m_files[file.index()];
+	}
+
+	std::string_view source_manager::buffer(file_id file) const noexcept {
+		return entry(file).contents;
+	}
+
+	std::string_view source_manager::name(file_id file) const noexcept {
+		return entry(file).name;
+	}
+
+	const fs::path& source_manager::path(file_id file) const noexcept {
+		return entry(file).path;
+	}
+
+	source_location source_manager::location(file_id file, std::uint32_t offset) const noexcept {
+		const file_entry& target = entry(file);
+		ZTD_ASSERT_MESSAGE(
+		     "offset is beyond the end of the file", offset <= target.contents.size());
+		return source_location(target.start + offset);
+	}
+
+	file_id source_manager::file_of(source_location location) const noexcept {
+		if (!location.is_valid() || location.is_macro_location()
+		     || location.raw() >= m_next_location) {
+			return file_id();
+		}
+		auto after_it
+		     = std::upper_bound(m_file_starts.begin(), m_file_starts.end(), location.raw());
+		return file_id(static_cast<std::uint32_t>(after_it - m_file_starts.begin() - 1));
+	}
+
+	std::uint32_t source_manager::offset_of(source_location location) const noexcept {
+		const file_id file = file_of(location);
+		ZTD_ASSERT_MESSAGE("location does not belong to this source manager", file.is_valid());
+		return location.raw() - m_file_starts[file.index()];
+	}
+
+	presumed_location source_manager::presume(source_location location) const noexcept {
+		const file_id file = file_of(location);
+		if (!file.is_valid()) {
+			return presumed_location { "<unknown source>", 0, 0 };
+		}
+		const file_entry& target   = m_files[file.index()];
+		const std::uint32_t offset = location.raw() - target.start;
+		auto line_it
+		     = std::upper_bound(target.line_starts.begin(), target.line_starts.end(), offset) - 1;
+		return presumed_location { target.name,
+			static_cast<std::uint32_t>(line_it - target.line_starts.begin()) + 1,
+			offset - *line_it + 1 };
+	}
+
+} // namespace a_c_compiler
@@ -0,0 +1,543 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/support/big_integer.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace a_c_compiler {
+
+	namespace {
+		using limb = big_integer::limb;
+
+		/* The low limb of `a * b`, with the high one in `high`. */
+		limb multiply_limbs(limb a, limb b, limb& high) noexcept {
+#if defined(__SIZEOF_INT128__)
+			__extension__ using wide = unsigned __int128;
+			const wide product       = wide(a) * b;
+			high                     = static_cast<limb>(product >> 64);
+			return static_cast<limb>(product);
+#else
+			const limb a_low     = a & 0xFFFFFFFF;
+			const limb a_high    = a >> 32;
+			const limb b_low     = b & 0xFFFFFFFF;
+			const limb b_high    = b >> 32;
+			const limb low_low   = a_low * b_low;
+			const limb high_low  = a_high * b_low;
+			const limb low_high  = a_low * b_high;
+			const limb high_high = a_high * b_high;
+			const limb middle    = (low_low >> 32) + (high_low & 0xFFFFFFFF) + low_high;
+			high                 = high_high + (high_low >> 32) + (middle >> 32);
+			return (middle << 32) | (low_low & 0xFFFFFFFF);
+#endif
+		}
+
+		/* Compares two magnitudes, which may have leading zero limbs. */
+		std::strong_ordering compare_magnitudes(
+		     std::span<const limb> left, std::span<const limb> right) noexcept {
+			std::size_t size = std::max(left.size(), right.size());
+			while (size-- != 0) {
+				const limb l = size < left.size() ? left[size] : 0;
+				const limb r = size < right.size() ? right[size] : 0;
+				if (l != r) {
+					return l <=> r;
+				}
+			}
+			return std::strong_ordering::equal;
+		}
+
+		/* `from -= amount` for magnitudes, where `from` is at least as big. */
+		void subtract_in_place(std::span<limb> from, std::span<const limb> amount) noexcept {
+			limb borrow = 0;
+			for (std::size_t index = 0; index < from.size(); ++index) {
+				const limb subtracted = index < amount.size() ? amount[index] : 0;
+				const limb difference = from[index] - subtracted - borrow;
+				const bool borrows    = from[index] < subtracted
+				     || (from[index] == subtracted && borrow != 0);
+				from[index]           = difference;
+				borrow                = borrows ? 1 : 0;
+			}
+		}
+
+		/* Negates two's complement limbs in place. Returns whether the + 1 carried out of the
+		 * top, which only happens for 0. */
+		bool negate_in_place(std::span<limb> bits) noexcept {
+			bool carry = true;
+			for (limb& bit : bits) {
+				bit   = ~bit + (carry ? 1 : 0);
+				carry = carry && bit == 0;
+			}
+			return carry;
+		}
+
+		/* The two's complement limbs of an integer, a limb at a time from the lowest, extended
+		 * with its sign forever. */
+		struct twos_complement_reader {
+			std::span<const limb> magnitude;
+			bool is_negative;
+			bool carry = true;
+
+			limb next(std::size_t index) noexcept {
+				const limb value = index < magnitude.size() ? magnitude[index] : 0;
+				if (!is_negative) {
+					return value;
+				}
+				const limb negated = ~value + (carry ? 1 : 0);
+				carry              = carry && value == 0;
+				return negated;
+			}
+		};
+	} // namespace
+
+	big_integer::big_integer(std::uint64_t value) noexcept {
+		if (value != 0) {
+			m_inline[0] = value;
+			m_size      = 1;
+		}
+	}
+
+	big_integer::big_integer(const big_integer& other) noexcept
+	: m_heap(), m_size(other.m_size), m_negative(other.m_negative) {
+		if (other.m_heap) {
+			m_heap = std::make_unique_for_overwrite<limb[]>(m_size);
+			std::memcpy(m_heap.get(), other.m_heap.get(), m_size * sizeof(limb));
+		}
+		else {
+			std::memcpy(m_inline, other.m_inline, sizeof(m_inline));
+		}
+	}
+
+	big_integer::big_integer(big_integer&& other) noexcept
+	: m_heap(std::move(other.m_heap)), m_size(other.m_size), m_negative(other.m_negative) {
+		std::memcpy(m_inline, other.m_inline, sizeof(m_inline));
+		other.m_size     = 0;
+		other.m_negative = false;
+	}
+
+	big_integer& big_integer::operator=(const big_integer& other) noexcept {
+		if (this != &other) {
+			*this = big_integer(other);
+		}
+		return *this;
+	}
+
+	big_integer& big_integer::operator=(big_integer&& other) noexcept {
+		if (this != &other) {
+			m_heap = std::move(other.m_heap);
+			std::memcpy(m_inline, other.m_inline, sizeof(m_inline));
+			m_size           = other.m_size;
+			m_negative       = other.m_negative;
+			other.m_size     = 0;
+			other.m_negative = false;
+		}
+		return *this;
+	}
+
+	big_integer big_integer::from_signed(std::int64_t value) noexcept {
+		big_integer result(value < 0 ? 0 - static_cast<std::uint64_t>(value)
+		                             : static_cast<std::uint64_t>(value));
+		result.m_negative = value < 0;
+		return result;
+	}
+
+	big_integer big_integer::from_double(double value) noexcept {
+		const double magnitude = std::fabs(value);
+		big_integer result;
+		if (magnitude < 0x1p64) {
+			result = big_integer(static_cast<std::uint64_t>(magnitude));
+		}
+		else {
+			// all 53 bits of the significand, shifted into place
+			int exponent           = 0;
+			const double fraction  = std::frexp(magnitude, &exponent);
+			const limb significand = static_cast<limb>(std::ldexp(fraction, 64));
+			result = big_integer(significand) << static_cast<std::uint32_t>(exponent - 64);
+		}
+		result.m_negative = value < 0 && !result.is_zero();
+		return result;
+	}
+
+	big_integer big_integer::power_of_two(std::uint32_t exponent) noexcept {
+		big_integer result = with_limbs(exponent / limb_bits + 1);
+		result.limbs()[exponent / limb_bits] = limb(1) << (exponent % limb_bits);
+		return result;
+	}
+
+	big_integer big_integer::with_limbs(std::uint32_t limb_count) noexcept {
+		big_integer result;
+		if (limb_count > inline_limbs) {
+			result.m_heap = std::make_unique<limb[]>(limb_count);
+		}
+		result.m_size = limb_count;
+		return result;
+	}
+
+	void big_integer::normalize() noexcept {
+		const limb* const bits = limbs();
+		while (m_size != 0 && bits[m_size - 1] == 0) {
+			--m_size;
+		}
+		if (m_size == 0) {
+			m_negative = false;
+		}
+		if (m_heap && m_size <= inline_limbs) {
+			std::memset(m_inline, 0, sizeof(m_inline));
+			std::memcpy(m_inline, m_heap.get(), m_size * sizeof(limb));
+			m_heap.reset();
+		}
+	}
+
+	std::uint32_t big_integer::bit_width() const noexcept {
+		if (m_size == 0) {
+			return 0;
+		}
+		return (m_size - 1) * limb_bits + std::bit_width(limbs()[m_size - 1]);
+	}
+
+	bool big_integer::fits_in(std::uint32_t width, bool is_unsigned) const noexcept {
+		if (is_unsigned) {
+			return !m_negative && bit_width() <= width;
+		}
+		const std::uint32_t value_width = bit_width();
+		if (value_width < width) {
+			return true;
+		}
+		// the one value as wide as the type that fits is its lowest: -2 to the power of
+		// `width - 1`
+		if (!m_negative || value_width != width) {
+			return false;
+		}
+		const std::span<const limb> bits = magnitude();
+		return std::has_single_bit(bits.back())
+		     && std::all_of(bits.begin(), bits.end() - 1, [](limb bit) { return bit == 0; });
+	}
+
+	big_integer big_integer::wrapped(std::uint32_t width, bool is_unsigned) const noexcept {
+		if (fits_in(width, is_unsigned)) {
+			return *this;
+		}
+		if (width == 0) {
+			return big_integer();
+		}
+		// the low `width` bits in two's complement, then read back as the type reads them
+		const std::uint32_t limb_count = (width + limb_bits - 1) / limb_bits;
+		const std::uint32_t top_bits   = width % limb_bits;
+		big_integer result             = with_limbs(limb_count);
+		const std::span<limb> bits(result.limbs(), limb_count);
+		twos_complement_reader reader { magnitude(), m_negative };
+		for (std::size_t index = 0; index < bits.size(); ++index) {
+			bits[index] = reader.next(index);
+		}
+		const limb top_mask = top_bits == 0 ? ~limb(0) : (limb(1) << top_bits) - 1;
+		bits.back() &= top_mask;
+		const bool sign_bit = ((bits.back() >> ((width - 1) % limb_bits)) & 1) != 0;
+		if (!is_unsigned && sign_bit) {
+			bits.back() |= ~top_mask;
+			negate_in_place(bits);
+			result.m_negative = true;
+		}
+		result.normalize();
+		return result;
+	}
+
+	std::uint64_t big_integer::low_bits() const noexcept {
+		const limb low = m_size == 0 ? 0 : limbs()[0];
+		return m_negative ? 0 - low : low;
+	}
+
+	double big_integer::to_double() const noexcept {
+		const std::uint32_t width = bit_width();
+		double value              = 0;
+		if (width <= limb_bits) {
+			value = static_cast<double>(m_size == 0 ? 0 : limbs()[0]);
+		}
+		else {
+			// the top 64 bits, with the lowest one set if any bit below them is (so that
+			// converting them rounds the way converting all of them would), scaled back up
+			const std::span<const limb> bits = magnitude();
+			const std::uint32_t shift        = width - limb_bits;
+			const std::uint32_t index        = shift / limb_bits;
+			const std::uint32_t offset       = shift % limb_bits;
+			limb top                         = bits[index] >> offset;
+			if (offset != 0) {
+				top |= bits[index + 1] << (limb_bits - offset);
+			}
+			const bool is_inexact
+			     = (offset != 0 && (bits[index] << (limb_bits - offset)) != 0)
+			     || std::any_of(
+			          bits.begin(), bits.begin() + index, [](limb bit) { return bit != 0; });
+			value = std::ldexp(static_cast<double>(top | (is_inexact ? 1 : 0)), int(shift));
+		}
+		return m_negative ? -value : value;
+	}
+
+	void big_integer::multiply_add(std::uint32_t factor, std::uint32_t addend) noexcept {
+		limb carry       = addend;
+		limb* const bits = limbs();
+		for (std::uint32_t index = 0; index < m_size; ++index) {
+			limb high      = 0;
+			const limb low = multiply_limbs(bits[index], factor, high);
+			bits[index]    = low + carry;
+			carry          = high + (bits[index] < low ? 1 : 0);
+		}
+		if (carry == 0) {
+			return;
+		}
+		if (!m_heap && m_size < inline_limbs) {
+			m_inline[m_size++] = carry;
+			return;
+		}
+		big_integer grown = with_limbs(m_size + 1);
+		std::memcpy(grown.limbs(), bits, m_size * sizeof(limb));
+		grown.limbs()[m_size] = carry;
+		grown.m_negative      = m_negative;
+		*this                 = std::move(grown);
+	}
+
+	big_integer big_integer::add_magnitudes(const big_integer& left, const big_integer& right,
+	     bool subtract, bool is_negative) noexcept {
+		const std::span<const limb> l = left.magnitude();
+		const std::span<const limb> r = right.magnitude();
+		if (!subtract) {
+			big_integer result = with_limbs(static_cast<std::uint32_t>(
+			     std::max(l.size(), r.size()) + 1));
+			limb* const sum = result.limbs();
+			limb carry      = 0;
+			for (std::uint32_t index = 0; index + 1 < result.m_size; ++index) {
+				const limb a = index < l.size() ? l[index] : 0;
+				const limb b = index < r.size() ? r[index] : 0;
+				sum[index]   = a + b + carry;
+				carry        = (sum[index] < a || (carry != 0 && sum[index] == a)) ? 1 : 0;
+			}
+			sum[result.m_size - 1] = carry;
+			result.m_negative      = is_negative;
+			result.normalize();
+			return result;
+		}
+		const bool flips              = compare_magnitudes(l, r) < 0;
+		const std::span<const limb> a = flips ? r : l;
+		const std::span<const limb> b = flips ? l : r;
+		big_integer result            = with_limbs(static_cast<std::uint32_t>(a.size()));
+		std::memcpy(result.limbs(), a.data(), a.size() * sizeof(limb));
+		subtract_in_place(std::span<limb>(result.limbs(), a.size()), b);
+		result.m_negative = is_negative != flips;
+		result.normalize();
+		return result;
+	}
+
+	big_integer big_integer::divide(
+	     const big_integer& left, const big_integer& right, big_integer* remainder) noexcept {
+		const std::span<const limb> l = left.magnitude();
+		const std::span<const limb> r = right.magnitude();
+		const bool quotient_negative  = left.m_negative != right.m_negative;
+		big_integer quotient;
+		big_integer rest;
+		if (l.size() <= 1 && r.size() == 1) {
+			const limb a = l.empty() ? 0 : l[0];
+			quotient     = big_integer(a / r[0]);
+			rest         = big_integer(a % r[0]);
+		}
+		else if (compare_magnitudes(l, r) < 0) {
+			rest = left;
+		}
+		else {
+			// long division a bit at a time: the remainder so far has at most one limb more
+			// than the divisor, and each step shifts the next bit of the dividend into it
+			quotient = with_limbs(static_cast<std::uint32_t>(l.size()));
+			rest     = with_limbs(static_cast<std::uint32_t>(r.size() + 1));
+			const std::span<limb> partial(rest.limbs(), rest.m_size);
+			limb* const quotient_bits = quotient.limbs();
+			for (std::uint32_t bit = left.bit_width(); bit-- != 0;) {
+				limb carried = (l[bit / limb_bits] >> (bit % limb_bits)) & 1;
+				for (limb& part : partial) {
+					const limb shifted_out = part >> (limb_bits - 1);
+					part                   = (part << 1) | carried;
+					carried                = shifted_out;
+				}
+				if (compare_magnitudes(partial, r) >= 0) {
+					subtract_in_place(partial, r);
+					quotient_bits[bit / limb_bits] |= limb(1) << (bit % limb_bits);
+				}
+			}
+			quotient.normalize();
+			rest.normalize();
+		}
+		quotient.m_negative = quotient_negative && !quotient.is_zero();
+		rest.m_negative     = left.m_negative && !rest.is_zero();
+		if (remainder != nullptr) {
+			*remainder = std::move(rest);
+		}
+		return quotient;
+	}
+
+	big_integer big_integer::bitwise(
+	     const big_integer& left, const big_integer& right, bitwise_operator op) noexcept {
+		// every limb past the wider magnitude is the same as the one at its end: all 0s or
+		// all 1s, by the sign
+		const std::uint32_t limb_count = std::max(left.m_size, right.m_size);
+		const auto apply = [op](limb a, limb b) noexcept {
+			switch (op) {
+			case bitwise_operator::and_:
+				return a & b;
+			case bitwise_operator::or_:
+				return a | b;
+			default:
+				return a ^ b;
+			}
+		};
+		const limb sign
+		     = apply(left.m_negative ? ~limb(0) : 0, right.m_negative ? ~limb(0) : 0);
+		big_integer result = with_limbs(limb_count);
+		const std::span<limb> bits(result.limbs(), limb_count);
+		twos_complement_reader l { left.magnitude(), left.m_negative };
+		twos_complement_reader r { right.magnitude(), right.m_negative };
+		for (std::size_t index = 0; index < bits.size(); ++index) {
+			bits[index] = apply(l.next(index), r.next(index));
+		}
+		if (sign != 0) {
+			if (negate_in_place(bits)) {
+				// all the low limbs were 0, so this is -2 to the power of their width
+				return -power_of_two(limb_count * limb_bits);
+			}
+			result.m_negative = true;
+		}
+		result.normalize();
+		return result;
+	}
+
+	big_integer operator-(const big_integer& value) noexcept {
+		big_integer result = value;
+		result.m_negative  = !value.m_negative && !value.is_zero();
+		return result;
+	}
+
+	big_integer operator~(const big_integer& value) noexcept {
+		return -value - big_integer(1);
+	}
+
+	big_integer operator+(const big_integer& left, const big_integer& right) noexcept {
+		return big_integer::add_magnitudes(
+		     left, right, left.m_negative != right.m_negative, left.m_negative);
+	}
+
+	big_integer operator-(const big_integer& left, const big_integer& right) noexcept {
+		return big_integer::add_magnitudes(
+		     left, right, left.m_negative == right.m_negative, left.m_negative);
+	}
+
+	big_integer operator*(const big_integer& left, const big_integer& right) noexcept {
+		if (left.is_zero() || right.is_zero()) {
+			return big_integer();
+		}
+		const std::span<const limb> l = left.magnitude();
+		const std::span<const limb> r = right.magnitude();
+		big_integer result            = big_integer::with_limbs(left.m_size + right.m_size);
+		limb* const product           = result.limbs();
+		for (std::size_t i = 0; i < l.size(); ++i) {
+			limb carry = 0;
+			for (std::size_t j = 0; j < r.size(); ++j) {
+				limb high = 0;
+				limb low  = multiply_limbs(l[i], r[j], high);
+				low += carry;
+				high += low < carry ? 1 : 0;
+				product[i + j] += low;
+				high += product[i + j] < low ? 1 : 0;
+				carry = high;
+			}
+			product[i + r.size()] = carry;
+		}
+		result.m_negative = left.m_negative != right.m_negative;
+		result.normalize();
+		return result;
+	}
+
+	big_integer operator/(const big_integer& left, const big_integer& right) noexcept {
+		return big_integer::divide(left, right, nullptr);
+	}
+
+	big_integer operator%(const big_integer& left, const big_integer& right) noexcept {
+		big_integer remainder;
+		(void)big_integer::divide(left, right, &remainder);
+		return remainder;
+	}
+
+	big_integer operator&(const big_integer& left, const big_integer& right) noexcept {
+		return big_integer::bitwise(left, right, big_integer::bitwise_operator::and_);
+	}
+
+	big_integer operator|(const big_integer& left, const big_integer& right) noexcept {
+		return big_integer::bitwise(left, right, big_integer::bitwise_operator::or_);
+	}
+
+	big_integer operator^(const big_integer& left, const big_integer& right) noexcept {
+		return big_integer::bitwise(left, right, big_integer::bitwise_operator::xor_);
+	}
+
+	big_integer operator<<(const big_integer& value, std::uint32_t by) noexcept {
+		if (value.is_zero()) {
+			return big_integer();
+		}
+		const std::uint32_t limbs_by = by / big_integer::limb_bits;
+		const std::uint32_t bits_by      = by % big_integer::limb_bits;
+		big_integer result               = big_integer::with_limbs(value.m_size + limbs_by + 1);
+		limb* const shifted              = result.limbs();
+		const std::span<const limb> bits = value.magnitude();
+		for (std::size_t index = 0; index < bits.size(); ++index) {
+			shifted[index + limbs_by] |= bits[index] << bits_by;
+			if (bits_by != 0) {
+				shifted[index + limbs_by + 1]
+				     |= bits[index] >> (big_integer::limb_bits - bits_by);
+			}
+		}
+		result.m_negative = value.m_negative;
+		result.normalize();
+		return result;
+	}
+
+	big_integer operator>>(const big_integer& value, std::uint32_t by) noexcept {
+		if (value.m_negative) {
+			// rounding toward negative infinity: -((|value| - 1) / 2^by) - 1
+			return -((-value - big_integer(1)) >> by) - big_integer(1);
+		}
+		const std::uint32_t limbs_by = by / big_integer::limb_bits;
+		const std::uint32_t bits_by  = by % big_integer::limb_bits;
+		if (limbs_by >= value.m_size) {
+			return big_integer();
+		}
+		big_integer result               = big_integer::with_limbs(value.m_size - limbs_by);
+		limb* const shifted              = result.limbs();
+		const std::span<const limb> bits = value.magnitude();
+		for (std::size_t index = 0; index < result.m_size; ++index) {
+			shifted[index] = bits[index + limbs_by] >> bits_by;
+			if (bits_by != 0 && index + limbs_by + 1 < bits.size()) {
+				shifted[index]
+				     |= bits[index + limbs_by + 1] << (big_integer::limb_bits - bits_by);
+			}
+		}
+		result.normalize();
+		return result;
+	}
+
+	bool operator==(const big_integer& left, const big_integer& right) noexcept {
+		return left.m_negative == right.m_negative && left.m_size == right.m_size
+		     && std::equal(left.magnitude().begin(), left.magnitude().end(),
+		          right.magnitude().begin());
+	}
+
+	std::strong_ordering operator<=>(const big_integer& left, const big_integer& right) noexcept {
+		if (left.m_negative != right.m_negative) {
+			return left.m_negative ? std::strong_ordering::less : std::strong_ordering::greater;
+		}
+		const std::strong_ordering magnitudes
+		     = compare_magnitudes(left.magnitude(), right.magnitude());
+		return left.m_negative ? 0 <=> magnitudes : magnitudes;
+	}
+
+} // namespace a_c_compiler
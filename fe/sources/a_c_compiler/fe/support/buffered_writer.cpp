@@ -0,0 +1,34 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/support/buffered_writer.h>
+
+namespace a_c_compiler {
+
+	buffered_writer::buffered_writer(std::FILE* output) noexcept
+	: m_output(output)
+	, m_buffer(std::make_unique_for_overwrite<char[]>(buffer_size))
+	, m_size(0)
+	, m_failed(false) {
+	}
+
+	buffered_writer::~buffered_writer() noexcept {
+		flush();
+	}
+
+	void buffered_writer::flush() noexcept {
+		write_through(std::string_view(m_buffer.get(), m_size));
+		m_size = 0;
+	}
+
+	void buffered_writer::write_through(std::string_view text) noexcept {
+		if (!text.empty() && std::fwrite(text.data(), 1, text.size(), m_output) != text.size()) {
+			m_failed = true;
+		}
+	}
+
+} // namespace a_c_compiler
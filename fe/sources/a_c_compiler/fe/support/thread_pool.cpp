@@ -0,0 +1,87 @@
+// =============================================================================
+// a_c_compiler
+//
+// © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+// All rights reserved.
+// ============================================================================ //
+
+#include <a_c_compiler/fe/support/thread_pool.h>
+
+#include <utility>
+
+namespace a_c_compiler {
+
+	std::size_t default_thread_count(std::size_t requested_count) noexcept {
+		if (requested_count != 0) {
+			return requested_count;
+		}
+		std::size_t hardware_count = std::thread::hardware_concurrency();
+		return hardware_count == 0 ? 1 : hardware_count;
+	}
+
+	thread_pool::thread_pool(std::size_t thread_count) noexcept
+	: m_mutex()
+	, m_task_available()
+	, m_tasks_finished()
+	, m_tasks()
+	, m_tasks_in_flight(0)
+	, m_stopping(false)
+	, m_workers() {
+		thread_count = default_thread_count(thread_count);
+		m_workers.reserve(thread_count);
+		for (std::size_t i = 0; i < thread_count; ++i) {
+			m_workers.emplace_back([this]() noexcept { this->work(); });
+		}
+	}
+
+	thread_pool::~thread_pool() noexcept {
+		{
+			std::unique_lock lock(m_mutex);
+			m_stopping = true;
+		}
+		m_task_available.notify_all();
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	void thread_pool::submit(std::function<void()> task) noexcept {
+		{
+			std::unique_lock lock(m_mutex);
+			m_tasks.push_back(std::move(task));
+			++m_tasks_in_flight;
+		}
+		m_task_available.notify_one();
+	}
+
+	void thread_pool::wait() noexcept {
+		std::unique_lock lock(m_mutex);
+		m_tasks_finished.wait(lock, [this]() { return m_tasks_in_flight == 0; });
+	}
+
+	void thread_pool::work() noexcept {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock(m_mutex);
+				m_task_available.wait(
+				     lock, [this]() { return m_stopping || !m_tasks.empty(); });
+				if (m_tasks.empty()) {
+					return;
+				}
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+			bool all_finished = false;
+			{
+				std::unique_lock lock(m_mutex);
+				all_finished = --m_tasks_in_flight == 0;
+			}
+			if (all_finished) {
+				m_tasks_finished.notify_all();
+			}
+		}
+	}
+
+} // namespace a_c_compiler
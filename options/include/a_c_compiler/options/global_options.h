@@ -14,7 +14,10 @@
 namespace a_c_compiler {
 
 	struct global_options {
-		constexpr global_options() : m_feature_flags() {
+		constexpr global_options()
+		: m_feature_flags()
+		, m_constexpr_step_limit(default_constexpr_step_limit)
+		, m_constexpr_depth_limit(default_constexpr_depth_limit) {
 		}
 
 		[[nodiscard]] constexpr bool get_feature_flag(
@@ -26,8 +29,31 @@ namespace a_c_compiler {
 			m_feature_flags[flag] |= (1 << bit);
 		}
 
+		/* How many operators and operands evaluating one constant expression may visit. */
+		[[nodiscard]] constexpr std::uint64_t constexpr_step_limit() const noexcept {
+			return m_constexpr_step_limit;
+		}
+
+		constexpr void set_constexpr_step_limit(std::uint64_t limit) noexcept {
+			m_constexpr_step_limit = limit;
+		}
+
+		/* How deeply the operands of one constant expression may nest. */
+		[[nodiscard]] constexpr std::uint32_t constexpr_depth_limit() const noexcept {
+			return m_constexpr_depth_limit;
+		}
+
+		constexpr void set_constexpr_depth_limit(std::uint32_t limit) noexcept {
+			m_constexpr_depth_limit = limit;
+		}
+
+		inline static constexpr const std::uint64_t default_constexpr_step_limit  = 1048576;
+		inline static constexpr const std::uint32_t default_constexpr_depth_limit = 512;
+
 	private:
 		inline static constexpr const std::size_t num_feature_flags = 32;
 		std::uint64_t m_feature_flags[num_feature_flags];
+		std::uint64_t m_constexpr_step_limit;
+		std::uint32_t m_constexpr_depth_limit;
 	};
 } // namespace a_c_compiler
@@ -0,0 +1,36 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# What every script run by a test made with `a_c_compiler_test_make_driver_script_test` shares.
+# Such a script is run with DRIVER (the compiler driver to run) and WORK_DIR (where to write its
+# inputs), and includes this first.
+
+foreach(variable DRIVER WORK_DIR)
+	if (NOT DEFINED ${variable})
+		message(FATAL_ERROR "${CMAKE_SCRIPT_MODE_FILE} has to be run with -D${variable}=...")
+	endif()
+endforeach()
+
+# Runs the driver on `file` in WORK_DIR up to the end of `phase`, with the options given after
+# it, and gives back what it reported. The driver itself has to succeed.
+function(driver_diagnostics out_variable phase file)
+	execute_process(
+		COMMAND ${DRIVER} -fstop-after-phase ${phase} ${ARGN} ${WORK_DIR}/${file}
+		RESULT_VARIABLE result
+		OUTPUT_QUIET
+		ERROR_VARIABLE diagnostics)
+	if (NOT result EQUAL 0)
+		message(FATAL_ERROR "running the driver on ${file} with '${ARGN}' failed: ${diagnostics}")
+	endif()
+	set(${out_variable} "${diagnostics}" PARENT_SCOPE)
+endfunction()
+
+# Parses `file` in WORK_DIR with the options given after it, and gives back its diagnostics.
+function(parse_errors out_variable file)
+	driver_diagnostics(diagnostics parse ${file} ${ARGN})
+	set(${out_variable} "${diagnostics}" PARENT_SCOPE)
+endfunction()
@@ -0,0 +1,60 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Writes the AST of a header-like file to an image with -femit-ast-image, and then parses a
+# file that needs its typedef-names against that image with -fuse-ast-image. Only the
+# declarations the file refers to (directly or not) may be read back from the image.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/ast_image_common.c
+	"typedef int count_type;\n"
+	"int base = 3;\n"
+	"int scale(int a, int b) { return a * b + base; }\n"
+	"int unused(count_type c) { return c - 1; }\n"
+	"int twice(int v) { return scale(v, 2); }\n")
+file(WRITE ${WORK_DIR}/ast_image_main.c
+	"count_type total = 4;\n"
+	"int main(int argc) { return twice(total); }\n")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -femit-ast-image ${WORK_DIR}/ast_image_common.ast
+		${WORK_DIR}/ast_image_common.c
+	RESULT_VARIABLE result
+	ERROR_VARIABLE errors)
+if (NOT result EQUAL 0 OR errors MATCHES "❌")
+	message(FATAL_ERROR "writing the AST image failed: ${errors}")
+endif()
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fuse-ast-image ${WORK_DIR}/ast_image_common.ast
+		-fdump-ast text ${WORK_DIR}/ast_image_main.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE dump
+	ERROR_VARIABLE errors)
+if (NOT result EQUAL 0 OR errors MATCHES "❌")
+	message(FATAL_ERROR "parsing against the AST image failed: ${errors}")
+endif()
+foreach(name total main twice scale base)
+	if (NOT dump MATCHES "\n  [a-z_]+ name=${name} ")
+		message(FATAL_ERROR "${name} is missing from the AST: ${dump}")
+	endif()
+endforeach()
+if (dump MATCHES "name=unused")
+	message(FATAL_ERROR "a declaration nothing refers to was read from the image: ${dump}")
+endif()
+
+file(WRITE ${WORK_DIR}/ast_image_broken.ast "not an image")
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fuse-ast-image ${WORK_DIR}/ast_image_broken.ast
+		${WORK_DIR}/ast_image_main.c
+	RESULT_VARIABLE result
+	OUTPUT_QUIET
+	ERROR_QUIET)
+if (result EQUAL 0)
+	message(FATAL_ERROR "a file that is not an AST image was accepted")
+endif()
@@ -0,0 +1,75 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Checks `_BitInt(N)`: the layouts -fdump-record-layouts gives members of it on the default
+# target (x86-64 System V), and constant expressions with it, both narrower than a `long
+# long` and wider, with C's rules for it: it is not promoted, unsigned ones wrap, and signed
+# ones must not overflow. A signed one has to be at least 2 bits wide, wherever `unsigned` is.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/bit_int.c
+	"constexpr unsigned _BitInt(256) one = 1;\n"
+	"constexpr unsigned _BitInt(256) p = (one << 255) - 19;\n"
+	"static_assert(p % 1000 == 949 && p % 7 == 3, \"remainders of 2^255 - 19\");\n"
+	"static_assert(p + 19 == one << 255 && -one == (one << 255) * 2 - 1);\n"
+	"static_assert((p * p) % p == 361, \"the product wraps\");\n"
+	"constexpr _BitInt(128) big = (_BitInt(128))1 << 100;\n"
+	"static_assert(big / 1024 == (_BitInt(128))1 << 90 && -big >> 99 == -2);\n"
+	"static_assert(((big - 1) & -big) == 0 && (big | 1) - big == 1 && (~big ^ -1) == big);\n"
+	"static_assert((unsigned _BitInt(4))15 + (unsigned _BitInt(4))1 == 0);\n"
+	"static_assert(sizeof(unsigned _BitInt(256)) == 32 && alignof(_BitInt(256)) == 8);\n"
+	"static_assert(sizeof(_BitInt(3)) == 1 && sizeof(_BitInt(65)) == 16);\n"
+	"struct keys { unsigned _BitInt(256) key; _BitInt(12) tag; _BitInt(40) id; };\n"
+	"int buckets[(int)(p % 7)];\n"
+	"static_assert((_BitInt(8))127 + (_BitInt(8))1 == 128);\n"
+	"static_assert((_BitInt(70))1 << 69 > 0);\n")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-record-layouts ${WORK_DIR}/bit_int.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE layouts
+	ERROR_VARIABLE diagnostics)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "parsing failed: ${diagnostics}")
+endif()
+
+string(CONCAT expected
+	"struct keys size=48 alignment=8\n"
+	"  key offset=0\n"
+	"  tag offset=32\n"
+	"  id offset=40\n")
+if (NOT layouts MATCHES "^${expected}$")
+	message(FATAL_ERROR "wrong layouts: ${layouts}")
+endif()
+
+# only the last two, which overflow a signed _BitInt
+string(CONCAT expected
+	"^[^\n]*bit_int.c \\(14, 31\\)\n"
+	"❌ expected a constant expression, but its value does not fit in its type\n"
+	"[^\n]*bit_int.c \\(15, 30\\)\n"
+	"❌ expected a constant expression, but its value does not fit in its type\n$")
+if (NOT diagnostics MATCHES "${expected}")
+	message(FATAL_ERROR "wrong diagnostics: ${diagnostics}")
+endif()
+
+file(WRITE ${WORK_DIR}/bit_int_width.c
+	"unsigned _BitInt(1) a;\n"
+	"_BitInt(1) unsigned b;\n"
+	"static_assert(sizeof(_BitInt(1) unsigned) == 1);\n"
+	"_BitInt(2) c;\n"
+	"_BitInt(1) d;\n"
+	"signed _BitInt(1) e;\n")
+parse_errors(diagnostics bit_int_width.c)
+string(CONCAT expected
+	"^[^\n]*bit_int_width.c \\(5, 1\\)\n"
+	"❌ [^\n]*\n"
+	"[^\n]*bit_int_width.c \\(6, 1\\)\n"
+	"❌ [^\n]*\n$")
+if (NOT diagnostics MATCHES "${expected}")
+	message(FATAL_ERROR "wrong diagnostics for 1-bit _BitInts: ${diagnostics}")
+endif()
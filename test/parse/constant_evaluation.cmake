@@ -0,0 +1,97 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Checks that constant expressions are evaluated while parsing: `constexpr` objects used in
+# array bounds, bit-field widths and other constants, `static_assert` declarations that hold
+# and ones that do not, expressions that are not constant, and the limits -fconstexpr-steps
+# and -fconstexpr-depth put on evaluating one. Then checks that a structure declared before
+# its body has the size of its body, in every mode, and one never completed has no size.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/constant_evaluation.c
+	"constexpr int width = 3;\n"
+	"constexpr int count = width * 4 + 1;\n"
+	"constexpr unsigned int one = 1;\n"
+	"struct s { int a : width; int b[count]; static_assert(sizeof(int[count]) == 52); };\n"
+	"int numbers[count];\n"
+	"static_assert(sizeof numbers == 52, \"array bound\");\n"
+	"static_assert(-1 > one && (1 ? 2 : 1 / 0) == 2);\n"
+	"static_assert(2.5 * 2 == 5 && (int)2.5 == 2);\n"
+	"static_assert(count < 10, \"too \" \"many\");\n"
+	"static_assert(1 / (count - 13));\n"
+	"constexpr int too_big = 2147483647 + 1;\n"
+	"constexpr char narrowed = 300;\n")
+
+# Parses `constant_evaluation.c` with the options given after `out_variable`, checks the
+# layout it gives `struct s`, and gives back its diagnostics.
+function(parse out_variable)
+	execute_process(
+		COMMAND ${DRIVER} -fstop-after-phase parse -fdump-record-layouts ${ARGN}
+			${WORK_DIR}/constant_evaluation.c
+		RESULT_VARIABLE result
+		OUTPUT_VARIABLE layouts
+		ERROR_VARIABLE diagnostics)
+	if (NOT result EQUAL 0)
+		message(FATAL_ERROR "parsing failed: ${diagnostics}")
+	endif()
+	string(CONCAT expected
+		"struct s size=56 alignment=4\n"
+		"  a offset=0 bit_offset=0 bit_width=3\n"
+		"  b offset=4\n")
+	if (NOT layouts MATCHES "^${expected}$")
+		message(FATAL_ERROR "wrong layout: ${layouts}")
+	endif()
+	set(${out_variable} "${diagnostics}" PARENT_SCOPE)
+endfunction()
+
+parse(diagnostics)
+string(CONCAT expected
+	"constant_evaluation.c \\(9, 1\\)\n"
+	"❌ static assertion failed: \"too many\"\n"
+	"[^\n]*constant_evaluation.c \\(10, 17\\)\n"
+	"❌ expected a constant expression, but it divides by zero\n"
+	"[^\n]*constant_evaluation.c \\(11, 36\\)\n"
+	"❌ expected a constant expression, but its value does not fit in its type\n"
+	"[^\n]*constant_evaluation.c \\(12, 27\\)\n"
+	"❌ expected a constant expression, but its value changes when converted to the type of "
+	"what it initializes\n$")
+if (NOT diagnostics MATCHES "${expected}")
+	message(FATAL_ERROR "wrong diagnostics: ${diagnostics}")
+endif()
+string(REGEX MATCHALL "❌" reported "${diagnostics}")
+list(LENGTH reported reported_count)
+if (NOT reported_count EQUAL 4)
+	message(FATAL_ERROR "expected 4 diagnostics: ${diagnostics}")
+endif()
+
+# too few steps and too shallow a nesting for `-1 > one && (1 ? 2 : 1 / 0) == 2`
+parse(diagnostics -fconstexpr-steps 8)
+if (NOT diagnostics MATCHES "\\(7, [0-9]+\\)\n❌ [^\n]*takes more steps than the limit allows")
+	message(FATAL_ERROR "the step limit was not kept to: ${diagnostics}")
+endif()
+parse(diagnostics -fconstexpr-depth 2)
+if (NOT diagnostics MATCHES "\\(7, [0-9]+\\)\n❌ [^\n]*nests more deeply than the limit allows")
+	message(FATAL_ERROR "the depth limit was not kept to: ${diagnostics}")
+endif()
+
+file(WRITE ${WORK_DIR}/incomplete_record.c
+	"struct s;\n"
+	"struct s *p;\n"
+	"struct s { int a; double b; } value;\n"
+	"static_assert(sizeof(*p) == 16, \"p\");\n"
+	"struct t *q;\n"
+	"static_assert(sizeof(*q) == 1);\n")
+foreach(mode "" "-fpipeline-lexer" "-fskip-function-bodies")
+	parse_errors(diagnostics incomplete_record.c ${mode})
+	string(CONCAT expected
+		"^[^\n]*incomplete_record.c \\(6, 15\\)\n"
+		"❌ expected a constant expression, but it uses something that is not a constant\n$")
+	if (NOT diagnostics MATCHES "${expected}")
+		message(FATAL_ERROR "wrong diagnostics with ${mode}: ${diagnostics}")
+	endif()
+endforeach()
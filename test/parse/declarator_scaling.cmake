@@ -0,0 +1,56 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Parses one long declaration whose parameters are themselves function declarators, once at a
+# small size and once at 16 times that size. Declarators should be parsed in linear time, so
+# the larger input should take about 16 times as long; anything quadratic takes about 256
+# times as long and fails here.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+set(small_parameter_count 500)
+set(size_ratio 16)
+# generous, since timings at this size are noisy; quadratic behaviour blows far past it
+set(allowed_ratio 64)
+# below this many microseconds, there is nothing meaningful to measure
+set(noise_floor 250000)
+
+function(write_pathological_input parameter_count output_file)
+	string(REPEAT "int (*(*p)(int, char*))[4], " ${parameter_count} parameters)
+	file(WRITE ${output_file} "void f(${parameters}int last);")
+endfunction()
+
+function(fastest_parse_time input_file out_variable)
+	set(fastest_time "")
+	foreach(attempt RANGE 2)
+		# the seconds and the microseconds of one reading of the clock, in microseconds
+		string(TIMESTAMP start "%s%f" UTC)
+		execute_process(
+			COMMAND ${DRIVER} -fstop-after-phase parse ${input_file}
+			OUTPUT_QUIET
+			ERROR_QUIET)
+		string(TIMESTAMP end "%s%f" UTC)
+		math(EXPR elapsed "${end} - ${start}")
+		if (fastest_time STREQUAL "" OR elapsed LESS fastest_time)
+			set(fastest_time ${elapsed})
+		endif()
+	endforeach()
+	set(${out_variable} ${fastest_time} PARENT_SCOPE)
+endfunction()
+
+math(EXPR large_parameter_count "${small_parameter_count} * ${size_ratio}")
+write_pathological_input(${small_parameter_count} ${WORK_DIR}/declarator_scaling.small.c)
+write_pathological_input(${large_parameter_count} ${WORK_DIR}/declarator_scaling.large.c)
+
+fastest_parse_time(${WORK_DIR}/declarator_scaling.small.c small_time)
+fastest_parse_time(${WORK_DIR}/declarator_scaling.large.c large_time)
+message(STATUS "${small_parameter_count} parameters: ${small_time}us, ${large_parameter_count} parameters: ${large_time}us")
+
+math(EXPR time_limit "${small_time} * ${allowed_ratio} + ${noise_floor}")
+if (large_time GREATER time_limit)
+	message(FATAL_ERROR "declarator parsing does not scale linearly: ${large_parameter_count} parameters took ${large_time}us, more than ${time_limit}us")
+endif()
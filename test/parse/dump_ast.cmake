@@ -0,0 +1,61 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Dumps the AST of a small translation unit as text and as JSON, and then that of one
+# expression nested far deeper than a recursive walk could go.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/dump_ast.c "int value = 1 + 2 * 3;\nint twice(int p) { return p * 2; }\n")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-ast text ${WORK_DIR}/dump_ast.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE text_dump)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "dumping the AST as text failed")
+endif()
+if (NOT text_dump MATCHES "\n  declaration name=value [^\n]*\n    expression op=add\n")
+	message(FATAL_ERROR "the text dump is missing the declaration of value: ${text_dump}")
+endif()
+if (NOT text_dump MATCHES "\n  function_definition [^\n]*\n    parameter_declaration name=p ")
+	message(FATAL_ERROR "the text dump is missing the definition of twice: ${text_dump}")
+endif()
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-ast json ${WORK_DIR}/dump_ast.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE json_dump)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "dumping the AST as JSON failed")
+endif()
+string(JSON root_kind ERROR_VARIABLE json_error GET "${json_dump}" kind)
+if (json_error)
+	message(FATAL_ERROR "the JSON dump does not parse: ${json_error}\n${json_dump}")
+endif()
+string(JSON value_name GET "${json_dump}" children 0 name)
+string(JSON multiply_op GET "${json_dump}" children 0 children 0 children 1 op)
+if (NOT root_kind STREQUAL "translation_unit" OR NOT value_name STREQUAL "value"
+	OR NOT multiply_op STREQUAL "multiply")
+	message(FATAL_ERROR "the JSON dump has the wrong shape: ${json_dump}")
+endif()
+
+set(term_count 50000)
+string(REPEAT " + 1" ${term_count} terms)
+file(WRITE ${WORK_DIR}/dump_ast_deep.c "int value = 1${terms};\n")
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-ast json ${WORK_DIR}/dump_ast_deep.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE deep_dump)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "dumping a deeply nested AST failed")
+endif()
+string(REGEX MATCHALL "\"op\":\"add\"" adds "${deep_dump}")
+list(LENGTH adds add_count)
+if (NOT add_count EQUAL term_count)
+	message(FATAL_ERROR "the deep dump has ${add_count} additions, not ${term_count}")
+endif()
@@ -0,0 +1,27 @@
+typedef int my_int;
+int scale = 1 + 2 * 3 - 4;
+int pick(int a, int b) {
+	a = b = a << 2 >= b && a != b || !~a;
+	p->next.values[a + 1](b, a += 2)++;
+	return (my_int)-a + sizeof(my_int) + sizeof a-- + (a ? b : 0);
+}
+// CHECK: tok_id: scale
+// CHECK: tok_plus
+// CHECK: tok_asterisk
+// CHECK: tok_minus
+// CHECK: tok_shift_left
+// CHECK: tok_greater_than_equals
+// CHECK: tok_ampersand_ampersand
+// CHECK: tok_exclamation_mark_equals
+// CHECK: tok_pipe_pipe
+// CHECK: tok_exclamation_mark
+// CHECK: tok_tilde
+// CHECK: tok_arrow
+// CHECK: tok_period
+// CHECK: tok_l_square_bracket
+// CHECK: tok_plus_equals
+// CHECK: tok_plus_plus
+// CHECK: tok_keyword_sizeof
+// CHECK: tok_minus_minus
+// CHECK: tok_question_mark
+// CHECK: tok_colon
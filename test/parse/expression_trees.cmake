@@ -0,0 +1,151 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Checks the trees the expression parser builds, as -fdump-ast text shows them: operators bind
+# as tightly as C says, binary ones group to the left and assignments and conditionals to the
+# right, and `( name )` is a cast only while `name` is a typedef-name. Then checks what malformed
+# expressions report.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/expression_trees.c
+	"typedef int T;\n"
+	"int x;\n"
+	"int left = 1 - 2 - 3;\n"
+	"int tighter = 1 + 2 * 3;\n"
+	"int grouped = (1 + 2) * 3;\n"
+	"int shifted = 1 << 2 + 3;\n"
+	"int logical = 1 || 2 && 3;\n"
+	"int unary = -x * 2;\n"
+	"int right = x = x = 1;\n"
+	"int nested = 1 ? 2 : 3 ? 4 : 5;\n"
+	"int cast = (T)-x;\n"
+	"int parenthesized = (x)-1;\n"
+	"int sized = sizeof (T) + 1;\n"
+	"int shadowed(int T) { return (T)-1; }\n")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-ast text ${WORK_DIR}/expression_trees.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE dump
+	ERROR_VARIABLE diagnostics)
+if (NOT result EQUAL 0 OR NOT diagnostics STREQUAL "")
+	message(FATAL_ERROR "expression_trees.c does not parse: ${diagnostics}")
+endif()
+
+# Checks that the declaration `name` is initialized with the tree given after it, one node per
+# argument, each indented two spaces for each of its parents.
+function(expect_initializer name)
+	set(tree "")
+	foreach(node IN LISTS ARGN)
+		string(APPEND tree "\n    ${node}")
+	endforeach()
+	string(FIND "${dump}" "\n  declaration name=${name} type=1 type_category=int${tree}\n  "
+		found)
+	if (found EQUAL -1)
+		message(FATAL_ERROR "${name} is not initialized with${tree}\nin: ${dump}")
+	endif()
+endfunction()
+
+expect_initializer(left
+	"expression op=subtract"
+	"  expression op=subtract"
+	"    expression op=numeric_literal value=1"
+	"    expression op=numeric_literal value=2"
+	"  expression op=numeric_literal value=3")
+expect_initializer(tighter
+	"expression op=add"
+	"  expression op=numeric_literal value=1"
+	"  expression op=multiply"
+	"    expression op=numeric_literal value=2"
+	"    expression op=numeric_literal value=3")
+expect_initializer(grouped
+	"expression op=multiply"
+	"  expression op=add"
+	"    expression op=numeric_literal value=1"
+	"    expression op=numeric_literal value=2"
+	"  expression op=numeric_literal value=3")
+expect_initializer(shifted
+	"expression op=shift_left"
+	"  expression op=numeric_literal value=1"
+	"  expression op=add"
+	"    expression op=numeric_literal value=2"
+	"    expression op=numeric_literal value=3")
+expect_initializer(logical
+	"expression op=logical_or"
+	"  expression op=numeric_literal value=1"
+	"  expression op=logical_and"
+	"    expression op=numeric_literal value=2"
+	"    expression op=numeric_literal value=3")
+expect_initializer(unary
+	"expression op=multiply"
+	"  expression op=negate"
+	"    expression op=identifier name=x"
+	"  expression op=numeric_literal value=2")
+expect_initializer(right
+	"expression op=assign"
+	"  expression op=identifier name=x"
+	"  expression op=assign"
+	"    expression op=identifier name=x"
+	"    expression op=numeric_literal value=1")
+expect_initializer(nested
+	"expression op=conditional"
+	"  expression op=numeric_literal value=1"
+	"  expression op=numeric_literal value=2"
+	"  expression op=conditional"
+	"    expression op=numeric_literal value=3"
+	"    expression op=numeric_literal value=4"
+	"    expression op=numeric_literal value=5")
+expect_initializer(cast
+	"expression op=cast type=1 type_category=int"
+	"  expression op=negate"
+	"    expression op=identifier name=x")
+expect_initializer(parenthesized
+	"expression op=subtract"
+	"  expression op=identifier name=x"
+	"  expression op=numeric_literal value=1")
+expect_initializer(sized
+	"expression op=add"
+	"  expression op=sizeof_type type=1 type_category=int"
+	"  expression op=numeric_literal value=1")
+
+# a parameter named like the typedef hides it, so that is a subtraction again
+string(CONCAT shadowed_body
+	"\n      statement token_count=7\n"
+	"        expression op=subtract\n"
+	"          expression op=identifier name=T\n"
+	"          expression op=numeric_literal value=1\n")
+string(FIND "${dump}" "${shadowed_body}" found)
+if (found EQUAL -1)
+	message(FATAL_ERROR "(T)-1 is not a subtraction where T is a parameter: ${dump}")
+endif()
+
+file(WRITE ${WORK_DIR}/expression_trees_malformed.c
+	"typedef int T;\n"
+	"int missing_operand = 1 +;\n"
+	"int missing_cast_operand = (T);\n"
+	"int missing_alternative = 1 ? 2;\n"
+	"int missing_inner_operand = 1 + (2 * );\n"
+	"int missing_operator = 1 2;\n"
+	"int missing_operator_after_parentheses = (1) 2;\n")
+parse_errors(diagnostics expression_trees_malformed.c)
+string(CONCAT expected
+	"^[^\n]*expression_trees_malformed.c \\(2, 26\\)\n"
+	"❌ expected an expression\n"
+	"[^\n]*expression_trees_malformed.c \\(3, 31\\)\n"
+	"❌ expected an expression\n"
+	"[^\n]*expression_trees_malformed.c \\(4, 32\\)\n"
+	"❌ expected an expression\n"
+	"[^\n]*expression_trees_malformed.c \\(5, 38\\)\n"
+	"❌ expected an expression\n"
+	"[^\n]*expression_trees_malformed.c \\(6, 26\\)\n"
+	"❌ expected ',' or ';' after the expression\n"
+	"[^\n]*expression_trees_malformed.c \\(7, 46\\)\n"
+	"❌ expected ',' or ';' after the expression\n$")
+if (NOT diagnostics MATCHES "${expected}")
+	message(FATAL_ERROR "wrong diagnostics: ${diagnostics}")
+endif()
@@ -0,0 +1,40 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Parses attribute specifiers that go wrong in every way an attribute can, each in a file of
+# its own, every way there is to parse. Each has to be reported, naming what it went wrong at,
+# and the same way every time, rather than crash the compiler.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+set(expected_identifier "expected an identifier, or a double colon")
+set(unexpected "expected a balanced set of parentheses, square brackets, or curly brackets")
+
+# Parses `source`, which has to be reported as `expected` says, the same way every time.
+function(check_attribute name source expected)
+	file(WRITE ${WORK_DIR}/malformed_attribute_${name}.c "${source}\n")
+	parse_errors(serial_errors malformed_attribute_${name}.c)
+	if (NOT serial_errors MATCHES "${expected}" OR serial_errors MATCHES "unknown source")
+		message(FATAL_ERROR "wrong diagnostics for '${source}': ${serial_errors}")
+	endif()
+	foreach(options "-fparallel-parse;-j;4" "-fpipeline-lexer" "-fskip-function-bodies")
+		parse_errors(errors malformed_attribute_${name}.c ${options})
+		if (NOT errors STREQUAL serial_errors)
+			message(FATAL_ERROR "parsing '${source}' with '${options}' reports differently: ${errors}")
+		endif()
+	endforeach()
+endfunction()
+
+check_attribute(semicolon "[[a;]];"
+	"\\(1, 4\\)\n❌ ${expected_identifier}[^\n]*\n[^\n]*\n❌ ${unexpected}[^\n]*unexpected ;\n")
+check_attribute(scope "[[a::;]] int x;" "\\(1, 6\\)\n❌ ${expected_identifier}")
+check_attribute(number "[[1]] int x;" "\\(1, 3\\)\n❌ ${expected_identifier}")
+check_attribute(arguments "[[a(]] int x;"
+	"\\(1, 4\\)\n❌ ${unexpected}[^\n]*unexpected \\(\n")
+check_attribute(end_of_input "[[a::" "${unexpected}[^\n]*unexpected end of input\n")
+check_attribute(list "[[a, 1]] int f(void) { return 0; }"
+	"\\(1, 6\\)\n❌ ${expected_identifier}")
@@ -0,0 +1,40 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Parses a translation unit with malformed expressions in initializers and in function bodies,
+# which have to be reported rather than skipped, along with a label, a statement the expression
+# parser does not take and a generic selection, which it does not know yet, which must not be.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/malformed_expression.c
+	"int x = ;\n"
+	"int y = 1 2;\n"
+	"int z = _Generic(1, int: 2);\n"
+	"int f(void) { return a +* ; }\n"
+	"int g(int a) { next: a = 1; if (a) return a; a b; return; }\n"
+	"int h(void) { return }\n")
+
+# bodies parsed with the rest, and parsed only once semantic analysis asks for them
+driver_diagnostics(parsed_diagnostics parse malformed_expression.c)
+driver_diagnostics(analyzed_diagnostics sema malformed_expression.c -fskip-function-bodies)
+string(CONCAT expected
+	"^[^\n]*malformed_expression.c \\(1, 9\\)\n"
+	"❌ expected an expression\n"
+	"[^\n]*malformed_expression.c \\(2, 11\\)\n"
+	"❌ expected ',' or ';' after the expression\n"
+	"[^\n]*malformed_expression.c \\(4, 27\\)\n"
+	"❌ expected an expression\n"
+	"[^\n]*malformed_expression.c \\(5, 48\\)\n"
+	"❌ expected ';' after the expression\n"
+	"[^\n]*malformed_expression.c \\(6, 22\\)\n"
+	"❌ expected an expression\n")
+foreach(diagnostics parsed_diagnostics analyzed_diagnostics)
+	if (NOT ${diagnostics} MATCHES "${expected}")
+		message(FATAL_ERROR "wrong diagnostics: ${${diagnostics}}")
+	endif()
+endforeach()
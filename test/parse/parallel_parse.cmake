@@ -0,0 +1,63 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Parses a translation unit that declares typedef-names all the way through, once serially and
+# once with -fparallel-parse. Every declaration uses the typedef-name declared just before it,
+# so a thread that has not been told about it misparses, and reports errors the serial parse
+# does not. Then parses a translation unit with a mistake in many of its declarations every way
+# there is: each has to report every mistake, in the same order, and carry on after it.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+set(declaration_count 200)
+
+set(source "typedef int t0;\n")
+foreach(index RANGE 1 ${declaration_count})
+	math(EXPR previous "${index} - 1")
+	string(APPEND source "typedef t${previous} t${index};\n")
+	string(APPEND source "t${index} f${index}(t${index} * p) { return (t${previous})*p + ${index}; }\n")
+	string(APPEND source "t${index} * v${index} = 0;\n")
+endforeach()
+file(WRITE ${WORK_DIR}/parallel_parse.c "${source}")
+
+parse_errors(serial_errors parallel_parse.c)
+parse_errors(parallel_errors parallel_parse.c -fparallel-parse -j 4)
+if (NOT serial_errors STREQUAL "")
+	message(FATAL_ERROR "the input does not parse serially: ${serial_errors}")
+endif()
+if (NOT parallel_errors STREQUAL "")
+	message(FATAL_ERROR "parallel parsing reports errors serial parsing does not: ${parallel_errors}")
+endif()
+
+# a declaration with a stray constant in every seventh line, and a stray `+` in every eleventh
+set(source "")
+foreach(index RANGE 1 ${declaration_count})
+	string(APPEND source "int v${index} = ${index};\n")
+	math(EXPR remainder "${index} % 7")
+	if (remainder EQUAL 0)
+		string(APPEND source "int bad${index} ${index};\n")
+	endif()
+	math(EXPR remainder "${index} % 11")
+	if (remainder EQUAL 0)
+		string(APPEND source "+ w${index};\n")
+	endif()
+	string(APPEND source "int g${index}(int a) { return a + v${index}; }\n")
+endforeach()
+file(WRITE ${WORK_DIR}/parallel_parse_errors.c "${source}")
+
+parse_errors(serial_errors parallel_parse_errors.c)
+string(REGEX MATCHALL "❌" reported "${serial_errors}")
+list(LENGTH reported reported_count)
+if (NOT reported_count EQUAL 46)
+	message(FATAL_ERROR "expected 46 errors: ${serial_errors}")
+endif()
+foreach(options "-fparallel-parse;-j;2" "-fparallel-parse;-j;8" "-fpipeline-lexer")
+	parse_errors(errors parallel_parse_errors.c ${options})
+	if (NOT errors STREQUAL serial_errors)
+		message(FATAL_ERROR "parsing with '${options}' reports differently: ${errors}")
+	endif()
+endforeach()
@@ -0,0 +1,62 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Parses a translation unit many times larger than the lexer's queue, once after lexing all of
+# it and once with -fpipeline-lexer. Function bodies straddle the batches the tokens are handed
+# over in, so a parser that does not wait for the rest of a body reports it as unbalanced.
+# Then does the same with a translation unit of constants to fold, whose literals the parser
+# reads while the lexer is still adding more of them.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+set(function_count 2000)
+
+set(source "typedef int t;\n")
+foreach(index RANGE 1 ${function_count})
+	string(APPEND source "/* function ${index} */\n")
+	string(APPEND source "t f${index}(t * p, t q) {\n\tt r = (p[q] + ${index}) * (q - 1);\n")
+	string(APPEND source "\treturn r ? r : f${index}(p, q - 1); // recurse\n}\n")
+endforeach()
+file(WRITE ${WORK_DIR}/pipeline_lexer.c "${source}")
+
+parse_errors(serial_errors pipeline_lexer.c)
+parse_errors(pipelined_errors pipeline_lexer.c -fpipeline-lexer)
+parse_errors(pipelined_skipping_errors pipeline_lexer.c -fpipeline-lexer
+	-fskip-function-bodies)
+if (NOT serial_errors STREQUAL "")
+	message(FATAL_ERROR "the input does not parse serially: ${serial_errors}")
+endif()
+foreach(errors pipelined_errors pipelined_skipping_errors)
+	if (NOT ${errors} STREQUAL "")
+		message(FATAL_ERROR "pipelined parsing reports errors serial parsing does not: ${${errors}}")
+	endif()
+endforeach()
+
+# every 500th assertion fails, and says which it is with its message
+set(constant_count 3000)
+set(source "")
+foreach(index RANGE 1 ${constant_count})
+	math(EXPR value "${index} * 3 + ${index} % 7")
+	math(EXPR remainder "${index} % 500")
+	if (remainder EQUAL 0)
+		math(EXPR value "${value} + 1")
+	endif()
+	string(APPEND source "constexpr int c${index} = ${index} * 3 + ${index} % 7;\n")
+	string(APPEND source "static_assert(c${index} == ${value}, \"constant ${index}\");\n")
+endforeach()
+file(WRITE ${WORK_DIR}/pipeline_lexer_constants.c "${source}")
+
+parse_errors(serial_errors pipeline_lexer_constants.c)
+parse_errors(pipelined_errors pipeline_lexer_constants.c -fpipeline-lexer)
+string(REGEX MATCHALL "static assertion failed: \"constant [0-9]+\"" failed "${serial_errors}")
+list(LENGTH failed failed_count)
+if (NOT failed_count EQUAL 6)
+	message(FATAL_ERROR "expected 6 failed assertions: ${serial_errors}")
+endif()
+if (NOT pipelined_errors STREQUAL serial_errors)
+	message(FATAL_ERROR "pipelined parsing folds constants differently: ${pipelined_errors}")
+endif()
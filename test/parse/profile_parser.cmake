@@ -0,0 +1,56 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Parses a translation unit with -fprofile-parser. Every declaration is first tried as a
+# function definition, which fails only once its declarator has been parsed, so the report has
+# to show the parser backtracking out of function definitions. The declaration then replays the
+# specifiers and declarator the function definition parsed, which -fdebug-parser counts.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+set(declaration_count 50)
+
+set(source "")
+foreach(index RANGE 1 ${declaration_count})
+	string(APPEND source "int v${index}[${index}];\n")
+	string(APPEND source "int f${index}(int p) { return p * ${index}; }\n")
+endforeach()
+file(WRITE ${WORK_DIR}/profile_parser.c "${source}")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fprofile-parser ${WORK_DIR}/profile_parser.c
+	RESULT_VARIABLE result
+	OUTPUT_QUIET
+	ERROR_VARIABLE report)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "parsing with -fprofile-parser failed")
+endif()
+if (report MATCHES "❌")
+	message(FATAL_ERROR "the input does not parse: ${report}")
+endif()
+string(FIND "${report}" "parser profile: backtrack sites" sites_begin)
+if (sites_begin EQUAL -1)
+	message(FATAL_ERROR "no profile was reported: ${report}")
+endif()
+string(SUBSTRING "${report}" ${sites_begin} -1 sites)
+if (NOT sites MATCHES "parse_function_definition \\| +${declaration_count} \\|")
+	message(FATAL_ERROR "backtracking out of each declaration was not reported: ${sites}")
+endif()
+
+math(EXPR memoized_rule_count "${declaration_count} * 2")
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdebug-parser ${WORK_DIR}/profile_parser.c
+	RESULT_VARIABLE result
+	OUTPUT_QUIET
+	ERROR_VARIABLE trace)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "parsing with -fdebug-parser failed")
+endif()
+set(replayed "${memoized_rule_count} re-parses out of ${memoized_rule_count} lookups")
+if (NOT trace MATCHES "saved ${replayed}")
+	message(FATAL_ERROR "the declarations did not replay what the function definitions parsed")
+endif()
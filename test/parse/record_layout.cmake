@@ -0,0 +1,64 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Checks the layouts -fdump-record-layouts gives structures and unions on the default target
+# (x86-64 System V): member offsets, bit-field placement (including unnamed and zero-width
+# bit-fields), `_Padding`, `alignas`, and records inside records.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/record_layout.c
+	"struct bits { unsigned a : 3; unsigned : 0; char c; unsigned long b : 40; int : 5; "
+	"short s; };\n"
+	"union either { char c; double d; int numbers[3]; };\n"
+	"struct padded { int meow; _Padding(16) padding; short bark; };\n"
+	"struct outer { char tag; struct inner { char c; long l; } in; struct bits *next; };\n"
+	"struct aligned { char c; alignas(16) int x; alignas(long) char y; };\n"
+	"struct flexible { int count; char data[]; };\n")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-record-layouts
+		${WORK_DIR}/record_layout.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE layouts)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "parsing failed")
+endif()
+
+string(CONCAT expected
+	"struct bits size=16 alignment=8\n"
+	"  a offset=0 bit_offset=0 bit_width=3\n"
+	"  \\(unnamed\\) offset=4\n"
+	"  c offset=4\n"
+	"  b offset=8 bit_offset=64 bit_width=40\n"
+	"  \\(unnamed\\) offset=13 bit_offset=104 bit_width=5\n"
+	"  s offset=14\n"
+	"union either size=16 alignment=8\n"
+	"  c offset=0\n"
+	"  d offset=0\n"
+	"  numbers offset=0\n"
+	"struct padded size=8 alignment=4\n"
+	"  meow offset=0\n"
+	"  padding offset=4 bit_offset=32 bit_width=16\n"
+	"  bark offset=6\n"
+	"struct inner size=16 alignment=8\n"
+	"  c offset=0\n"
+	"  l offset=8\n"
+	"struct outer size=32 alignment=8\n"
+	"  tag offset=0\n"
+	"  in offset=8\n"
+	"  next offset=24\n"
+	"struct aligned size=32 alignment=16\n"
+	"  c offset=0\n"
+	"  x offset=16\n"
+	"  y offset=24\n"
+	"struct flexible size=4 alignment=4\n"
+	"  count offset=0\n"
+	"  data offset=4\n")
+if (NOT layouts MATCHES "^${expected}$")
+	message(FATAL_ERROR "wrong layouts: ${layouts}")
+endif()
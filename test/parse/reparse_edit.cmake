@@ -0,0 +1,124 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Makes edits to a translation unit with -freparse-edit, which parses it, makes the edit and
+# brings the AST up to date by parsing again only what the edit touches, and checks that the
+# AST comes out the same as it does from parsing the edited text from scratch. (Type numbers
+# are left out of the comparison: the types of what was replaced are still in the module.)
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+string(CONCAT source
+	"typedef int count_type;\n"
+	"int base = 3;\n"
+	"/* adds its arguments */\n"
+	"int add(int a, int b) { return a + b; }\n"
+	"count_type twice(count_type v) { return add(v, v) * base; }\n"
+	"int g = 4, *h;\n"
+	"int last(void) { return twice(2); }\n"
+	"[[deprecated]] int old_one(int q);\n")
+file(WRITE ${WORK_DIR}/reparse_edit.c "${source}")
+
+# The text AST dump of parsing `file` (and running `-freparse-edit` with `edit`, if it is not
+# empty), without the type numbers.
+function(dump_ast out_variable file edit)
+	if (edit STREQUAL "")
+		# the same command either way: with no edit, it just asks for the same dump twice
+		set(edit_option -fdump-ast)
+		set(edit "text")
+	else()
+		set(edit_option -freparse-edit)
+	endif()
+	execute_process(
+		COMMAND ${DRIVER} -fstop-after-phase parse -fdump-ast text ${edit_option} "${edit}"
+			${file}
+		RESULT_VARIABLE result
+		OUTPUT_VARIABLE dump
+		ERROR_VARIABLE diagnostics)
+	if (NOT result EQUAL 0 OR diagnostics MATCHES "❌")
+		message(FATAL_ERROR "parsing ${file} failed: ${diagnostics}")
+	endif()
+	string(REGEX REPLACE " type=[0-9]+" "" dump "${dump}")
+	set(${out_variable} "${dump}" PARENT_SCOPE)
+endfunction()
+
+# Replaces `old` with `new`, which should mean parsing `expected` of the tokens again: "some"
+# or "all".
+function(check_edit old new expected)
+	string(FIND "${source}" "${old}" offset)
+	string(LENGTH "${old}" length)
+	string(SUBSTRING "${source}" 0 ${offset} before)
+	math(EXPR after_offset "${offset} + ${length}")
+	string(SUBSTRING "${source}" ${after_offset} -1 after)
+	file(WRITE ${WORK_DIR}/reparse_edit_fresh.c "${before}${new}${after}")
+
+	set(edit "${offset},${length},${new}")
+	dump_ast(edited ${WORK_DIR}/reparse_edit.c "${edit}")
+	dump_ast(fresh ${WORK_DIR}/reparse_edit_fresh.c "")
+	if (NOT edited STREQUAL fresh)
+		message(FATAL_ERROR "replacing '${old}' with '${new}' gives\n${edited}\nrather than\n${fresh}")
+	endif()
+
+	execute_process(
+		COMMAND ${DRIVER} -v -fstop-after-phase parse -freparse-edit "${edit}"
+			${WORK_DIR}/reparse_edit.c
+		OUTPUT_VARIABLE report
+		ERROR_QUIET)
+	if (NOT report MATCHES "Parsed ([0-9]+) of ([0-9]+) tokens again")
+		message(FATAL_ERROR "replacing '${old}' with '${new}' did not say what it parsed again")
+	endif()
+	if (expected STREQUAL "all" AND NOT CMAKE_MATCH_1 EQUAL CMAKE_MATCH_2)
+		message(FATAL_ERROR "replacing '${old}' with '${new}' only parsed ${CMAKE_MATCH_1} of ${CMAKE_MATCH_2} tokens again")
+	endif()
+	math(EXPR half_of_the_tokens "${CMAKE_MATCH_2} / 2")
+	if (expected STREQUAL "some" AND NOT CMAKE_MATCH_1 LESS half_of_the_tokens)
+		message(FATAL_ERROR "replacing '${old}' with '${new}' parsed ${CMAKE_MATCH_1} of ${CMAKE_MATCH_2} tokens again")
+	endif()
+endfunction()
+
+# within one function body, or one comment
+check_edit("a + b" "a * b" some)
+check_edit("its arguments" "both numbers" some)
+# adding, renaming and removing declarations
+check_edit("int g = 4, *h;" "int g = 4, *h, i = 5; int extra;" some)
+check_edit("int last(void)" "int final_one(void)" some)
+check_edit("int last(void) { return twice(2); }\n" "" some)
+# what every declaration after it depends on
+check_edit("typedef int count_type;" "typedef long count_type;" all)
+
+# Editing the same function body over and over, as someone typing does: the AST comes out as it
+# does from parsing the last text from scratch, and each edit takes the place of the nodes the
+# one before made rather than adding to them.
+string(FIND "${source}" "a + b" offset)
+set(edit_options)
+foreach (replacement "a * b" "a - b" "a / b")
+	list(APPEND edit_options -freparse-edit "${offset},5,${replacement}")
+endforeach()
+execute_process(
+	COMMAND ${DRIVER} -v -fstop-after-phase parse -fdump-ast text ${edit_options}
+		${WORK_DIR}/reparse_edit.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE report
+	ERROR_VARIABLE diagnostics)
+if (NOT result EQUAL 0 OR diagnostics MATCHES "❌")
+	message(FATAL_ERROR "editing add over and over failed: ${diagnostics}")
+endif()
+string(REGEX MATCHALL "into [0-9]+ nodes" node_counts "${report}")
+list(LENGTH node_counts edit_count)
+list(REMOVE_DUPLICATES node_counts)
+list(LENGTH node_counts different_counts)
+if (NOT edit_count EQUAL 3 OR NOT different_counts EQUAL 1)
+	message(FATAL_ERROR "editing add over and over grew the node table:\n${report}")
+endif()
+string(REPLACE "a + b" "a / b" edited_source "${source}")
+file(WRITE ${WORK_DIR}/reparse_edit_fresh.c "${edited_source}")
+dump_ast(fresh ${WORK_DIR}/reparse_edit_fresh.c "")
+string(REGEX REPLACE " type=[0-9]+" "" edited "${report}")
+string(FIND "${edited}" "${fresh}" found)
+if (found EQUAL -1)
+	message(FATAL_ERROR "editing add over and over gives\n${edited}\nrather than\n${fresh}")
+endif()
@@ -0,0 +1,102 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Checks what semantic analysis reports about a translation unit: undeclared names, things
+# assigned to that cannot be, calls of things that are not functions, `return`s that disagree
+# with their function and functions defined twice. Then checks a translation unit with many
+# function bodies, some of them wrong, once on one thread and once on several, with its bodies
+# parsed with the rest and parsed later: the diagnostics have to be the same, in the same order.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/semantic_analysis.c
+	"int counter;\n"
+	"int table[4];\n"
+	"int helper(int n);\n"
+	"void reset(void) {\n"
+	"	counter = 0;\n"
+	"	return counter;\n"
+	"}\n"
+	"int next(int step) {\n"
+	"	int local;\n"
+	"	local = step + __func__[0];\n"
+	"	counter += step + missing;\n"
+	"	5 = counter;\n"
+	"	table = 0;\n"
+	"	helper = 0;\n"
+	"	step(2);\n"
+	"	local(3);\n"
+	"	helper(local)++;\n"
+	"	return;\n"
+	"}\n"
+	"int helper(int n) {\n"
+	"	return n;\n"
+	"}\n"
+	"int helper(int n) {\n"
+	"	return n;\n"
+	"}\n")
+
+driver_diagnostics(diagnostics sema semantic_analysis.c -j 1)
+string(CONCAT expected
+	"semantic_analysis.c \\(6, 2\\)\n"
+	"❌ function 'reset' returns void, but this returns a value\n"
+	"[^\n]*semantic_analysis.c \\(11, 20\\)\n"
+	"❌ use of undeclared identifier 'missing'\n"
+	"[^\n]*semantic_analysis.c \\(12, 4\\)\n"
+	"❌ expression is not assignable\n"
+	"[^\n]*semantic_analysis.c \\(13, 2\\)\n"
+	"❌ cannot modify 'table', which is not a modifiable lvalue\n"
+	"[^\n]*semantic_analysis.c \\(14, 2\\)\n"
+	"❌ cannot modify 'helper', which is not a modifiable lvalue\n"
+	"[^\n]*semantic_analysis.c \\(15, 2\\)\n"
+	"❌ called object 'step' is not a function\n"
+	"[^\n]*semantic_analysis.c \\(17, 15\\)\n"
+	"❌ expression is not assignable\n"
+	"[^\n]*semantic_analysis.c \\(18, 2\\)\n"
+	"❌ function 'next' returns a value, but this returns none\n"
+	"[^\n]*semantic_analysis.c \\(23, 5\\)\n"
+	"❌ redefinition of function 'helper'\n$")
+if (NOT diagnostics MATCHES "${expected}")
+	message(FATAL_ERROR "wrong diagnostics: ${diagnostics}")
+endif()
+string(REGEX MATCHALL "❌" reported "${diagnostics}")
+list(LENGTH reported reported_count)
+if (NOT reported_count EQUAL 9)
+	message(FATAL_ERROR "expected 9 diagnostics: ${diagnostics}")
+endif()
+
+# Bodies of very different sizes, so that the threads have to steal from each other, with an
+# undeclared name in every seventh one.
+set(function_count 400)
+set(source "int shared;\n")
+foreach(index RANGE 1 ${function_count})
+	string(APPEND source "int f${index}(int a) {\n")
+	math(EXPR statement_count "(${index} * 37) % 61")
+	foreach(statement RANGE ${statement_count})
+		string(APPEND source "	a = a + shared * ${statement};\n")
+	endforeach()
+	math(EXPR remainder "${index} % 7")
+	if (remainder EQUAL 0)
+		string(APPEND source "	a = a + unknown${index};\n")
+	endif()
+	string(APPEND source "	return a;\n}\n")
+endforeach()
+file(WRITE ${WORK_DIR}/semantic_analysis_bodies.c "${source}")
+
+driver_diagnostics(serial_diagnostics sema semantic_analysis_bodies.c -j 1)
+string(REGEX MATCHALL "❌" reported "${serial_diagnostics}")
+list(LENGTH reported reported_count)
+if (NOT reported_count EQUAL 57)
+	message(FATAL_ERROR "expected 57 diagnostics: ${serial_diagnostics}")
+endif()
+foreach(options "-j;4" "-j;8" "-fskip-function-bodies;-j;4")
+	driver_diagnostics(parallel_diagnostics sema semantic_analysis_bodies.c ${options})
+	if (NOT parallel_diagnostics STREQUAL serial_diagnostics)
+		message(FATAL_ERROR
+			"analyzing with '${options}' reports differently: ${parallel_diagnostics}")
+	endif()
+endforeach()
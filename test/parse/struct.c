@@ -5,4 +5,9 @@ struct s {
 typedef struct {
   bool field;
 } var;
-// CHECK: unimplemented keyword 'struct'
+// CHECK: tok_keyword_struct
+// CHECK: tok_id: s
+// CHECK: tok_id: field
+// CHECK: tok_keyword_typedef
+// CHECK: tok_keyword_struct
+// CHECK: tok_id: var
@@ -0,0 +1,84 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Checks that every mention of the same type is the same type, whether it is spelled out or
+# named by a typedef, and that storage classes stay with the declarations rather than making
+# types of their own. Then checks that structures with the same members are still different
+# types, on one thread and on several.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/type_interning.c
+	"typedef unsigned long size;\n"
+	"static unsigned long first;\n"
+	"extern size second;\n"
+	"unsigned long third = sizeof(size) + (unsigned long)1;\n"
+	"static int other;\n")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-ast text ${WORK_DIR}/type_interning.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE dump)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "parsing failed")
+endif()
+
+if (NOT dump MATCHES "declaration name=size type=([0-9]+) [^\n]* typedef=true\n")
+	message(FATAL_ERROR "the typedef is missing or lost its storage class: ${dump}")
+endif()
+set(unsigned_long ${CMAKE_MATCH_1})
+foreach (mention
+		"declaration name=first type=${unsigned_long} [^\n]* static=true\n"
+		"declaration name=second type=${unsigned_long} [^\n]* extern=true\n"
+		"declaration name=third type=${unsigned_long} "
+		"op=sizeof_type type=${unsigned_long} "
+		"op=cast type=${unsigned_long} ")
+	if (NOT dump MATCHES "${mention}")
+		message(FATAL_ERROR "a mention of unsigned long is a type of its own: ${dump}")
+	endif()
+endforeach()
+
+if (NOT dump MATCHES "declaration name=other type=([0-9]+) ")
+	message(FATAL_ERROR "the declaration of other is missing: ${dump}")
+endif()
+if (CMAKE_MATCH_1 EQUAL unsigned_long)
+	message(FATAL_ERROR "int and unsigned long are the same type: ${dump}")
+endif()
+
+file(WRITE ${WORK_DIR}/type_interning_records.c
+	"struct first { int x; } a;\n"
+	"struct second { int x; } b;\n"
+	"typedef struct { int x; } third;\n"
+	"struct first c;\n"
+	"int f(void) { return 0; }\n"
+	"third d;\n"
+	"third e;\n")
+
+foreach (threads 1 4)
+	execute_process(
+		COMMAND ${DRIVER} -fstop-after-phase parse -fparallel-parse -j ${threads}
+			-fdump-ast text ${WORK_DIR}/type_interning_records.c
+		RESULT_VARIABLE result
+		OUTPUT_VARIABLE dump)
+	if (NOT result EQUAL 0)
+		message(FATAL_ERROR "parsing failed on ${threads} threads")
+	endif()
+	foreach (name a b c d e)
+		if (NOT dump MATCHES "declaration name=${name} type=([0-9]+) ")
+			message(FATAL_ERROR "the declaration of ${name} is missing: ${dump}")
+		endif()
+		set(type_of_${name} ${CMAKE_MATCH_1})
+	endforeach()
+	if (type_of_a EQUAL type_of_b OR type_of_a EQUAL type_of_d OR type_of_b EQUAL type_of_d)
+		message(FATAL_ERROR
+			"structures with the same members are the same type on ${threads} threads: ${dump}")
+	endif()
+	if (NOT type_of_a EQUAL type_of_c OR NOT type_of_d EQUAL type_of_e)
+		message(FATAL_ERROR
+			"a mention of a structure is a type of its own on ${threads} threads: ${dump}")
+	endif()
+endforeach()
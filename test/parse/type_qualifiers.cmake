@@ -0,0 +1,63 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Checks that type qualifiers end up on the types they qualify: wherever they are among the
+# specifiers, through a typedef-name, and on each pointer of a declarator, with the same
+# qualified type interned once.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/type_qualifiers.c
+	"static const int a = 1;\n"
+	"int const volatile b;\n"
+	"typedef const int const_int;\n"
+	"volatile const_int c;\n"
+	"const int *d;\n"
+	"int *const *volatile e;\n"
+	"struct s { const int m; } const f;\n"
+	"static_assert(sizeof(const int) == 4 && (const int)3 == 3);\n")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-ast text ${WORK_DIR}/type_qualifiers.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE dump
+	ERROR_VARIABLE diagnostics)
+if (NOT result EQUAL 0 OR NOT diagnostics STREQUAL "")
+	message(FATAL_ERROR "type_qualifiers.c does not parse: ${diagnostics}")
+endif()
+
+function(type_of out_variable name)
+	if (NOT dump MATCHES "\n  declaration name=${name} type=([0-9]+) ([^\n]*)\n")
+		message(FATAL_ERROR "${name} is not in the dump: ${dump}")
+	endif()
+	set(${out_variable} "${CMAKE_MATCH_1} ${CMAKE_MATCH_2}" PARENT_SCOPE)
+endfunction()
+
+foreach(name a b c d e f)
+	type_of(${name}_type ${name})
+endforeach()
+if (NOT a_type MATCHES "^[0-9]+ type_category=int const=true static=true$")
+	message(FATAL_ERROR "a is not a const int: ${a_type}")
+endif()
+if (NOT b_type MATCHES "^([0-9]+) type_category=int const=true volatile=true$")
+	message(FATAL_ERROR "b is not a const volatile int: ${b_type}")
+endif()
+if (NOT c_type STREQUAL b_type)
+	message(FATAL_ERROR "c (${c_type}) is not the same type as b (${b_type})")
+endif()
+if (NOT d_type MATCHES "^[0-9]+ type_category=pointer$")
+	message(FATAL_ERROR "d is not an unqualified pointer: ${d_type}")
+endif()
+if (NOT e_type MATCHES "^[0-9]+ type_category=pointer volatile=true$")
+	message(FATAL_ERROR "e is not a volatile pointer: ${e_type}")
+endif()
+if (NOT f_type MATCHES "^[0-9]+ type_category=struct const=true$")
+	message(FATAL_ERROR "f is not a const structure: ${f_type}")
+endif()
+if (NOT dump MATCHES "\n    member_declaration name=m type=[0-9]+ type_category=int const=true ")
+	message(FATAL_ERROR "m is not a const int: ${dump}")
+endif()
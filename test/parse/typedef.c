@@ -1,2 +1,12 @@
 typedef int my_int;
-// CHECK: unimplemented keyword
+typedef unsigned long size;
+my_int x, *y;
+size count;
+my_int twice(my_int value, size) { return value * 2; }
+int hidden(int my_int) { return my_int * 2; }
+// CHECK: tok_keyword_typedef
+// CHECK: tok_id: my_int
+// CHECK: tok_id: my_int
+// CHECK: tok_id: x
+// CHECK: tok_id: size
+// CHECK: tok_id: count
@@ -0,0 +1,58 @@
+# =============================================================================
+# a_c_compiler
+#
+# © Asher Mancinelli & JeanHeyd "ThePhD" Meneide
+# All rights reserved.
+# ============================================================================ #
+
+# Checks that the parser tells a typedef-name apart from an ordinary identifier: as the type of
+# a declaration, as the type of an unnamed parameter and in a cast, and not where a parameter
+# of the same name hides it, where `(my_int)-1` is a subtraction rather than a cast. The lexer
+# test in typedef.c only sees the tokens, which are the same either way.
+
+include(${CMAKE_CURRENT_LIST_DIR}/../driver_script.cmake)
+
+file(WRITE ${WORK_DIR}/typedef_names.c
+	"typedef int my_int;\n"
+	"typedef unsigned long size;\n"
+	"my_int x, *y;\n"
+	"size count;\n"
+	"my_int twice(my_int value, size) { return (my_int)-value; }\n"
+	"int hidden(int my_int) { return (my_int)-1; }\n"
+	"my_int after;\n")
+
+execute_process(
+	COMMAND ${DRIVER} -fstop-after-phase parse -fdump-ast text ${WORK_DIR}/typedef_names.c
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE dump
+	ERROR_VARIABLE diagnostics)
+if (NOT result EQUAL 0 OR NOT diagnostics STREQUAL "")
+	message(FATAL_ERROR "parsing failed: ${diagnostics}")
+endif()
+
+string(CONCAT expected
+	"translation_unit\n"
+	"  declaration name=my_int type=1 type_category=int typedef=true\n"
+	"  declaration name=size type=2 type_category=long typedef=true\n"
+	"  declaration name=x type=1 type_category=int\n"
+	"  declaration name=y type=3 type_category=pointer\n"
+	"  declaration name=count type=2 type_category=long\n"
+	"  function_definition name=twice type=4 type_category=function body_token_count=9\n"
+	"    parameter_declaration name=value type=1 type_category=int\n"
+	"    parameter_declaration type=2 type_category=long\n"
+	"    compound_statement\n"
+	"      statement token_count=7\n"
+	"        expression op=cast type=1 type_category=int\n"
+	"          expression op=negate\n"
+	"            expression op=identifier name=value\n"
+	"  function_definition name=hidden type=5 type_category=function body_token_count=9\n"
+	"    parameter_declaration name=my_int type=1 type_category=int\n"
+	"    compound_statement\n"
+	"      statement token_count=7\n"
+	"        expression op=subtract\n"
+	"          expression op=identifier name=my_int\n"
+	"          expression op=numeric_literal value=1\n"
+	"  declaration name=after type=1 type_category=int\n")
+if (NOT dump STREQUAL expected)
+	message(FATAL_ERROR "typedef-names and identifiers are mixed up: ${dump}")
+endif()
@@ -0,0 +1,17 @@
+#include "include/quoted.h"
+#include <angled.h>
+// angled includes that are not found are assumed to be system headers
+#include <stdio.h>
+#if defined(NOT_EVER_DEFINED)
+// missing quoted includes are fine when they might be compiled out
+#include "missing_but_conditional.h"
+#endif
+/* #include "commented_out.h" */
+const char* s = "#include \"in_a_string.h\"";
+#embed "include/embedded.txt"
+
+// CHECK: include.o:
+// CHECK: include/quoted.h
+// CHECK: include/nested/nested.h
+// CHECK: angled.h
+// CHECK: include/embedded.txt
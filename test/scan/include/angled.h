@@ -0,0 +1,7 @@
+#ifndef ANGLED_H
+#define ANGLED_H
+
+// already seen through quoted.h, so it is only listed once
+#include "nested/nested.h"
+
+#endif
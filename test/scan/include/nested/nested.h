@@ -0,0 +1,4 @@
+#pragma once
+
+#define NESTED_VALUE \
+	1
@@ -0,0 +1,6 @@
+#ifndef QUOTED_H
+#define QUOTED_H
+
+#include "nested/nested.h"
+
+#endif